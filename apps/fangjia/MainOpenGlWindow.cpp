@@ -17,8 +17,14 @@
 #include <qtimer.h>
 #include <qcolor.h>
 #include <qopenglwindow.h>
+#include <FrameCapture.h>
+#include <FrameClock.h>
+#include <RasterCache.h>
 #include <RenderData.hpp>
+#include <RenderThread.h>
+#include <RenderUtils.hpp>
 #include <UiNav.h>
+#include <UiRetained.h>
 #include <UiTopBar.h>
 #include <GL/gl.h>
 #include <memory>
@@ -26,13 +32,21 @@
 #include <qsize.h>
 #include <qstring.h>
 
+#include <algorithm>
 #include <qbytearray.h>
+#include <qdatetime.h>
+#include <qdir.h>
 #include <qevent.h>
+#include <qfont.h>
 #include <qnamespace.h>
 #include <qrect.h>
+#include <qscreen.h>
 #include <qwindow.h>
+#include <cmath>
+#include <cstddef>
 #include <exception>
 #include <qlogging.h>
+#include <qglobal.h>
 #include <utility>
 #include <Binding.h>
 #include <ComponentWrapper.h>
@@ -71,15 +85,15 @@ MainOpenGlWindow::MainOpenGlWindow(
 	try
 	{
 		qDebug() << "MainOpenGlWindow constructor start";
+		m_startupClock.start();
 
 		// Bootstrap the database during app initialization
 		Data::DatabaseBootstrapper::initialize();
 
-		// 设置动画定时器
-		connect(&m_animTimer, &QTimer::timeout, this, &MainOpenGlWindow::onAnimationTick);
-		m_animTimer.setTimerType(Qt::PreciseTimer);
-		m_animTimer.setInterval(16);
-		m_animClock.start();
+		// 出帧调度：交换完成时请求下一动画帧；刷新间隔跟随所在屏幕
+		connect(this, &QOpenGLWindow::frameSwapped, this, &MainOpenGlWindow::onFrameSwapped);
+		connect(this, &QWindow::screenChanged, this, &MainOpenGlWindow::onScreenChanged);
+		onScreenChanged(screen());
 
 		qDebug() << "MainOpenGlWindow constructor end";
 	}
@@ -112,7 +126,27 @@ MainOpenGlWindow::~MainOpenGlWindow()
 #endif
 
 		makeCurrent();
+		// 渲染线程先停下：其排队的纹理操作在窗口上下文中执行完，图集才能整体释放
+		if (m_renderThread)
+		{
+			m_renderThread->stop();
+			m_renderThread.reset();
+		}
+		if (qEnvironmentVariableIsSet("FJ_ATLAS_STATS"))
+		{
+			const auto st = m_iconCache.atlasStats();
+			qDebug() << "Atlas stats: mode" << (m_iconCache.rasterMode() == IconCache::RasterMode::Sdf ? "sdf" : "bitmap")
+				<< "pages" << st.pageCount << "maskPages" << st.maskPageCount << "bytes" << st.textureBytes << "entries" << st.entryCount
+				<< "glyphs" << st.glyphCount << "aliases" << st.aliasCount
+				<< "occupancy" << st.occupancy << "fragmentation" << st.fragmentation;
+			const auto cs = m_iconCache.cacheStats();
+			qDebug() << "Icon cache: hits" << cs.hits << "misses" << cs.misses << "evictions" << cs.evictions
+				<< "bytes" << cs.bytes << "budget" << cs.budgetBytes;
+		}
 		m_iconCache.releaseAll(this);
+		// 等待仍在执行的栅格化任务，之后不再有完成回调
+		m_iconCache.setAsyncRaster(false);
+		m_iconCache.setRasterReadyCallback({});
 		m_renderer.releaseGL();
 		doneCurrent();
 	}
@@ -132,7 +166,91 @@ void MainOpenGlWindow::initializeGL()
 		glEnable(GL_BLEND);
 		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+		// 渲染器开关：单线程时作用于m_renderer，渲染线程模式下在渲染线程中作用于其渲染器
+		const auto configureRenderer = [](Renderer& renderer)
+			{
+				// 对比/排查用：设置FJ_RENDER_IMMEDIATE时退回逐命令绘制路径
+				if (qEnvironmentVariableIsSet("FJ_RENDER_IMMEDIATE"))
+				{
+					renderer.setSubmitPath(Renderer::SubmitPath::Immediate);
+				}
+				// 设置FJ_STREAM_ORPHAN时流式缓冲改用每帧孤立化（对比非同步映射 + 栅栏的效果）
+				if (qEnvironmentVariableIsSet("FJ_STREAM_ORPHAN"))
+				{
+					renderer.setStreamMode(StreamBuffer::Mode::Orphan);
+				}
+				// 设置FJ_OCCLUSION_CULL=0时关闭遮挡剔除（剪裁与视口剔除保留）
+				if (qEnvironmentVariable("FJ_OCCLUSION_CULL") == QStringLiteral("0"))
+				{
+					renderer.setOcclusionCullingEnabled(false);
+				}
+				// 设置FJ_OPAQUE_PASS=0时关闭不透明深度预通道（全部命令按原方式混合绘制）
+				if (qEnvironmentVariable("FJ_OPAQUE_PASS") == QStringLiteral("0"))
+				{
+					renderer.setOpaquePassEnabled(false);
+				}
+			};
 		m_renderer.initializeGL(this);
+		configureRenderer(m_renderer);
+		// 设置FJ_RENDER_THREAD时由渲染线程绘制（共享上下文 + 离屏帧缓冲），本线程只录制并合成结果
+		if (qEnvironmentVariableIsSet("FJ_RENDER_THREAD"))
+		{
+			m_renderThread = std::make_unique<RenderThread>(m_iconCache);
+			m_renderThread->setFrameReadyCallback([this]
+				{
+					QMetaObject::invokeMethod(this, [this] { m_scheduler.requestFrame(); }, Qt::QueuedConnection);
+				});
+			if (!m_renderThread->startRendering(context(), configureRenderer))
+			{
+				qWarning() << "Render thread unavailable, falling back to single-threaded rendering";
+				m_renderThread.reset();
+			}
+		}
+		// 局部重绘需要窗口保留上一帧；设置FJ_RENDER_FULL时退回每帧整窗重绘，FJ_DEBUG_DAMAGE标出重绘区域
+		// 渲染线程每帧整帧重绘到离屏帧缓冲，窗口侧不做局部重绘
+		m_partialRepaint = updateBehavior() != NoPartialUpdate && !qEnvironmentVariableIsSet("FJ_RENDER_FULL") && !m_renderThread;
+		m_debugDamage = m_partialRepaint && qEnvironmentVariableIsSet("FJ_DEBUG_DAMAGE");
+		// 帧剖析与耗时叠加层
+		if (qEnvironmentVariableIsSet("FJ_PROFILE_HUD"))
+		{
+			setProfilerHudVisible(true);
+		}
+		else if (qEnvironmentVariableIsSet("FJ_PROFILE"))
+		{
+			setProfilingEnabled(true);
+		}
+		// 帧捕获：FJ_CAPTURE_FRAMES=120,300 捕获第120与第300帧
+		m_captureDir = qEnvironmentVariable("FJ_CAPTURE_DIR", QDir::temp().filePath("fangjia_captures"));
+		for (const QString& part : qEnvironmentVariable("FJ_CAPTURE_FRAMES").split(',', Qt::SkipEmptyParts))
+		{
+			bool ok = false;
+			const quint64 index = part.trimmed().toULongLong(&ok);
+			if (ok && index > 0) m_captureFrames.push_back(index);
+		}
+		std::sort(m_captureFrames.begin(), m_captureFrames.end());
+		// 设置FJ_RENDER_SDF时字形与白膜图标改用距离场缓存（可用atlasStats对比两种模式的纹理数与显存）
+		if (qEnvironmentVariableIsSet("FJ_RENDER_SDF"))
+		{
+			m_iconCache.setRasterMode(IconCache::RasterMode::Sdf, this);
+		}
+		// SVG栅格化结果的磁盘缓存（FJ_RASTER_CACHE=0关闭）：热启动时首帧的图标直接映射文件上传
+		m_iconCache.setRasterCache(&RasterCache::instance());
+		// 纹理缓存字节预算：FJ_ICON_CACHE_MB（默认64，0为不限），超出时按LRU淘汰最近两帧未绘制的子图
+		{
+			constexpr int kDefaultIconCacheMb = 64;
+			bool ok = false;
+			const int mb = qEnvironmentVariableIntValue("FJ_ICON_CACHE_MB", &ok);
+			m_iconCache.setByteBudget(static_cast<qint64>(ok ? mb : kDefaultIconCacheMb) * 1024 * 1024);
+		}
+		// 设置FJ_ASYNC_RASTER时SVG与字形在线程池中栅格化，完成后按每帧预算上传（新句柄在此之前不绘制）
+		if (qEnvironmentVariableIsSet("FJ_ASYNC_RASTER"))
+		{
+			m_iconCache.setRasterReadyCallback([this]
+				{
+					QMetaObject::invokeMethod(this, [this] { m_scheduler.requestFrame(); }, Qt::QueuedConnection);
+				});
+			m_iconCache.setAsyncRaster(true);
+		}
 
 #ifdef Q_OS_WIN
 		if (!m_winChrome)
@@ -204,6 +322,7 @@ void MainOpenGlWindow::resizeGL(const int w, const int h)
 	m_fbWpx = w;
 	m_fbHpx = h;
 	m_renderer.resize(w, h);
+	m_damage.invalidateAll();  // 帧缓冲重新分配，旧内容不可用
 	updateLayout();
 
 #ifdef Q_OS_WIN
@@ -213,19 +332,347 @@ void MainOpenGlWindow::resizeGL(const int w, const int h)
 
 void MainOpenGlWindow::paintGL()
 {
+	// 渲染线程模式下GL命令不在本上下文中，GPU计时无意义
+	m_renderer.setGpuTimingEnabled(m_profiler.enabled() && !m_renderThread);
+	m_profiler.beginFrame();
+
+	// 动画按本帧的预计呈现时间求值，再录制命令
+	m_scheduler.beginFrame(FrameClock::preciseMs());
+	m_iconCache.beginFrame();
+	Render::FrameData& frameData = m_frame;
+	frameData.clear();
+	{
+		const FrameProfiler::ScopedStage profile(FrameProfiler::Stage::Record);
+		uploadRasterResults();
+		m_scheduler.endFrame(tickAnimations());
+		m_uiRoot.append(frameData);
+	}
+	++m_frameIndex;
+	captureFrameIfRequested(frameData);
+	if (m_profilerHud) appendProfilerHud(frameData);
+	markTexturesUsed(frameData);
+
+	{
+		const FrameProfiler::ScopedStage profile(FrameProfiler::Stage::Submit);
+		submitFrame(frameData);
+	}
+	trimIconCache();
+	if (m_profiler.inFrame()) m_swapClock.start();
+}
+
+void MainOpenGlWindow::markTexturesUsed(const Render::FrameData& fd)
+{
+	// 命令可能来自缓存的子树而不经过ensureXxx：按本帧实际绘制的句柄记录使用
+	for (const auto& img : fd.images) m_iconCache.markUsed(img.textureId);
+	// 图层内容在DPR变化等情况下由渲染器直接重绘，其引用的句柄同样在用
+	for (const auto& layer : fd.layers)
+	{
+		if (layer.content) markTexturesUsed(*layer.content);
+	}
+}
+
+void MainOpenGlWindow::trimIconCache()
+{
+	if (m_iconCache.evictToBudget(this) > 0)
+	{
+		// 缓存的子树命令可能引用了被淘汰的句柄：下次绘制时重新录制（重新ensure得到新句柄）
+		UiRetained::invalidateAll();
+	}
+}
+
+void MainOpenGlWindow::submitFrame(Render::FrameData& frameData)
+{
+	const auto dpr = static_cast<float>(devicePixelRatio());
+
+	if (m_renderThread)
+	{
+		submitFrameThreaded(frameData, dpr);
+		return;
+	}
+
+	if (!m_partialRepaint)
+	{
+		glClearColor(m_clearColor.redF(), m_clearColor.greenF(), m_clearColor.blueF(), 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		m_renderer.drawFrame(frameData, m_iconCache, dpr);
+		return;
+	}
+
+	// 与上一帧的命令流比较得出损坏区域，只清除并重绘这些区域
+	if (dpr != m_lastDpr)
+	{
+		m_damage.invalidateAll();
+		m_lastDpr = dpr;
+	}
+	m_repaintRects = m_damage.update(frameData, QRectF(0, 0, width(), height()));
+	if (m_debugDamage) appendDamageOverlay(frameData);
+
+	m_renderer.drawFrame(frameData, m_iconCache, dpr, m_repaintRects, m_clearColor);
+}
+
+void MainOpenGlWindow::submitFrameThreaded(Render::FrameData& frameData, const float dpr)
+{
+	// 只有命令流变化时才提交：渲染线程完成后请求的合成帧不再产生新的提交，避免自激
+	if (dpr != m_lastDpr)
+	{
+		m_damage.invalidateAll();
+		m_lastDpr = dpr;
+	}
+	if (!m_damage.update(frameData, QRectF(0, 0, width(), height())).empty())
+	{
+		auto& job = m_renderThread->beginJob();
+		// 交换而非移动：渲染线程用过的槽位容量回到m_frame，三个槽位轮流复用
+		std::swap(job.frame, frameData);
+		job.fbSizePx = QSize(m_fbWpx, m_fbHpx);
+		job.dpr = dpr;
+		job.clearColor = m_clearColor;
+		m_renderThread->submitJob();
+	}
+
+	// 合成最新完成的一帧（尺寸变化期间尺寸可能不一致，先清屏）
+	m_renderThread->takeFrame();
 	glClearColor(m_clearColor.redF(), m_clearColor.greenF(), m_clearColor.blueF(), 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
+	m_renderThread->present(defaultFramebufferObject());
+}
+
+void MainOpenGlWindow::uploadRasterResults()
+{
+	constexpr qint64 kUploadBudgetBytes = 1024 * 1024;  // 每帧上传预算（约64个128px图标）
 
-	Render::FrameData frameData;
-	m_uiRoot.append(frameData);
-	m_renderer.drawFrame(frameData, m_iconCache, static_cast<float>(devicePixelRatio()));
+	const auto result = m_iconCache.uploadCompleted(this, kUploadBudgetBytes);
+	if (result.uploaded > 0)
+	{
+		// 句柄不变，命令流比较看不出变化：整帧重绘，图层也须重新绘制其内容
+		m_damage.invalidateAll();
+		UiRetained::invalidateAll();
+	}
+	// 超出预算的留到下一帧
+	if (result.remaining > 0) m_scheduler.requestFrame();
+}
+
+const Renderer::FrameStats& MainOpenGlWindow::lastRenderStats() const noexcept
+{
+	return m_renderThread ? m_renderThread->currentFrame().stats : m_renderer.lastFrameStats();
+}
+
+void MainOpenGlWindow::appendDamageOverlay(Render::FrameData& fd)
+{
+	constexpr int kFlashFrames = 12;
+
+	// 上一帧画出的色块本帧变淡或消失：老化后把旧色块区域并入重绘区域
+	const std::size_t uiDamageCount = m_repaintRects.size();
+	for (auto& flash : m_damageFlashes)
+	{
+		m_repaintRects.push_back(flash.rect);
+		++flash.age;
+	}
+	std::erase_if(m_damageFlashes, [](const DamageFlash& f) { return f.age >= kFlashFrames; });
+
+	// 只有界面自身的损坏区域产生新色块（叠加层引起的重绘不再闪烁，避免自激）
+	for (std::size_t i = 0; i < uiDamageCount; ++i)
+	{
+		m_damageFlashes.push_back(DamageFlash{ m_repaintRects[i], 0 });
+	}
+	DamageTracker::mergeRects(m_repaintRects);
+
+	for (const auto& flash : m_damageFlashes)
+	{
+		const float fade = 1.0f - static_cast<float>(flash.age) / kFlashFrames;
+		fd.addRoundedRect(Render::RoundedRectCmd{
+			.rect = flash.rect,
+			.radiusPx = 0.0f,
+			.color = QColor(255, 0, 128, static_cast<int>(std::round(96.0f * fade)))
+			});
+	}
+
+	if (!m_damageFlashes.empty()) m_scheduler.requestFrame();
+}
+
+void MainOpenGlWindow::setProfilingEnabled(const bool on)
+{
+	// GPU计时在paintGL中按此开关同步（需要当前上下文）
+	m_profiler.setEnabled(on);
+	FrameProfiler::setActive(on ? &m_profiler : nullptr);
+	if (!on) setProfilerHudVisible(false);
+}
+
+void MainOpenGlWindow::setProfilerHudVisible(const bool on)
+{
+	if (on && !m_profiler.enabled()) setProfilingEnabled(true);
+	m_profilerHud = on;
+	m_hudText.clear();
+	m_scheduler.requestFrame();
+}
+
+void MainOpenGlWindow::onFrameSwapped()
+{
+	m_scheduler.frameSwapped(FrameClock::preciseMs());
+	if (m_startupClock.isValid())
+	{
+		// 启动到首帧呈现的耗时（含数据库初始化与首帧图标栅格化），对比磁盘缓存冷/热启动
+		const auto rs = RasterCache::instance().stats();
+		qDebug() << "First frame presented in" << m_startupClock.elapsed() << "ms; raster cache hits" << rs.hits
+			<< "misses" << rs.misses << "rejected" << rs.rejected << "writes" << rs.writes << "load ms" << rs.loadMs;
+		m_startupClock.invalidate();
+	}
+	if (!m_profiler.inFrame()) return;
+
+	m_profiler.addStageNs(FrameProfiler::Stage::Swap, m_swapClock.nsecsElapsed());
+	if (const qint64 gpuNs = m_renderer.takeGpuTimeNs(); gpuNs >= 0)
+	{
+		m_profiler.setGpuNs(gpuNs);
+	}
+	m_profiler.endFrame(lastRenderStats().drawCalls);
+}
+
+void MainOpenGlWindow::onScreenChanged(QScreen* screen)
+{
+	disconnect(m_refreshRateConn);
+	if (!screen) return;
+
+	m_scheduler.setRefreshRate(screen->refreshRate());
+	m_refreshRateConn = connect(screen, &QScreen::refreshRateChanged, this, [this](const qreal hz)
+		{
+			m_scheduler.setRefreshRate(hz);
+		});
+}
+
+void MainOpenGlWindow::requestFrameCapture()
+{
+	m_captureNext = true;
+	m_scheduler.requestFrame();
+}
+
+void MainOpenGlWindow::captureFrameIfRequested(const Render::FrameData& fd)
+{
+	bool scheduled = false;
+	while (!m_captureFrames.empty() && m_captureFrames.front() <= m_frameIndex)
+	{
+		scheduled = scheduled || m_captureFrames.front() == m_frameIndex;
+		m_captureFrames.erase(m_captureFrames.begin());
+	}
+	if (!m_captureNext && !scheduled) return;
+	m_captureNext = false;
+
+	if (!QDir().mkpath(m_captureDir))
+	{
+		qWarning() << "Frame capture: cannot create" << m_captureDir;
+		return;
+	}
+	const auto capture = FrameCapture::capture(fd, m_iconCache, static_cast<float>(devicePixelRatio()), size());
+	const QString path = QDir(m_captureDir).filePath(QString("frame_%1_%2.fjcap")
+		.arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"))
+		.arg(m_frameIndex));
+	if (QString error; capture.save(path, &error))
+	{
+		qDebug() << "Frame capture written:" << path << "commands:" << capture.frame.commands.size();
+	}
+	else
+	{
+		qWarning() << "Frame capture failed:" << path << error;
+	}
+}
+
+void MainOpenGlWindow::appendProfilerHud(Render::FrameData& fd)
+{
+	constexpr int kBars = 120;             // 柱状图显示的帧数
+	constexpr float kBarW = 2.0f;
+	constexpr float kGraphH = 60.0f;       // 图高对应 kGraphMs
+	constexpr float kGraphMs = 33.3f;
+	constexpr int kHudTextInterval = 30;   // 文字刷新间隔（帧）
+	constexpr float kPad = 8.0f;
+	constexpr float kHistW = FrameProfiler::kHistogramBuckets * kBarW;
+
+	const float panelW = kPad * 3 + kBars * kBarW + kHistW;
+	const float panelH = kPad * 3 + kGraphH + 14.0f;
+	const QRectF panel(width() - panelW - 12.0f, height() - panelH - 12.0f, panelW, panelH);
+	fd.addRoundedRect(Render::RoundedRectCmd{ .rect = panel, .radiusPx = 6.0f, .color = QColor(0, 0, 0, 170) });
+
+	const QRectF graph(panel.left() + kPad, panel.bottom() - kPad - kGraphH, kBars * kBarW, kGraphH);
+	const auto msToH = [&](const double ms) { return static_cast<float>(std::min<double>(kGraphH, ms / kGraphMs * kGraphH)); };
+
+	// 16.7ms参考线
+	fd.addRoundedRect(Render::RoundedRectCmd{
+		.rect = QRectF(graph.left(), graph.bottom() - msToH(16.7), graph.width(), 1.0),
+		.radiusPx = 0.0f, .color = QColor(255, 255, 255, 60) });
+
+	// 分阶段堆叠柱：录制 / 剪裁 / 提交 / 交换，白点为GPU耗时
+	static const QColor kStageColors[FrameProfiler::kStageCount] = {
+		QColor(86, 156, 214), QColor(78, 201, 176), QColor(220, 160, 60), QColor(150, 150, 150)
+	};
+	const int n = m_profiler.sampleCount();
+	const int first = std::max(0, n - kBars);
+	for (int i = first; i < n; ++i)
+	{
+		const auto& smp = m_profiler.sample(i);
+		const float x = static_cast<float>(graph.left()) + static_cast<float>(i - first) * kBarW;
+		double accMs = 0.0;
+		for (int k = 0; k < FrameProfiler::kStageCount; ++k)
+		{
+			const double ms = static_cast<double>(smp.stageNs[static_cast<std::size_t>(k)]) / 1.0e6;
+			const float y0 = msToH(accMs);
+			const float y1 = msToH(accMs + ms);
+			accMs += ms;
+			if (y1 - y0 < 0.5f) continue;
+			fd.addRoundedRect(Render::RoundedRectCmd{
+				.rect = QRectF(x, graph.bottom() - y1, kBarW, y1 - y0),
+				.radiusPx = 0.0f, .color = kStageColors[k] });
+		}
+		if (smp.gpuNs >= 0)
+		{
+			const float gy = msToH(static_cast<double>(smp.gpuNs) / 1.0e6);
+			fd.addRoundedRect(Render::RoundedRectCmd{
+				.rect = QRectF(x, graph.bottom() - gy - 1.0, kBarW, 1.0),
+				.radiusPx = 0.0f, .color = QColor(255, 255, 255, 220) });
+		}
+	}
+
+	// 滚动直方图（每桶1ms，高度按最大桶归一）
+	const auto hist = m_profiler.histogram();
+	const int maxCount = std::max(1, *std::max_element(hist.begin(), hist.end()));
+	const float histX = static_cast<float>(graph.right()) + kPad;
+	for (int b = 0; b < FrameProfiler::kHistogramBuckets; ++b)
+	{
+		const float h = kGraphH * static_cast<float>(hist[static_cast<std::size_t>(b)]) / static_cast<float>(maxCount);
+		if (h < 0.5f) continue;
+		fd.addRoundedRect(Render::RoundedRectCmd{
+			.rect = QRectF(histX + static_cast<float>(b) * kBarW, graph.bottom() - h, kBarW - 0.5f, h),
+			.radiusPx = 0.0f, .color = b >= 17 ? QColor(230, 90, 90) : QColor(120, 200, 120) });
+	}
+
+	// 文字：p50/p99（定期刷新）
+	if (m_hudText.isEmpty() || ++m_hudFrames >= kHudTextInterval)
+	{
+		m_hudFrames = 0;
+		const auto sum = m_profiler.summary();
+		const auto& rs = lastRenderStats();
+		m_hudText = QString("CPU %1/%2  GPU %3/%4 ms  DC %5  CULL %6/%7/%8")
+			.arg(sum.cpuP50Ms, 0, 'f', 1).arg(sum.cpuP99Ms, 0, 'f', 1)
+			.arg(sum.gpuP50Ms, 0, 'f', 1).arg(sum.gpuP99Ms, 0, 'f', 1)
+			.arg(static_cast<int>(sum.drawCallsP50))
+			.arg(rs.culledClipped).arg(rs.culledOffscreen).arg(rs.culledOccluded);
+	}
+	const float dpr = static_cast<float>(devicePixelRatio());
+	QFont font;
+	const int fontPx = static_cast<int>(std::lround(11.0f * dpr));
+	font.setPixelSize(fontPx);
+	const QColor textColor(235, 235, 235);
+	const int tex = m_iconCache.ensureTextPx(RenderUtils::makeTextCacheKey(QStringLiteral("hud|") + m_hudText, fontPx, textColor),
+		font, m_hudText, textColor, this);
+	const QSize ts = m_iconCache.textureSizePx(tex);
+	fd.addImage(Render::ImageCmd{
+		.dstRect = QRectF(panel.left() + kPad, panel.top() + kPad, ts.width() / dpr, ts.height() / dpr),
+		.textureId = tex,
+		.srcRectPx = QRectF(0, 0, ts.width(), ts.height()),
+		.clip = fd.addClip(panel) });
 }
 
 void MainOpenGlWindow::mousePressEvent(QMouseEvent* e)
 {
 	if (e->button() == Qt::LeftButton) {
 		if (m_uiRoot.onMousePress(e->pos())) {
-			update();
+			m_scheduler.requestFrame();
 			e->accept();
 			return;
 		}
@@ -246,7 +693,7 @@ void MainOpenGlWindow::mouseMoveEvent(QMouseEvent* e)
 {
 	const bool handled = m_uiRoot.onMouseMove(e->pos());
 	setCursor(handled ? Qt::PointingHandCursor : Qt::ArrowCursor);
-	if (handled) update();
+	if (handled) m_scheduler.requestFrame();
 	QOpenGLWindow::mouseMoveEvent(e);
 }
 
@@ -261,15 +708,11 @@ void MainOpenGlWindow::mouseReleaseEvent(QMouseEvent* e)
 			// 声明式TopBar现在通过回调处理系统按钮，无需手动检查
 			// 旧的 m_topBar.takeActions() 和 m_topBar.takeSystemActions() 调用已移除
 
-			if (!m_animTimer.isActive())
-			{
-				m_animClock.start();
-				m_animTimer.start();
-			}
+			m_scheduler.requestAnimation();
 		}
 
 		// Always schedule a redraw on left-button release to ensure VM-driven rebuilds are rendered
-		update();
+		m_scheduler.requestFrame();
 
 		if (handled)
 		{
@@ -288,11 +731,7 @@ void MainOpenGlWindow::mouseDoubleClickEvent(QMouseEvent* e)
 		{
 			m_navVm.toggleExpanded();
 			updateLayout();
-			if (!m_animTimer.isActive())
-			{
-				m_animClock.start();
-				m_animTimer.start();
-			}
+			m_scheduler.requestAnimation();
 			e->accept();
 			return;
 		}
@@ -306,13 +745,8 @@ void MainOpenGlWindow::wheelEvent(QWheelEvent* e)
 
 	if (m_uiRoot.onWheel(e->position().toPoint(), e->angleDelta()))
 	{
-		// 如有消费则启动动画计时器并重绘
-		if (!m_animTimer.isActive())
-		{
-			m_animClock.start();
-			m_animTimer.start();
-		}
-		update();
+		// 如有消费则持续出帧，直到动画结束
+		m_scheduler.requestAnimation();
 		e->accept();
 	}
 	else
@@ -323,17 +757,20 @@ void MainOpenGlWindow::wheelEvent(QWheelEvent* e)
 
 void MainOpenGlWindow::keyPressEvent(QKeyEvent* e)
 {
+	// Ctrl+Shift+F12：捕获下一帧（不转发给UI组件）
+	if (e->key() == Qt::Key_F12 && e->modifiers() == (Qt::ControlModifier | Qt::ShiftModifier))
+	{
+		requestFrameCapture();
+		e->accept();
+		return;
+	}
+
 	// 将键盘按下事件转发到UI组件层次结构
 
 	if (m_uiRoot.onKeyPress(e->key(), e->modifiers()))
 	{
-		// 如有消费则启动动画计时器并重绘
-		if (!m_animTimer.isActive())
-		{
-			m_animClock.start();
-			m_animTimer.start();
-		}
-		update();
+		// 如有消费则持续出帧，直到动画结束
+		m_scheduler.requestAnimation();
 		e->accept();
 	}
 	else
@@ -348,13 +785,8 @@ void MainOpenGlWindow::keyReleaseEvent(QKeyEvent* e)
 
 	if (m_uiRoot.onKeyRelease(e->key(), e->modifiers()))
 	{
-		// 如有消费则启动动画计时器并重绘
-		if (!m_animTimer.isActive())
-		{
-			m_animClock.start();
-			m_animTimer.start();
-		}
-		update();
+		// 如有消费则持续出帧，直到动画结束
+		m_scheduler.requestAnimation();
 		e->accept();
 	}
 	else
@@ -477,18 +909,15 @@ void MainOpenGlWindow::setupThemeListeners()
 					if (m_shellRebuildHost)
 					{
 						m_shellRebuildHost->requestRebuild();
-						// Ensure animation timer is running if a follow animation is expected
-						if (m_animateFollowChange && !m_animTimer.isActive()) {
-							m_animClock.start();
-							m_animTimer.start();
-						}
+						// Keep frames coming while the follow animation runs
+						if (m_animateFollowChange) m_scheduler.requestAnimation();
 						// Clear the animation intent after a short delay to avoid racing the rebuild
 						QTimer::singleShot(300, [this]() {
 							m_animateFollowChange = false;
 							});
 					}
 					updateLayout();
-					update();
+					m_scheduler.requestFrame();
 					});
 			});
 	}
@@ -529,13 +958,16 @@ void MainOpenGlWindow::applyTheme()
 		m_clearColor = QColor::fromRgbF(0.91f, 0.92f, 0.94f);
 	}
 
+	// 清屏颜色变化不体现在命令流中，需整帧重绘
+	m_damage.invalidateAll();
+
 	// 通过UiRoot传播主题变化到所有组件
 	m_uiRoot.propagateThemeChange(isDark);
 
 	// 更新资源上下文（图标可能需要重新加载）
 	m_uiRoot.updateResourceContext(m_iconCache, this, static_cast<float>(devicePixelRatio()));
 
-	update();
+	m_scheduler.requestFrame();
 }
 
 bool MainOpenGlWindow::followSystem() const noexcept
@@ -575,7 +1007,7 @@ void MainOpenGlWindow::onNavSelectionChanged(const int index)
 			m_shellRebuildHost->requestRebuild();
 		}
 
-		update();
+		m_scheduler.requestFrame();
 	}
 }
 
@@ -604,15 +1036,11 @@ void MainOpenGlWindow::onFollowSystemToggle() const
 		if (self->m_shellRebuildHost) {
 			self->m_shellRebuildHost->requestRebuild();
 		}
-		if (!self->m_animTimer.isActive()) {
-			self->m_animClock.start();
-			self->m_animTimer.start();
-		}
-		self->update();
+		self->m_scheduler.requestAnimation();
 		});
 }
 
-void MainOpenGlWindow::onAnimationTick()
+bool MainOpenGlWindow::tickAnimations()
 {
 	const bool hasAnimation = m_uiRoot.tick();
 
@@ -627,12 +1055,7 @@ void MainOpenGlWindow::onAnimationTick()
 		}
 	}
 
-	if (!hasAnimation)
-	{
-		m_animTimer.stop();
-	}
-
-	update();
+	return hasAnimation;
 }
 
 void MainOpenGlWindow::initializeDeclarativeShell()
@@ -12,12 +12,18 @@
 #include <qelapsedtimer.h>
 #include <qopenglfunctions.h>
 #include <qopenglwindow.h>
-#include <qtimer.h>
+#include <qmetaobject.h>
+#include <qstring.h>
+#include <vector>
 
 #include "CurrentPageHost.h"
+#include "DamageTracker.h"
+#include "FrameProfiler.h"
+#include "FrameScheduler.h"
 #include "IconCache.h"
 #include "NavViewModel.h"
 #include "PageRouter.h"
+#include "RenderThread.h"
 #include "Renderer.h"
 #include "ThemeManager.h"
 #include "UiNav.h"
@@ -36,6 +42,7 @@ class WinWindowChrome;
 
 // 前向声明
 class AppConfig;
+class QScreen;
 
 namespace fj::presentation::binding {
 	class INavDataProvider;
@@ -48,14 +55,27 @@ namespace fj::presentation::binding {
 /// - UI组件层次结构与事件分发
 /// - 页面路由与导航状态管理  
 /// - 主题模式切换与传播
-/// - 动画循环驱动（60fps目标）
+/// - 动画循环驱动（与显示刷新同步，见FrameScheduler）
 /// 
 /// 生命周期：
 /// 1. 构造时注入依赖服务（配置、主题管理器）
 /// 2. initializeGL()中初始化渲染器和UI组件
 /// 3. resizeGL()中更新视口和布局
-/// 4. paintGL()中执行帧渲染
+/// 4. paintGL()中推进动画并执行帧渲染（默认保留上一帧，只重绘与上一帧命令流不同的损坏区域）；
+///    重绘请求经FrameScheduler合并，动画期间每次帧交换完成后请求下一帧，空闲时不产生唤醒
 /// 5. 析构时清理OpenGL资源
+/// 
+/// 调试开关（环境变量）：
+/// - FJ_RENDER_FULL：每帧整窗重绘（关闭局部重绘）
+/// - FJ_DEBUG_DAMAGE：以渐隐色块标出每帧重绘的区域
+/// - FJ_PROFILE：启用帧剖析（分阶段CPU耗时与GPU计时，可经frameProfiler()轮询）
+/// - FJ_PROFILE_HUD：启用帧剖析并在右下角显示耗时叠加层
+/// - FJ_CAPTURE_FRAMES：逗号分隔的帧序号（从1起），捕获这些帧的绘制输入；Ctrl+Shift+F12捕获下一帧
+/// - FJ_CAPTURE_DIR：帧捕获的输出目录（默认为临时目录下的fangjia_captures）
+/// - FJ_RENDER_THREAD：由渲染线程绘制（见RenderThread），UI线程只录制命令并合成上一帧结果；不做局部重绘，无GPU计时
+/// - FJ_ASYNC_RASTER：图标与字形在线程池中栅格化（见IconCache异步栅格化），完成后按每帧字节预算上传
+/// - FJ_RASTER_CACHE=0：关闭SVG栅格化结果的磁盘缓存（见RasterCache）；首帧呈现时打印启动耗时与磁盘缓存命中
+/// - FJ_ICON_CACHE_MB：纹理缓存的子图字节预算（默认64，0为不限），超出时按最近使用淘汰；FJ_ATLAS_STATS在退出时打印命中/淘汰统计
 class MainOpenGlWindow final : public QOpenGLWindow, protected QOpenGLFunctions
 {
 public:
@@ -64,11 +84,11 @@ public:
 	/// 构造函数：注入核心依赖服务
 	/// 参数：config — 应用配置管理器（窗口几何、主题设置等）
 	/// 参数：themeManager — 主题管理器（模式切换、系统主题监听）
-	/// 参数：updateBehavior — Qt窗口更新行为控制
+	/// 参数：updateBehavior — Qt窗口更新行为控制（NoPartialUpdate时每帧整窗重绘）
 	explicit MainOpenGlWindow(
 		std::shared_ptr<AppConfig> config,
 		std::shared_ptr<ThemeManager> themeManager,
-		UpdateBehavior updateBehavior = NoPartialUpdate);
+		UpdateBehavior updateBehavior = PartialUpdateBlit);
 	~MainOpenGlWindow() override;
 
 	// 主题管理
@@ -93,6 +113,18 @@ public:
 	// 系统按钮区域（右侧5个按钮：follow/theme/min/max/close）用于禁用拖拽
 	QRect topBarSystemButtonsRect() const;
 
+	/// 帧剖析：启用后每帧记录录制/剪裁/提交/交换的CPU耗时与GPU耗时
+	/// 说明：浸泡测试可轮询frameProfiler().summary()获取p50/p99帧耗时与绘制调用数
+	void setProfilingEnabled(bool on);
+	void setProfilerHudVisible(bool on);
+	[[nodiscard]] const FrameProfiler& frameProfiler() const noexcept { return m_profiler; }
+
+	/// 出帧调度：重绘请求合并与动画帧节奏（统计可用于确认空闲时无唤醒）
+	[[nodiscard]] const FrameScheduler& frameScheduler() const noexcept { return m_scheduler; }
+
+	/// 帧捕获：把下一帧的绘制输入（FrameData、纹理键与尺寸、DPR）写入捕获目录，供回放工具复现
+	void requestFrameCapture();
+
 protected:
 	/// OpenGL生命周期回调
 	void initializeGL() override;
@@ -128,7 +160,45 @@ private:
 	void onNavSelectionChanged(int index);
 	void onThemeToggle() const;
 	void onFollowSystemToggle() const;
-	void onAnimationTick();
+
+	/// 功能：推进一帧的动画（在paintGL中、录制命令之前调用，此时FrameClock为本帧呈现时间）
+	/// 返回：是否仍有动画（决定交换完成后是否继续出帧）
+	bool tickAnimations();
+
+	/// 功能：窗口所在屏幕变化：按新屏幕的刷新率重置调度器并跟踪其刷新率变化
+	void onScreenChanged(QScreen* screen);
+
+	/// 功能：追加损坏区域调试叠加层
+	/// 参数：fd — 本帧绘制命令（在其末尾追加闪烁色块）
+	/// 说明：上一帧的色块会变淡或消失，其区域并入m_repaintRects；色块存续期间持续请求下一帧
+	void appendDamageOverlay(Render::FrameData& fd);
+
+	/// 功能：上传异步栅格化完成的图像（每帧有字节预算），有新图像时整帧重绘
+	void uploadRasterResults();
+
+	/// 功能：记录本帧绘制的纹理句柄（含图层内容），供纹理缓存按最近使用淘汰
+	void markTexturesUsed(const Render::FrameData& fd);
+
+	/// 功能：纹理缓存超出字节预算时淘汰最近未绘制的子图
+	void trimIconCache();
+
+	/// 功能：提交一帧（损坏区域计算 + 渲染器绘制）
+	void submitFrame(Render::FrameData& fd);
+
+	/// 功能：渲染线程模式下提交一帧（命令流有变化时交给渲染线程）并合成最新完成的一帧
+	void submitFrameThreaded(Render::FrameData& fd, float dpr);
+
+	/// 功能：最近一次绘制的提交统计（渲染线程模式下取当前合成帧的统计）
+	[[nodiscard]] const Renderer::FrameStats& lastRenderStats() const noexcept;
+
+	/// 功能：追加帧耗时叠加层（分阶段耗时柱状图 + 直方图 + p50/p99文字）
+	void appendProfilerHud(Render::FrameData& fd);
+
+	/// 功能：帧交换完成回调：通知出帧调度器，计入交换耗时与GPU耗时并结束剖析帧
+	void onFrameSwapped();
+
+	/// 功能：按需捕获本帧（热键请求或FJ_CAPTURE_FRAMES命中时写出捕获文件）
+	void captureFrameIfRequested(const Render::FrameData& fd);
 
 private:
 	// 主题状态
@@ -161,10 +231,38 @@ private:
 	IconCache m_iconCache;
 	int m_fbWpx{ 0 };    // 帧缓冲宽度（像素）
 	int m_fbHpx{ 0 };    // 帧缓冲高度（像素）
+	Render::FrameData m_frame;  // 帧命令区：每帧clear后重新录制，保留容量，稳态不再分配
+	std::unique_ptr<RenderThread> m_renderThread;  // FJ_RENDER_THREAD时启用（须在m_iconCache之后声明，先于它析构）
+
+	// 局部重绘
+	struct DamageFlash {
+		QRectF rect;     // 重绘区域（逻辑像素）
+		int    age{ 0 }; // 已显示的帧数
+	};
+	DamageTracker m_damage;
+	std::vector<QRectF> m_repaintRects;       // 本帧需重绘的区域
+	std::vector<DamageFlash> m_damageFlashes; // 调试叠加层中仍在显示的区域
+	bool  m_partialRepaint{ false };          // 是否启用局部重绘（需窗口保留上一帧）
+	bool  m_debugDamage{ false };             // 是否显示重绘区域叠加层
+	float m_lastDpr{ 0.0f };                  // 上一帧DPR（变化时整帧重绘）
+
+	// 帧剖析
+	FrameProfiler m_profiler;
+	QElapsedTimer m_swapClock;                // paintGL返回 -> frameSwapped
+	QElapsedTimer m_startupClock;             // 构造 -> 首帧交换完成（之后失效）
+	bool    m_profilerHud{ false };
+	QString m_hudText;                        // 叠加层文字（每kHudTextInterval帧刷新一次，减少文本缓存条目）
+	int     m_hudFrames{ 0 };
+
+	// 帧捕获
+	quint64 m_frameIndex{ 0 };                // 已绘制帧数（FJ_CAPTURE_FRAMES的帧序号）
+	std::vector<quint64> m_captureFrames;     // 待捕获的帧序号（升序）
+	bool    m_captureNext{ false };           // 热键请求：捕获下一帧
+	QString m_captureDir;
 
-	// 动画驱动（目标60fps）
-	QTimer m_animTimer;
-	QElapsedTimer m_animClock;
+	// 出帧调度（update()经requestUpdate在下一次刷新时送达paintGL）
+	FrameScheduler m_scheduler{ [this] { update(); } };
+	QMetaObject::Connection m_refreshRateConn;  // 当前屏幕的refreshRateChanged
 
 #ifdef Q_OS_WIN
 	WinWindowChrome* m_winChrome{ nullptr };  // Windows平台自定义标题栏
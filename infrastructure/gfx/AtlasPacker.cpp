@@ -0,0 +1,102 @@
+#include "AtlasPacker.h"
+
+#include <algorithm>
+#include <optional>
+#include <qrect.h>
+#include <qsize.h>
+
+AtlasPacker::AtlasPacker(const QSize& pageSizePx, const int paddingPx)
+	: m_pageSize(pageSizePx)
+	, m_padding(std::max(0, paddingPx))
+{
+}
+
+std::optional<QRect> AtlasPacker::allocate(const QSize& sizePx)
+{
+	if (sizePx.isEmpty()) return std::nullopt;
+
+	const int w = sizePx.width() + 2 * m_padding;
+	const int h = sizePx.height() + 2 * m_padding;
+	if (w > m_pageSize.width() || h > m_pageSize.height()) return std::nullopt;
+
+	// 选择放得下且垂直浪费最小的货架
+	Shelf* bestFit = nullptr;
+	for (auto& s : m_shelves) {
+		if (h > s.height || s.cursorX + w > m_pageSize.width()) continue;
+		if (!bestFit || s.height < bestFit->height) bestFit = &s;
+	}
+
+	// 浪费超过货架高度的1/4时优先开新货架；页内放不下新货架时再退而求其次
+	Shelf* target = (bestFit && (bestFit->height - h) * 4 <= bestFit->height) ? bestFit : nullptr;
+	if (!target) {
+		const int top = m_shelves.empty() ? 0 : m_shelves.back().y + m_shelves.back().height;
+		if (top + h <= m_pageSize.height()) {
+			m_shelves.push_back(Shelf{ .y = top, .height = h });
+			target = &m_shelves.back();
+		}
+		else {
+			target = bestFit;
+		}
+	}
+	if (!target) return std::nullopt;
+
+	const QRect padded(target->cursorX, target->y, w, h);
+	target->cursorX += w;
+	++target->liveCount;
+	++m_liveCount;
+	m_usedArea += static_cast<qint64>(w) * h;
+	return padded.adjusted(m_padding, m_padding, -m_padding, -m_padding);
+}
+
+void AtlasPacker::release(const QRect& rectPx)
+{
+	const QRect padded = rectPx.adjusted(-m_padding, -m_padding, m_padding, m_padding);
+	const auto it = std::find_if(m_shelves.begin(), m_shelves.end(), [&](const Shelf& s) {
+		return s.y == padded.y() && padded.x() + padded.width() <= s.cursorX && s.liveCount > 0;
+	});
+	if (it == m_shelves.end()) return;
+
+	--it->liveCount;
+	--m_liveCount;
+	m_usedArea -= static_cast<qint64>(padded.width()) * padded.height();
+
+	if (it->liveCount == 0) {
+		it->cursorX = 0;
+	}
+	else if (padded.x() + padded.width() == it->cursorX) {
+		it->cursorX = padded.x();
+	}
+
+	// 末尾连续的空货架整体回收，便于之后开出不同高度的新货架
+	while (!m_shelves.empty() && m_shelves.back().liveCount == 0) {
+		m_shelves.pop_back();
+	}
+}
+
+void AtlasPacker::reset()
+{
+	m_shelves.clear();
+	m_usedArea = 0;
+	m_liveCount = 0;
+}
+
+qint64 AtlasPacker::consumedArea() const noexcept
+{
+	qint64 area = 0;
+	for (const auto& s : m_shelves) {
+		area += static_cast<qint64>(s.cursorX) * s.height;
+	}
+	return area;
+}
+
+double AtlasPacker::occupancy() const noexcept
+{
+	const qint64 page = pageArea();
+	return page > 0 ? static_cast<double>(m_usedArea) / static_cast<double>(page) : 0.0;
+}
+
+double AtlasPacker::fragmentation() const noexcept
+{
+	const qint64 consumed = consumedArea();
+	return consumed > 0 ? 1.0 - static_cast<double>(m_usedArea) / static_cast<double>(consumed) : 0.0;
+}
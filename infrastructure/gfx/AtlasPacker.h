@@ -0,0 +1,73 @@
+/*
+ * 文件名：AtlasPacker.h
+ * 职责：纹理图集页的矩形分配器（货架/shelf算法），只做CPU侧簿记，不涉及OpenGL。
+ * 依赖：Qt6 Core。
+ * 线程：非线程安全，由持有者（IconCache）在同一线程中使用。
+ * 备注：分配结果包含四周padding，避免线性过滤时采样到相邻子图。
+ */
+
+#pragma once
+#include <optional>
+#include <qglobal.h>
+#include <qrect.h>
+#include <qsize.h>
+#include <vector>
+
+/// 图集页矩形分配器（货架算法）
+///
+/// 功能：
+/// - 在固定尺寸的页内按行（货架）分配子矩形
+/// - 优先放入高度接近的已有货架，减少货架内的垂直浪费
+/// - 释放位于货架末尾的子矩形时回收该空间；中间的空洞只能通过整体重排（reset后重新分配）回收
+///
+/// 统计口径：
+/// - 占用率 = 存活子矩形面积（含padding） / 页面积
+/// - 碎片率 = 1 - 存活面积 / 货架已消耗面积（货架高度 × 游标宽度），0表示无浪费
+class AtlasPacker {
+public:
+	/// 功能：构造分配器
+	/// 参数：pageSizePx — 页尺寸（像素）
+	/// 参数：paddingPx — 每个子矩形四周保留的透明边距
+	explicit AtlasPacker(const QSize& pageSizePx = QSize(), int paddingPx = 1);
+
+	/// 功能：分配一个子矩形
+	/// 参数：sizePx — 子图尺寸（不含padding）
+	/// 返回：子图在页内的位置（不含padding）；页内空间不足时返回空
+	std::optional<QRect> allocate(const QSize& sizePx);
+
+	/// 功能：释放先前由allocate返回的子矩形
+	/// 说明：位于货架末尾时立即回收，否则计入碎片
+	void release(const QRect& rectPx);
+
+	/// 功能：清空所有分配（用于重排）
+	void reset();
+
+	[[nodiscard]] QSize pageSizePx() const noexcept { return m_pageSize; }
+	[[nodiscard]] int paddingPx() const noexcept { return m_padding; }
+	[[nodiscard]] bool empty() const noexcept { return m_liveCount == 0; }
+	[[nodiscard]] int liveCount() const noexcept { return m_liveCount; }
+
+	/// 功能：存活子矩形面积（含padding，像素²）
+	[[nodiscard]] qint64 usedArea() const noexcept { return m_usedArea; }
+	/// 功能：货架已消耗面积（像素²），包含货架内的垂直浪费与释放后未回收的空洞
+	[[nodiscard]] qint64 consumedArea() const noexcept;
+	/// 功能：页面积（像素²）
+	[[nodiscard]] qint64 pageArea() const noexcept { return static_cast<qint64>(m_pageSize.width()) * m_pageSize.height(); }
+
+	[[nodiscard]] double occupancy() const noexcept;
+	[[nodiscard]] double fragmentation() const noexcept;
+
+private:
+	struct Shelf {
+		int y{ 0 };          // 货架顶边
+		int height{ 0 };     // 货架高度（含padding）
+		int cursorX{ 0 };    // 下一个子矩形的左边
+		int liveCount{ 0 };  // 货架上存活的子矩形数
+	};
+
+	QSize m_pageSize;
+	int   m_padding{ 1 };
+	std::vector<Shelf> m_shelves;
+	qint64 m_usedArea{ 0 };
+	int    m_liveCount{ 0 };
+};
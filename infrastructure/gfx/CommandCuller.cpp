@@ -0,0 +1,99 @@
+#include "CommandCuller.h"
+
+#include "DamageTracker.h"
+#include "RenderData.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <qrect.h>
+#include <vector>
+
+namespace {
+	// 遮挡者向内收缩（逻辑像素）：与DamageTracker的抗锯齿外扩对称，DPR>=1时至少覆盖1个设备像素
+	constexpr qreal kOccluderInsetPx = 1.0;
+
+	qreal area(const QRectF& r) {
+		return r.width() * r.height();
+	}
+
+	/// 不透明直角矩形的可靠覆盖区域；不能作为遮挡者时返回空矩形
+	QRectF occluderRect(const Render::RoundedRectCmd& cmd, const Render::ClipRegion& clip) {
+		if (cmd.color.alpha() < 255 || cmd.radiusPx > 0.0f) return {};
+		QRectF r = cmd.rect.normalized();
+		// 半透明描边处透出下层：只取描边以内的填充区域
+		if (cmd.strokeWidthPx > 0.0f && cmd.strokeColor.alpha() < 255) {
+			r.adjust(cmd.strokeWidthPx, cmd.strokeWidthPx, -cmd.strokeWidthPx, -cmd.strokeWidthPx);
+		}
+		if (!clip.rect.isEmpty()) {
+			if (clip.radiusPx > 0.0f) return {};
+			r = r.intersected(clip.rect);
+		}
+		r.adjust(kOccluderInsetPx, kOccluderInsetPx, -kOccluderInsetPx, -kOccluderInsetPx);
+		return r.width() > 0.0 && r.height() > 0.0 ? r : QRectF();
+	}
+}
+
+void CommandCuller::reset() noexcept
+{
+	m_rects.clear();
+	m_images.clear();
+	m_shadows.clear();
+	m_stats = Stats{};
+}
+
+void CommandCuller::mark(const Render::CmdRef& ref) noexcept
+{
+	switch (ref.type) {
+	case Render::CmdType::RoundedRect: m_rects[ref.index] = 1; break;
+	case Render::CmdType::Image:       m_images[ref.index] = 1; break;
+	case Render::CmdType::Shadow:      m_shadows[ref.index] = 1; break;
+	}
+}
+
+void CommandCuller::addOccluder(const QRectF& r)
+{
+	if (area(r) < kMinOccluderArea) return;
+	if (static_cast<int>(m_occluders.size()) < kMaxOccluders) {
+		m_occluders.push_back(r);
+		return;
+	}
+	const auto smallest = std::min_element(m_occluders.begin(), m_occluders.end(),
+		[](const QRectF& a, const QRectF& b) { return area(a) < area(b); });
+	if (area(*smallest) < area(r)) *smallest = r;
+}
+
+void CommandCuller::run(const Render::FrameData& fd, const std::vector<Render::CmdRef>& order, const QRectF& viewport)
+{
+	m_stats = Stats{};
+	m_rects.assign(fd.roundedRects.size(), 0);
+	m_images.assign(fd.images.size(), 0);
+	m_shadows.assign(fd.shadows.size(), 0);
+	m_occluders.clear();
+
+	// 从后往前：遮挡者只能遮住比它更早绘制的命令
+	for (std::size_t k = order.size(); k-- > 0;) {
+		const Render::CmdRef& ref = order[k];
+		const QRectF b = DamageTracker::commandBounds(fd, ref);
+		if (b.width() <= 0.0 || b.height() <= 0.0) {
+			mark(ref);
+			++m_stats.clipped;
+			continue;
+		}
+		if (!b.intersects(viewport)) {
+			mark(ref);
+			++m_stats.offscreen;
+			continue;
+		}
+		if (!m_occlusion) continue;
+
+		if (std::any_of(m_occluders.begin(), m_occluders.end(), [&b](const QRectF& o) { return o.contains(b); })) {
+			mark(ref);
+			++m_stats.occluded;
+			continue;
+		}
+		if (ref.type == Render::CmdType::RoundedRect) {
+			const auto& cmd = fd.roundedRects[ref.index];
+			addOccluder(occluderRect(cmd, fd.clip(cmd.clip)).intersected(viewport));
+		}
+	}
+}
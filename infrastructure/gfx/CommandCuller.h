@@ -0,0 +1,72 @@
+/*
+ * 文件名：CommandCuller.h
+ * 职责：提交前的CPU剔除，标出剪裁为空、落在视口之外、或被其后的不透明直角矩形完全遮挡的命令。
+ * 依赖：渲染数据结构、DamageTracker（命令覆盖范围）、Qt6 Core。
+ * 线程：非线程安全，由渲染器在拥有OpenGL上下文的线程中使用。
+ * 备注：只做CPU侧判定，不涉及OpenGL；判定均偏保守（覆盖范围含抗锯齿外扩，遮挡者向内收缩），宁可少剔不可错剔。
+ */
+
+#pragma once
+#include <cstdint>
+#include <qrect.h>
+#include <vector>
+
+#include "RenderData.hpp"
+
+/// 命令剔除：按绘制顺序为每条命令给出"是否跳过"
+///
+/// 剔除规则（依次判定）：
+/// - 剪裁：命令覆盖范围与其剪裁区域不相交
+/// - 视口：覆盖范围与视口不相交
+/// - 遮挡（可关闭）：覆盖范围完全落在某个更晚绘制的不透明遮挡者之内
+///
+/// 遮挡者：填充alpha为255、圆角为0、且无圆角剪裁的RoundedRectCmd（页面背景、列表底色等；半透明描边时只取描边以内），
+/// 取矩形与剪裁的交集再向内收缩1逻辑像素（避开抗锯齿边缘与剪裁的整像素取整）。
+/// 从后往前遍历命令流，只保留面积最大的kMaxOccluders个遮挡者，开销与命令数成线性。
+class CommandCuller {
+public:
+	/// 最近一次run的剔除计数
+	struct Stats {
+		int clipped{ 0 };    // 与剪裁区域不相交
+		int offscreen{ 0 };  // 在视口之外
+		int occluded{ 0 };   // 被更晚的不透明矩形完全遮挡
+
+		[[nodiscard]] int total() const noexcept { return clipped + offscreen + occluded; }
+	};
+
+	/// 功能：启用/停用遮挡剔除（剪裁与视口剔除始终进行）
+	void setOcclusionEnabled(const bool on) noexcept { m_occlusion = on; }
+	[[nodiscard]] bool occlusionEnabled() const noexcept { return m_occlusion; }
+
+	/// 功能：为一帧命令计算剔除标记
+	/// 参数：fd — 帧数据
+	/// 参数：order — 绘制顺序（与渲染器一致）
+	/// 参数：viewport — 视口（逻辑像素）
+	void run(const Render::FrameData& fd, const std::vector<Render::CmdRef>& order, const QRectF& viewport);
+
+	/// 功能：清除剔除标记（所有命令都绘制）
+	void reset() noexcept;
+
+	/// 功能：查询某类型数组中第i条命令是否被剔除
+	[[nodiscard]] bool rectCulled(const std::size_t i) const noexcept { return i < m_rects.size() && m_rects[i]; }
+	[[nodiscard]] bool imageCulled(const std::size_t i) const noexcept { return i < m_images.size() && m_images[i]; }
+	[[nodiscard]] bool shadowCulled(const std::size_t i) const noexcept { return i < m_shadows.size() && m_shadows[i]; }
+
+	[[nodiscard]] const Stats& stats() const noexcept { return m_stats; }
+
+	static constexpr int kMaxOccluders = 8;
+	static constexpr qreal kMinOccluderArea = 64.0;  // 更小的不透明矩形不值得参与判定（逻辑像素²）
+
+private:
+	/// 功能：把命令标记为剔除
+	void mark(const Render::CmdRef& ref) noexcept;
+	/// 功能：登记遮挡者（已满时替换面积最小的一个）
+	void addOccluder(const QRectF& r);
+
+	std::vector<std::uint8_t> m_rects;    // 类型数组索引 -> 是否剔除
+	std::vector<std::uint8_t> m_images;
+	std::vector<std::uint8_t> m_shadows;
+	std::vector<QRectF>       m_occluders;
+	Stats m_stats;
+	bool  m_occlusion{ true };
+};
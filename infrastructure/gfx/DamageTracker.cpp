@@ -0,0 +1,237 @@
+#include "DamageTracker.h"
+
+#include "RenderData.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <qrect.h>
+#include <vector>
+
+namespace {
+	// 抗锯齿边缘外扩（逻辑像素）
+	constexpr qreal kAaMarginPx = 1.0;
+
+	bool hasClip(const QRectF& clip) {
+		return clip.width() > 0.0 && clip.height() > 0.0;
+	}
+
+	// 剪裁按内容比较：两帧的剪裁表各自登记，同一剪裁的索引未必相同
+	bool sameCmd(const Render::RoundedRectCmd& a, const Render::ClipRegion& ca, const Render::RoundedRectCmd& b, const Render::ClipRegion& cb) {
+		return a.rect == b.rect && a.radiusPx == b.radiusPx && a.color == b.color && ca == cb
+			&& a.strokeWidthPx == b.strokeWidthPx && a.strokeColor == b.strokeColor;
+	}
+
+	bool sameCmd(const Render::ImageCmd& a, const Render::ClipRegion& ca, const Render::ImageCmd& b, const Render::ClipRegion& cb) {
+		return a.dstRect == b.dstRect && a.textureId == b.textureId && a.srcRectPx == b.srcRectPx
+			&& a.tint == b.tint && ca == cb;
+	}
+
+	bool sameCmd(const Render::ShadowCmd& a, const Render::ClipRegion& ca, const Render::ShadowCmd& b, const Render::ClipRegion& cb) {
+		return a.rect == b.rect && a.radiusPx == b.radiusPx && a.blurPx == b.blurPx
+			&& a.color == b.color && ca == cb;
+	}
+
+	template <typename Cmd>
+	bool sameCmd(const Render::FrameData& fa, const Cmd& a, const Render::FrameData& fb, const Cmd& b) {
+		return sameCmd(a, fa.clip(a.clip), b, fb.clip(b.clip));
+	}
+
+	// 图层合成命令相同还不够：图层内容版本或范围变化时纹理内容也变了
+	bool sameLayer(const Render::FrameData& fa, const Render::FrameData& fb, const int textureId) {
+		if (!Render::isLayerTexture(textureId)) return true;
+		const Render::LayerDef* la = fa.findLayer(textureId);
+		const Render::LayerDef* lb = fb.findLayer(textureId);
+		if (!la || !lb) return la == lb;
+		return la->version == lb->version && la->bounds == lb->bounds;
+	}
+
+	bool sameCmd(const Render::FrameData& fa, const Render::CmdRef& a, const Render::FrameData& fb, const Render::CmdRef& b) {
+		if (a.type != b.type) return false;
+		switch (a.type) {
+		case Render::CmdType::RoundedRect: return sameCmd(fa, fa.roundedRects[a.index], fb, fb.roundedRects[b.index]);
+		case Render::CmdType::Image:       return sameCmd(fa, fa.images[a.index], fb, fb.images[b.index]) && sameLayer(fa, fb, fa.images[a.index].textureId);
+		case Render::CmdType::Shadow:      return sameCmd(fa, fa.shadows[a.index], fb, fb.shadows[b.index]);
+		}
+		return false;
+	}
+
+	// 与Renderer一致：命令流不完整时按"先投影、再矩形、后图像"构造顺序
+	void buildOrder(const Render::FrameData& fd, std::vector<Render::CmdRef>& out) {
+		out.clear();
+		if (fd.hasOrderedStream()) {
+			out = fd.commands;
+			return;
+		}
+		out.reserve(fd.shadows.size() + fd.roundedRects.size() + fd.images.size());
+		for (std::size_t i = 0; i < fd.shadows.size(); ++i)
+			out.push_back(Render::CmdRef{ Render::CmdType::Shadow, static_cast<std::uint32_t>(i) });
+		for (std::size_t i = 0; i < fd.roundedRects.size(); ++i)
+			out.push_back(Render::CmdRef{ Render::CmdType::RoundedRect, static_cast<std::uint32_t>(i) });
+		for (std::size_t i = 0; i < fd.images.size(); ++i)
+			out.push_back(Render::CmdRef{ Render::CmdType::Image, static_cast<std::uint32_t>(i) });
+	}
+
+	qreal area(const QRectF& r) {
+		return r.width() * r.height();
+	}
+}
+
+QRectF DamageTracker::commandBounds(const Render::FrameData& fd, const Render::CmdRef& ref)
+{
+	QRectF r;
+	Render::ClipRegion clip;
+	switch (ref.type) {
+	case Render::CmdType::RoundedRect: {
+		const auto& cmd = fd.roundedRects[ref.index];
+		r = cmd.rect;
+		clip = fd.clip(cmd.clip);
+		break;
+	}
+	case Render::CmdType::Image: {
+		const auto& cmd = fd.images[ref.index];
+		r = cmd.dstRect;
+		clip = fd.clip(cmd.clip);
+		break;
+	}
+	case Render::CmdType::Shadow: {
+		// 投影在形状外约blurPx（3σ）范围内衰减
+		const auto& cmd = fd.shadows[ref.index];
+		const qreal m = std::max(0.0f, cmd.blurPx);
+		r = cmd.rect.adjusted(-m, -m, m, m);
+		clip = fd.clip(cmd.clip);
+		break;
+	}
+	}
+
+	// 父子剪裁不相交：命令完全不可见
+	if (clip.empty) return {};
+	r = r.normalized().adjusted(-kAaMarginPx, -kAaMarginPx, kAaMarginPx, kAaMarginPx);
+	const QRectF clipRect = clip.rect;
+	if (hasClip(clipRect)) {
+		// 剪裁按设备像素向外取整，这里同样留出1像素余量
+		r = r.intersected(clipRect.adjusted(-kAaMarginPx, -kAaMarginPx, kAaMarginPx, kAaMarginPx));
+	}
+	return r;
+}
+
+void DamageTracker::addDamage(const Render::FrameData& fd, const Render::CmdRef& ref)
+{
+	const QRectF r = commandBounds(fd, ref);
+	if (r.width() > 0.0 && r.height() > 0.0) m_rects.push_back(r);
+}
+
+const std::vector<QRectF>& DamageTracker::update(const Render::FrameData& fd, const QRectF& viewport)
+{
+	m_rects.clear();
+	buildOrder(fd, m_curOrder);
+
+	if (!m_hasPrevious || viewport != m_viewport) {
+		m_full = true;
+		if (viewport.width() > 0.0 && viewport.height() > 0.0) m_rects.push_back(viewport);
+	}
+	else {
+		m_full = false;
+		const auto& a = m_prevOrder;
+		const auto& b = m_curOrder;
+
+		// 1) 公共前缀与公共后缀：单个组件的变化通常只落在中间一小段
+		std::size_t i = 0, j = 0;
+		std::size_t ea = a.size(), eb = b.size();
+		while (i < ea && j < eb && sameCmd(m_prev, a[i], fd, b[j])) { ++i; ++j; }
+		while (ea > i && eb > j && sameCmd(m_prev, a[ea - 1], fd, b[eb - 1])) { --ea; --eb; }
+
+		// 2) 中间段：小窗口前瞻对齐，识别插入、删除与原位修改
+		while (i < ea && j < eb) {
+			if (sameCmd(m_prev, a[i], fd, b[j])) { ++i; ++j; continue; }
+
+			int skipNew = 0;  // 本帧在 j 处插入的命令数
+			for (int k = 1; k <= kLookahead && j + k < eb; ++k) {
+				if (sameCmd(m_prev, a[i], fd, b[j + k])) { skipNew = k; break; }
+			}
+			int skipOld = 0;  // 上一帧在 i 处删除的命令数
+			for (int k = 1; k <= kLookahead && i + k < ea; ++k) {
+				if (sameCmd(m_prev, a[i + k], fd, b[j])) { skipOld = k; break; }
+			}
+
+			if (skipNew > 0 && (skipOld == 0 || skipNew <= skipOld)) {
+				for (int k = 0; k < skipNew; ++k) addDamage(fd, b[j + k]);
+				j += skipNew;
+			}
+			else if (skipOld > 0) {
+				for (int k = 0; k < skipOld; ++k) addDamage(m_prev, a[i + k]);
+				i += skipOld;
+			}
+			else {
+				// 原位修改：新旧两处都需重绘
+				addDamage(m_prev, a[i++]);
+				addDamage(fd, b[j++]);
+			}
+		}
+		for (; i < ea; ++i) addDamage(m_prev, a[i]);
+		for (; j < eb; ++j) addDamage(fd, b[j]);
+
+		// 3) 裁剪到视口并合并；面积过大时退化为整帧
+		for (auto& r : m_rects) r = r.intersected(viewport);
+		std::erase_if(m_rects, [](const QRectF& r) { return r.width() <= 0.0 || r.height() <= 0.0; });
+		mergeRects(m_rects, kMaxRects);
+
+		qreal damaged = 0.0;
+		for (const auto& r : m_rects) damaged += area(r);
+		if (!m_rects.empty() && damaged >= kFullRepaintRatio * area(viewport)) {
+			m_full = true;
+			m_rects.assign(1, viewport);
+		}
+	}
+
+	m_prev = fd;
+	m_prevOrder.swap(m_curOrder);
+	m_viewport = viewport;
+	m_hasPrevious = true;
+	return m_rects;
+}
+
+void DamageTracker::mergeRects(std::vector<QRectF>& rects, const int maxRects)
+{
+	// 数量很大时（如整页滚动）逐对合并代价高，直接取外接矩形
+	constexpr std::size_t kBoundingFallback = 64;
+	if (rects.size() > kBoundingFallback) {
+		QRectF bound;
+		for (const auto& r : rects) bound = bound.united(r);
+		rects.assign(1, bound);
+		return;
+	}
+
+	const std::size_t limit = static_cast<std::size_t>(std::max(1, maxRects));
+	bool changed = true;
+	while (changed) {
+		changed = false;
+
+		// 相交的矩形合并为外接矩形，保证剩余矩形两两不相交
+		for (std::size_t p = 0; p < rects.size() && !changed; ++p) {
+			for (std::size_t q = p + 1; q < rects.size(); ++q) {
+				if (rects[p].intersects(rects[q])) {
+					rects[p] = rects[p].united(rects[q]);
+					rects.erase(rects.begin() + static_cast<std::ptrdiff_t>(q));
+					changed = true;
+					break;
+				}
+			}
+		}
+		if (changed || rects.size() <= limit) continue;
+
+		// 数量超限：合并外接面积增量最小的一对
+		std::size_t bestP = 0, bestQ = 1;
+		qreal bestCost = std::numeric_limits<qreal>::max();
+		for (std::size_t p = 0; p < rects.size(); ++p) {
+			for (std::size_t q = p + 1; q < rects.size(); ++q) {
+				const qreal cost = area(rects[p].united(rects[q])) - area(rects[p]) - area(rects[q]);
+				if (cost < bestCost) { bestCost = cost; bestP = p; bestQ = q; }
+			}
+		}
+		rects[bestP] = rects[bestP].united(rects[bestQ]);
+		rects.erase(rects.begin() + static_cast<std::ptrdiff_t>(bestQ));
+		changed = true;
+	}
+}
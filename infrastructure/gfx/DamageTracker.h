@@ -0,0 +1,63 @@
+/*
+ * 文件名：DamageTracker.h
+ * 职责：帧间损坏区域计算，比较相邻两帧的绘制命令流，得出需要重绘的矩形集合。
+ * 依赖：渲染数据结构、Qt6 Core。
+ * 线程：非线程安全，由窗口在UI线程中使用。
+ * 备注：只做CPU侧比较，不涉及OpenGL；区域以逻辑像素表示，由渲染器换算为设备像素剪裁。
+ */
+
+#pragma once
+#include <qrect.h>
+#include <vector>
+
+#include "RenderData.hpp"
+
+/// 损坏区域跟踪器：按命令流差异推导局部重绘区域
+///
+/// 原理：
+/// - 组件已把可见状态完整地表达为绘制命令，因此两帧命令流的差异就是像素变化的来源
+/// - 两帧命令流按顺序对齐（公共前后缀 + 小窗口前瞻匹配），匹配上的命令保持相对顺序，
+///   未匹配命令（新增、删除、改变）的覆盖范围之外像素必然不变，其覆盖范围的并集即为损坏区域
+/// - 覆盖范围 = 命令自身范围（投影含模糊带）与剪裁求交，再外扩1像素容纳抗锯齿边缘
+///
+/// 合并策略：
+/// - 相交的区域合并为外接矩形；数量超过上限时合并"外接面积增量"最小的一对
+/// - 损坏面积超过视口一半时直接退化为整帧重绘
+class DamageTracker {
+public:
+	/// 功能：比较本帧与上一帧，计算损坏区域并记录本帧
+	/// 参数：fd — 本帧完整的绘制命令
+	/// 参数：viewport — 视口矩形（逻辑像素），损坏区域被裁剪到其中
+	/// 返回：需重绘的区域（逻辑像素）；无变化时为空，整帧重绘时为{viewport}
+	const std::vector<QRectF>& update(const Render::FrameData& fd, const QRectF& viewport);
+
+	/// 功能：使下一次update返回整帧（DPR、清屏颜色等命令之外的状态变化时调用；视口变化会自动识别）
+	void invalidateAll() noexcept { m_hasPrevious = false; }
+
+	/// 功能：最近一次update是否为整帧重绘
+	[[nodiscard]] bool fullRepaint() const noexcept { return m_full; }
+
+	/// 功能：合并矩形集合
+	/// 参数：rects — 待合并的矩形（就地修改）
+	/// 参数：maxRects — 合并后的数量上限
+	static void mergeRects(std::vector<QRectF>& rects, int maxRects = kMaxRects);
+
+	/// 功能：命令在屏幕上可能影响的范围（逻辑像素，含抗锯齿外扩，已与剪裁求交）
+	[[nodiscard]] static QRectF commandBounds(const Render::FrameData& fd, const Render::CmdRef& ref);
+
+	static constexpr int kMaxRects = 4;            // 每帧损坏矩形上限（每个矩形一次剪裁绘制）
+	static constexpr double kFullRepaintRatio = 0.5;  // 损坏面积占视口比例超过该值时整帧重绘
+	static constexpr int kLookahead = 8;           // 对齐时的前瞻窗口（命令数）
+
+private:
+	/// 功能：把未匹配命令的覆盖范围加入损坏集合
+	void addDamage(const Render::FrameData& fd, const Render::CmdRef& ref);
+
+	Render::FrameData m_prev;          // 上一帧命令（复用容量）
+	std::vector<Render::CmdRef> m_prevOrder;
+	std::vector<Render::CmdRef> m_curOrder;
+	std::vector<QRectF> m_rects;
+	QRectF m_viewport;                 // 上一帧视口（变化时整帧重绘）
+	bool m_hasPrevious{ false };
+	bool m_full{ true };
+};
@@ -0,0 +1,336 @@
+#include "FrameCapture.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <qbytearray.h>
+#include <qcolor.h>
+#include <qdatastream.h>
+#include <qfile.h>
+#include <qiodevice.h>
+#include <qrect.h>
+#include <qset.h>
+#include <qsize.h>
+#include <qstring.h>
+#include <utility>
+#include <vector>
+
+#include "IconCache.h"
+#include "RenderData.hpp"
+
+namespace {
+	void setError(QString* error, const QString& msg) {
+		if (error) *error = msg;
+	}
+
+	// 紧凑字段按内存布局原样写出：矩形4个float，颜色4个字节
+	QDataStream& operator<<(QDataStream& ds, const Render::RectF& r) {
+		return ds << r.x() << r.y() << r.width() << r.height();
+	}
+	QDataStream& operator>>(QDataStream& ds, Render::RectF& r) {
+		float x = 0, y = 0, w = 0, h = 0;
+		ds >> x >> y >> w >> h;
+		r = Render::RectF(x, y, w, h);
+		return ds;
+	}
+	QDataStream& operator<<(QDataStream& ds, const Render::Rgba8& c) {
+		return ds << quint8(c.r) << quint8(c.g) << quint8(c.b) << quint8(c.a);
+	}
+	QDataStream& operator>>(QDataStream& ds, Render::Rgba8& c) {
+		quint8 r = 0, g = 0, b = 0, a = 0;
+		ds >> r >> g >> b >> a;
+		c = Render::Rgba8(r, g, b, a);
+		return ds;
+	}
+	QDataStream& operator<<(QDataStream& ds, const Render::ClipRegion& c) {
+		return ds << c.rect << c.radiusPx;
+	}
+	QDataStream& operator>>(QDataStream& ds, Render::ClipRegion& c) {
+		return ds >> c.rect >> c.radiusPx;
+	}
+
+	QDataStream& operator<<(QDataStream& ds, const Render::RoundedRectCmd& c) {
+		return ds << c.rect << c.radiusPx << c.color << quint32(c.clip) << c.strokeWidthPx << c.strokeColor;
+	}
+	QDataStream& operator>>(QDataStream& ds, Render::RoundedRectCmd& c) {
+		quint32 clip = 0;
+		ds >> c.rect >> c.radiusPx >> c.color >> clip >> c.strokeWidthPx >> c.strokeColor;
+		c.clip = clip;
+		return ds;
+	}
+	QDataStream& operator<<(QDataStream& ds, const Render::ImageCmd& c) {
+		return ds << c.dstRect << qint32(c.textureId) << c.srcRectPx << c.tint << quint32(c.clip);
+	}
+	QDataStream& operator>>(QDataStream& ds, Render::ImageCmd& c) {
+		qint32 tex = 0;
+		quint32 clip = 0;
+		ds >> c.dstRect >> tex >> c.srcRectPx >> c.tint >> clip;
+		c.textureId = tex;
+		c.clip = clip;
+		return ds;
+	}
+	QDataStream& operator<<(QDataStream& ds, const Render::ShadowCmd& c) {
+		return ds << c.rect << c.radiusPx << c.blurPx << c.color << quint32(c.clip);
+	}
+	QDataStream& operator>>(QDataStream& ds, Render::ShadowCmd& c) {
+		quint32 clip = 0;
+		ds >> c.rect >> c.radiusPx >> c.blurPx >> c.color >> clip;
+		c.clip = clip;
+		return ds;
+	}
+
+	// 剪裁索引须落在剪裁表内（0为不剪裁，kEmptyClip为全部剪掉）
+	template <typename T>
+	bool clipsInRange(const std::vector<T>& v, const size_t clipCount) {
+		return std::all_of(v.begin(), v.end(), [clipCount](const T& c) { return c.clip <= clipCount || c.clip == Render::kEmptyClip; });
+	}
+
+	template <typename T>
+	void writeArray(QDataStream& ds, const std::vector<T>& v) {
+		ds << quint32(v.size());
+		for (const auto& c : v) ds << c;
+	}
+
+	template <typename T>
+	bool readArray(QDataStream& ds, std::vector<T>& v) {
+		quint32 n = 0;
+		ds >> n;
+		// 防御截断/损坏的数据：元素至少占若干字节，数量不可能超过剩余字节数
+		if (ds.status() != QDataStream::Ok || n > static_cast<quint32>(ds.device()->bytesAvailable())) return false;
+		v.resize(n);
+		for (auto& c : v) ds >> c;
+		return ds.status() == QDataStream::Ok;
+	}
+
+	/// 与Renderer中文本的展开规则一致：每个落在srcRectPx内的字形一条图像命令
+	void appendTextGlyphs(Render::FrameData& out, const Render::ImageCmd& img, const IconCache::TextRun& run) {
+		const QRectF src = img.srcRectPx;
+		if (src.width() <= 0.0 || src.height() <= 0.0) return;
+		const qreal sx = img.dstRect.width() / src.width();
+		const qreal sy = img.dstRect.height() / src.height();
+		const QColor tint(run.color.red() * img.tint.red() / 255, run.color.green() * img.tint.green() / 255,
+			run.color.blue() * img.tint.blue() / 255, run.color.alpha() * img.tint.alpha() / 255);
+
+		for (const auto& g : run.glyphs) {
+			const QRectF part = QRectF(g.rectPx).intersected(src);
+			if (part.isEmpty()) continue;
+			const QRectF local = part.translated(-g.rectPx.topLeft());
+			Render::ImageCmd glyph = img;
+			glyph.dstRect = QRectF(img.dstRect.x() + (part.x() - src.x()) * sx, img.dstRect.y() + (part.y() - src.y()) * sy,
+				part.width() * sx, part.height() * sy);
+			glyph.textureId = g.glyphId;
+			glyph.srcRectPx = QRectF(local.x() * g.srcScale, local.y() * g.srcScale,
+				local.width() * g.srcScale, local.height() * g.srcScale);
+			glyph.tint = tint;
+			out.addImage(glyph);
+		}
+	}
+}
+
+FrameCapture FrameCapture::capture(const Render::FrameData& fd, const IconCache& iconCache, const float devicePixelRatio,
+	const QSize& viewportSize)
+{
+	FrameCapture cap;
+	cap.devicePixelRatio = devicePixelRatio;
+	cap.viewportSize = viewportSize;
+
+	// 先按命令流完整复制一份（补全缺失的命令流），再把文本展开为字形
+	Render::FrameData ordered;
+	ordered.appendFrame(fd);
+	Render::FrameData& out = cap.frame;
+	out.clips = ordered.clips;
+	out.roundedRects.reserve(ordered.roundedRects.size());
+	out.shadows.reserve(ordered.shadows.size());
+	out.commands.reserve(ordered.commands.size());
+	for (const auto& ref : ordered.commands) {
+		switch (ref.type) {
+		case Render::CmdType::RoundedRect: out.addRoundedRect(ordered.roundedRects[ref.index]); break;
+		case Render::CmdType::Shadow:      out.addShadow(ordered.shadows[ref.index]); break;
+		case Render::CmdType::Image: {
+			const auto& img = ordered.images[ref.index];
+			if (const IconCache::TextRun* run = iconCache.textRun(img.textureId)) appendTextGlyphs(out, img, *run);
+			else if (Render::isLayerTexture(img.textureId)) {
+				// 图层合成：源区域换算为设备像素，与回放时同尺寸的占位纹理对应
+				Render::ImageCmd composite = img;
+				composite.srcRectPx = QRectF(img.srcRectPx.x() * devicePixelRatio, img.srcRectPx.y() * devicePixelRatio,
+					img.srcRectPx.width() * devicePixelRatio, img.srcRectPx.height() * devicePixelRatio);
+				out.addImage(composite);
+			}
+			else out.addImage(img);
+			break;
+		}
+		}
+	}
+
+	QSet<int> seen;
+	for (const auto& img : out.images) {
+		if (seen.contains(img.textureId)) continue;
+		seen.insert(img.textureId);
+		if (Render::isLayerTexture(img.textureId)) {
+			const Render::LayerDef* def = ordered.findLayer(img.textureId);
+			const QRectF b = def ? def->bounds : QRectF();
+			cap.textures.push_back(Texture{ .handle = img.textureId, .key = QStringLiteral("layer:%1").arg(-img.textureId),
+				.sizePx = QSize(static_cast<int>(std::ceil(b.width() * devicePixelRatio)), static_cast<int>(std::ceil(b.height() * devicePixelRatio))) });
+			continue;
+		}
+		cap.textures.push_back(Texture{ .handle = img.textureId, .key = iconCache.keyOf(img.textureId),
+			.sizePx = iconCache.textureSizePx(img.textureId) });
+	}
+	return cap;
+}
+
+QByteArray FrameCapture::encode() const
+{
+	QByteArray body;
+	{
+		QDataStream ds(&body, QIODevice::WriteOnly);
+		ds.setVersion(QDataStream::Qt_6_0);
+		ds.setByteOrder(QDataStream::LittleEndian);
+		ds.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+		ds << devicePixelRatio << viewportSize;
+		ds << quint32(textures.size());
+		for (const auto& t : textures) ds << qint32(t.handle) << t.key << t.sizePx;
+		writeArray(ds, frame.clips);
+		writeArray(ds, frame.roundedRects);
+		writeArray(ds, frame.images);
+		writeArray(ds, frame.shadows);
+		ds << quint32(frame.commands.size());
+		for (const auto& ref : frame.commands) ds << quint8(ref.type) << quint32(ref.index);
+	}
+
+	QByteArray data;
+	QDataStream ds(&data, QIODevice::WriteOnly);
+	ds.setVersion(QDataStream::Qt_6_0);
+	ds.setByteOrder(QDataStream::LittleEndian);
+	ds << kMagic << kVersion << qCompress(body);
+	return data;
+}
+
+bool FrameCapture::decode(const QByteArray& data, FrameCapture& out, QString* error)
+{
+	QDataStream head(data);
+	head.setVersion(QDataStream::Qt_6_0);
+	head.setByteOrder(QDataStream::LittleEndian);
+	quint32 magic = 0;
+	quint16 version = 0;
+	QByteArray packed;
+	head >> magic >> version;
+	if (head.status() != QDataStream::Ok || magic != kMagic) {
+		setError(error, QStringLiteral("not a frame capture"));
+		return false;
+	}
+	if (version != kVersion) {
+		setError(error, QStringLiteral("unsupported capture version %1 (expected %2)").arg(version).arg(kVersion));
+		return false;
+	}
+	head >> packed;
+	const QByteArray body = qUncompress(packed);
+	if (head.status() != QDataStream::Ok || body.isEmpty()) {
+		setError(error, QStringLiteral("corrupted capture body"));
+		return false;
+	}
+
+	QDataStream ds(body);
+	ds.setVersion(QDataStream::Qt_6_0);
+	ds.setByteOrder(QDataStream::LittleEndian);
+	ds.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+	FrameCapture cap;
+	quint32 texCount = 0;
+	ds >> cap.devicePixelRatio >> cap.viewportSize >> texCount;
+	if (ds.status() != QDataStream::Ok || texCount > static_cast<quint32>(body.size())) {
+		setError(error, QStringLiteral("truncated capture header"));
+		return false;
+	}
+	cap.textures.resize(texCount);
+	for (auto& t : cap.textures) {
+		qint32 handle = 0;
+		ds >> handle >> t.key >> t.sizePx;
+		t.handle = handle;
+	}
+	if (!readArray(ds, cap.frame.clips) || !readArray(ds, cap.frame.roundedRects) || !readArray(ds, cap.frame.images)
+		|| !readArray(ds, cap.frame.shadows)) {
+		setError(error, QStringLiteral("truncated command arrays"));
+		return false;
+	}
+	const size_t clipCount = cap.frame.clips.size();
+	if (!clipsInRange(cap.frame.roundedRects, clipCount) || !clipsInRange(cap.frame.images, clipCount)
+		|| !clipsInRange(cap.frame.shadows, clipCount)) {
+		setError(error, QStringLiteral("clip reference out of range"));
+		return false;
+	}
+
+	quint32 cmdCount = 0;
+	ds >> cmdCount;
+	if (ds.status() != QDataStream::Ok || cmdCount > static_cast<quint32>(body.size())) {
+		setError(error, QStringLiteral("truncated command stream"));
+		return false;
+	}
+	cap.frame.commands.resize(cmdCount);
+	for (auto& ref : cap.frame.commands) {
+		quint8 type = 0;
+		quint32 index = 0;
+		ds >> type >> index;
+		const size_t limit = type == quint8(Render::CmdType::RoundedRect) ? cap.frame.roundedRects.size()
+			: type == quint8(Render::CmdType::Image) ? cap.frame.images.size()
+			: type == quint8(Render::CmdType::Shadow) ? cap.frame.shadows.size() : 0;
+		if (index >= limit) {
+			setError(error, QStringLiteral("command reference out of range"));
+			return false;
+		}
+		ref = Render::CmdRef{ static_cast<Render::CmdType>(type), index };
+	}
+	if (ds.status() != QDataStream::Ok) {
+		setError(error, QStringLiteral("truncated command stream"));
+		return false;
+	}
+
+	out = std::move(cap);
+	return true;
+}
+
+bool FrameCapture::save(const QString& path, QString* error) const
+{
+	QFile f(path);
+	if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		setError(error, f.errorString());
+		return false;
+	}
+	const QByteArray data = encode();
+	if (f.write(data) != data.size()) {
+		setError(error, f.errorString());
+		return false;
+	}
+	return true;
+}
+
+bool FrameCapture::load(const QString& path, FrameCapture& out, QString* error)
+{
+	QFile f(path);
+	if (!f.open(QIODevice::ReadOnly)) {
+		setError(error, f.errorString());
+		return false;
+	}
+	return decode(f.readAll(), out, error);
+}
+
+Render::FrameData FrameCapture::slice(const Render::FrameData& fd, qsizetype first, qsizetype last)
+{
+	const auto n = static_cast<qsizetype>(fd.commands.size());
+	first = std::clamp<qsizetype>(first, 0, n);
+	last = std::clamp<qsizetype>(last, first, n);
+
+	Render::FrameData out;
+	out.clips = fd.clips;
+	out.commands.reserve(static_cast<size_t>(last - first));
+	for (qsizetype i = first; i < last; ++i) {
+		const auto& ref = fd.commands[static_cast<size_t>(i)];
+		switch (ref.type) {
+		case Render::CmdType::RoundedRect: out.addRoundedRect(fd.roundedRects[ref.index]); break;
+		case Render::CmdType::Image:       out.addImage(fd.images[ref.index]); break;
+		case Render::CmdType::Shadow:      out.addShadow(fd.shadows[ref.index]); break;
+		}
+	}
+	return out;
+}
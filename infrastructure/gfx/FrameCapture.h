@@ -0,0 +1,63 @@
+/*
+ * 文件名：FrameCapture.h
+ * 职责：帧捕获与回放的数据格式，把一帧FrameData连同DPR、视口与所引用纹理的键/尺寸编码为带版本的二进制。
+ * 依赖：渲染数据结构、IconCache、Qt6 Core。
+ * 线程：纯数据处理，无共享状态；capture需与IconCache在同一线程调用。
+ * 备注：不保存纹理像素，回放时按尺寸生成占位纹理；文本在捕获时展开为逐字形的图像命令；离屏图层只保留合成命令（图层纹理视同普通纹理）。
+ */
+
+#pragma once
+#include <qbytearray.h>
+#include <qglobal.h>
+#include <qsize.h>
+#include <qstring.h>
+#include <vector>
+
+#include "IconCache.h"
+#include "RenderData.hpp"
+
+/// 帧捕获：一帧完整的绘制输入
+///
+/// 格式（小端，QDataStream）：
+/// - 文件头：魔数"FJFC"、格式版本
+/// - 正文（qCompress压缩）：DPR、视口、纹理表（句柄、缓存键、像素尺寸）、三类命令数组、有序命令流
+///
+/// 文本句柄在捕获时按Renderer的展开规则拆成逐字形的ImageCmd，回放侧无需重建排版；
+/// 纹理内容以同尺寸占位纹理代替（绘制开销取决于尺寸与图集分页，而非像素内容）
+class FrameCapture {
+public:
+	/// 纹理表条目
+	struct Texture {
+		int     handle{ 0 };   // 捕获时的IconCache句柄（命令中的textureId）
+		QString key;           // 捕获时的缓存键（诊断用）
+		QSize   sizePx;        // 子图像素尺寸
+	};
+
+	static constexpr quint32 kMagic = 0x464A4643;  // "FJFC"
+	static constexpr quint16 kVersion = 3;  // 2：圆角矩形增加描边字段；3：命令改为紧凑布局（float矩形、RGBA8颜色、剪裁表索引）
+
+	float devicePixelRatio{ 1.0f };
+	QSize viewportSize;                 // 视口（逻辑像素）
+	Render::FrameData frame;
+	std::vector<Texture> textures;
+
+	/// 功能：从一帧绘制输入生成捕获
+	/// 参数：fd — 本帧完整的绘制命令
+	/// 参数：iconCache — 解析纹理句柄（文本展开为字形、记录键与尺寸）
+	/// 参数：devicePixelRatio / viewportSize — 本帧DPR与逻辑视口
+	[[nodiscard]] static FrameCapture capture(const Render::FrameData& fd, const IconCache& iconCache,
+		float devicePixelRatio, const QSize& viewportSize);
+
+	/// 功能：编码为二进制
+	[[nodiscard]] QByteArray encode() const;
+	/// 功能：从二进制解码
+	/// 返回：成功与否；失败时error给出原因（魔数/版本不符、数据截断、索引越界）
+	static bool decode(const QByteArray& data, FrameCapture& out, QString* error = nullptr);
+
+	/// 功能：写入/读取文件
+	bool save(const QString& path, QString* error = nullptr) const;
+	static bool load(const QString& path, FrameCapture& out, QString* error = nullptr);
+
+	/// 功能：截取命令流中[first, last)的命令，保持原顺序（回放时二分定位高开销命令）
+	[[nodiscard]] static Render::FrameData slice(const Render::FrameData& fd, qsizetype first, qsizetype last);
+};
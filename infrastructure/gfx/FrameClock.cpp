@@ -0,0 +1,37 @@
+#include "FrameClock.h"
+
+#include <algorithm>
+#include <qelapsedtimer.h>
+#include <qglobal.h>
+
+namespace {
+	const QElapsedTimer& processClock() {
+		static const QElapsedTimer clock = [] {
+			QElapsedTimer t;
+			t.start();
+			return t;
+		}();
+		return clock;
+	}
+}
+
+qint64 FrameClock::nowMs() noexcept
+{
+	return s_inFrame ? s_frameMs : std::max(realMs(), s_frameMs);
+}
+
+qint64 FrameClock::realMs() noexcept
+{
+	return processClock().elapsed();
+}
+
+double FrameClock::preciseMs() noexcept
+{
+	return static_cast<double>(processClock().nsecsElapsed()) / 1.0e6;
+}
+
+void FrameClock::beginFrame(const qint64 frameMs) noexcept
+{
+	s_frameMs = std::max(frameMs, s_frameMs);
+	s_inFrame = true;
+}
@@ -0,0 +1,35 @@
+/*
+ * 文件名：FrameClock.h
+ * 职责：动画统一取时的单调时钟；帧内返回本帧的预计呈现时间，使同一帧的所有动画按同一时刻求值。
+ * 依赖：Qt6 Core。
+ * 线程：仅在UI线程使用（帧时间为进程内全局状态）。
+ * 备注：帧时间由FrameScheduler在每帧开始时写入；不在帧内时退回实时时间。
+ */
+
+#pragma once
+#include <qglobal.h>
+
+/// 帧时钟（毫秒，进程内单调）
+///
+/// 组件的动画起止时刻与进度都应取nowMs()：
+/// - 帧内（beginFrame与endFrame之间）：返回本帧的预计呈现时间，tick中各组件看到相同的时刻
+/// - 帧外（输入事件中启动动画等）：返回实时时间，但不早于上一帧的帧时间，保证时间不回退
+class FrameClock {
+public:
+	/// 功能：动画时间（毫秒）
+	[[nodiscard]] static qint64 nowMs() noexcept;
+	/// 功能：实时时间（毫秒，不受帧时间影响）
+	[[nodiscard]] static qint64 realMs() noexcept;
+	/// 功能：实时时间（毫秒，亚毫秒精度，供调度器测量刷新间隔）
+	[[nodiscard]] static double preciseMs() noexcept;
+
+	/// 功能：开始一帧，此后nowMs返回frameMs（早于上一帧的帧时间时沿用上一帧）
+	static void beginFrame(qint64 frameMs) noexcept;
+	/// 功能：结束一帧，nowMs恢复为实时时间
+	static void endFrame() noexcept { s_inFrame = false; }
+	[[nodiscard]] static bool inFrame() noexcept { return s_inFrame; }
+
+private:
+	static inline qint64 s_frameMs{ 0 };  // 最近一帧的帧时间（帧外nowMs的下限）
+	static inline bool   s_inFrame{ false };
+};
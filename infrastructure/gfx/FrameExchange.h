@@ -0,0 +1,60 @@
+/*
+ * 文件名：FrameExchange.h
+ * 职责：单生产者/单消费者的无锁三重缓冲，在线程间交接整帧数据（UI线程 -> 渲染线程的FrameData，渲染线程 -> UI线程的帧缓冲）。
+ * 依赖：C++标准库（std::atomic）。
+ * 线程：back/publish只由生产者线程调用，consume/front只由消费者线程调用。
+ * 备注：交接只是一次原子交换，不加锁、不拷贝；生产者领先时旧的未取帧被覆盖（只保留最新一帧）。
+ */
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/// 三重缓冲：生产者写back，消费者读front，中间槽在两者之间原子交换
+///
+/// 槽位所有权任何时刻都不重叠：生产者写入back时消费者仍可读front，
+/// publish把back与中间槽交换并标记"有新帧"，consume再把front与中间槽交换取得最新一帧。
+/// 槽位内容在多次交接间复用（FrameData等容器的容量得以保留）。
+template <typename T>
+class FrameExchange {
+public:
+	/// 功能：生产者的写入槽
+	[[nodiscard]] T& back() noexcept { return m_slots[m_back]; }
+
+	/// 功能：发布写入槽（与中间槽交换）
+	/// 返回：是否覆盖了一帧尚未被取走的数据
+	bool publish() noexcept {
+		const std::uint8_t prev = m_middle.exchange(static_cast<std::uint8_t>(m_back | kFresh), std::memory_order_acq_rel);
+		m_back = static_cast<std::uint8_t>(prev & kIndexMask);
+		return (prev & kFresh) != 0;
+	}
+
+	/// 功能：取得最新发布的一帧（与中间槽交换）
+	/// 返回：是否有新帧；没有时front保持不变
+	bool consume() noexcept {
+		if ((m_middle.load(std::memory_order_acquire) & kFresh) == 0) return false;
+		const std::uint8_t prev = m_middle.exchange(m_front, std::memory_order_acq_rel);
+		m_front = static_cast<std::uint8_t>(prev & kIndexMask);
+		return true;
+	}
+
+	/// 功能：消费者当前持有的一帧
+	[[nodiscard]] T& front() noexcept { return m_slots[m_front]; }
+	[[nodiscard]] const T& front() const noexcept { return m_slots[m_front]; }
+
+	/// 功能：是否有尚未取走的新帧（任意线程，仅作提示）
+	[[nodiscard]] bool hasFresh() const noexcept { return (m_middle.load(std::memory_order_acquire) & kFresh) != 0; }
+
+	/// 功能：遍历全部槽位（仅在两端线程都不再访问时使用，如释放资源）
+	[[nodiscard]] std::array<T, 3>& slots() noexcept { return m_slots; }
+
+private:
+	static constexpr std::uint8_t kFresh = 0x4;
+	static constexpr std::uint8_t kIndexMask = 0x3;
+
+	std::array<T, 3> m_slots{};
+	std::uint8_t m_back{ 0 };                  // 生产者独占
+	std::atomic<std::uint8_t> m_middle{ 1 };   // 低两位为槽位下标，kFresh表示有新帧
+	std::uint8_t m_front{ 2 };                 // 消费者独占
+};
@@ -0,0 +1,122 @@
+#include "FrameProfiler.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <qglobal.h>
+#include <vector>
+
+namespace {
+	constexpr double kNsPerMs = 1.0e6;
+}
+
+void FrameProfiler::beginFrame()
+{
+	if (!m_enabled) return;
+	if (!m_clock.isValid()) m_clock.start();
+
+	const qint64 now = m_clock.nsecsElapsed();
+	m_current = Sample{};
+	m_current.intervalNs = m_lastBeginNs >= 0 ? now - m_lastBeginNs : 0;
+	m_lastBeginNs = now;
+	m_inFrame = true;
+}
+
+void FrameProfiler::addStageNs(const Stage stage, const qint64 ns) noexcept
+{
+	if (!m_enabled) return;
+	m_current.stageNs[static_cast<std::size_t>(stage)] += std::max<qint64>(0, ns);
+}
+
+void FrameProfiler::setGpuNs(const qint64 ns) noexcept
+{
+	if (!m_enabled) return;
+	m_current.gpuNs = ns;
+}
+
+void FrameProfiler::endFrame(const int drawCalls)
+{
+	if (!m_enabled || !m_inFrame) return;
+	m_inFrame = false;
+
+	// Clip嵌套在Record内部计时：扣除后各阶段互斥
+	auto& st = m_current.stageNs;
+	const auto rec = static_cast<std::size_t>(Stage::Record);
+	const auto clip = static_cast<std::size_t>(Stage::Clip);
+	st[rec] = std::max<qint64>(0, st[rec] - st[clip]);
+
+	m_current.cpuNs = 0;
+	for (const qint64 ns : st) m_current.cpuNs += ns;
+	m_current.drawCalls = drawCalls;
+
+	m_ring[static_cast<std::size_t>(m_head)] = m_current;
+	m_head = (m_head + 1) % kHistory;
+	m_count = std::min(m_count + 1, kHistory);
+}
+
+void FrameProfiler::reset()
+{
+	m_head = 0;
+	m_count = 0;
+	m_current = Sample{};
+	m_lastBeginNs = -1;
+	m_inFrame = false;
+}
+
+const FrameProfiler::Sample& FrameProfiler::sample(const int i) const noexcept
+{
+	const int oldest = (m_head - m_count + kHistory) % kHistory;
+	return m_ring[static_cast<std::size_t>((oldest + std::clamp(i, 0, std::max(0, m_count - 1))) % kHistory)];
+}
+
+double FrameProfiler::percentile(std::vector<double>& values, const double q)
+{
+	if (values.empty()) return 0.0;
+	const auto n = static_cast<double>(values.size());
+	const auto rank = static_cast<std::size_t>(std::clamp(std::ceil(std::clamp(q, 0.0, 1.0) * n), 1.0, n)) - 1;
+	std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(rank), values.end());
+	return values[rank];
+}
+
+FrameProfiler::Summary FrameProfiler::summary() const
+{
+	Summary s;
+	s.frames = m_count;
+	if (m_count == 0) return s;
+
+	std::vector<double> cpu, gpu, interval, calls;
+	cpu.reserve(static_cast<std::size_t>(m_count));
+	calls.reserve(static_cast<std::size_t>(m_count));
+	for (int i = 0; i < m_count; ++i) {
+		const Sample& smp = sample(i);
+		cpu.push_back(static_cast<double>(smp.cpuNs) / kNsPerMs);
+		if (smp.gpuNs >= 0) gpu.push_back(static_cast<double>(smp.gpuNs) / kNsPerMs);
+		if (smp.intervalNs > 0) interval.push_back(static_cast<double>(smp.intervalNs) / kNsPerMs);
+		calls.push_back(smp.drawCalls);
+		for (int k = 0; k < kStageCount; ++k) {
+			s.stageAvgMs[static_cast<std::size_t>(k)] += static_cast<double>(smp.stageNs[static_cast<std::size_t>(k)]) / kNsPerMs;
+		}
+		s.drawCallsMax = std::max(s.drawCallsMax, smp.drawCalls);
+	}
+	for (auto& avg : s.stageAvgMs) avg /= m_count;
+
+	s.cpuP50Ms = percentile(cpu, 0.50);
+	s.cpuP99Ms = percentile(cpu, 0.99);
+	s.gpuP50Ms = percentile(gpu, 0.50);
+	s.gpuP99Ms = percentile(gpu, 0.99);
+	s.intervalP50Ms = percentile(interval, 0.50);
+	s.intervalP99Ms = percentile(interval, 0.99);
+	s.drawCallsP50 = percentile(calls, 0.50);
+	return s;
+}
+
+std::array<int, FrameProfiler::kHistogramBuckets> FrameProfiler::histogram() const
+{
+	std::array<int, kHistogramBuckets> h{};
+	for (int i = 0; i < m_count; ++i) {
+		const auto ms = static_cast<int>(static_cast<double>(sample(i).cpuNs) / kNsPerMs);
+		++h[static_cast<std::size_t>(std::clamp(ms, 0, kHistogramBuckets - 1))];
+	}
+	return h;
+}
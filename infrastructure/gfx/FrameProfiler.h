@@ -0,0 +1,124 @@
+/*
+ * 文件名：FrameProfiler.h
+ * 职责：帧耗时剖析，按阶段（录制、剪裁、提交、交换）累计CPU耗时，结合GPU计时结果维护滚动历史与直方图。
+ * 依赖：Qt6 Core。
+ * 线程：仅在UI线程使用；活动实例为进程内单例指针。
+ * 备注：本身不涉及OpenGL，GPU耗时由Renderer的计时查询取回后写入。
+ */
+
+#pragma once
+#include <array>
+#include <qelapsedtimer.h>
+#include <qglobal.h>
+#include <vector>
+
+/// 帧剖析器：滚动保存最近kHistory帧的分阶段耗时
+///
+/// 阶段划分（互斥）：
+/// - Record：UiRoot::append生成绘制命令（已扣除其中的Clip）
+/// - Clip：RenderUtils::applyParentClip（嵌套在Record内部计时，endFrame时从Record中扣除）
+/// - Submit：损坏区域计算与Renderer::drawFrame的CPU耗时
+/// - Swap：paintGL返回到frameSwapped之间（缓冲交换、局部更新的回传等驱动耗时）
+///
+/// GPU耗时来自GL_TIME_ELAPSED查询，结果滞后若干帧取回，记入取回时的那一帧（只用于统计分布）
+class FrameProfiler {
+public:
+	enum class Stage : int { Record, Clip, Submit, Swap };
+	static constexpr int kStageCount = 4;
+	static constexpr int kHistory = 240;          // 滚动窗口（帧）
+	static constexpr int kHistogramBuckets = 34;  // 直方图：每桶1ms，最后一桶为>=33ms
+
+	/// 单帧样本
+	struct Sample {
+		std::array<qint64, kStageCount> stageNs{};  // 各阶段CPU耗时（纳秒）
+		qint64 cpuNs{ 0 };       // 各阶段之和
+		qint64 gpuNs{ -1 };      // GPU耗时（纳秒；无结果时为-1）
+		qint64 intervalNs{ 0 };  // 与上一帧开始时刻的间隔（首帧为0）
+		int    drawCalls{ 0 };
+	};
+
+	/// 滚动窗口统计（毫秒）
+	struct Summary {
+		int    frames{ 0 };
+		double cpuP50Ms{ 0.0 };
+		double cpuP99Ms{ 0.0 };
+		double gpuP50Ms{ 0.0 };       // 无GPU结果时为0
+		double gpuP99Ms{ 0.0 };
+		double intervalP50Ms{ 0.0 };
+		double intervalP99Ms{ 0.0 };
+		std::array<double, kStageCount> stageAvgMs{};
+		double drawCallsP50{ 0.0 };
+		int    drawCallsMax{ 0 };
+	};
+
+	/// 阶段计时作用域：计入当前活动剖析器（无活动实例或未启用时不计时）
+	class ScopedStage {
+	public:
+		explicit ScopedStage(const Stage stage) noexcept
+			: m_profiler(s_active && s_active->m_enabled ? s_active : nullptr), m_stage(stage) {
+			if (m_profiler) m_timer.start();
+		}
+		~ScopedStage() {
+			if (m_profiler) m_profiler->addStageNs(m_stage, m_timer.nsecsElapsed());
+		}
+		ScopedStage(const ScopedStage&) = delete;
+		ScopedStage& operator=(const ScopedStage&) = delete;
+	private:
+		FrameProfiler* m_profiler;
+		Stage m_stage;
+		QElapsedTimer m_timer;
+	};
+
+	FrameProfiler() = default;
+	~FrameProfiler() { if (s_active == this) s_active = nullptr; }
+	FrameProfiler(const FrameProfiler&) = delete;
+	FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+	/// 功能：启用/停用采样（停用时begin/end/add均为空操作，历史保留）
+	void setEnabled(bool on) noexcept { m_enabled = on; }
+	[[nodiscard]] bool enabled() const noexcept { return m_enabled; }
+
+	/// 功能：设置活动实例（ScopedStage计入的对象）；传nullptr清除
+	static void setActive(FrameProfiler* p) noexcept { s_active = p; }
+	[[nodiscard]] static FrameProfiler* active() noexcept { return s_active; }
+
+	/// 功能：开始一帧（记录开始时刻，清零当前样本）
+	void beginFrame();
+	/// 功能：累加阶段耗时（纳秒）
+	void addStageNs(Stage stage, qint64 ns) noexcept;
+	/// 功能：写入GPU耗时（纳秒）
+	void setGpuNs(qint64 ns) noexcept;
+	/// 功能：结束一帧并存入历史
+	/// 参数：drawCalls — 本帧绘制调用次数
+	void endFrame(int drawCalls);
+	/// 功能：是否处于beginFrame与endFrame之间
+	[[nodiscard]] bool inFrame() const noexcept { return m_inFrame; }
+
+	/// 功能：清空历史
+	void reset();
+
+	[[nodiscard]] int sampleCount() const noexcept { return m_count; }
+	/// 功能：按时间顺序访问历史样本（0为最旧）
+	[[nodiscard]] const Sample& sample(int i) const noexcept;
+	/// 功能：滚动窗口统计
+	[[nodiscard]] Summary summary() const;
+	/// 功能：滚动窗口内CPU帧耗时的直方图（每桶1ms）
+	[[nodiscard]] std::array<int, kHistogramBuckets> histogram() const;
+
+	/// 功能：最近邻秩百分位（values会被部分排序）
+	/// 参数：q — 0..1
+	/// 返回：values为空时为0
+	static double percentile(std::vector<double>& values, double q);
+
+private:
+	std::array<Sample, kHistory> m_ring{};
+	int m_head{ 0 };    // 下一次写入位置
+	int m_count{ 0 };
+	Sample m_current;
+	QElapsedTimer m_clock;
+	qint64 m_lastBeginNs{ -1 };
+	bool m_inFrame{ false };
+	bool m_enabled{ false };
+
+	static inline FrameProfiler* s_active{ nullptr };
+};
@@ -0,0 +1,98 @@
+#include "FrameScheduler.h"
+
+#include "FrameClock.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <qglobal.h>
+#include <utility>
+
+namespace {
+	constexpr double kIntervalSmoothing = 0.1;  // 刷新间隔的指数平滑系数
+	constexpr double kMaxIntervalRatio = 1.5;   // 超过估计值此倍数的交换间隔视为掉帧，不计入
+}
+
+FrameScheduler::FrameScheduler(std::function<void()> requestUpdate)
+	: m_requestUpdate(std::move(requestUpdate))
+{
+}
+
+void FrameScheduler::setRefreshRate(const double hz)
+{
+	m_refreshHz = hz > 0.0 ? hz : kDefaultRefreshHz;
+	m_intervalMs = std::max(kMinIntervalMs, 1000.0 / m_refreshHz);
+}
+
+void FrameScheduler::requestFrame()
+{
+	// 帧内的请求推迟到交换完成后发出，与下一次垂直同步对齐
+	if (m_inFrame) {
+		if (m_requestedInFrame) ++m_stats.coalesced;
+		m_requestedInFrame = true;
+		return;
+	}
+	if (m_pending) {
+		++m_stats.coalesced;
+		return;
+	}
+	m_pending = true;
+	++m_stats.requests;
+	if (m_requestUpdate) m_requestUpdate();
+}
+
+void FrameScheduler::requestAnimation()
+{
+	m_animating = true;
+	requestFrame();
+}
+
+qint64 FrameScheduler::beginFrame(const double nowMs)
+{
+	m_pending = false;
+	m_inFrame = true;
+	m_requestedInFrame = false;
+	m_chained = m_chainNext;
+	m_chainNext = false;
+	++m_stats.frames;
+	if (m_chained) ++m_stats.animationFrames;
+
+	// 本帧在上次交换之后的第一个刷新时刻呈现；空闲后的首帧直接取当前时刻
+	double frameMs = nowMs;
+	if (m_lastSwapMs >= 0.0 && nowMs - m_lastSwapMs < kMaxPredictMs) {
+		const double periods = std::max(1.0, std::ceil((nowMs - m_lastSwapMs) / m_intervalMs));
+		frameMs = m_lastSwapMs + periods * m_intervalMs;
+	}
+	FrameClock::beginFrame(std::llround(frameMs));
+	return FrameClock::nowMs();
+}
+
+void FrameScheduler::endFrame(const bool animating)
+{
+	m_animating = animating;
+	FrameClock::endFrame();
+}
+
+void FrameScheduler::frameSwapped(const double nowMs)
+{
+	// 只有首尾相接的动画帧的交换间隔反映刷新周期
+	if (m_chained && m_lastSwapMs >= 0.0) {
+		const double delta = nowMs - m_lastSwapMs;
+		if (delta >= kMinIntervalMs && delta <= m_intervalMs * kMaxIntervalRatio) {
+			m_intervalMs = std::max(kMinIntervalMs, m_intervalMs + (delta - m_intervalMs) * kIntervalSmoothing);
+		}
+	}
+	m_lastSwapMs = nowMs;
+	m_inFrame = false;
+	m_chained = false;
+
+	const bool requested = m_requestedInFrame;
+	m_requestedInFrame = false;
+	if (m_animating) {
+		m_chainNext = true;
+		requestFrame();
+	}
+	else if (requested) {
+		requestFrame();
+	}
+}
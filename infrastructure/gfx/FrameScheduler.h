@@ -0,0 +1,78 @@
+/*
+ * 文件名：FrameScheduler.h
+ * 职责：与显示刷新同步的出帧调度：合并一帧内的重绘请求，动画期间在每次帧交换完成后请求下一帧，并给出本帧的预计呈现时间。
+ * 依赖：FrameClock、Qt6 Core。
+ * 线程：仅在UI线程使用。
+ * 备注：本身不依赖窗口，通过构造时注入的回调发出重绘请求（窗口中为QPaintDeviceWindow::update，即requestUpdate）。
+ */
+
+#pragma once
+#include <functional>
+#include <qglobal.h>
+
+/// 出帧调度器
+///
+/// 帧循环：
+/// 1. requestFrame/requestAnimation：无挂起请求时发出一次重绘请求，其余请求合并；帧内发生的请求推迟到帧交换完成后
+/// 2. beginFrame（paintGL开始）：清除挂起请求，按上次交换时刻与刷新间隔推算本帧的呈现时间，写入FrameClock
+/// 3. endFrame：记录本帧tick后是否仍有动画
+/// 4. frameSwapped（交换完成）：记录呈现时刻并测量刷新间隔；仍有动画或帧内有请求时请求下一帧
+///
+/// 交换按垂直同步节流，因此动画期间的出帧节奏跟随实际刷新率；没有动画与请求时不产生任何唤醒。
+/// 刷新间隔先取屏幕标称值，再以连续动画帧的交换间隔平滑修正（掉帧造成的整数倍间隔不计入）。
+class FrameScheduler {
+public:
+	/// 统计（自构造起累计）
+	struct Stats {
+		qint64 requests{ 0 };   // 发出的重绘请求
+		qint64 coalesced{ 0 };  // 被合并的请求（已有挂起请求或帧内请求）
+		qint64 frames{ 0 };     // 绘制的帧
+		qint64 animationFrames{ 0 };  // 由动画驱动的帧（上一帧交换完成后自动请求）
+	};
+
+	static constexpr double kDefaultRefreshHz = 60.0;
+	static constexpr double kMinIntervalMs = 1000.0 / 360.0;  // 刷新间隔估计的下限（无垂直同步时避免趋零）
+	static constexpr double kMaxPredictMs = 250.0;            // 距上次交换超过此时长视为空闲后的首帧，不做相位推算
+
+	/// 参数：requestUpdate — 发出一次重绘请求（窗口中为update()）
+	explicit FrameScheduler(std::function<void()> requestUpdate);
+
+	/// 功能：设置屏幕标称刷新率（Hz；非正值取kDefaultRefreshHz），刷新间隔估计随之重置
+	void setRefreshRate(double hz);
+	[[nodiscard]] double refreshRate() const noexcept { return m_refreshHz; }
+	/// 功能：当前刷新间隔估计（毫秒）
+	[[nodiscard]] double frameIntervalMs() const noexcept { return m_intervalMs; }
+
+	/// 功能：请求绘制一帧（同一帧内的多次请求合并为一次）
+	void requestFrame();
+	/// 功能：请求持续出帧，直到某帧的tick报告动画结束
+	void requestAnimation();
+
+	/// 功能：开始一帧（paintGL开始时调用）
+	/// 参数：nowMs — 当前时刻（FrameClock::preciseMs）
+	/// 返回：本帧的动画时间（预计呈现时刻，毫秒），同时写入FrameClock
+	qint64 beginFrame(double nowMs);
+	/// 功能：结束一帧的动画求值
+	/// 参数：animating — 本帧tick后是否仍有动画
+	void endFrame(bool animating);
+	/// 功能：帧交换完成（frameSwapped时调用）
+	/// 参数：nowMs — 当前时刻（FrameClock::preciseMs）
+	void frameSwapped(double nowMs);
+
+	[[nodiscard]] bool pending() const noexcept { return m_pending; }
+	[[nodiscard]] bool animating() const noexcept { return m_animating; }
+	[[nodiscard]] const Stats& stats() const noexcept { return m_stats; }
+
+private:
+	std::function<void()> m_requestUpdate;
+	double m_refreshHz{ kDefaultRefreshHz };
+	double m_intervalMs{ 1000.0 / kDefaultRefreshHz };
+	double m_lastSwapMs{ -1.0 };     // 上次交换完成时刻（无则为-1）
+	bool   m_pending{ false };       // 已发出请求、尚未开始绘制
+	bool   m_inFrame{ false };       // beginFrame与frameSwapped之间
+	bool   m_requestedInFrame{ false };  // 帧内收到的请求（交换完成后发出）
+	bool   m_animating{ false };
+	bool   m_chained{ false };       // 本帧由上一帧交换完成时的动画请求触发（交换间隔可用于测量刷新间隔）
+	bool   m_chainNext{ false };     // 下一帧由本次交换完成时的动画请求触发
+	Stats  m_stats;
+};
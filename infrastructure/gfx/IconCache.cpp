@@ -1,10 +1,50 @@
 #include "IconCache.h"
 #include "IconLoader.h"
 
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <qfontmetrics.h>
+#include <qmutex.h>
 #include <QtGui/qopengl.h>
 #include <qopenglfunctions.h>
+#include <qthreadpool.h>
+#include <utility>
+#include <vector>
 
-int IconCache::createTextureFromImage(const QImage& imgRGBA, QOpenGLFunctions* gl)
+#ifndef GL_R8
+#define GL_R8 0x8229
+#endif
+
+namespace {
+	constexpr int    kMinPageSizePx = 64;             // setPageSizePx的下限
+	constexpr int    kPaddingPx = 1;                  // 子图四周透明边距，防止线性过滤串色
+	constexpr double kRepackFragmentation = 0.4;      // 共享页碎片率超过此值时重排
+
+	constexpr int    kSdfSpreadPx = 4;                // 距离场外扩边距（尺寸档像素）
+
+	constexpr quint64 kProtectedFrames = 2;           // 最近使用于本帧或上一帧的句柄不淘汰（渲染线程可能仍在绘制上一帧）
+
+	bool isLarge(const QSize& sizePx, const int pageSizePx) {
+		return sizePx.width() > pageSizePx / 2 || sizePx.height() > pageSizePx / 2;
+	}
+
+	// 距离场尺寸档：同一档内的所有目标尺寸共用一份距离场
+	int sdfBandPx(const int sizePx) {
+		if (sizePx <= 32) return 32;
+		if (sizePx <= 64) return 64;
+		return 128;
+	}
+}
+
+IconCache::~IconCache()
+{
+	// 排队未开始的任务直接丢弃；正在执行的任务写入m_landed，须等它们结束
+	m_rasterPool.clear();
+	m_rasterPool.waitForDone();
+}
+
+int IconCache::createTexture(const QSize& sizePx, const bool singleChannel, QOpenGLFunctions* gl)
 {
 	GLuint tex = 0;
 	gl->glGenTextures(1, &tex);
@@ -14,60 +54,764 @@ int IconCache::createTextureFromImage(const QImage& imgRGBA, QOpenGLFunctions* g
 	gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
+	// 以全透明初始化，保证padding与未分配区域不会被采样出杂色（清零缓冲逐行紧密排列）
+	const int bpp = singleChannel ? 1 : 4;
+	const std::vector<uchar> zeros(static_cast<std::size_t>(sizePx.width()) * sizePx.height() * bpp, 0);
+	gl->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	gl->glTexImage2D(GL_TEXTURE_2D, 0, singleChannel ? GL_R8 : GL_RGBA8, sizePx.width(), sizePx.height(),
+		0, singleChannel ? GL_RED : GL_RGBA, GL_UNSIGNED_BYTE, zeros.data());
 	gl->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-	gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, imgRGBA.width(), imgRGBA.height(),
-		0, GL_RGBA, GL_UNSIGNED_BYTE, imgRGBA.constBits());
+	gl->glBindTexture(GL_TEXTURE_2D, 0);
 	return static_cast<int>(tex);
 }
 
+int IconCache::createPage(const QSize& sizePx, const bool dedicated, const Content content, QOpenGLFunctions* gl)
+{
+	Page page{
+		.live = true,
+		.dedicated = dedicated,
+		.content = content,
+		.packer = AtlasPacker(sizePx, dedicated ? 0 : kPaddingPx)
+	};
+
+	// 复用空闲槽位，保持已有缓存项的页下标不变
+	int index = -1;
+	for (std::size_t i = 0; i < m_pages.size(); ++i) {
+		if (!m_pages[i].live) {
+			index = static_cast<int>(i);
+			break;
+		}
+	}
+	if (index < 0) {
+		m_pages.emplace_back();
+		index = static_cast<int>(m_pages.size()) - 1;
+	}
+	// 纹理ID由GL操作写入（延迟模式下槽位里可能还留着待销毁的旧纹理，同样按序处理）
+	page.texture = m_pages[static_cast<std::size_t>(index)].texture;
+	m_pages[static_cast<std::size_t>(index)] = std::move(page);
+	runGl(GlOp{ .kind = GlOp::Kind::CreatePage, .page = index, .sizePx = sizePx, .singleChannel = content != Content::Color }, gl);
+	return index;
+}
+
+void IconCache::destroyPage(const int pageIndex, QOpenGLFunctions* gl)
+{
+	Page& page = m_pages[static_cast<std::size_t>(pageIndex)];
+	if (page.live) runGl(GlOp{ .kind = GlOp::Kind::DestroyPage, .page = pageIndex }, gl);
+	page.live = false;
+	page.dedicated = false;
+	page.content = Content::Color;
+	page.packer = AtlasPacker();
+}
+
+bool IconCache::placeEntry(Entry& entry, const QSize& sizePx, QOpenGLFunctions* gl, const bool allowRepack)
+{
+	if (sizePx.isEmpty()) return false;
+
+	// 大图独占一页，不参与共享页的分配与重排
+	if (isLarge(sizePx, m_pageSizePx)) {
+		const int p = createPage(sizePx, true, entry.content, gl);
+		entry.page = p;
+		entry.rectPx = m_pages[static_cast<std::size_t>(p)].packer.allocate(sizePx).value_or(QRect());
+		return entry.rectPx.isValid();
+	}
+
+	for (std::size_t i = 0; i < m_pages.size(); ++i) {
+		Page& page = m_pages[i];
+		if (!page.live || page.dedicated || page.content != entry.content) continue;
+		if (const auto r = page.packer.allocate(sizePx)) {
+			entry.page = static_cast<int>(i);
+			entry.rectPx = *r;
+			return true;
+		}
+	}
+
+	// 现有页放不下：碎片过多时先重排回收空洞，否则新开一页
+	if (allowRepack && shouldRepack()) {
+		repack(gl);
+		return placeEntry(entry, sizePx, gl, false);
+	}
+	const int p = createPage(QSize(m_pageSizePx, m_pageSizePx), false, entry.content, gl);
+	entry.page = p;
+	entry.rectPx = m_pages[static_cast<std::size_t>(p)].packer.allocate(sizePx).value_or(QRect());
+	return entry.rectPx.isValid();
+}
+
+void IconCache::uploadEntry(const Entry& entry, const QImage& img, QOpenGLFunctions* gl)
+{
+	const Page& page = m_pages[static_cast<std::size_t>(entry.page)];
+	const int pad = page.packer.paddingPx();
+	const int bpp = bytesPerPixel(page.content);
+	const QImage::Format format = bpp == 1 ? QImage::Format_Alpha8 : QImage::Format_RGBA8888;
+	const QImage src = img.format() == format ? img
+		: (bpp == 1 ? IconLoader::toAlphaMask(img) : img.convertToFormat(QImage::Format_RGBA8888));
+	const int w = std::min(src.width(), entry.rectPx.width());
+	const int h = std::min(src.height(), entry.rectPx.height());
+
+	// padding一并写入透明像素：槽位可能曾被其他子图使用过
+	QImage padded(w + 2 * pad, h + 2 * pad, format);
+	padded.fill(Qt::transparent);
+	for (int y = 0; y < h; ++y) {
+		std::memcpy(padded.scanLine(y + pad) + static_cast<std::size_t>(pad) * bpp, src.constScanLine(y), static_cast<std::size_t>(w) * bpp);
+	}
+
+	runGl(GlOp{
+		.kind = GlOp::Kind::Upload,
+		.page = entry.page,
+		.dstPx = QPoint(entry.rectPx.x() - pad, entry.rectPx.y() - pad),
+		.image = std::move(padded)
+		}, gl);
+}
+
+void IconCache::runGl(GlOp op, QOpenGLFunctions* gl)
+{
+	if (m_deferGl) m_glOps.push_back(std::move(op));
+	else executeGl(op, gl);
+}
+
+void IconCache::executeGl(const GlOp& op, QOpenGLFunctions* gl)
+{
+	Page& page = m_pages[static_cast<std::size_t>(op.page)];
+	switch (op.kind) {
+	case GlOp::Kind::CreatePage:
+		page.texture = static_cast<unsigned int>(createTexture(op.sizePx, op.singleChannel, gl));
+		break;
+	case GlOp::Kind::Upload:
+		gl->glBindTexture(GL_TEXTURE_2D, page.texture);
+		// QImage的行字节数按4字节对齐，单通道图像同样适用
+		gl->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		gl->glTexSubImage2D(GL_TEXTURE_2D, 0, op.dstPx.x(), op.dstPx.y(), op.image.width(), op.image.height(),
+			op.image.format() == QImage::Format_Alpha8 ? GL_RED : GL_RGBA, GL_UNSIGNED_BYTE, op.image.constBits());
+		gl->glBindTexture(GL_TEXTURE_2D, 0);
+		break;
+	case GlOp::Kind::CopyRects: {
+		// 源页挂到临时帧缓冲上作为读缓冲，逐块复制到本页（同为RGBA8或同为R8）
+		GLint prevFbo = 0;
+		gl->glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFbo);
+		GLuint fbo = 0;
+		gl->glGenFramebuffers(1, &fbo);
+		gl->glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		gl->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+			m_pages[static_cast<std::size_t>(op.srcPage)].texture, 0);
+		gl->glBindTexture(GL_TEXTURE_2D, page.texture);
+		for (const PageCopy& c : op.copies) {
+			gl->glCopyTexSubImage2D(GL_TEXTURE_2D, 0, c.dstPx.x(), c.dstPx.y(), c.srcPx.x(), c.srcPx.y(), c.srcPx.width(), c.srcPx.height());
+		}
+		gl->glBindTexture(GL_TEXTURE_2D, 0);
+		gl->glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(prevFbo));
+		gl->glDeleteFramebuffers(1, &fbo);
+		break;
+	}
+	case GlOp::Kind::DestroyPage:
+		if (page.texture) {
+			GLuint id = page.texture;
+			gl->glDeleteTextures(1, &id);
+		}
+		page.texture = 0;
+		break;
+	}
+}
+
+void IconCache::setDeferredGl(const bool on)
+{
+	const QMutexLocker lock(&m_mutex);
+	m_deferGl = on;
+}
+
+bool IconCache::hasPendingGl() const
+{
+	const QMutexLocker lock(&m_mutex);
+	return !m_glOps.empty();
+}
+
+void IconCache::flushGl(QOpenGLFunctions* gl)
+{
+	for (const GlOp& op : m_glOps) executeGl(op, gl);
+	m_glOps.clear();
+}
+
+void IconCache::setAsyncRaster(const bool on)
+{
+	m_async = on;
+	if (!on) m_rasterPool.waitForDone();
+}
+
+void IconCache::setRasterReadyCallback(std::function<void()> cb)
+{
+	const QMutexLocker lock(&m_landedMutex);
+	m_onRasterReady = std::move(cb);
+}
+
+std::function<QImage()> IconCache::withRasterCache(const QByteArray& svgData, const QSize& keySizePx,
+	const RasterCache::Variant variant, std::function<QImage()> rasterize) const
+{
+	if (!m_rasterCache) return rasterize;
+	return [disk = m_rasterCache, svgData, keySizePx, variant, rasterize = std::move(rasterize)] {
+		// 哈希在栅格化函数内计算：异步模式下不占用UI线程
+		const QByteArray hash = RasterCache::contentHash(svgData);
+		if (QImage cached = disk->load(hash, keySizePx, variant); !cached.isNull()) return cached;
+		QImage img = rasterize();
+		disk->store(hash, keySizePx, variant, img);
+		return img;
+	};
+}
+
+void IconCache::startRaster(const int handle, std::function<QImage()> rasterize)
+{
+	m_rasterPool.start([this, handle, rasterize = std::move(rasterize)] {
+		QImage img = rasterize();
+		std::function<void()> notify;
+		{
+			const QMutexLocker lock(&m_landedMutex);
+			m_landed.push_back(RasterResult{ .handle = handle, .image = std::move(img) });
+			notify = m_onRasterReady;
+		}
+		if (notify) notify();
+	});
+}
+
+IconCache::UploadResult IconCache::uploadCompleted(QOpenGLFunctions* gl, const qint64 budgetBytes)
+{
+	{
+		const QMutexLocker lock(&m_landedMutex);
+		for (auto& r : m_landed) m_ready.push_back(std::move(r));
+		m_landed.clear();
+	}
+
+	UploadResult result;
+	const QMutexLocker lock(&m_mutex);
+	while (!m_ready.empty()) {
+		const RasterResult& r = m_ready.front();
+		// 等待期间被释放（句柄不复用，查不到即已失效）的结果直接丢弃，不计入预算
+		const auto it = m_entries.find(r.handle);
+		const bool live = it != m_entries.end() && it->page < 0 && !it->failed;
+		const qint64 bytes = live ? static_cast<qint64>(r.image.width()) * r.image.height() * bytesPerPixel(it->content) : 0;
+		if (result.uploaded > 0 && result.bytes + bytes > budgetBytes) break;
+
+		if (live) {
+			Entry& entry = *it;
+			if (placeEntry(entry, r.image.size(), gl, true)) {
+				uploadEntry(entry, r.image, gl);
+				m_bytes += entryBytes(entry);
+				++result.uploaded;
+				result.bytes += bytes;
+			}
+			else {
+				// 栅格化失败（空图像）：保留为不绘制的句柄，避免调用方每帧重新提交；不再计为等待中
+				entry.page = -1;
+				entry.rectPx = QRect();
+				entry.failed = true;
+			}
+		}
+		m_ready.pop_front();
+	}
+	result.remaining = static_cast<int>(m_ready.size());
+	return result;
+}
+
+int IconCache::ensureImage(const QString& key, std::function<QImage()> rasterize, QOpenGLFunctions* gl, const Content content,
+	const QSize& expectedSizePx)
+{
+	if (const int hit = lookup(key)) return hit;
+	return insertImage(key, std::move(rasterize), gl, content, expectedSizePx);
+}
+
+int IconCache::insertImage(const QString& key, std::function<QImage()> rasterize, QOpenGLFunctions* gl, const Content content,
+	const QSize& expectedSizePx)
+{
+	if (m_async) {
+		// 只登记句柄：页内位置在结果上传时分配，此前rectPx只记录预期尺寸
+		const QMutexLocker lock(&m_mutex);
+		const int handle = addHandle(key);
+		m_entries.insert(handle, Entry{ .key = key, .rectPx = QRect(QPoint(), expectedSizePx), .content = content });
+		startRaster(handle, std::move(rasterize));
+		return handle;
+	}
+	const QImage img = rasterize();
+	Entry entry{ .key = key, .content = content };
+	const QMutexLocker lock(&m_mutex);
+	if (!placeEntry(entry, img.size(), gl, true)) return 0;
+	uploadEntry(entry, img, gl);
+
+	const int handle = addHandle(key);
+	m_bytes += entryBytes(entry);
+	m_entries.insert(handle, std::move(entry));
+	return handle;
+}
+
 int IconCache::ensureSvgPx(const QString& key, const QByteArray& svgData, const QSize& pixelSize, QOpenGLFunctions* gl)
 {
-	if (const auto it = m_cache.find(key); it != m_cache.end()) {
-		return it->id;
+	// 先查键：命中路径每帧都走，不构造栅格化函数（其中拷贝SVG数据并可能包一层磁盘缓存）
+	if (const int hit = lookup(key)) return hit;
+	if (m_mode == RasterMode::Bitmap) {
+		return insertImage(key, withRasterCache(svgData, pixelSize, RasterCache::Variant::Mask, [svgData, pixelSize] {
+			return IconLoader::toAlphaMask(IconLoader::renderSvgToImage(svgData, pixelSize));
+		}), gl, Content::Mask, pixelSize);
+	}
+	if (pixelSize.isEmpty()) return 0;
+
+	// 按尺寸档生成一份距离场；调用方的（按尺寸区分的）键只映射为别名
+	const int longSide = std::max(pixelSize.width(), pixelSize.height());
+	const qreal scale = static_cast<qreal>(sdfBandPx(longSide)) / static_cast<qreal>(longSide);
+	const QSize refSize(std::max(1, qRound(pixelSize.width() * scale)), std::max(1, qRound(pixelSize.height() * scale)));
+	const QString fieldKey = QString("sdf:%1@%2x%3")
+		.arg(static_cast<qulonglong>(qHash(svgData)))
+		.arg(refSize.width())
+		.arg(refSize.height());
+	int target = lookup(fieldKey);
+	if (target == 0) {
+		target = insertImage(fieldKey, withRasterCache(svgData, refSize, RasterCache::Variant::Sdf, [svgData, refSize] {
+			return IconLoader::toAlphaMask(IconLoader::renderSvgSdf(svgData, refSize, kSdfSpreadPx));
+		}), gl, Content::Sdf);
 	}
-	const QImage img = IconLoader::renderSvgToImage(svgData, pixelSize);
-	const int id = createTextureFromImage(img, gl);
-	m_cache.insert(key, Tex{ .id = id, .sizePx = img.size() });
-	m_idToSize.insert(id, img.size());
-	return id;
+	if (target == 0) return 0;
+
+	const QMutexLocker lock(&m_mutex);
+	const int handle = addHandle(key);
+	m_aliases.insert(handle, Alias{ .target = target, .sizePx = pixelSize, .insetPx = QPoint(kSdfSpreadPx, kSdfSpreadPx), .srcScale = scale });
+	return handle;
 }
 
 int IconCache::ensureFontGlyphPx(const QString& key, const QFont& font, const QChar glyph, const QSize& pixelSize, const QColor& glyphColor, QOpenGLFunctions* gl)
 {
-	if (const auto it = m_cache.find(key); it != m_cache.end()) {
-		return it->id;
-	}
-	const QImage img = IconLoader::renderGlyphToImage(font, glyph, pixelSize, glyphColor);
-	const int id = createTextureFromImage(img, gl);
-	m_cache.insert(key, Tex{ .id = id, .sizePx = img.size() });
-	m_idToSize.insert(id, img.size());
-	return id;
+	if (const int hit = lookup(key)) return hit;
+	return insertImage(key, [font, glyph, pixelSize, glyphColor] {
+		return IconLoader::renderGlyphToImage(font, glyph, pixelSize, glyphColor);
+	}, gl, Content::Color, pixelSize);
 }
 
 int IconCache::ensureTextPx(const QString& key, const QFont& fontPx, const QString& text, const QColor& color, QOpenGLFunctions* gl)
 {
-	if (const auto it = m_cache.find(key); it != m_cache.end()) {
-		return it->id;
+	if (const int hit = lookup(key)) return hit;
+
+	const QFontMetrics fm(fontPx);
+	TextRun run{
+		.sizePx = QSize(std::max(1, fm.horizontalAdvance(text)), std::max(1, fm.height())),
+		.color = color
+	};
+
+	// 字形按（字体, 像素尺寸, 字形索引）缓存为白色蒙版，与颜色无关；
+	// 距离场模式下像素尺寸取尺寸档，字形四边形按字号/尺寸档缩放
+	const auto placements = IconLoader::layoutGlyphs(fontPx, text);
+	run.glyphs.reserve(placements.size());
+	for (const auto& g : placements) {
+		const bool sdf = (m_mode == RasterMode::Sdf);
+		QRawFont raw = g.rawFont;
+		if (sdf) raw.setPixelSize(sdfBandPx(qRound(g.rawFont.pixelSize())));
+
+		QRect bounds = IconLoader::glyphBoundsPx(raw, g.glyphIndex);
+		if (bounds.isEmpty()) continue;  // 空白字形
+		if (sdf) bounds.adjust(-kSdfSpreadPx, -kSdfSpreadPx, kSdfSpreadPx, kSdfSpreadPx);
+
+		const QString glyphKey = makeGlyphKey(raw, g.glyphIndex) + (sdf ? QStringLiteral("|sdf") : QString());
+		const bool isNew = !m_keyToHandle.contains(glyphKey);
+		const int glyphId = sdf
+			? ensureImage(glyphKey, [raw, index = g.glyphIndex] {
+				return IconLoader::toAlphaMask(IconLoader::renderGlyphSdf(raw, index, kSdfSpreadPx));
+			}, gl, Content::Sdf, bounds.size())
+			: ensureImage(glyphKey, [raw, index = g.glyphIndex] {
+				return IconLoader::toAlphaMask(IconLoader::renderGlyphMask(raw, index));
+			}, gl, Content::Mask, bounds.size());
+		if (glyphId == 0) continue;
+		if (isNew) ++m_glyphCount;
+
+		if (sdf) {
+			const qreal k = g.rawFont.pixelSize() / raw.pixelSize();
+			const QRectF r(g.penPx.x() + bounds.x() * k, g.penPx.y() + bounds.y() * k, bounds.width() * k, bounds.height() * k);
+			run.glyphs.push_back(GlyphQuad{ .glyphId = glyphId, .rectPx = r, .srcScale = 1.0 / k });
+		}
+		else {
+			const QPoint pen(qRound(g.penPx.x()), qRound(g.penPx.y()));
+			run.glyphs.push_back(GlyphQuad{ .glyphId = glyphId, .rectPx = QRectF(bounds.translated(pen)) });
+		}
 	}
-	const QImage img = IconLoader::renderTextToImage(fontPx, text, color);
-	const int id = createTextureFromImage(img, gl);
-	m_cache.insert(key, Tex{ .id = id, .sizePx = img.size() });
-	m_idToSize.insert(id, img.size());
-	return id;
+
+	const QMutexLocker lock(&m_mutex);
+	const int handle = addHandle(key);
+	m_textRuns.insert(handle, std::move(run));
+	return handle;
+}
+
+QString IconCache::makeGlyphKey(const QRawFont& rawFont, const quint32 glyphIndex)
+{
+	return QString("glyph:%1|%2|%3@%4px#%5")
+		.arg(rawFont.familyName(), rawFont.styleName())
+		.arg(rawFont.weight())
+		.arg(rawFont.pixelSize())
+		.arg(glyphIndex);
 }
 
 QSize IconCache::textureSizePx(const int texId) const
 {
-	const auto it = m_idToSize.find(texId);
-	return (it != m_idToSize.end()) ? *it : QSize();
+	if (const auto it = m_entries.find(texId); it != m_entries.end()) return it->rectPx.size();
+	if (const auto it = m_textRuns.find(texId); it != m_textRuns.end()) return it->sizePx;
+	if (const auto it = m_aliases.find(texId); it != m_aliases.end()) return it->sizePx;
+	return {};
+}
+
+const IconCache::TextRun* IconCache::textRun(const int texId) const
+{
+	const auto it = m_textRuns.find(texId);
+	return (it != m_textRuns.end()) ? &it.value() : nullptr;
+}
+
+QString IconCache::keyOf(const int texId) const
+{
+	if (const auto it = m_entries.find(texId); it != m_entries.end()) return it->key;
+	// 文本与别名句柄不在m_entries中，反查键表（线性查找，仅用于诊断）
+	for (auto it = m_keyToHandle.cbegin(); it != m_keyToHandle.cend(); ++it) {
+		if (it.value() == texId) return it.key();
+	}
+	return {};
+}
+
+IconCache::Region IconCache::resolve(const int texId) const
+{
+	if (const auto ait = m_aliases.find(texId); ait != m_aliases.end()) {
+		Region r = resolve(ait->target);
+		r.originPx += ait->insetPx;
+		r.srcScale = ait->srcScale;
+		return r;
+	}
+	const auto it = m_entries.find(texId);
+	if (it == m_entries.end() || it->page < 0) return {};
+	const Page& page = m_pages[static_cast<std::size_t>(it->page)];
+	return Region{ .textureId = static_cast<int>(page.texture), .originPx = it->rectPx.topLeft(), .pageSizePx = page.packer.pageSizePx(),
+		.sdf = page.content == Content::Sdf, .mask = page.content != Content::Color };
+}
+
+void IconCache::setRasterMode(const RasterMode mode, QOpenGLFunctions* gl)
+{
+	if (mode == m_mode) return;
+	releaseAll(gl);
+	m_mode = mode;
+}
+
+void IconCache::release(const QString& key, QOpenGLFunctions* gl)
+{
+	const QMutexLocker lock(&m_mutex);
+	const auto kit = m_keyToHandle.find(key);
+	if (kit == m_keyToHandle.end()) return;
+	eraseKey(kit, gl);
+	if (shouldRepack()) repack(gl);
+}
+
+void IconCache::eraseKey(const QHash<QString, int>::iterator kit, QOpenGLFunctions* gl)
+{
+	const int handle = *kit;
+	m_lastUse.remove(handle);
+	if (m_textRuns.remove(handle) > 0 || m_aliases.remove(handle) > 0) {
+		// 文本与别名只持有子图引用，被引用的子图可能由其他句柄共享，保留在图集中
+		m_keyToHandle.erase(kit);
+		return;
+	}
+	const auto eit = m_entries.find(handle);
+	const bool glyph = kit.key().startsWith(QLatin1String("glyph:"));
+	if (glyph) --m_glyphCount;
+	const int pageIndex = eit->page;
+	m_keyToHandle.erase(kit);
+	// 只有字形被文本引用、只有距离场被别名引用
+	if (glyph || eit->content == Content::Sdf) eraseReferencing(handle);
+	if (pageIndex < 0) {
+		// 尚未上传：之后到达的栅格化结果查不到句柄，会被丢弃
+		m_entries.erase(eit);
+		return;
+	}
+	m_bytes -= entryBytes(*eit);
+	Page& page = m_pages[static_cast<std::size_t>(pageIndex)];
+	page.packer.release(eit->rectPx);
+	m_entries.erase(eit);
+
+	// 空出的独占页立即回收；共享页至少保留一页，避免反复创建/销毁
+	const auto sharedPages = std::count_if(m_pages.begin(), m_pages.end(), [](const Page& p) { return p.live && !p.dedicated; });
+	if (page.packer.empty() && (page.dedicated || sharedPages > 1)) {
+		destroyPage(pageIndex, gl);
+	}
+}
+
+void IconCache::eraseReferencing(const int handle)
+{
+	// 指向已擦除子图的文本/别名若保留，之后的命中会返回一个永远不显示的句柄
+	for (auto it = m_keyToHandle.begin(); it != m_keyToHandle.end();) {
+		const int h = *it;
+		bool refers = false;
+		if (const auto rit = m_textRuns.constFind(h); rit != m_textRuns.cend()) {
+			refers = std::any_of(rit->glyphs.cbegin(), rit->glyphs.cend(), [handle](const GlyphQuad& g) { return g.glyphId == handle; });
+		}
+		else if (const auto ait = m_aliases.constFind(h); ait != m_aliases.cend()) {
+			refers = ait->target == handle;
+		}
+		if (!refers) {
+			++it;
+			continue;
+		}
+		m_textRuns.remove(h);
+		m_aliases.remove(h);
+		m_lastUse.remove(h);
+		it = m_keyToHandle.erase(it);
+	}
+}
+
+qint64 IconCache::entryBytes(const Entry& entry) noexcept
+{
+	return entry.page < 0 ? 0 : static_cast<qint64>(entry.rectPx.width()) * entry.rectPx.height() * bytesPerPixel(entry.content);
+}
+
+int IconCache::lookup(const QString& key)
+{
+	const auto it = m_keyToHandle.constFind(key);
+	if (it == m_keyToHandle.cend()) {
+		++m_stats.misses;
+		return 0;
+	}
+	++m_stats.hits;
+	// 与markUsed一致地连带记录字形与距离场：只被查找的文本/别名不会留下已被淘汰的子图
+	markUsed(*it);
+	return *it;
+}
+
+int IconCache::addHandle(const QString& key)
+{
+	const int handle = m_nextHandle++;
+	m_keyToHandle.insert(key, handle);
+	m_lastUse.insert(handle, m_frame);
+	return handle;
+}
+
+void IconCache::touch(const int handle)
+{
+	if (const auto it = m_lastUse.find(handle); it != m_lastUse.end()) *it = m_frame;
+}
+
+void IconCache::markUsed(const int texId)
+{
+	if (texId <= 0) return;
+	touch(texId);
+	if (const auto rit = m_textRuns.constFind(texId); rit != m_textRuns.cend()) {
+		for (const auto& g : rit->glyphs) touch(g.glyphId);
+	}
+	else if (const auto ait = m_aliases.constFind(texId); ait != m_aliases.cend()) {
+		touch(ait->target);
+	}
+}
+
+int IconCache::evictToBudget(QOpenGLFunctions* gl)
+{
+	if (m_budgetBytes <= 0 || m_bytes <= m_budgetBytes) return 0;
+
+	// 候选按最近使用帧升序；同一帧内文本与别名排在子图之前：
+	// 文本/别名被查找或标记使用时总会连带记录其子图，淘汰某个子图时引用它的文本与别名通常已先被淘汰；
+	// 其余情况（子图被单独释放等）由eraseKey一并移除引用它的文本与别名
+	struct Candidate {
+		quint64 lastUse;
+		bool    pixels;   // 持有图集像素（子图），否则为文本/别名
+		QString key;
+	};
+	std::vector<Candidate> candidates;
+	for (auto it = m_keyToHandle.cbegin(); it != m_keyToHandle.cend(); ++it) {
+		const quint64 used = m_lastUse.value(it.value(), 0);
+		if (used + kProtectedFrames > m_frame) continue;
+		candidates.push_back(Candidate{ .lastUse = used, .pixels = m_entries.contains(it.value()), .key = it.key() });
+	}
+	std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+		return a.lastUse != b.lastUse ? a.lastUse < b.lastUse : a.pixels < b.pixels;
+	});
+
+	const QMutexLocker lock(&m_mutex);
+	int evicted = 0;
+	for (const auto& c : candidates) {
+		if (m_bytes <= m_budgetBytes) break;
+		const auto kit = m_keyToHandle.find(c.key);
+		if (kit == m_keyToHandle.end()) continue;
+		eraseKey(kit, gl);
+		++evicted;
+	}
+	if (evicted > 0 && shouldRepack()) repack(gl);
+	m_stats.evictions += evicted;
+	return evicted;
+}
+
+IconCache::CacheStats IconCache::cacheStats() const noexcept
+{
+	CacheStats stats = m_stats;
+	stats.bytes = m_bytes;
+	stats.budgetBytes = m_budgetBytes;
+	return stats;
+}
+
+bool IconCache::shouldRepack() const
+{
+	qint64 used = 0;
+	qint64 consumed = 0;
+	for (const auto& page : m_pages) {
+		if (!page.live || page.dedicated) continue;
+		used += page.packer.usedArea();
+		consumed += page.packer.consumedArea();
+	}
+	// 浪费面积不足页面积的1/8时不值得重排
+	if (consumed - used < static_cast<qint64>(m_pageSizePx) * m_pageSizePx / 8) return false;
+	return 1.0 - static_cast<double>(used) / static_cast<double>(consumed) > kRepackFragmentation;
+}
+
+void IconCache::setPageSizePx(const int sizePx)
+{
+	const QMutexLocker lock(&m_mutex);
+	m_pageSizePx = std::max(kMinPageSizePx, sizePx);
+}
+
+int IconCache::pageSizePx() const noexcept
+{
+	return m_pageSizePx;
+}
+
+void IconCache::compact(QOpenGLFunctions* gl)
+{
+	const QMutexLocker lock(&m_mutex);
+	repack(gl);
+}
+
+void IconCache::repack(QOpenGLFunctions* gl)
+{
+	// 收集共享页上的缓存项，按高度降序重新分配：同高度子图聚在同一货架，垂直浪费最小
+	std::vector<int> handles;
+	handles.reserve(static_cast<std::size_t>(m_entries.size()));
+	for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+		// 等待中与已失败的子图不在任何页上
+		if (it->failed || it->page < 0) continue;
+		if (!m_pages[static_cast<std::size_t>(it->page)].dedicated) handles.push_back(it.key());
+	}
+	std::sort(handles.begin(), handles.end(), [this](const int a, const int b) {
+		const QRect& ra = m_entries.constFind(a)->rectPx;
+		const QRect& rb = m_entries.constFind(b)->rectPx;
+		return ra.height() != rb.height() ? ra.height() > rb.height() : ra.width() > rb.width();
+	});
+
+	// 旧页在复制完成前保持存活（createPage不会复用其槽位），新布局只放入本次新建的页
+	std::vector<int> oldPages;
+	for (std::size_t i = 0; i < m_pages.size(); ++i) {
+		if (m_pages[i].live && !m_pages[i].dedicated) oldPages.push_back(static_cast<int>(i));
+	}
+	std::vector<int> newPages;
+	std::vector<GlOp> copyOps;  // 每对（源页, 目标页）一个操作
+	for (const int handle : handles) {
+		Entry& entry = *m_entries.find(handle);
+		const QSize sizePx = entry.rectPx.size();
+		int target = -1;
+		std::optional<QRect> placed;
+		for (const int p : newPages) {
+			if (m_pages[static_cast<std::size_t>(p)].content != entry.content) continue;
+			if ((placed = m_pages[static_cast<std::size_t>(p)].packer.allocate(sizePx))) {
+				target = p;
+				break;
+			}
+		}
+		if (!placed) {
+			target = createPage(QSize(m_pageSizePx, m_pageSizePx), false, entry.content, gl);
+			placed = m_pages[static_cast<std::size_t>(target)].packer.allocate(sizePx);
+			// 连空页都放不下（页尺寸已调小）：不留下空页
+			if (placed) newPages.push_back(target);
+			else destroyPage(target, gl);
+		}
+		if (!placed) {
+			// 放不下：与空结果一样保留为不绘制的句柄，不再计入图集字节
+			m_bytes -= entryBytes(entry);
+			entry.page = -1;
+			entry.rectPx = QRect();
+			entry.failed = true;
+			continue;
+		}
+
+		const QPoint pad(kPaddingPx, kPaddingPx);
+		const PageCopy copy{ .srcPx = entry.rectPx.adjusted(-kPaddingPx, -kPaddingPx, kPaddingPx, kPaddingPx), .dstPx = placed->topLeft() - pad };
+		const auto op = std::find_if(copyOps.begin(), copyOps.end(), [&](const GlOp& o) { return o.srcPage == entry.page && o.page == target; });
+		if (op != copyOps.end()) op->copies.push_back(copy);
+		else copyOps.push_back(GlOp{ .kind = GlOp::Kind::CopyRects, .page = target, .srcPage = entry.page, .copies = { copy } });
+		entry.page = target;
+		entry.rectPx = *placed;
+	}
+
+	// 复制排在新页创建之后、旧页销毁之前（延迟模式下按序执行）
+	for (GlOp& op : copyOps) runGl(std::move(op), gl);
+	for (const int p : oldPages) destroyPage(p, gl);
+	++m_repackCount;
+}
+
+IconCache::AtlasStats IconCache::atlasStats() const
+{
+	AtlasStats stats;
+	qint64 used = 0;
+	qint64 consumed = 0;
+	qint64 sharedArea = 0;
+	for (const auto& page : m_pages) {
+		if (!page.live) continue;
+		const QSize sz = page.packer.pageSizePx();
+		++stats.pageCount;
+		stats.textureBytes += static_cast<qint64>(sz.width()) * sz.height() * bytesPerPixel(page.content);
+		if (page.content != Content::Color) ++stats.maskPageCount;
+		if (page.dedicated) continue;
+		used += page.packer.usedArea();
+		consumed += page.packer.consumedArea();
+		sharedArea += page.packer.pageArea();
+	}
+	stats.entryCount = static_cast<int>(m_entries.size());
+	stats.occupancy = sharedArea > 0 ? static_cast<double>(used) / static_cast<double>(sharedArea) : 0.0;
+	stats.fragmentation = consumed > 0 ? 1.0 - static_cast<double>(used) / static_cast<double>(consumed) : 0.0;
+	stats.repackCount = m_repackCount;
+	stats.glyphCount = m_glyphCount;
+	stats.textRunCount = static_cast<int>(m_textRuns.size());
+	stats.sdfEntryCount = static_cast<int>(std::count_if(m_entries.cbegin(), m_entries.cend(), [](const Entry& e) { return e.content == Content::Sdf; }));
+	stats.aliasCount = static_cast<int>(m_aliases.size());
+	stats.pendingCount = static_cast<int>(std::count_if(m_entries.cbegin(), m_entries.cend(), [](const Entry& e) { return e.page < 0 && !e.failed; }));
+	stats.failedCount = static_cast<int>(std::count_if(m_entries.cbegin(), m_entries.cend(), [](const Entry& e) { return e.failed; }));
+	return stats;
 }
 
 void IconCache::releaseAll(QOpenGLFunctions* gl)
 {
-	for (auto it = m_cache.begin(); it != m_cache.end(); ++it) {
-		GLuint id = static_cast<GLuint>(it->id);
-		if (id) gl->glDeleteTextures(1, &id);
+	const QMutexLocker lock(&m_mutex);
+	for (std::size_t i = 0; i < m_pages.size(); ++i) {
+		destroyPage(static_cast<int>(i), gl);
 	}
-	m_cache.clear();
-	m_idToSize.clear();
-}
\ No newline at end of file
+	// 排队的操作按页下标引用槽位：全部执行前保留空闲槽位
+	if (m_glOps.empty()) m_pages.clear();
+	m_entries.clear();
+	m_textRuns.clear();
+	m_aliases.clear();
+	m_keyToHandle.clear();
+	m_lastUse.clear();
+	m_glyphCount = 0;
+	m_bytes = 0;
+
+	// 未开始的栅格化任务不再需要；已完成或正在执行的结果因句柄失效会在上传时丢弃
+	m_rasterPool.clear();
+	m_ready.clear();
+}
+
+void IconSnapshot::capture(const IconResolver& source, const int texId)
+{
+	if (texId <= 0 || m_regions.contains(texId) || m_runs.contains(texId)) return;
+	if (const TextRun* run = source.textRun(texId)) {
+		for (const GlyphQuad& g : run->glyphs) {
+			if (!m_regions.contains(g.glyphId)) m_regions.insert(g.glyphId, source.resolve(g.glyphId));
+		}
+		m_runs.insert(texId, *run);
+		return;
+	}
+	m_regions.insert(texId, source.resolve(texId));
+}
+
+void IconSnapshot::clear()
+{
+	m_regions.clear();
+	m_runs.clear();
+}
+
+IconResolver::Region IconSnapshot::resolve(const int texId) const
+{
+	return m_regions.value(texId);
+}
+
+const IconResolver::TextRun* IconSnapshot::textRun(const int texId) const
+{
+	const auto it = m_runs.find(texId);
+	return (it != m_runs.end()) ? &it.value() : nullptr;
+}
@@ -1,41 +1,179 @@
 /*
- * 文件名：IconCache.h  
+ * 文件名：IconCache.h
  * 职责：图标与文本纹理缓存管理，负责SVG渲染、字体栅格化和OpenGL纹理生命周期。
- * 依赖：Qt6 OpenGL/Gui/Svg。
- * 线程：仅在拥有OpenGL上下文的线程中使用（通常为UI线程）。
- * 备注：所有纹理创建和销毁必须在同一OpenGL上下文中进行，支持白膜（tint）策略。
+ * 依赖：Qt6 OpenGL/Gui/Svg、RasterCache（可选的磁盘缓存）。
+ * 线程：ensureXxx/release等写操作仅在UI线程调用；延迟GL模式下渲染线程持有mutex()执行flushGl并拷贝IconSnapshot，解锁后绘制；
+ *       异步栅格化模式下栅格化函数在内部线程池中执行，结果经uploadCompleted回到UI线程。
+ * 备注：所有纹理创建和销毁必须在同一OpenGL上下文（或共享组）中进行，支持白膜（tint）策略。
  */
 
 #pragma once
+#include <algorithm>
+#include <deque>
+#include <functional>
 #include <qbytearray.h>
 #include <qcolor.h>
 #include <qhash.h>
+#include <qimage.h>
+#include <qmutex.h>
 #include <qopenglfunctions.h>
+#include <qpoint.h>
+#include <qrawfont.h>
+#include <qrect.h>
 #include <qsize.h>
 #include <qstring.h>
+#include <qthreadpool.h>
+#include <vector>
+
+#include "AtlasPacker.h"
+#include "RasterCache.h"
+
+/// 句柄解析接口：渲染器只通过它把子图句柄换算为图集页纹理，并展开文本句柄
+///
+/// 实现：
+/// - IconCache：直接读取缓存的当前状态（与写操作同一线程，或持有IconCache::mutex()）
+/// - IconSnapshot：渲染线程在持锁期间拷贝出本帧用到的句柄，解锁后绘制
+class IconResolver {
+public:
+	/// 子图在图集中的位置
+	struct Region {
+		int    textureId{ 0 };  // 图集页的OpenGL纹理ID（0表示句柄无效）
+		QPoint originPx;        // 子图左上角在页内的位置（像素）
+		QSize  pageSizePx;      // 页尺寸（像素），用于归一化纹理坐标
+		qreal  srcScale{ 1.0 }; // 句柄坐标 -> 页内像素的缩放（距离场别名句柄不为1）
+		bool   sdf{ false };    // 纹理内容为距离场
+		bool   mask{ false };   // 单通道（R8）纹理：红色通道为覆盖率或距离，颜色全部来自tint
+		bool   premultiplied{ false }; // 纹理颜色已预乘alpha（渲染器的离屏图层）
+	};
+
+	/// 文本中的单个字形四边形
+	struct GlyphQuad {
+		int    glyphId{ 0 };      // 字形子图句柄
+		QRectF rectPx;            // 字形在文本框内的位置（设备像素，左上原点）
+		qreal  srcScale{ 1.0 };   // 文本框像素 -> 字形子图像素的缩放（距离场模式下为尺寸档/字号）
+	};
+
+	/// 排版后的文本：文本框尺寸 + 字形四边形序列
+	struct TextRun {
+		QSize  sizePx;      // 文本框尺寸（与整串栅格化的纹理尺寸一致）
+		QColor color;       // 文本颜色（字形为白色蒙版，绘制时与tint相乘）
+		std::vector<GlyphQuad> glyphs;
+	};
+
+	virtual ~IconResolver() = default;
+
+	/// 功能：将子图句柄解析为图集页纹理与页内位置
+	/// 参数：texId — 子图句柄
+	/// 返回：句柄无效时textureId为0
+	[[nodiscard]] virtual Region resolve(int texId) const = 0;
+
+	/// 功能：查询文本句柄对应的字形序列
+	/// 返回：非文本句柄时返回空指针
+	[[nodiscard]] virtual const TextRun* textRun(int texId) const = 0;
+};
 
 /// 图标与文本纹理缓存：管理OpenGL纹理资源的创建、缓存和释放
-/// 
+///
 /// 功能：
-/// - SVG图标渲染为OpenGL纹理（支持指定像素尺寸）  
+/// - SVG图标渲染为OpenGL纹理（支持指定像素尺寸）
 /// - 字体字符栅格化（单字符精确控制）
 /// - 文本字符串渲染（多字符组合，支持颜色）
 /// - 纹理生命周期管理（创建、查询、释放）
-/// 
+///
 /// 白膜策略：
 /// - SVG图标通常为单色白色模板，运行时通过着色器着色
 /// - 文本渲染直接生成带颜色的纹理，无需额外着色
-class IconCache {
+/// - 白膜（SVG图标、字形）与距离场只有覆盖率/距离有意义，放入单通道（R8）图集页，显存与上传带宽为RGBA8的1/4；
+///   Region::mask告知渲染器按红色通道读取，带颜色的位图（ensureFontGlyphPx）仍为RGBA8页
+///
+/// 图集：
+/// - 所有子图打包进少量图集页（货架分配），共享同一GL纹理，渲染器可合并为一次绘制
+/// - ensureXxx返回的是稳定的子图句柄而非GL纹理名；调用方按子图自身坐标填写ImageCmd::srcRectPx，
+///   渲染器通过resolve()换算为图集页纹理与页内偏移
+/// - 超过页尺寸一半的大图单独占用一页
+/// - 释放导致碎片率过高时整体重排：子图按新布局放入新页，像素在GPU上从旧页复制（不重新栅格化），句柄保持不变
+///
+/// 字形图集文本：
+/// - ensureTextPx不再整串栅格化：字形按（字体, 像素尺寸, 字形索引）各栅格化一次为白色蒙版放入图集，
+///   文本只记录字形四边形序列（TextRun），颜色在绘制时作为tint施加
+/// - 返回的文本句柄与普通子图句柄用法相同（textureSizePx为文本框尺寸），渲染器按textRun()展开
+///
+/// 距离场（SDF）模式：
+/// - 字形与白膜SVG图标按尺寸档（32/64/128px）栅格化为有符号距离场，同一档内的所有尺寸与任意tint共用一份纹理
+/// - 调用方的缓存键不变：按尺寸区分的键只生成无纹理的别名句柄，指向共享的距离场子图
+/// - 带颜色的单字符（ensureFontGlyphPx）仍为位图
+///
+/// 延迟GL模式（渲染线程）：
+/// - 图集布局、句柄分配与栅格化照常在调用线程完成，纹理创建/上传/销毁记为待执行操作，gl参数可为空
+/// - 拥有上下文的渲染线程在绘制前持有mutex()调用flushGl按序执行，并把本帧用到的句柄拷贝进IconSnapshot；
+///   解锁后按快照绘制，UI线程的缓存未命中不必等待绘制结束
+/// - 写操作（缓存未命中、释放、重排）在修改内部状态时持有同一互斥量；命中路径只读，不加锁
+///
+/// 异步栅格化（首次打开大量新标签/图标的页面、DPR变化时避免UI线程卡顿）：
+/// - 未命中时只分配句柄并登记待栅格化项，栅格化函数交给内部线程池执行；排版（字形布局、文本框尺寸）仍在调用线程完成
+/// - 完成前句柄解析为textureId 0，渲染器跳过不画；textureSizePx返回请求尺寸，调用方的布局不受影响
+/// - 完成的图像由uploadCompleted在UI线程按字节预算放入图集并上传（延迟GL模式下照常排队），
+///   每有图像完成即在工作线程中调用setRasterReadyCallback设置的回调，供窗口请求重绘
+///
+/// 字节预算与LRU淘汰（长时间运行时文本、颜色变体、DPR组合不再无限累积）：
+/// - 每帧beginFrame推进帧号；ensureXxx命中与markUsed（窗口对本帧实际绘制的句柄调用）记录最近使用帧，文本与别名连带记录其子图
+/// - 子图像素字节超过预算时，evictToBudget按最近使用帧从旧到新淘汰；本帧与上一帧用到的句柄受保护
+///   （渲染线程可能仍在绘制上一帧）
+/// - 被淘汰的键再次ensure时重新生成（句柄不同）；缓存命令的调用方须据evictToBudget的返回值重新录制
+///
+/// 磁盘缓存（冷启动时跳过SVG解析与栅格化）：
+/// - 设置setRasterCache后，SVG图标的白色蒙版与距离场按（SVG内容哈希, 像素尺寸, 变体）先查磁盘，未命中时栅格化并写入
+/// - 查找与写入都在栅格化函数内执行（异步模式下在工作线程）
+class IconCache : public IconResolver {
 public:
+	/// 栅格化模式
+	enum class RasterMode {
+		Bitmap,  // 按目标像素尺寸栅格化为位图蒙版
+		Sdf      // 按尺寸档栅格化为距离场，着色器按阈值重建边缘
+	};
+
+	/// 图集统计
+	struct AtlasStats {
+		int    pageCount{ 0 };        // 图集页数（含独占页）
+		int    entryCount{ 0 };       // 缓存的子图数
+		qint64 textureBytes{ 0 };     // 图集页显存占用（RGBA8页每像素4字节，R8页1字节）
+		double occupancy{ 0.0 };      // 共享页占用率（存活面积/页面积）
+		double fragmentation{ 0.0 };  // 共享页碎片率（1 - 存活面积/已消耗面积）
+		int    repackCount{ 0 };      // 累计重排次数
+		int    glyphCount{ 0 };       // 字形子图数
+		int    textRunCount{ 0 };     // 缓存的文本排版数
+		int    sdfEntryCount{ 0 };    // 距离场子图数
+		int    aliasCount{ 0 };       // 距离场别名句柄数（不占纹理）
+		int    pendingCount{ 0 };     // 等待异步栅格化结果的子图数
+		int    failedCount{ 0 };      // 异步栅格化结果为空、不绘制的子图数
+		int    maskPageCount{ 0 };    // 单通道（R8）页数（含独占页）
+	};
+
+	/// 缓存统计（命中/未命中/淘汰为自创建起的累计值，可在运行时轮询）
+	struct CacheStats {
+		qint64 hits{ 0 };         // 按缓存键查找命中次数（文本内部的字形、距离场共享子图查找也计入）
+		qint64 misses{ 0 };       // 查找未命中（随后生成）次数
+		qint64 evictions{ 0 };    // 因超出预算淘汰的缓存键数
+		qint64 bytes{ 0 };        // 存活子图的像素字节（按所在页的格式，不含图集页中的空闲区域）
+		qint64 budgetBytes{ 0 };  // 字节预算（0为不限）
+	};
+
+	/// 异步栅格化结果的一次上传
+	struct UploadResult {
+		int    uploaded{ 0 };    // 放入图集并上传的子图数
+		qint64 bytes{ 0 };       // 上传的像素字节数
+		int    remaining{ 0 };   // 已完成栅格化、超出预算留待下次上传的子图数
+	};
+
 	IconCache() = default;
-	~IconCache() = default;
+	~IconCache();
 
 	/// 功能：确保SVG图标纹理存在
 	/// 参数：key — 缓存键（由调用方生成，需包含尺寸等区分要素）
 	/// 参数：svgData — SVG文件的字节数据
 	/// 参数：pixelSize — 目标渲染尺寸（设备像素）
 	/// 参数：gl — OpenGL函数表
-	/// 返回：OpenGL纹理ID
+	/// 返回：子图句柄（传给ImageCmd::textureId）
 	/// 说明：相同key的重复调用会直接返回已缓存的纹理
 	int ensureSvgPx(const QString& key, const QByteArray& svgData, const QSize& pixelSize, QOpenGLFunctions* gl);
 
@@ -46,40 +184,291 @@ public:
 	/// 参数：pixelSize — 渲染尺寸（设备像素）
 	/// 参数：glyphColor — 字符颜色
 	/// 参数：gl — OpenGL函数表
-	/// 返回：OpenGL纹理ID
+	/// 返回：子图句柄
 	int ensureFontGlyphPx(const QString& key, const QFont& font, QChar glyph, const QSize& pixelSize, const QColor& glyphColor, QOpenGLFunctions* gl);
 
-	/// 功能：渲染文本字符串为纹理  
+	/// 功能：排版文本字符串为字形序列
 	/// 参数：key — 缓存键（必须包含文本内容、颜色、字体大小等区分要素）
 	/// 参数：fontPx — 字体对象（需已设置像素大小）
 	/// 参数：text — 要渲染的文本字符串
 	/// 参数：color — 文本颜色
 	/// 参数：gl — OpenGL函数表
-	/// 返回：OpenGL纹理ID
-	/// 说明：纹理尺寸由字体像素大小和文本长度自动计算
+	/// 返回：文本句柄（可直接用作ImageCmd::textureId）
+	/// 说明：文本框尺寸由字体像素大小和文本长度自动计算；只有首次出现的字形才需要栅格化与上传
 	int ensureTextPx(const QString& key, const QFont& fontPx, const QString& text, const QColor& color, QOpenGLFunctions* gl);
 
-	/// 功能：查询纹理的像素尺寸
-	/// 参数：texId — OpenGL纹理ID
-	/// 返回：纹理的像素尺寸
+	/// 功能：查询子图的像素尺寸
+	/// 参数：texId — 子图句柄
+	/// 返回：子图自身的像素尺寸（与图集页尺寸无关）
 	[[nodiscard]] QSize textureSizePx(int texId) const;
 
+	/// 功能：将子图句柄解析为图集页纹理与页内位置
+	/// 参数：texId — 子图句柄
+	/// 返回：句柄无效时textureId为0
+	[[nodiscard]] Region resolve(int texId) const override;
+
+	/// 功能：查询文本句柄对应的字形序列
+	/// 返回：非文本句柄时返回空指针
+	[[nodiscard]] const TextRun* textRun(int texId) const override;
+
+	/// 功能：查询句柄对应的缓存键（诊断与帧捕获用）
+	/// 返回：句柄无效时返回空字符串
+	[[nodiscard]] QString keyOf(int texId) const;
+
+	/// 功能：释放单个缓存项
+	/// 参数：key — 缓存键
+	/// 参数：gl — OpenGL函数表
+	/// 说明：释放后若共享页碎片率过高会触发重排
+	void release(const QString& key, QOpenGLFunctions* gl);
+
+	/// 功能：立即重排所有共享图集页
+	/// 参数：gl — OpenGL函数表
+	void compact(QOpenGLFunctions* gl);
+
+	/// 功能：设置共享图集页尺寸（如按GL_MAX_TEXTURE_SIZE或显存预算调小）
+	/// 参数：sizePx — 页边长（像素，不小于64；默认1024）
+	/// 说明：只影响之后新建的页；已有子图在下一次重排时搬入新尺寸的页，放不下的标记为失败（不再绘制）
+	void setPageSizePx(int sizePx);
+	[[nodiscard]] int pageSizePx() const noexcept;
+
+	/// 功能：获取图集占用与碎片统计
+	[[nodiscard]] AtlasStats atlasStats() const;
+
+	/// 功能：切换栅格化模式
+	/// 参数：mode — 目标模式
+	/// 参数：gl — OpenGL函数表
+	/// 说明：模式变化时释放全部缓存，之后的ensureXxx按新模式重新生成
+	void setRasterMode(RasterMode mode, QOpenGLFunctions* gl);
+	[[nodiscard]] RasterMode rasterMode() const noexcept { return m_mode; }
+
 	/// 功能：释放所有缓存的纹理
 	/// 参数：gl — OpenGL函数表
 	/// 说明：在窗口或OpenGL上下文销毁时调用
 	void releaseAll(QOpenGLFunctions* gl);
 
+	/// 功能：切换延迟GL模式（开启后GL操作排队，由flushGl执行）
+	/// 说明：关闭前应先flushGl，否则排队的操作会在下一次flushGl时才执行
+	void setDeferredGl(bool on);
+	[[nodiscard]] bool deferredGl() const noexcept { return m_deferGl; }
+	/// 功能：是否有待执行的GL操作
+	[[nodiscard]] bool hasPendingGl() const;
+	/// 功能：按序执行排队的GL操作
+	/// 参数：gl — 拥有（或共享）图集纹理的上下文的函数表
+	/// 说明：延迟模式下由渲染线程在持有mutex()时调用
+	void flushGl(QOpenGLFunctions* gl);
+	/// 功能：缓存写操作与渲染线程读取之间的互斥量
+	[[nodiscard]] QMutex& mutex() const noexcept { return m_mutex; }
+
+	/// 功能：设置子图像素字节预算
+	/// 参数：bytes — 预算（<=0为不限）
+	/// 说明：只在evictToBudget时生效，超出预算不会阻止新子图生成
+	void setByteBudget(qint64 bytes) noexcept { m_budgetBytes = std::max<qint64>(0, bytes); }
+	[[nodiscard]] qint64 byteBudget() const noexcept { return m_budgetBytes; }
+
+	/// 功能：开始新的一帧（推进最近使用帧号）
+	void beginFrame() noexcept { ++m_frame; }
+	/// 功能：记录句柄在本帧被绘制（文本连同其字形、距离场别名连同共享子图）
+	/// 说明：命令可能来自缓存而不经过ensureXxx，窗口须对本帧全部图像命令调用
+	void markUsed(int texId);
+	/// 功能：超出预算时按LRU淘汰最近两帧未用到的缓存键，直到不超出预算或无可淘汰项
+	/// 参数：gl — OpenGL函数表（延迟GL模式下可为空）
+	/// 返回：淘汰的缓存键数
+	int evictToBudget(QOpenGLFunctions* gl);
+	/// 功能：获取命中/未命中/淘汰计数与字节数
+	[[nodiscard]] CacheStats cacheStats() const noexcept;
+
+	/// 功能：设置栅格化磁盘缓存
+	/// 参数：cache — 磁盘缓存（须比本对象及其栅格化任务存活更久），为空时不使用
+	void setRasterCache(RasterCache* cache) noexcept { m_rasterCache = cache; }
+	[[nodiscard]] RasterCache* rasterCache() const noexcept { return m_rasterCache; }
+
+	/// 功能：切换异步栅格化模式
+	/// 说明：关闭时等待已提交的栅格化任务执行完毕，其结果仍需uploadCompleted上传
+	void setAsyncRaster(bool on);
+	[[nodiscard]] bool asyncRaster() const noexcept { return m_async; }
+	/// 功能：设置栅格化完成回调（在工作线程中调用；调用方自行排队到UI线程）
+	void setRasterReadyCallback(std::function<void()> cb);
+	/// 功能：把已完成栅格化的图像放入图集并上传
+	/// 参数：gl — OpenGL函数表（延迟GL模式下可为空）
+	/// 参数：budgetBytes — 本次上传的像素字节预算（至少上传一张，超出预算的大图不会一直等待）
+	/// 返回：本次上传统计；remaining > 0时调用方应在下一帧继续上传
+	UploadResult uploadCompleted(QOpenGLFunctions* gl, qint64 budgetBytes);
+
 private:
-	struct Tex {
-		int   id{ 0 };        // OpenGL纹理ID
-		QSize sizePx;         // 纹理尺寸（设备像素）
+	/// 子图内容类型（同类子图才共用图集页）
+	enum class Content {
+		Color,  // 带颜色的位图（RGBA8页）
+		Mask,   // 白色蒙版（R8页，红色通道为覆盖率）
+		Sdf     // 距离场（R8页，与蒙版页分开，便于按页切换着色器分支）
 	};
-	QHash<QString, Tex> m_cache;        // 缓存键 -> 纹理信息
-	QHash<int, QSize>   m_idToSize;     // 纹理ID -> 尺寸快速查询
 
-	/// 功能：从RGBA图像创建OpenGL纹理
-	/// 参数：imgRGBA — 32位RGBA格式的图像数据
-	/// 参数：gl — OpenGL函数表  
+	/// 子图缓存项
+	struct Entry {
+		QString key;
+		int     page{ -1 };     // 所在图集页下标（-1：异步栅格化尚未完成或已失败）
+		QRect   rectPx;         // 页内位置（不含padding）
+		Content content{ Content::Color };  // 只放入同类页
+		bool    failed{ false };  // 异步栅格化结果为空：不再等待、不参与重排
+	};
+
+	/// 距离场别名：调用方按尺寸区分的句柄 -> 共享距离场子图
+	struct Alias {
+		int    target{ 0 };     // 距离场子图句柄
+		QSize  sizePx;          // 调用方请求的尺寸（textureSizePx返回值）
+		QPoint insetPx;         // 图像内容在子图内的偏移（距离场外扩边距）
+		qreal  srcScale{ 1.0 }; // 请求像素 -> 子图像素
+	};
+
+	/// 图集页
+	struct Page {
+		unsigned int texture{ 0 };  // OpenGL纹理ID（延迟模式下创建操作执行前为0）
+		bool live{ false };         // 槽位是否在用（false表示空闲槽位）
+		bool dedicated{ false };    // 独占页：只容纳一张大图
+		Content content{ Content::Color };  // 页内子图的类型（决定纹理格式）
+		AtlasPacker packer;
+	};
+
+	/// 异步栅格化完成的图像
+	struct RasterResult {
+		int    handle{ 0 };
+		QImage image;
+	};
+
+	/// 页间复制的一块区域（重排时搬运子图）
+	struct PageCopy {
+		QRect  srcPx;    // 源页内区域（含padding）
+		QPoint dstPx;    // 目标页内位置（含padding）
+	};
+
+	/// 页纹理操作（立即执行，或在延迟模式下排队）
+	struct GlOp {
+		enum class Kind { CreatePage, Upload, CopyRects, DestroyPage };
+		Kind   kind{ Kind::Upload };
+		int    page{ -1 };
+		int    srcPage{ -1 };  // CopyRects：源页
+		QSize  sizePx;   // CreatePage：页尺寸
+		bool   singleChannel{ false };  // CreatePage：R8页
+		QPoint dstPx;    // Upload：写入位置（含padding）
+		QImage image;    // Upload：加了透明padding的像素（RGBA8888，R8页为Alpha8）
+		std::vector<PageCopy> copies;  // CopyRects：从源页复制到本页的区域
+	};
+
+	QHash<QString, int> m_keyToHandle;  // 缓存键 -> 子图句柄
+	QHash<int, Entry>   m_entries;      // 子图句柄 -> 缓存项
+	QHash<int, TextRun> m_textRuns;     // 文本句柄 -> 字形序列
+	QHash<int, Alias>   m_aliases;      // 别名句柄 -> 距离场子图
+	RasterMode m_mode{ RasterMode::Bitmap };
+	int m_glyphCount{ 0 };              // 字形子图数（统计用）
+	std::vector<Page>   m_pages;
+	int m_nextHandle{ 1 };              // 句柄单调递增，不复用，避免释放后旧句柄指向新子图
+	int m_repackCount{ 0 };
+	int m_pageSizePx{ 1024 };           // 新建共享页的边长（默认为GLES 2.0保证的最小纹理尺寸上限）
+	bool m_deferGl{ false };
+	std::vector<GlOp> m_glOps;          // 延迟模式下待执行的GL操作（按序）
+	mutable QMutex m_mutex;
+
+	QHash<int, quint64> m_lastUse;      // 句柄 -> 最近使用帧号
+	quint64 m_frame{ 0 };
+	qint64  m_budgetBytes{ 0 };
+	qint64  m_bytes{ 0 };               // 已放入图集的子图像素字节
+	CacheStats m_stats;                 // 只使用其中的累计计数
+	RasterCache* m_rasterCache{ nullptr };
+
+	bool m_async{ false };
+	std::deque<RasterResult>  m_ready;          // UI线程：已取回、待上传（按完成顺序）
+	std::vector<RasterResult> m_landed;         // 工作线程写入的完成结果（受m_landedMutex保护）
+	std::function<void()>     m_onRasterReady;  // 受m_landedMutex保护
+	QMutex      m_landedMutex;
+	QThreadPool m_rasterPool;                   // 析构时先停止，任务不会访问已销毁的成员
+
+	/// 功能：按缓存键查找，未命中时栅格化并放入图集（异步模式下登记待栅格化项）
+	/// 参数：expectedSizePx — 栅格化结果的尺寸（已知时填写，异步完成前由textureSizePx返回）
+	/// 参数：content — 子图类型；蒙版与距离场的栅格化函数应返回Format_Alpha8（其他格式上传时取alpha通道）
+	int ensureImage(const QString& key, std::function<QImage()> rasterize, QOpenGLFunctions* gl,
+		Content content = Content::Color, const QSize& expectedSizePx = QSize());
+	/// 功能：未命中时的生成路径（不查键）；调用方已lookup未命中时使用，命中路径不必构造栅格化函数
+	int insertImage(const QString& key, std::function<QImage()> rasterize, QOpenGLFunctions* gl,
+		Content content = Content::Color, const QSize& expectedSizePx = QSize());
+
+	/// 功能：按缓存键查找（计入命中/未命中，命中时记录使用帧）
+	/// 返回：未命中时返回0
+	int lookup(const QString& key);
+	/// 功能：登记新句柄（键表与使用帧）
+	int addHandle(const QString& key);
+	/// 功能：记录句柄的使用帧（未登记的句柄忽略）
+	void touch(int handle);
+	/// 功能：移除一个缓存键（不触发重排）；需持有m_mutex
+	/// 说明：移除字形或距离场子图时，引用它的文本与别名一并移除
+	void eraseKey(QHash<QString, int>::iterator kit, QOpenGLFunctions* gl);
+	/// 功能：移除引用该子图的文本与别名（键、使用帧一并移除）；需持有m_mutex
+	void eraseReferencing(int handle);
+	/// 功能：子图的像素字节
+	[[nodiscard]] static qint64 entryBytes(const Entry& entry) noexcept;
+	/// 功能：该类子图所在页的每像素字节数（RGBA8为4，R8为1）
+	[[nodiscard]] static int bytesPerPixel(Content content) noexcept { return content == Content::Color ? 4 : 1; }
+
+	/// 功能：为SVG栅格化函数加上磁盘缓存（未设置磁盘缓存时原样返回）
+	/// 参数：svgData — SVG内容（计算内容哈希）
+	/// 参数：keySizePx — 栅格化尺寸（磁盘缓存键）
+	[[nodiscard]] std::function<QImage()> withRasterCache(const QByteArray& svgData, const QSize& keySizePx,
+		RasterCache::Variant variant, std::function<QImage()> rasterize) const;
+
+	/// 功能：把栅格化函数提交到线程池，完成结果写入m_landed并通知回调
+	void startRaster(int handle, std::function<QImage()> rasterize);
+
+	/// 功能：生成字形子图的缓存键（字体族、样式、字重、像素尺寸、字形索引）
+	static QString makeGlyphKey(const QRawFont& rawFont, quint32 glyphIndex);
+
+	/// 功能：为子图分配页内位置（必要时新建页或先重排）
+	/// 返回：是否成功；成功时写入entry.page与entry.rectPx
+	bool placeEntry(Entry& entry, const QSize& sizePx, QOpenGLFunctions* gl, bool allowRepack);
+
+	/// 功能：将子图上传到页内位置（连同透明padding一并写入）
+	/// 说明：R8页上传图像的alpha通道，RGBA8页上传RGBA8像素
+	void uploadEntry(const Entry& entry, const QImage& img, QOpenGLFunctions* gl);
+
+	/// 功能：执行或排队一个GL操作
+	void runGl(GlOp op, QOpenGLFunctions* gl);
+	/// 功能：执行一个GL操作
+	void executeGl(const GlOp& op, QOpenGLFunctions* gl);
+
+	/// 功能：新建图集页（复用空闲槽位），返回页下标
+	int createPage(const QSize& sizePx, bool dedicated, Content content, QOpenGLFunctions* gl);
+	void destroyPage(int pageIndex, QOpenGLFunctions* gl);
+
+	/// 功能：重排所有共享页：按高度降序分配到新页，在GPU上从旧页复制像素后释放旧页
+	/// 说明：不重新栅格化，持有m_mutex期间只排队GL操作；搬运期间新旧页并存
+	void repack(QOpenGLFunctions* gl);
+	[[nodiscard]] bool shouldRepack() const;
+
+	/// 功能：创建清零的RGBA8或R8纹理
+	/// 参数：sizePx — 纹理尺寸
+	/// 参数：singleChannel — 是否为单通道（R8）
+	/// 参数：gl — OpenGL函数表
 	/// 返回：创建的OpenGL纹理ID
-	static int createTextureFromImage(const QImage& imgRGBA, QOpenGLFunctions* gl);
-};
\ No newline at end of file
+	static int createTexture(const QSize& sizePx, bool singleChannel, QOpenGLFunctions* gl);
+};
+
+/// 句柄解析快照：渲染线程持有IconCache::mutex()期间拷贝本帧用到的句柄，解锁后供渲染器读取
+///
+/// 说明：
+/// - 只拷贝解析结果（页纹理、页内位置）与文本的字形序列，不持有IconCache的任何引用
+/// - 未拷贝的句柄解析为textureId 0，渲染器跳过不画
+/// - 快照之后UI线程释放或重排的子图，其旧页纹理要到下一次flushGl才销毁，本帧照常绘制
+class IconSnapshot final : public IconResolver {
+public:
+	/// 功能：拷贝一个句柄的解析结果（文本句柄连同其全部字形）
+	/// 参数：source — 解析来源（调用方须持有其互斥量）
+	/// 参数：texId — 子图或文本句柄（非正值忽略）
+	void capture(const IconResolver& source, int texId);
+	/// 功能：清空快照（每帧重新拷贝）
+	void clear();
+	[[nodiscard]] bool empty() const noexcept { return m_regions.isEmpty() && m_runs.isEmpty(); }
+
+	[[nodiscard]] Region resolve(int texId) const override;
+	[[nodiscard]] const TextRun* textRun(int texId) const override;
+
+private:
+	QHash<int, Region>  m_regions;  // 子图句柄（含文本的字形）-> 解析结果
+	QHash<int, TextRun> m_runs;     // 文本句柄 -> 字形序列
+};
@@ -1,11 +1,13 @@
 #include "IconLoader.h"
 
 #include <algorithm>
+#include <cmath>
 #include <qbytearray.h>
 #include <qcolor.h>
 #include <qfont.h>
 #include <qfontmetrics.h>
 #include <qglobal.h>
+#include <qglyphrun.h>
 #include <qimage.h>
 #include <qnamespace.h>
 #include <qpainter.h>
@@ -14,6 +16,70 @@
 #include <qsize.h>
 #include <qstring.h>
 #include <qsvgrenderer.h>
+#include <qtextlayout.h>
+#include <vector>
+
+namespace {
+	// 与 renderTextToImage 相同的渲染提示，保证两种文本路径字形一致
+	QFont textRenderFont(const QFont& fontPx)
+	{
+		QFont f = fontPx;
+		f.setHintingPreference(QFont::PreferVerticalHinting);
+		f.setStyleStrategy(QFont::PreferAntialias);
+		return f;
+	}
+
+	// 距离变换中"无特征"的占位值（取有限大数，避免inf参与运算产生NaN）
+	constexpr float kFar = 1e20f;
+
+	// 一维平方欧氏距离变换（Felzenszwalb & Huttenlocher），f/d长度为n，v/z为工作区（z长度n+1）
+	void edt1d(const float* f, float* d, const int n, int* v, float* z)
+	{
+		const auto parabolaCut = [f](const int q, const int p) {
+			return ((f[q] + static_cast<float>(q * q)) - (f[p] + static_cast<float>(p * p))) / static_cast<float>(2 * q - 2 * p);
+		};
+		int k = 0;
+		v[0] = 0;
+		z[0] = -kFar;
+		z[1] = kFar;
+		for (int q = 1; q < n; ++q) {
+			float s = parabolaCut(q, v[k]);
+			while (s <= z[k]) {
+				--k;
+				s = parabolaCut(q, v[k]);
+			}
+			++k;
+			v[k] = q;
+			z[k] = s;
+			z[k + 1] = kFar;
+		}
+		k = 0;
+		for (int q = 0; q < n; ++q) {
+			while (z[k + 1] < static_cast<float>(q)) ++k;
+			const float dq = static_cast<float>(q - v[k]);
+			d[q] = dq * dq + f[v[k]];
+		}
+	}
+
+	// 二维平方距离变换：grid中特征像素为0，其余为kFar；原地写回平方距离
+	void edt2d(std::vector<float>& grid, const int w, const int h)
+	{
+		const int n = std::max(w, h);
+		std::vector<float> f(static_cast<std::size_t>(n)), d(static_cast<std::size_t>(n)), z(static_cast<std::size_t>(n) + 1);
+		std::vector<int> v(static_cast<std::size_t>(n));
+		for (int x = 0; x < w; ++x) {
+			for (int y = 0; y < h; ++y) f[y] = grid[static_cast<std::size_t>(y) * w + x];
+			edt1d(f.data(), d.data(), h, v.data(), z.data());
+			for (int y = 0; y < h; ++y) grid[static_cast<std::size_t>(y) * w + x] = d[y];
+		}
+		for (int y = 0; y < h; ++y) {
+			float* row = grid.data() + static_cast<std::size_t>(y) * w;
+			std::copy(row, row + w, f.begin());
+			edt1d(f.data(), d.data(), w, v.data(), z.data());
+			std::copy(d.begin(), d.begin() + w, row);
+		}
+	}
+}
 
 QImage IconLoader::toWhiteMask(const QImage& srcRgba8888)
 {
@@ -33,6 +99,20 @@ QImage IconLoader::toWhiteMask(const QImage& srcRgba8888)
 	return out;
 }
 
+QImage IconLoader::toAlphaMask(const QImage& src)
+{
+	if (src.isNull() || src.format() == QImage::Format_Alpha8) return src;
+	// 统一转换为RGBA8888后逐像素取第4字节（alpha）
+	const QImage rgba = src.convertToFormat(QImage::Format_RGBA8888);
+	QImage out(rgba.size(), QImage::Format_Alpha8);
+	for (int y = 0; y < rgba.height(); ++y) {
+		const uchar* in = rgba.constScanLine(y);
+		uchar* line = out.scanLine(y);
+		for (int x = 0; x < rgba.width(); ++x) line[x] = in[x * 4 + 3];
+	}
+	return out;
+}
+
 QImage IconLoader::renderSvgToImage(const QByteArray& svg, const QSize& pixelSize)
 {
 	QImage img(pixelSize, QImage::Format_ARGB32_Premultiplied);
@@ -77,14 +157,151 @@ QImage IconLoader::renderTextToImage(const QFont& fontPx, const QString& text, c
 	p.setRenderHint(QPainter::Antialiasing, true);
 	p.setRenderHint(QPainter::SmoothPixmapTransform, true);
 
-	QFont renderFont = f;
-	renderFont.setHintingPreference(QFont::PreferVerticalHinting);
-	renderFont.setStyleStrategy(QFont::PreferAntialias);
-	p.setFont(renderFont);
+	p.setFont(textRenderFont(f));
 
 	p.setPen(color);
 	p.drawText(0, fm.ascent(), text);
 
 	p.end();
 	return img.convertToFormat(QImage::Format_RGBA8888);
-}
\ No newline at end of file
+}
+
+std::vector<IconLoader::GlyphPlacement> IconLoader::layoutGlyphs(const QFont& fontPx, const QString& text)
+{
+	std::vector<GlyphPlacement> out;
+	if (text.isEmpty()) return out;
+
+	QTextLayout layout(text, textRenderFont(fontPx));
+	layout.beginLayout();
+	QTextLine line = layout.createLine();
+	if (!line.isValid()) {
+		layout.endLayout();
+		return out;
+	}
+	line.setLineWidth(1e6);  // 单行：不在此处换行
+	line.setPosition(QPointF(0, 0));
+	layout.endLayout();
+
+	// 基线与 renderTextToImage 的 drawText(0, fm.ascent()) 对齐
+	const QFontMetrics fm(fontPx);
+	const qreal baselineShift = fm.ascent() - line.ascent();
+
+	out.reserve(static_cast<std::size_t>(text.size()));
+	const QList<QGlyphRun> runs = line.glyphRuns();
+	for (const QGlyphRun& run : runs) {
+		const QRawFont raw = run.rawFont();
+		const QList<quint32> indexes = run.glyphIndexes();
+		const QList<QPointF> positions = run.positions();
+		for (qsizetype i = 0; i < indexes.size() && i < positions.size(); ++i) {
+			out.push_back(GlyphPlacement{ .rawFont = raw, .glyphIndex = indexes[i], .penPx = positions[i] + QPointF(0, baselineShift) });
+		}
+	}
+	return out;
+}
+
+QRect IconLoader::glyphBoundsPx(const QRawFont& rawFont, const quint32 glyphIndex)
+{
+	const QRectF b = rawFont.boundingRect(glyphIndex);
+	if (b.width() <= 0.0 || b.height() <= 0.0) return {};
+	return b.toAlignedRect().adjusted(-1, -1, 1, 1);
+}
+
+QImage IconLoader::renderGlyphMask(const QRawFont& rawFont, const quint32 glyphIndex)
+{
+	const QRect bounds = glyphBoundsPx(rawFont, glyphIndex);
+	if (bounds.isEmpty()) return {};
+
+	QImage img(bounds.size(), QImage::Format_ARGB32_Premultiplied);
+	img.fill(Qt::transparent);
+
+	QGlyphRun run;
+	run.setRawFont(rawFont);
+	run.setGlyphIndexes({ glyphIndex });
+	run.setPositions({ QPointF(0, 0) });
+
+	QPainter p(&img);
+	p.setRenderHint(QPainter::TextAntialiasing, true);
+	p.setRenderHint(QPainter::Antialiasing, true);
+	p.setPen(Qt::white);
+	p.drawGlyphRun(QPointF(-bounds.left(), -bounds.top()), run);
+	p.end();
+	return img.convertToFormat(QImage::Format_RGBA8888);
+}
+
+QImage IconLoader::distanceFieldFromMask(const QImage& maskRgba8888, const int spreadPx)
+{
+	const QImage mask = maskRgba8888.convertToFormat(QImage::Format_RGBA8888);
+	const int w = mask.width();
+	const int h = mask.height();
+	if (w <= 0 || h <= 0) return {};
+
+	// 分别计算到"内部"与到"外部"的距离，相减得到有符号距离（外正内负）
+	const std::size_t count = static_cast<std::size_t>(w) * h;
+	std::vector<float> toInside(count), toOutside(count);
+	for (int y = 0; y < h; ++y) {
+		const uchar* line = mask.constScanLine(y);
+		for (int x = 0; x < w; ++x) {
+			const bool inside = line[x * 4 + 3] >= 128;
+			const std::size_t i = static_cast<std::size_t>(y) * w + x;
+			toInside[i] = inside ? 0.0f : kFar;
+			toOutside[i] = inside ? kFar : 0.0f;
+		}
+	}
+	edt2d(toInside, w, h);
+	edt2d(toOutside, w, h);
+
+	const float spread = static_cast<float>(std::max(1, spreadPx));
+	QImage out(w, h, QImage::Format_RGBA8888);
+	for (int y = 0; y < h; ++y) {
+		uchar* line = out.scanLine(y);
+		for (int x = 0; x < w; ++x) {
+			const std::size_t i = static_cast<std::size_t>(y) * w + x;
+			// 像素中心到轮廓的距离约为到最近异侧像素距离减半个像素
+			const float outside = toInside[i] > 0.0f ? std::sqrt(toInside[i]) - 0.5f : 0.0f;
+			const float inside = toOutside[i] > 0.0f ? std::sqrt(toOutside[i]) - 0.5f : 0.0f;
+			const float signedDist = outside - inside;
+			const float a = std::clamp(0.5f - signedDist / (2.0f * spread), 0.0f, 1.0f);
+			line[x * 4 + 0] = 255;
+			line[x * 4 + 1] = 255;
+			line[x * 4 + 2] = 255;
+			line[x * 4 + 3] = static_cast<uchar>(std::lround(a * 255.0f));
+		}
+	}
+	return out;
+}
+
+QImage IconLoader::renderGlyphSdf(const QRawFont& rawFont, const quint32 glyphIndex, const int spreadPx)
+{
+	const QRect bounds = glyphBoundsPx(rawFont, glyphIndex);
+	if (bounds.isEmpty()) return {};
+	const QRect padded = bounds.adjusted(-spreadPx, -spreadPx, spreadPx, spreadPx);
+
+	QImage img(padded.size(), QImage::Format_ARGB32_Premultiplied);
+	img.fill(Qt::transparent);
+
+	QGlyphRun run;
+	run.setRawFont(rawFont);
+	run.setGlyphIndexes({ glyphIndex });
+	run.setPositions({ QPointF(0, 0) });
+
+	QPainter p(&img);
+	p.setRenderHint(QPainter::Antialiasing, true);
+	p.setPen(Qt::white);
+	p.drawGlyphRun(QPointF(-padded.left(), -padded.top()), run);
+	p.end();
+	return distanceFieldFromMask(img, spreadPx);
+}
+
+QImage IconLoader::renderSvgSdf(const QByteArray& svg, const QSize& pixelSize, const int spreadPx)
+{
+	const QSize padded = pixelSize + QSize(2 * spreadPx, 2 * spreadPx);
+	QImage img(padded, QImage::Format_ARGB32_Premultiplied);
+	img.fill(Qt::transparent);
+	{
+		QPainter p(&img);
+		p.setRenderHint(QPainter::Antialiasing, true);
+		QSvgRenderer renderer(svg);
+		renderer.render(&p, QRectF(QPointF(spreadPx, spreadPx), QSizeF(pixelSize)));
+	}
+	return distanceFieldFromMask(img, spreadPx);
+}
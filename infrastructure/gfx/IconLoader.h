@@ -3,14 +3,25 @@
 #include <qcolor.h>
 #include <qfont.h>
 #include <qimage.h>
+#include <qpoint.h>
+#include <qrawfont.h>
+#include <qrect.h>
 #include <qsize.h>
 #include <qstring.h>
+#include <vector>
 
 class QSvgRenderer;
 
 // 无状态 Helper：仅负责将 SVG/字体/文本栅格化为 QImage
 class IconLoader {
 public:
+	// 排版后的单个字形：字体 + 字形索引 + 笔位（基线原点，相对文本框左上角，设备像素）
+	struct GlyphPlacement {
+		QRawFont rawFont;
+		quint32  glyphIndex{ 0 };
+		QPointF  penPx;
+	};
+
 	// 渲染 SVG 为 QImage（移除了未使用的颜色参数）
 	static QImage renderSvgToImage(const QByteArray& svg, const QSize& pixelSize);
 
@@ -20,6 +31,27 @@ public:
 	// 渲染文本为 QImage
 	static QImage renderTextToImage(const QFont& fontPx, const QString& text, const QColor& color);
 
+	// 单行排版文本为字形序列（文本框尺寸与 renderTextToImage 一致：宽=advance，高=fm.height，基线=ascent）
+	static std::vector<GlyphPlacement> layoutGlyphs(const QFont& fontPx, const QString& text);
+
+	// 字形包围盒（相对笔位，整像素对齐并外扩1px留给抗锯齿）；空白字形返回空矩形
+	static QRect glyphBoundsPx(const QRawFont& rawFont, quint32 glyphIndex);
+
+	// 渲染单个字形为白色蒙版，图像尺寸等于 glyphBoundsPx
+	static QImage renderGlyphMask(const QRawFont& rawFont, quint32 glyphIndex);
+
+	// 渲染单个字形为有符号距离场，图像尺寸为 glyphBoundsPx 四周各外扩 spreadPx
+	static QImage renderGlyphSdf(const QRawFont& rawFont, quint32 glyphIndex, int spreadPx);
+
+	// 渲染 SVG 为有符号距离场，图像尺寸为 pixelSize 四周各外扩 spreadPx
+	static QImage renderSvgSdf(const QByteArray& svg, const QSize& pixelSize, int spreadPx);
+
+	// 由蒙版（alpha）生成有符号距离场：RGB 为白色，alpha 编码距离（0.5 为轮廓，向内增大，±spreadPx 处饱和）
+	static QImage distanceFieldFromMask(const QImage& maskRgba8888, int spreadPx);
+
 	// 将 QImage 转换为白色蒙版（用于 tint 着色）
 	static QImage toWhiteMask(const QImage& srcRgba8888);
+
+	// 提取 alpha 通道为单通道蒙版（Format_Alpha8，上传为 R8 纹理；白色蒙版与距离场只有 alpha 携带信息）
+	static QImage toAlphaMask(const QImage& src);
 };
\ No newline at end of file
@@ -0,0 +1,189 @@
+#include "RasterCache.h"
+
+#include <cstring>
+#include <memory>
+#include <qbytearray.h>
+#include <qcryptographichash.h>
+#include <qdebug.h>
+#include <qdir.h>
+#include <qelapsedtimer.h>
+#include <qfile.h>
+#include <qimage.h>
+#include <qiodevice.h>
+#include <qlogging.h>
+#include <qmutex.h>
+#include <qsavefile.h>
+#include <qstandardpaths.h>
+#include <qstring.h>
+#include <utility>
+
+namespace {
+	constexpr int kHashBytes = 20;  // SHA-1
+
+	/// 文件头（本机字节序；缓存只在本机使用，字节序不同的文件因魔数不符而失效）
+	struct FileHeader {
+		quint32 magic;
+		quint32 version;
+		quint32 variant;
+		quint32 keyWidth;
+		quint32 keyHeight;
+		quint32 width;
+		quint32 height;
+		quint32 bytesPerLine;
+		quint32 bytesPerPixel;  // 1：Alpha8，4：RGBA8888
+		char    hash[kHashBytes];
+		char    reserved[8];
+	};
+	static_assert(sizeof(FileHeader) == 64, "pixel data must start at a 16-byte aligned offset");
+
+	/// 映射文件并校验头部；成功时返回以映射内存构造的图像，图像释放时删除file（解除映射）
+	QImage mapImage(std::unique_ptr<QFile> file, const QByteArray& hash, const QSize& keySizePx, const RasterCache::Variant variant)
+	{
+		const qint64 size = file->size();
+		if (size < static_cast<qint64>(sizeof(FileHeader))) return {};
+		const uchar* data = file->map(0, size);
+		if (!data) return {};
+		// 映射在文件关闭后仍然有效，不必为每张待上传的图像占用一个文件句柄
+		file->close();
+
+		FileHeader h{};
+		std::memcpy(&h, data, sizeof(h));
+		const bool valid = h.magic == RasterCache::kFileMagic && h.version == RasterCache::kFormatVersion
+			&& h.variant == static_cast<quint32>(variant)
+			&& h.keyWidth == static_cast<quint32>(keySizePx.width()) && h.keyHeight == static_cast<quint32>(keySizePx.height())
+			&& (h.bytesPerPixel == 1 || h.bytesPerPixel == 4)
+			&& h.width > 0 && h.height > 0 && h.bytesPerLine == h.width * h.bytesPerPixel
+			&& std::memcmp(h.hash, hash.constData(), kHashBytes) == 0
+			&& size >= static_cast<qint64>(sizeof(FileHeader)) + static_cast<qint64>(h.bytesPerLine) * h.height;
+		if (!valid) return {};
+
+		QFile* owner = file.release();
+		return QImage(data + sizeof(FileHeader), static_cast<int>(h.width), static_cast<int>(h.height),
+			static_cast<qsizetype>(h.bytesPerLine), h.bytesPerPixel == 1 ? QImage::Format_Alpha8 : QImage::Format_RGBA8888,
+			[](void* info) { delete static_cast<QFile*>(info); }, owner);
+	}
+}
+
+RasterCache::RasterCache(QString dir)
+	: m_dir(std::move(dir))
+	, m_enabled(qEnvironmentVariable("FJ_RASTER_CACHE") != QStringLiteral("0"))
+{
+}
+
+RasterCache& RasterCache::instance()
+{
+	static RasterCache cache(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QStringLiteral("/rastercache"));
+	return cache;
+}
+
+QByteArray RasterCache::contentHash(const QByteArray& content)
+{
+	return QCryptographicHash::hash(content, QCryptographicHash::Sha1);
+}
+
+QString RasterCache::fileName(const QByteArray& hash, const QSize& keySizePx, const Variant variant)
+{
+	return QStringLiteral("%1-%2x%3-%4.fjr")
+		.arg(QString::fromLatin1(hash.toHex()))
+		.arg(keySizePx.width())
+		.arg(keySizePx.height())
+		.arg(static_cast<quint32>(variant));
+}
+
+void RasterCache::setDirectory(const QString& dir)
+{
+	const QMutexLocker lock(&m_mutex);
+	m_dir = dir;
+}
+
+QString RasterCache::directory() const
+{
+	const QMutexLocker lock(&m_mutex);
+	return m_dir;
+}
+
+void RasterCache::setEnabled(const bool on)
+{
+	const QMutexLocker lock(&m_mutex);
+	m_enabled = on;
+}
+
+bool RasterCache::enabled() const
+{
+	const QMutexLocker lock(&m_mutex);
+	return m_enabled;
+}
+
+RasterCache::Stats RasterCache::stats() const
+{
+	const QMutexLocker lock(&m_mutex);
+	return m_stats;
+}
+
+QImage RasterCache::load(const QByteArray& hash, const QSize& keySizePx, const Variant variant)
+{
+	if (hash.size() != kHashBytes || keySizePx.isEmpty()) return {};
+	QString path;
+	{
+		const QMutexLocker lock(&m_mutex);
+		if (!m_enabled) return {};
+		path = QDir(m_dir).filePath(fileName(hash, keySizePx, variant));
+	}
+
+	QElapsedTimer t;
+	t.start();
+	auto file = std::make_unique<QFile>(path);
+	if (!file->open(QIODevice::ReadOnly)) {
+		const QMutexLocker lock(&m_mutex);
+		++m_stats.misses;
+		return {};
+	}
+	QImage img = mapImage(std::move(file), hash, keySizePx, variant);
+	const double ms = static_cast<double>(t.nsecsElapsed()) / 1.0e6;
+
+	const QMutexLocker lock(&m_mutex);
+	(img.isNull() ? m_stats.rejected : m_stats.hits) += 1;
+	m_stats.loadMs += ms;
+	return img;
+}
+
+void RasterCache::store(const QByteArray& hash, const QSize& keySizePx, const Variant variant, const QImage& image)
+{
+	if (image.isNull() || hash.size() != kHashBytes || keySizePx.isEmpty()) return;
+	QString dirPath;
+	{
+		const QMutexLocker lock(&m_mutex);
+		if (!m_enabled) return;
+		dirPath = m_dir;
+	}
+	const QDir dir(dirPath);
+	if (!dir.mkpath(QStringLiteral("."))) return;
+
+	const bool alpha = image.format() == QImage::Format_Alpha8;
+	const QImage pixels = alpha || image.format() == QImage::Format_RGBA8888 ? image : image.convertToFormat(QImage::Format_RGBA8888);
+	FileHeader h{};
+	h.magic = kFileMagic;
+	h.version = kFormatVersion;
+	h.variant = static_cast<quint32>(variant);
+	h.keyWidth = static_cast<quint32>(keySizePx.width());
+	h.keyHeight = static_cast<quint32>(keySizePx.height());
+	h.width = static_cast<quint32>(pixels.width());
+	h.height = static_cast<quint32>(pixels.height());
+	h.bytesPerPixel = alpha ? 1 : 4;
+	h.bytesPerLine = h.width * h.bytesPerPixel;
+	std::memcpy(h.hash, hash.constData(), kHashBytes);
+
+	QSaveFile f(dir.filePath(fileName(hash, keySizePx, variant)));
+	if (!f.open(QIODevice::WriteOnly)) return;
+	f.write(reinterpret_cast<const char*>(&h), sizeof(h));
+	// QImage的行按4字节对齐，文件中逐行紧密排列
+	for (int y = 0; y < pixels.height(); ++y) {
+		f.write(reinterpret_cast<const char*>(pixels.constScanLine(y)), h.bytesPerLine);
+	}
+	if (!f.commit()) {
+		qWarning() << "RasterCache: cannot write" << f.fileName();
+		return;
+	}
+	const QMutexLocker lock(&m_mutex);
+	++m_stats.writes;
+}
@@ -0,0 +1,86 @@
+/*
+ * 文件名：RasterCache.h
+ * 职责：栅格化结果的磁盘缓存，保存SVG图标的白色蒙版与距离场，下次启动时映射文件直接上传，跳过SVG解析与栅格化。
+ * 依赖：Qt6 Core（QStandardPaths、QCryptographicHash、QFile内存映射）、Qt6 Gui（QImage）。
+ * 线程：load/store可在任意线程并发调用（IconCache异步栅格化的工作线程）；统计与设置加锁。
+ * 备注：缓存键包含资源内容哈希，资源变化时自动失效；设置FJ_RASTER_CACHE=0可关闭。
+ */
+
+#pragma once
+#include <qbytearray.h>
+#include <qimage.h>
+#include <qmutex.h>
+#include <qsize.h>
+#include <qstring.h>
+
+/// 栅格化磁盘缓存
+///
+/// 键：（资源内容哈希, 像素尺寸, 变体）。文件位于 <目录>/<内容哈希>-<宽>x<高>-<变体>.fjr，格式：
+/// - 64字节头：魔数、格式版本、变体、键尺寸、图像宽高与行字节数、每像素字节数、资源内容的SHA-1
+/// - 紧随其后为像素：单通道蒙版为Alpha8（1字节/像素），其余为RGBA8（4字节/像素），与上传到图集的格式一致
+///
+/// load映射文件后直接以映射内存构造QImage（Format_Alpha8或Format_RGBA8888，只读，不拷贝），图像释放时解除映射；
+/// 头部任一字段与请求不符（内容哈希不同、格式版本变化、文件截断）时视为失效，由调用方重新栅格化并覆盖。
+/// 栅格化算法变化（如距离场外扩边距）时提升kFormatVersion，使旧文件全部失效。
+class RasterCache {
+public:
+	/// 栅格化变体（同一资源同一尺寸的不同产物）
+	enum class Variant : quint32 {
+		Mask = 0,  // 白色蒙版（renderSvgToImage）
+		Sdf  = 1   // 有符号距离场（renderSvgSdf）
+	};
+
+	/// 累计统计（自创建起）
+	struct Stats {
+		int    hits{ 0 };         // 从文件载入次数
+		int    misses{ 0 };       // 无对应文件次数
+		int    rejected{ 0 };     // 文件存在但校验失败次数
+		int    writes{ 0 };       // 写入文件次数
+		double loadMs{ 0.0 };     // 载入（打开、映射、校验）总耗时
+	};
+
+	static constexpr quint32 kFileMagic = 0x52524A46;  // "FJRR"
+	static constexpr quint32 kFormatVersion = 2;
+
+	/// 参数：dir — 缓存目录（不存在时在首次写入时创建）
+	explicit RasterCache(QString dir);
+
+	RasterCache(const RasterCache&) = delete;
+	RasterCache& operator=(const RasterCache&) = delete;
+
+	/// 功能：进程内共享实例（目录为 AppDataLocation/rastercache）
+	static RasterCache& instance();
+
+	/// 功能：计算资源内容哈希（SHA-1，20字节）
+	[[nodiscard]] static QByteArray contentHash(const QByteArray& content);
+
+	/// 功能：载入缓存的栅格化结果
+	/// 参数：hash — contentHash()的结果
+	/// 参数：keySizePx — 请求的像素尺寸（键的一部分，与图像尺寸不必相同，如距离场带外扩边距）
+	/// 参数：variant — 栅格化变体
+	/// 返回：映射文件的图像（按写入时的格式）；未命中、校验失败或缓存停用时返回空图像
+	[[nodiscard]] QImage load(const QByteArray& hash, const QSize& keySizePx, Variant variant);
+
+	/// 功能：保存栅格化结果（先写临时文件再替换，读者不会看到半个文件）
+	/// 说明：Format_Alpha8按单通道保存，其他格式转换为RGBA8888；空图像不保存
+	void store(const QByteArray& hash, const QSize& keySizePx, Variant variant, const QImage& image);
+
+	/// 功能：设置缓存目录
+	void setDirectory(const QString& dir);
+	[[nodiscard]] QString directory() const;
+
+	/// 功能：启用/停用缓存（停用时load总是未命中，store不写入）
+	void setEnabled(bool on);
+	[[nodiscard]] bool enabled() const;
+
+	[[nodiscard]] Stats stats() const;
+
+	/// 功能：缓存文件名（不含目录）
+	[[nodiscard]] static QString fileName(const QByteArray& hash, const QSize& keySizePx, Variant variant);
+
+private:
+	mutable QMutex m_mutex;
+	QString m_dir;
+	bool m_enabled{ true };
+	Stats m_stats;
+};
@@ -3,17 +3,113 @@
  * 职责：渲染系统的核心数据结构定义，包含绘制命令和帧数据容器。
  * 依赖：Qt6 Core（QColor、QRect）、标准库容器。
  * 线程：数据结构线程安全，可在多线程间传递。
- * 备注：定义了逻辑像素坐标系统，支持剪裁区域，采用命令模式收集绘制指令。
+ * 备注：定义了逻辑像素坐标系统，支持剪裁区域，采用命令模式收集绘制指令；命令为紧凑的平凡可复制结构（float矩形、RGBA8颜色、剪裁表索引）。
  */
 
 #pragma once
+#include <cstdint>
+#include <memory>
+#include <qnamespace.h>
 #include <vector>
 
 #include <qcolor.h>
+#include <qpoint.h>
 #include <qrect.h>
 
 namespace Render {
 
+	/// 命令中的矩形（逻辑像素，单精度，16字节）
+	///
+	/// 说明：可与QRectF隐式互转，录制处照常传入QRectF/QRect；读取处的常用访问函数与QRectF同名，
+	/// 需要其余几何运算时转换为QRectF
+	class RectF {
+	public:
+		constexpr RectF() noexcept = default;
+		constexpr RectF(const float x, const float y, const float w, const float h) noexcept : m_x(x), m_y(y), m_w(w), m_h(h) {}
+		RectF(const QRectF& r) noexcept
+			: m_x(static_cast<float>(r.x())), m_y(static_cast<float>(r.y())),
+			  m_w(static_cast<float>(r.width())), m_h(static_cast<float>(r.height())) {}
+		RectF(const QRect& r) noexcept
+			: m_x(static_cast<float>(r.x())), m_y(static_cast<float>(r.y())),
+			  m_w(static_cast<float>(r.width())), m_h(static_cast<float>(r.height())) {}
+
+		operator QRectF() const noexcept { return { m_x, m_y, m_w, m_h }; }
+
+		[[nodiscard]] constexpr float x() const noexcept { return m_x; }
+		[[nodiscard]] constexpr float y() const noexcept { return m_y; }
+		[[nodiscard]] constexpr float width() const noexcept { return m_w; }
+		[[nodiscard]] constexpr float height() const noexcept { return m_h; }
+		[[nodiscard]] constexpr float left() const noexcept { return m_x; }
+		[[nodiscard]] constexpr float top() const noexcept { return m_y; }
+		[[nodiscard]] constexpr float right() const noexcept { return m_x + m_w; }
+		[[nodiscard]] constexpr float bottom() const noexcept { return m_y + m_h; }
+		/// 宽或高<=0
+		[[nodiscard]] constexpr bool isEmpty() const noexcept { return m_w <= 0.0f || m_h <= 0.0f; }
+
+		void translate(const QPointF& d) noexcept {
+			m_x += static_cast<float>(d.x());
+			m_y += static_cast<float>(d.y());
+		}
+		[[nodiscard]] QRectF adjusted(const qreal dx1, const qreal dy1, const qreal dx2, const qreal dy2) const noexcept {
+			return QRectF(*this).adjusted(dx1, dy1, dx2, dy2);
+		}
+		[[nodiscard]] QRectF normalized() const noexcept { return QRectF(*this).normalized(); }
+
+		friend constexpr bool operator==(const RectF&, const RectF&) noexcept = default;
+
+	private:
+		float m_x{ 0.0f };
+		float m_y{ 0.0f };
+		float m_w{ 0.0f };
+		float m_h{ 0.0f };
+	};
+
+	/// 命令中的颜色（非预乘RGBA8，4字节）
+	///
+	/// 说明：可与QColor隐式互转；着色器与实例属性本就按8位归一化读取，转换不损失可见精度
+	struct Rgba8 {
+		std::uint8_t r{ 0 };
+		std::uint8_t g{ 0 };
+		std::uint8_t b{ 0 };
+		std::uint8_t a{ 0 };
+
+		constexpr Rgba8() noexcept = default;
+		constexpr Rgba8(const int red, const int green, const int blue, const int alpha = 255) noexcept
+			: r(static_cast<std::uint8_t>(red)), g(static_cast<std::uint8_t>(green)),
+			  b(static_cast<std::uint8_t>(blue)), a(static_cast<std::uint8_t>(alpha)) {}
+		Rgba8(const QColor& c) noexcept : Rgba8(c.red(), c.green(), c.blue(), c.alpha()) {}
+		Rgba8(const Qt::GlobalColor c) noexcept : Rgba8(QColor(c)) {}
+
+		operator QColor() const noexcept { return QColor(r, g, b, a); }
+
+		[[nodiscard]] constexpr int red() const noexcept { return r; }
+		[[nodiscard]] constexpr int green() const noexcept { return g; }
+		[[nodiscard]] constexpr int blue() const noexcept { return b; }
+		[[nodiscard]] constexpr int alpha() const noexcept { return a; }
+		[[nodiscard]] constexpr float redF() const noexcept { return r / 255.0f; }
+		[[nodiscard]] constexpr float greenF() const noexcept { return g / 255.0f; }
+		[[nodiscard]] constexpr float blueF() const noexcept { return b / 255.0f; }
+		[[nodiscard]] constexpr float alphaF() const noexcept { return a / 255.0f; }
+
+		friend constexpr bool operator==(const Rgba8&, const Rgba8&) noexcept = default;
+	};
+
+	/// 剪裁区域（逻辑像素矩形 + 圆角），存放在FrameData::clips中，命令只记录索引
+	struct ClipRegion {
+		RectF rect;               // 宽高<=0表示不剪裁
+		float radiusPx{ 0.0f };   // 圆角半径（逻辑像素；0为直角剪裁）
+		bool  empty{ false };     // 剪裁交集为空：命令完全不可见（仅kEmptyClipRegion为true）
+
+		friend constexpr bool operator==(const ClipRegion&, const ClipRegion&) noexcept = default;
+	};
+
+	/// 剪裁表索引（从1起；kNoClip表示不剪裁，kEmptyClip表示剪裁掉全部内容）
+	using ClipId = std::uint32_t;
+	inline constexpr ClipId kNoClip = 0;
+	inline constexpr ClipId kEmptyClip = 0xFFFFFFFFu;
+	inline constexpr ClipRegion kNoClipRegion{};
+	inline constexpr ClipRegion kEmptyClipRegion{ {}, 0.0f, true };
+
 	/// 圆角矩形绘制命令
 	/// 
 	/// 坐标系说明：
@@ -21,12 +117,22 @@ namespace Render {
 	/// - 渲染时乘以DPR转换为设备像素
 	/// - 着色器接收设备像素坐标进行绘制
 	struct RoundedRectCmd {
-		QRectF rect;      // 目标矩形（逻辑像素坐标）
-		float  radiusPx;  // 圆角半径（逻辑像素）
-		QColor color;     // 填充颜色（包含alpha透明度）
+		RectF  rect;              // 目标矩形（逻辑像素坐标）
+		float  radiusPx{ 0.0f };  // 圆角半径（逻辑像素）
+		Rgba8  color;             // 填充颜色（包含alpha透明度）
+
+		// 剪裁区域（FrameData::addClip的返回值；kNoClip表示不启用剪裁）
+		ClipId clip{ kNoClip };
+
+		// 描边：沿rect内侧，宽度<=0表示不描边；此时color只填充描边以内的区域（内圆角为radiusPx - strokeWidthPx），
+		// 填充与描边在同一次SDF求值中合成，互不重叠
+		float  strokeWidthPx{ 0.0f };  // 描边宽度（逻辑像素）
+		Rgba8  strokeColor;            // 描边颜色（包含alpha透明度）
 
-		// 剪裁区域（逻辑像素坐标；宽高<=0表示不启用剪裁）
-		QRectF clipRect;
+		/// 是否有可见描边
+		[[nodiscard]] bool stroked() const noexcept { return strokeWidthPx > 0.0f && strokeColor.alpha() > 0; }
+		/// 是否有任何可见内容（填充或描边）
+		[[nodiscard]] bool visible() const noexcept { return color.alpha() > 0 || stroked(); }
 	};
 
 	/// 纹理图像绘制命令
@@ -36,36 +142,213 @@ namespace Render {
 	/// - 白底图标可通过tint着色为任意颜色（白膜策略）
 	/// - 支持透明度调制和颜色混合
 	struct ImageCmd {
-		QRectF dstRect;       // 目标矩形（逻辑像素坐标）
-		int    textureId{ 0 }; // OpenGL纹理句柄
-		QRectF srcRectPx;     // 源纹理区域（设备像素坐标）
-		QColor tint{ 255,255,255,255 }; // 着色调制（白色=不变，其他=着色）
+		RectF  dstRect;        // 目标矩形（逻辑像素坐标）
+		int    textureId{ 0 }; // IconCache子图句柄（渲染时解析为图集页纹理）
+		RectF  srcRectPx;      // 源纹理区域（子图自身的设备像素坐标）
+		Rgba8  tint{ 255,255,255,255 }; // 着色调制（白色=不变，其他=着色）
+
+		// 剪裁区域（FrameData::addClip的返回值；kNoClip表示不启用剪裁）
+		ClipId clip{ kNoClip };
+	};
+
+	/// 圆角矩形投影命令（高斯模糊）
+	///
+	/// 说明：
+	/// - rect为投影形状本身（已包含偏移与扩展），渲染时在其外侧约blurPx范围内衰减至0
+	/// - 着色器对圆角矩形与高斯核的卷积做解析求值，一条命令一次绘制，无需分层叠加
+	struct ShadowCmd {
+		RectF  rect;              // 投影形状（逻辑像素坐标）
+		float  radiusPx{ 0.0f };  // 形状圆角半径（逻辑像素）
+		float  blurPx{ 0.0f };    // 模糊范围（逻辑像素；高斯σ = blurPx / 3）
+		Rgba8  color;             // 投影颜色（alpha为形状内部的不透明度）
+
+		// 剪裁区域（FrameData::addClip的返回值；kNoClip表示不启用剪裁）
+		ClipId clip{ kNoClip };
+	};
+
+	struct FrameData;
 
-		// 剪裁区域（逻辑像素坐标；宽高<=0表示不启用剪裁）
-		QRectF clipRect;
+	/// 离屏图层定义：子树命令录制一次，由渲染器绘制到图层纹理并缓存
+	///
+	/// 说明：
+	/// - content为子树自身的命令（逻辑像素坐标），渲染器把bounds范围内的内容绘制到独立纹理（尺寸 = bounds × DPR）
+	/// - version、bounds或DPR变化时才重新绘制纹理，否则只做合成
+	/// - 合成是一条普通的ImageCmd（textureId = layerTextureId(id)，srcRectPx为bounds内的逻辑像素坐标），
+	///   剪裁、平移、着色（不透明度）的处理与其他图像命令一致
+	struct LayerDef {
+		int           id{ 0 };       // 图层标识（>0，进程内唯一）
+		std::uint64_t version{ 0 };  // 内容版本（内容重新录制时递增）
+		QRectF        bounds;        // 内容范围（逻辑像素坐标）
+		std::shared_ptr<const FrameData> content;  // 录制的子树命令（只读共享，不随帧复制）
+	};
+
+	/// 功能：图层的纹理句柄（负值，与IconCache的正值句柄不冲突）
+	constexpr int layerTextureId(const int layerId) noexcept { return -layerId; }
+	/// 功能：判断纹理句柄是否指向离屏图层
+	constexpr bool isLayerTexture(const int textureId) noexcept { return textureId < 0; }
+
+	/// 命令类型标签（命令流中的判别字段）
+	enum class CmdType : std::uint8_t {
+		RoundedRect,  // 索引指向 FrameData::roundedRects
+		Image,        // 索引指向 FrameData::images
+		Shadow        // 索引指向 FrameData::shadows
+	};
+
+	/// 命令流条目：类型标签 + 类型数组内的索引
+	struct CmdRef {
+		CmdType       type;
+		std::uint32_t index;
 	};
 
 	/// 帧渲染数据容器：收集一帧内的所有绘制命令
 	/// 
 	/// 设计理念：
 	/// - 命令模式：UI组件生成绘制命令，渲染器批量执行
+	/// - 有序命令流：commands记录追加顺序，即绘制顺序（Z序），后追加者在上
+	/// - 类型数组：命令本体按类型存放，便于父级剪裁按区间处理与渲染器批量打包
 	/// - 类型扩展：可轻松添加新的图元类型（线条、贝塞尔曲线等）
-	/// - 内存管理：使用vector确保内存局部性和高效遍历
+	/// - 内存管理：使用vector确保内存局部性和高效遍历；命令均为平凡可复制的紧凑结构，
+	///   剪裁区域集中在剪裁表中（同一容器内的命令共用一项），帧间复制即整块内存拷贝
+	/// - 帧内存复用：clear()保留各数组容量，窗口持有一个FrameData逐帧clear后重新录制，稳态下录制不再分配堆内存
+	/// 
+	/// 使用约定：
+	/// - 组件必须通过addRoundedRect/addImage/addShadow/addLayer追加命令，以保证commands与类型数组同步
+	/// - 剪裁通过addClip登记后把返回的ClipId写入命令；剪裁表项可能被多条命令共用，修改剪裁须登记新项（见translate）
+	/// - 已追加命令的其他字段可通过类型数组就地修改，不影响顺序
+	/// - 在两个FrameData之间搬运命令时ClipId随剪裁表一起才有意义（appendFrame会重映射）
 	struct FrameData {
 		std::vector<RoundedRectCmd> roundedRects;  // 圆角矩形绘制命令列表
 		std::vector<ImageCmd>       images;        // 纹理图像绘制命令列表
+		std::vector<ShadowCmd>      shadows;       // 投影绘制命令列表
+		std::vector<CmdRef>         commands;      // 有序命令流（绘制顺序）
+		std::vector<LayerDef>       layers;        // 本帧合成命令引用的离屏图层
+		std::vector<ClipRegion>     clips;         // 剪裁表（ClipId - 1为下标）
+
+		/// 功能：登记剪裁区域
+		/// 参数：rect — 剪裁矩形（逻辑像素；宽高<=0表示不剪裁）
+		/// 参数：radiusPx — 圆角半径（逻辑像素）
+		/// 返回：剪裁索引；与最近登记的一项相同时直接复用（连续录制的兄弟命令通常共用同一剪裁）
+		ClipId addClip(const QRectF& rect, const float radiusPx = 0.0f) {
+			if (rect.width() <= 0.0 || rect.height() <= 0.0) return kNoClip;
+			const ClipRegion region{ RectF(rect), radiusPx };
+			if (clips.empty() || !(clips.back() == region)) clips.push_back(region);
+			return static_cast<ClipId>(clips.size());
+		}
+
+		/// 功能：按索引取剪裁区域
+		/// 返回：kEmptyClip为kEmptyClipRegion；kNoClip或越界时为不剪裁的空区域
+		[[nodiscard]] const ClipRegion& clip(const ClipId id) const noexcept {
+			if (id == kEmptyClip) return kEmptyClipRegion;
+			return id == kNoClip || id > clips.size() ? kNoClipRegion : clips[id - 1];
+		}
+
+		/// 功能：追加圆角矩形命令
+		void addRoundedRect(const RoundedRectCmd& cmd) {
+			commands.push_back(CmdRef{ CmdType::RoundedRect, static_cast<std::uint32_t>(roundedRects.size()) });
+			roundedRects.push_back(cmd);
+		}
+
+		/// 功能：追加图像命令
+		void addImage(const ImageCmd& cmd) {
+			commands.push_back(CmdRef{ CmdType::Image, static_cast<std::uint32_t>(images.size()) });
+			images.push_back(cmd);
+		}
+
+		/// 功能：追加投影命令
+		void addShadow(const ShadowCmd& cmd) {
+			commands.push_back(CmdRef{ CmdType::Shadow, static_cast<std::uint32_t>(shadows.size()) });
+			shadows.push_back(cmd);
+		}
+
+		/// 功能：追加离屏图层及其合成命令
+		/// 参数：def — 图层定义（内容、版本、范围）
+		/// 参数：composite — 合成命令（textureId须为layerTextureId(def.id)）
+		void addLayer(const LayerDef& def, const ImageCmd& composite) {
+			layers.push_back(def);
+			addImage(composite);
+		}
+
+		/// 功能：按图层句柄查找图层定义
+		/// 返回：未找到时为nullptr（图层数通常很少，线性查找）
+		const LayerDef* findLayer(const int textureId) const {
+			for (const auto& def : layers) {
+				if (layerTextureId(def.id) == textureId) return &def;
+			}
+			return nullptr;
+		}
+
+		/// 功能：按绘制顺序追加另一帧数据中的全部命令
+		/// 参数：other — 来源帧数据（如缓存的子树命令）
+		/// 说明：来源命令流不完整时按"先投影、再矩形、后图像"的顺序追加；来源剪裁表整体追加，命令的ClipId随之平移
+		void appendFrame(const FrameData& other) {
+			commands.reserve(commands.size() + other.roundedRects.size() + other.images.size() + other.shadows.size());
+			roundedRects.reserve(roundedRects.size() + other.roundedRects.size());
+			images.reserve(images.size() + other.images.size());
+			shadows.reserve(shadows.size() + other.shadows.size());
+			layers.insert(layers.end(), other.layers.begin(), other.layers.end());
+			const auto clipBase = static_cast<ClipId>(clips.size());
+			clips.insert(clips.end(), other.clips.begin(), other.clips.end());
+			const auto rebase = [clipBase](auto cmd) {
+				if (cmd.clip != kNoClip && cmd.clip != kEmptyClip) cmd.clip += clipBase;
+				return cmd;
+			};
+			if (!other.hasOrderedStream()) {
+				for (const auto& cmd : other.shadows) addShadow(rebase(cmd));
+				for (const auto& cmd : other.roundedRects) addRoundedRect(rebase(cmd));
+				for (const auto& cmd : other.images) addImage(rebase(cmd));
+				return;
+			}
+			for (const auto& ref : other.commands) {
+				switch (ref.type) {
+				case CmdType::RoundedRect: addRoundedRect(rebase(other.roundedRects[ref.index])); break;
+				case CmdType::Image:       addImage(rebase(other.images[ref.index])); break;
+				case CmdType::Shadow:      addShadow(rebase(other.shadows[ref.index])); break;
+				}
+			}
+		}
+
+		/// 功能：平移类型数组中从rr0/im0/sh0起的命令及其剪裁
+		/// 参数：d — 平移量（逻辑像素）
+		/// 说明：剪裁表项可能被范围之外的命令共用，平移后的剪裁登记为新项（相邻命令的同一剪裁只登记一次）
+		void translate(const QPointF& d, const std::size_t rr0 = 0, const std::size_t im0 = 0, const std::size_t sh0 = 0) {
+			ClipId lastIn = kNoClip;
+			ClipId lastOut = kNoClip;
+			const auto moveClip = [&](ClipId& id) {
+				if (id == kNoClip || id == kEmptyClip) return;
+				if (id != lastIn) {
+					ClipRegion moved = clip(id);
+					moved.rect.translate(d);
+					lastIn = id;
+					lastOut = addClip(moved.rect, moved.radiusPx);
+				}
+				id = lastOut;
+			};
+			for (std::size_t i = rr0; i < roundedRects.size(); ++i) { roundedRects[i].rect.translate(d); moveClip(roundedRects[i].clip); }
+			for (std::size_t i = im0; i < images.size(); ++i) { images[i].dstRect.translate(d); moveClip(images[i].clip); }
+			for (std::size_t i = sh0; i < shadows.size(); ++i) { shadows[i].rect.translate(d); moveClip(shadows[i].clip); }
+		}
 
 		/// 功能：清空所有绘制命令
 		/// 说明：准备下一帧的命令收集
 		void clear() {
 			roundedRects.clear();
 			images.clear();
+			shadows.clear();
+			commands.clear();
+			layers.clear();
+			clips.clear();
 		}
 		
 		/// 功能：检查是否包含绘制命令
 		/// 返回：true表示无任何绘制内容
 		bool empty() const {
-			return roundedRects.empty() && images.empty();
+			return roundedRects.empty() && images.empty() && shadows.empty();
+		}
+
+		/// 功能：检查命令流是否覆盖全部命令
+		/// 返回：false表示存在绕过addXxx直接写入类型数组的命令（渲染器将按旧的"先矩形后图像"顺序绘制）
+		bool hasOrderedStream() const {
+			return commands.size() == roundedRects.size() + images.size() + shadows.size();
 		}
 	};
 
@@ -0,0 +1,230 @@
+#include "RenderThread.h"
+
+#include <functional>
+#include <memory>
+#include <qdebug.h>
+#include <qlogging.h>
+#include <qmutex.h>
+#include <qoffscreensurface.h>
+#include <qopenglcontext.h>
+#include <qopenglextrafunctions.h>
+#include <qopenglframebufferobject.h>
+#include <qopenglfunctions.h>
+#include <qthread.h>
+#include <QtGui/qopengl.h>
+#include <utility>
+
+#ifndef GL_READ_FRAMEBUFFER
+#define GL_READ_FRAMEBUFFER 0x8CA8
+#endif
+#ifndef GL_DRAW_FRAMEBUFFER
+#define GL_DRAW_FRAMEBUFFER 0x8CA9
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+#ifndef GL_TIMEOUT_IGNORED
+#define GL_TIMEOUT_IGNORED 0xFFFFFFFFFFFFFFFFull
+#endif
+
+namespace {
+	// 拷贝帧（含图层内容）中全部图像命令的句柄；图层句柄为负值，由渲染器自行解析
+	void captureFrame(IconSnapshot& snapshot, const IconCache& icons, const Render::FrameData& fd) {
+		for (const auto& img : fd.images) snapshot.capture(icons, img.textureId);
+		for (const auto& layer : fd.layers) {
+			if (layer.content) captureFrame(snapshot, icons, *layer.content);
+		}
+	}
+}
+
+RenderThread::RenderThread(IconCache& iconCache)
+	: m_icons(iconCache)
+{
+	setObjectName(QStringLiteral("RenderThread"));
+}
+
+RenderThread::~RenderThread()
+{
+	if (isRunning()) {
+		qWarning() << "RenderThread destroyed while running; call stop() with the window context current";
+		m_quit.store(true, std::memory_order_release);
+		m_wake.release();
+		wait();
+	}
+	delete m_context;
+	delete m_surface;
+}
+
+bool RenderThread::startRendering(QOpenGLContext* shareContext, std::function<void(Renderer&)> setup)
+{
+	if (isRunning() || !shareContext) return false;
+
+	// 上下文与离屏表面都须在UI线程创建；上下文随后移入渲染线程
+	m_surface = new QOffscreenSurface();
+	m_surface->setFormat(shareContext->format());
+	m_surface->create();
+
+	m_context = new QOpenGLContext();
+	m_context->setFormat(shareContext->format());
+	m_context->setShareContext(shareContext);
+	if (!m_surface->isValid() || !m_context->create() || !QOpenGLContext::areSharing(m_context, shareContext)) {
+		qWarning() << "RenderThread: cannot create a shared OpenGL context";
+		delete m_context;
+		delete m_surface;
+		m_context = nullptr;
+		m_surface = nullptr;
+		return false;
+	}
+
+	m_setup = std::move(setup);
+	m_ownerThread = QThread::currentThread();
+	m_quit.store(false, std::memory_order_relaxed);
+	m_icons.setDeferredGl(true);
+	m_context->moveToThread(this);
+	start();
+	return true;
+}
+
+void RenderThread::stop()
+{
+	if (isRunning()) {
+		m_quit.store(true, std::memory_order_release);
+		m_wake.release();
+		wait();
+	}
+
+	// UI线程一侧：读帧缓冲属于窗口上下文；排队的纹理操作改在窗口上下文执行（纹理在共享组内）
+	if (auto* ctx = QOpenGLContext::currentContext()) {
+		if (m_readFbo) {
+			ctx->extraFunctions()->glDeleteFramebuffers(1, &m_readFbo);
+			m_readFbo = 0;
+		}
+		const QMutexLocker lock(&m_icons.mutex());
+		m_icons.flushGl(ctx->functions());
+	}
+	m_icons.setDeferredGl(false);
+}
+
+void RenderThread::submitJob()
+{
+	Job& job = m_jobs.back();
+	job.serial = m_nextSerial++;
+	if (m_jobs.publish()) m_stats.dropped.fetch_add(1, std::memory_order_relaxed);
+	m_stats.submitted.fetch_add(1, std::memory_order_relaxed);
+	m_wake.release();
+}
+
+bool RenderThread::present(const GLuint drawFbo)
+{
+	Target& t = m_targets.front();
+	QOpenGLContext* ctx = QOpenGLContext::currentContext();
+	if (!t.texture || !ctx) return false;
+	auto* glx = ctx->extraFunctions();
+
+	// 服务端等待：不阻塞UI线程，只保证GPU先完成渲染线程的绘制
+	if (t.drawn) {
+		glx->glWaitSync(t.drawn, 0, GL_TIMEOUT_IGNORED);
+		glx->glDeleteSync(t.drawn);
+		t.drawn = nullptr;
+	}
+
+	if (!m_readFbo) glx->glGenFramebuffers(1, &m_readFbo);
+	glx->glBindFramebuffer(GL_READ_FRAMEBUFFER, m_readFbo);
+	glx->glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, t.texture, 0);
+	glx->glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFbo);
+	const int w = t.sizePx.width();
+	const int h = t.sizePx.height();
+	glx->glBlitFramebuffer(0, 0, w, h, 0, 0, w, h, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	glx->glBindFramebuffer(GL_FRAMEBUFFER, drawFbo);
+
+	// 同一帧可能被合成多次：只保留最近一次的读栅栏
+	if (t.read) glx->glDeleteSync(t.read);
+	t.read = glx->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	return true;
+}
+
+void RenderThread::run()
+{
+	if (!m_context->makeCurrent(m_surface)) {
+		qWarning() << "RenderThread: makeCurrent failed";
+		m_context->moveToThread(m_ownerThread);
+		return;
+	}
+	QOpenGLFunctions* gl = m_context->functions();
+	gl->glEnable(GL_BLEND);
+	gl->glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	m_renderer.initializeGL(gl);
+	if (m_setup) m_setup(m_renderer);
+
+	for (;;) {
+		m_wake.acquire();
+		// 积压的唤醒合并为一次：只绘制最新一帧
+		m_wake.tryAcquire(m_wake.available());
+		if (m_quit.load(std::memory_order_acquire)) break;
+		if (!m_jobs.consume()) continue;
+		renderJob(m_jobs.front());
+	}
+
+	releaseTargets();
+	m_renderer.releaseGL();
+	m_context->doneCurrent();
+	m_context->moveToThread(m_ownerThread);
+}
+
+void RenderThread::renderJob(const Job& job)
+{
+	if (job.fbSizePx.isEmpty()) return;
+	QOpenGLFunctions* gl = m_context->functions();
+	QOpenGLExtraFunctions* glx = m_context->extraFunctions();
+
+	// 写入槽可能刚被UI线程合成过：等它的读栅栏；从未被取走的帧的绘制栅栏已无人等待
+	Target& t = m_targets.back();
+	if (t.read) {
+		glx->glWaitSync(t.read, 0, GL_TIMEOUT_IGNORED);
+		glx->glDeleteSync(t.read);
+		t.read = nullptr;
+	}
+	if (t.drawn) {
+		glx->glDeleteSync(t.drawn);
+		t.drawn = nullptr;
+	}
+	if (!t.fbo || t.fbo->size() != job.fbSizePx) {
+		t.fbo = std::make_unique<QOpenGLFramebufferObject>(job.fbSizePx, QOpenGLFramebufferObject::CombinedDepthStencil);
+	}
+
+	t.fbo->bind();
+	m_renderer.resize(job.fbSizePx.width(), job.fbSizePx.height());
+	gl->glViewport(0, 0, job.fbSizePx.width(), job.fbSizePx.height());
+	gl->glClearColor(job.clearColor.redF(), job.clearColor.greenF(), job.clearColor.blueF(), 1.0f);
+	gl->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	{
+		// 只在执行排队的纹理操作与拷贝句柄解析期间持锁（UI线程的缓存未命中此时会等待），绘制不持锁
+		const QMutexLocker lock(&m_icons.mutex());
+		m_icons.flushGl(gl);
+		m_iconSnapshot.clear();
+		captureFrame(m_iconSnapshot, m_icons, job.frame);
+	}
+	m_renderer.drawFrame(job.frame, m_iconSnapshot, job.dpr);
+	t.drawn = glx->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	// 栅栏须先提交到GPU，其他上下文才能等待它
+	gl->glFlush();
+	t.fbo->release();
+
+	t.texture = t.fbo->texture();
+	t.sizePx = job.fbSizePx;
+	t.serial = job.serial;
+	t.stats = m_renderer.lastFrameStats();
+	m_targets.publish();
+	m_stats.rendered.fetch_add(1, std::memory_order_relaxed);
+	if (m_onFrameReady) m_onFrameReady();
+}
+
+void RenderThread::releaseTargets()
+{
+	QOpenGLExtraFunctions* glx = m_context->extraFunctions();
+	for (Target& t : m_targets.slots()) {
+		if (t.drawn) glx->glDeleteSync(t.drawn);
+		if (t.read) glx->glDeleteSync(t.read);
+		t = Target{};
+	}
+}
@@ -0,0 +1,132 @@
+/*
+ * 文件名：RenderThread.h
+ * 职责：渲染线程：持有与窗口上下文共享的OpenGL上下文，把UI线程录制的FrameData绘制到离屏帧缓冲，供UI线程合成到窗口。
+ * 依赖：Renderer、IconCache（延迟GL模式）、FrameExchange、Qt6 OpenGL。
+ * 线程：beginJob/submitJob/takeFrame/present/stop只在UI线程调用；run在渲染线程执行。
+ * 备注：帧数据与帧缓冲都经无锁三重缓冲交接；跨上下文的读写顺序由GL栅栏保证。
+ */
+
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <qcolor.h>
+#include <qglobal.h>
+#include <qopenglframebufferobject.h>
+#include <qsemaphore.h>
+#include <qsize.h>
+#include <qthread.h>
+#include <QtGui/qopengl.h>
+
+#include "FrameExchange.h"
+#include "IconCache.h"
+#include "RenderData.hpp"
+#include "Renderer.h"
+
+class QOffscreenSurface;
+class QOpenGLContext;
+
+/// 渲染线程
+///
+/// 流水线：
+/// 1. UI线程在beginJob()返回的槽位中填入一帧（FrameData、帧缓冲尺寸、DPR、清屏颜色），submitJob()发布并唤醒渲染线程
+/// 2. 渲染线程取最新一帧：持锁执行IconCache排队的纹理操作并拷贝本帧的句柄解析（IconSnapshot），
+///    解锁后绘制到自己的离屏帧缓冲（带深度附件），放置栅栏后发布
+/// 3. UI线程takeFrame()取得最新完成的帧缓冲，present()等待其栅栏后blit到窗口帧缓冲，再放置读栅栏
+/// 4. 渲染线程复用该帧缓冲前等待读栅栏
+///
+/// 渲染线程落后时未取走的帧被覆盖（只绘制最新一帧）；每个离屏帧缓冲都整帧重绘，不做局部重绘。
+class RenderThread final : public QThread {
+public:
+	/// 一帧的绘制输入（UI线程填写）
+	struct Job {
+		Render::FrameData frame;
+		QSize   fbSizePx;        // 帧缓冲尺寸（设备像素）
+		float   dpr{ 1.0f };
+		QColor  clearColor;
+		quint64 serial{ 0 };     // 由submitJob编号
+	};
+
+	/// 一帧的绘制结果（渲染线程写入，UI线程合成）
+	struct Target {
+		std::unique_ptr<QOpenGLFramebufferObject> fbo;  // 仅在渲染线程访问
+		GLuint  texture{ 0 };     // 颜色附件（共享组内可见）
+		QSize   sizePx;
+		GLsync  drawn{ nullptr }; // 绘制完成栅栏：UI线程等待后删除
+		GLsync  read{ nullptr };  // 合成完成栅栏：渲染线程复用前等待后删除
+		quint64 serial{ 0 };
+		Renderer::FrameStats stats;
+	};
+
+	/// 统计（自启动起累计）
+	struct Stats {
+		std::atomic<qint64> submitted{ 0 };  // UI线程提交的帧
+		std::atomic<qint64> dropped{ 0 };    // 渲染线程取走前被覆盖的帧
+		std::atomic<qint64> rendered{ 0 };   // 渲染线程绘制的帧
+	};
+
+	/// 参数：iconCache — 与UI线程共用的纹理缓存（启动时切换为延迟GL模式）
+	explicit RenderThread(IconCache& iconCache);
+	~RenderThread() override;
+
+	RenderThread(const RenderThread&) = delete;
+	RenderThread& operator=(const RenderThread&) = delete;
+
+	/// 功能：创建共享上下文并启动线程
+	/// 参数：shareContext — 窗口的上下文（需为当前上下文；纹理在两者间共享）
+	/// 参数：setup — 在渲染线程中配置渲染器（提交路径、剔除等开关），可为空
+	/// 返回：上下文创建失败时返回false（调用方应退回单线程渲染）
+	bool startRendering(QOpenGLContext* shareContext, std::function<void(Renderer&)> setup = {});
+
+	/// 功能：停止线程并释放两侧资源（需在UI线程、窗口上下文为当前时调用）
+	/// 说明：停止后IconCache退出延迟GL模式，排队的纹理操作在当前上下文中执行
+	void stop();
+
+	/// 功能：设置帧完成回调（在渲染线程中调用；调用方自行排队到UI线程）
+	void setFrameReadyCallback(std::function<void()> cb) { m_onFrameReady = std::move(cb); }
+
+	/// 功能：UI线程的写入槽（上一次写入的内容仍在，frame可先clear再复用容量）
+	[[nodiscard]] Job& beginJob() noexcept { return m_jobs.back(); }
+	/// 功能：发布写入槽并唤醒渲染线程
+	void submitJob();
+
+	/// 功能：取得最新绘制完成的一帧
+	/// 返回：是否有新帧（没有时继续使用上一帧）
+	bool takeFrame() noexcept { return m_targets.consume(); }
+	/// 功能：UI线程当前持有的帧（texture为0表示尚无结果）
+	[[nodiscard]] const Target& currentFrame() const noexcept { return m_targets.front(); }
+
+	/// 功能：把当前持有的帧blit到目标帧缓冲（左下角对齐，尺寸取两者较小值）
+	/// 参数：drawFbo — 目标帧缓冲（窗口的defaultFramebufferObject）
+	/// 返回：尚无结果时返回false，不绘制
+	bool present(GLuint drawFbo);
+
+	[[nodiscard]] const Stats& stats() const noexcept { return m_stats; }
+
+protected:
+	void run() override;
+
+private:
+	/// 功能：在渲染线程中绘制一帧
+	void renderJob(const Job& job);
+	/// 功能：在渲染线程中释放帧缓冲与栅栏
+	void releaseTargets();
+
+	IconCache&   m_icons;
+	IconSnapshot m_iconSnapshot;  // 持锁期间拷贝的本帧句柄解析结果，解锁后绘制
+	Renderer     m_renderer;
+	std::function<void(Renderer&)> m_setup;
+	std::function<void()> m_onFrameReady;
+
+	QOpenGLContext*    m_context{ nullptr };   // 渲染线程的上下文（创建于UI线程，移入渲染线程，结束时移回）
+	QOffscreenSurface* m_surface{ nullptr };   // 只用于makeCurrent，实际绘制目标是Target::fbo
+	QThread*           m_ownerThread{ nullptr };
+
+	FrameExchange<Job>    m_jobs;     // UI线程 -> 渲染线程
+	FrameExchange<Target> m_targets;  // 渲染线程 -> UI线程
+	QSemaphore        m_wake;
+	std::atomic<bool> m_quit{ false };
+	quint64 m_nextSerial{ 1 };
+	GLuint  m_readFbo{ 0 };           // UI线程上下文中用于blit的读帧缓冲
+	Stats   m_stats;
+};
@@ -1,11 +1,20 @@
 #include "Renderer.h"
 
+#include "CommandCuller.h"
 #include "IconCache.h"
 #include "RenderData.hpp"
+#include "ShaderCache.h"
 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <iterator>
 #include <qcolor.h>
+#include <qelapsedtimer.h>
+#include <qhash.h>
+#include <qlogging.h>
+#include <qopenglcontext.h>
+#include <qopenglextrafunctions.h>
 #include <qopenglfunctions.h>
 #include <qopenglshaderprogram.h>
 #include <qrect.h>
@@ -13,6 +22,13 @@
 #include <QtGui/qopengl.h>   // 使用 Qt 自带 OpenGL 定义
 #include <qvectornd.h>
 
+#ifndef GL_DEPTH
+#define GL_DEPTH 0x1801
+#endif
+#ifndef GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE
+#define GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE 0x2216
+#endif
+
 namespace {
 	void rectPxToNdcVerts(const QRectF& rPx, const int vpWpx, const int vpHpx, float out[12]) {
 		const float xL = static_cast<float>(rPx.left());
@@ -38,6 +54,258 @@ namespace {
 		return { x, y, w, h };
 	}
 
+	// 着色器剪裁参数（设备像素，左上原点）
+	struct ShaderClip {
+		float px[4]{ 0.f, 0.f, 0.f, 0.f };  // 宽高为0表示不剪裁
+		float radiusPx{ 0.f };
+		bool  visible{ true };              // false：剪裁区域为空或完全在帧缓冲之外
+	};
+
+	// 直角剪裁与原glScissor的取整规则一致（向外取整到整像素）；圆角剪裁保留精确的设备像素矩形，使圆角与卡片背景重合
+	ShaderClip shaderClip(const Render::ClipRegion& region, const float dpr, const int fbWpx, const int fbHpx) {
+		const QRectF clipLogical = region.rect;
+		const float clipRadius = region.radiusPx;
+		ShaderClip out;
+		if (region.empty) {
+			out.visible = false;
+			return out;
+		}
+		if (clipLogical.width() <= 0.0 || clipLogical.height() <= 0.0) return out;
+		const QRect c = clipLogicalToPxTopLeft(clipLogical, dpr, fbWpx, fbHpx);
+		if (c.width() <= 0 || c.height() <= 0) {
+			out.visible = false;
+			return out;
+		}
+		if (clipRadius > 0.0f) {
+			out.px[0] = static_cast<float>(clipLogical.x() * dpr);
+			out.px[1] = static_cast<float>(clipLogical.y() * dpr);
+			out.px[2] = static_cast<float>(clipLogical.width() * dpr);
+			out.px[3] = static_cast<float>(clipLogical.height() * dpr);
+			out.radiusPx = clipRadius * dpr;
+		}
+		else {
+			out.px[0] = static_cast<float>(c.x());
+			out.px[1] = static_cast<float>(c.y());
+			out.px[2] = static_cast<float>(c.width());
+			out.px[3] = static_cast<float>(c.height());
+		}
+		return out;
+	}
+
+	// 损坏区域：逻辑像素 -> 设备像素（左上原点），四边向外取整，保证覆盖所有受影响的像素
+	QRect damageLogicalToPx(const QRectF& logical, const float dpr, const int fbWpx, const int fbHpx) {
+		const int x0 = std::clamp(static_cast<int>(std::floor(logical.left() * dpr)), 0, fbWpx);
+		const int y0 = std::clamp(static_cast<int>(std::floor(logical.top() * dpr)), 0, fbHpx);
+		const int x1 = std::clamp(static_cast<int>(std::ceil(logical.right() * dpr)), 0, fbWpx);
+		const int y1 = std::clamp(static_cast<int>(std::ceil(logical.bottom() * dpr)), 0, fbHpx);
+		return { x0, y0, std::max(0, x1 - x0), std::max(0, y1 - y0) };
+	}
+
+	// 高斯模糊圆角矩形投影（解析近似）：x方向对圆角矩形的横截线段做erf闭式积分，
+	// y方向在±3σ内做4点求积；两种提交路径的片段着色器共用
+	constexpr auto kShadowGlsl = R"(
+vec2 erf2(vec2 x){
+    vec2 s = sign(x);
+    vec2 a = abs(x);
+    x = 1.0 + (0.278393 + (0.230389 + 0.078108 * (a * a)) * a) * a;
+    x *= x;
+    return s - s / (x * x);
+}
+
+float gaussian(float x, float sigma){
+    return exp(-(x * x) / (2.0 * sigma * sigma)) / (2.5066283 * sigma);
+}
+
+float shadowX(float x, float y, float sigma, float corner, vec2 halfSize){
+    float delta = min(halfSize.y - corner - abs(y), 0.0);
+    float curved = halfSize.x - corner + sqrt(max(0.0, corner * corner - delta * delta));
+    vec2 integral = 0.5 + 0.5 * erf2((x + vec2(-curved, curved)) * (0.70710678 / sigma));
+    return integral.y - integral.x;
+}
+
+float shadowAlpha(vec4 rectPx, float corner, float sigma, vec2 p){
+    vec2 halfSize = 0.5 * rectPx.zw;
+    vec2 q = p - (rectPx.xy + halfSize);
+    corner = min(corner, min(halfSize.x, halfSize.y));
+    float low  = q.y - halfSize.y;
+    float high = q.y + halfSize.y;
+    float start = clamp(-3.0 * sigma, low, high);
+    float end   = clamp(3.0 * sigma, low, high);
+    float stepY = (end - start) / 4.0;
+    float y = start + stepY * 0.5;
+    float value = 0.0;
+    for (int i = 0; i < 4; ++i) {
+        value += shadowX(q.x, q.y - y, sigma, corner, halfSize) * gaussian(y, sigma) * stepY;
+        y += stepY;
+    }
+    return value;
+}
+)";
+
+	// 剪裁覆盖率：clipPx为设备像素矩形（左上原点，宽高<=0表示不剪裁）；
+	// 直角剪裁与glScissor等价（像素中心落在矩形内即保留），圆角剪裁按距离场做1像素抗锯齿过渡
+	constexpr auto kClipGlsl = R"(
+float clipCoverage(vec2 fragPx, vec4 clipPx, float clipRadius){
+    if (clipPx.z <= 0.0 || clipPx.w <= 0.0) return 1.0;
+    if (clipRadius <= 0.0) {
+        vec2 c0 = clipPx.xy;
+        vec2 c1 = clipPx.xy + clipPx.zw;
+        return (fragPx.x < c0.x || fragPx.y < c0.y || fragPx.x >= c1.x || fragPx.y >= c1.y) ? 0.0 : 1.0;
+    }
+    vec2 halfSize = 0.5 * clipPx.zw;
+    float r = min(clipRadius, min(halfSize.x, halfSize.y));
+    vec2 q = abs(fragPx - (clipPx.xy + halfSize)) - (halfSize - vec2(r));
+    float d = length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - r;
+    return clamp(0.5 - d, 0.0, 1.0);
+}
+)";
+
+	// 圆角矩形填充 + 内侧描边：一次距离场求值得到外轮廓与描边内沿两个覆盖率，填充与描边按覆盖率互不重叠地合成；
+	// 返回未预乘颜色（alpha含覆盖率），描边宽度<=0时即普通填充。两种提交路径的片段着色器共用
+	constexpr auto kRectGlsl = R"(
+float sdRoundRect(vec2 p, vec2 halfSize, float r){
+    vec2 q = abs(p) - (halfSize - vec2(r));
+    float outside = length(max(q, 0.0));
+    float inside = min(max(q.x, q.y), 0.0);
+    return outside + inside - r;
+}
+
+vec4 rectColor(vec2 fragPx, vec4 rectPx, float radius, vec4 fill, float strokeW, vec4 stroke){
+    vec2 halfSize = 0.5 * rectPx.zw;
+    float r = min(radius, min(halfSize.x, halfSize.y));
+    float dist = sdRoundRect(fragPx - (rectPx.xy + halfSize), halfSize, r);
+    float aa = fwidth(dist);
+    float outer = 1.0 - smoothstep(0.0, aa, dist);
+    if (strokeW <= 0.0) return vec4(fill.rgb, fill.a * outer);
+    float inner = 1.0 - smoothstep(0.0, aa, dist + strokeW);
+    float fa = fill.a * inner;
+    float sa = stroke.a * (outer - inner);
+    float a = fa + sa;
+    vec3 rgb = a > 0.0 ? (fill.rgb * fa + stroke.rgb * sa) / a : fill.rgb;
+    return vec4(rgb, a);
+}
+)";
+
+	// 投影的高斯σ（设备像素）：blurPx约为3σ；过小时取0.5避免除零并保留一点抗锯齿
+	float shadowSigmaPx(const float blurPx, const float dpr) {
+		return std::max(0.5f, blurPx * dpr / 3.0f);
+	}
+
+	// 投影绘制区域需覆盖形状外3σ的衰减带（再留1px）
+	QRectF shadowBoundsPx(const QRectF& rectPx, const float sigmaPx) {
+		const qreal m = 3.0 * sigmaPx + 1.0;
+		return rectPx.adjusted(-m, -m, m, m);
+	}
+
+	// 不透明内部小于此面积（设备像素²）时不参与预通道：遮住的像素太少，不抵多一个实例的开销
+	constexpr int kMinOpaqueAreaPx = 256;
+
+	// 圆角矩形内接的直角矩形向内收缩量：r(1-1/√2)使角点落在圆弧上，再留1像素避开抗锯齿
+	qreal roundedInset(const qreal radius) {
+		return radius > 0.0 ? radius * 0.29289322 + 1.0 : 0.0;
+	}
+
+	// 不透明圆角矩形中每个像素都被完全覆盖的区域（设备像素，左上原点，向内取整到整像素）；
+	// 与剪裁区域（圆角剪裁同样取内接矩形）及帧缓冲求交，太小时返回空矩形
+	QRect opaqueInteriorPx(const QRectF& rectPx, const float radiusPx, const ShaderClip& clip, const int fbWpx, const int fbHpx) {
+		if (rectPx.width() <= 0.0 || rectPx.height() <= 0.0) return {};
+		const qreal r = std::min<qreal>(radiusPx, 0.5 * std::min(rectPx.width(), rectPx.height()));
+		const qreal inset = roundedInset(r);
+		QRectF in = rectPx.adjusted(inset, inset, -inset, -inset).intersected(QRectF(0.0, 0.0, fbWpx, fbHpx));
+		if (clip.px[2] > 0.0f && clip.px[3] > 0.0f) {
+			const QRectF c(clip.px[0], clip.px[1], clip.px[2], clip.px[3]);
+			const qreal ci = roundedInset(std::min<qreal>(clip.radiusPx, 0.5 * std::min(c.width(), c.height())));
+			in = in.intersected(c.adjusted(ci, ci, -ci, -ci));
+		}
+		const int x0 = static_cast<int>(std::ceil(in.left()));
+		const int y0 = static_cast<int>(std::ceil(in.top()));
+		const int x1 = static_cast<int>(std::floor(in.right()));
+		const int y1 = static_cast<int>(std::floor(in.bottom()));
+		if (x1 <= x0 || y1 <= y0 || (x1 - x0) * (y1 - y0) < kMinOpaqueAreaPx) return {};
+		return { x0, y0, x1 - x0, y1 - y0 };
+	}
+
+	// 单位四边形（两个三角形，0..1），实例化绘制时由顶点着色器展开到目标矩形
+	constexpr float kUnitQuad[12] = {
+		0.f, 0.f, 1.f, 0.f, 1.f, 1.f,
+		0.f, 0.f, 1.f, 1.f, 0.f, 1.f
+	};
+
+	// 图像命令展开后的单个纹理四边形
+	struct ImageQuad {
+		QRectF dstPx;               // 目标矩形（设备像素，左上原点）
+		QRectF srcPx;               // 源区域（图集页内像素）
+		IconCache::Region page;     // 所在图集页
+		QColor tint;
+	};
+
+	QRectF scaledRect(const QRectF& r, const qreal k) {
+		return { r.x() * k, r.y() * k, r.width() * k, r.height() * k };
+	}
+
+	// 整帧平移（逻辑像素）：图层内容以bounds左上角为原点绘制到图层纹理
+	Render::FrameData translatedFrame(const Render::FrameData& fd, const QPointF& d) {
+		// 整帧平移时剪裁表只属于本帧，可就地平移
+		Render::FrameData out = fd;
+		for (auto& c : out.roundedRects) c.rect.translate(d);
+		for (auto& c : out.images) c.dstRect.translate(d);
+		for (auto& c : out.shadows) c.rect.translate(d);
+		for (auto& c : out.clips) c.rect.translate(d);
+		return out;
+	}
+
+	// 图像命令最多展开的四边形数（forEachImageQuad的上限，不解析子图）
+	qsizetype imageQuadBound(const Render::ImageCmd& img, const IconResolver& iconCache) {
+		if (img.textureId == 0) return 0;
+		if (Render::isLayerTexture(img.textureId)) return 1;
+		if (const IconCache::TextRun* run = iconCache.textRun(img.textureId)) return static_cast<qsizetype>(run->glyphs.size());
+		return 1;
+	}
+
+	// 将图像命令展开为纹理四边形：普通子图与图层为1个，文本为每个落在srcRectPx内的字形各1个
+	template <typename Fn>
+	void forEachImageQuad(const Render::ImageCmd& img, const IconResolver& iconCache, const QHash<int, IconCache::Region>& layerPages,
+		const float dpr, Fn&& fn) {
+		const QRectF dstPx(img.dstRect.x() * dpr, img.dstRect.y() * dpr, img.dstRect.width() * dpr, img.dstRect.height() * dpr);
+
+		if (Render::isLayerTexture(img.textureId)) {
+			// 图层纹理由帧缓冲绘制而来（底左原点）：源区域按图层缩放换算为纹理像素后纵向翻转
+			const IconCache::Region page = layerPages.value(img.textureId);
+			if (page.textureId == 0) return;
+			const QRectF s = scaledRect(img.srcRectPx, page.srcScale);
+			const QRectF flipped(s.x(), page.pageSizePx.height() - s.y(), s.width(), -s.height());
+			fn(ImageQuad{ .dstPx = dstPx, .srcPx = flipped, .page = page, .tint = img.tint });
+			return;
+		}
+
+		if (const IconCache::TextRun* run = iconCache.textRun(img.textureId)) {
+			// srcRectPx以文本框为坐标系：与之求交即可实现横向截断等部分绘制
+			const QRectF& src = img.srcRectPx;
+			if (src.width() <= 0.0 || src.height() <= 0.0) return;
+			const qreal sx = dstPx.width() / src.width();
+			const qreal sy = dstPx.height() / src.height();
+			const QColor tint(run->color.red() * img.tint.red() / 255, run->color.green() * img.tint.green() / 255,
+				run->color.blue() * img.tint.blue() / 255, run->color.alpha() * img.tint.alpha() / 255);
+
+			for (const auto& g : run->glyphs) {
+				const QRectF part = QRectF(g.rectPx).intersected(src);
+				if (part.isEmpty()) continue;
+				const IconCache::Region page = iconCache.resolve(g.glyphId);
+				if (page.textureId == 0) continue;
+				const QRectF dst(dstPx.x() + (part.x() - src.x()) * sx, dstPx.y() + (part.y() - src.y()) * sy,
+					part.width() * sx, part.height() * sy);
+				const QRectF glyphSrc = scaledRect(part.translated(-g.rectPx.topLeft()), g.srcScale * page.srcScale);
+				fn(ImageQuad{ .dstPx = dst, .srcPx = glyphSrc.translated(page.originPx), .page = page, .tint = tint });
+			}
+			return;
+		}
+
+		// 句柄 -> 图集页纹理；srcRectPx为子图自身坐标，需按别名缩放并加上子图在页内的偏移
+		const IconCache::Region page = iconCache.resolve(img.textureId);
+		if (page.textureId == 0) return;
+		fn(ImageQuad{ .dstPx = dstPx, .srcPx = scaledRect(img.srcRectPx, page.srcScale).translated(page.originPx), .page = page, .tint = img.tint });
+	}
+
 	void glScissorTopLeft(QOpenGLFunctions* gl, const QRect& clipTopLeftPx, const int fbHpx) {
 		const int x = clipTopLeftPx.x();
 		const int y = std::max(0, fbHpx - (clipTopLeftPx.y() + clipTopLeftPx.height()));
@@ -52,58 +320,78 @@ void Renderer::initializeGL(QOpenGLFunctions* gl)
 {
 	m_gl = gl;
 
+	// 实例化绘制需要GL 3.3（或GLES 3.0）的扩展函数
+	if (const QOpenGLContext* ctx = QOpenGLContext::currentContext(); ctx && ctx->format().majorVersion() >= 3) {
+		m_glx = ctx->extraFunctions();
+	}
+	if (!m_stream.isValid()) m_stream.initialize(m_gl, m_glx);
+
+	// GL_TIME_ELAPSED：桌面GL 3.3核心功能或GL_ARB_timer_query（GLES无此查询目标）
+	if (const QOpenGLContext* ctx = QOpenGLContext::currentContext(); ctx && m_glx && !ctx->isOpenGLES() && !m_gpuQueries[0]) {
+		const auto ver = ctx->format().version();
+		m_gpuTimingSupported = ver >= qMakePair(3, 3) || ctx->hasExtension(QByteArrayLiteral("GL_ARB_timer_query"));
+		if (m_gpuTimingSupported) m_glx->glGenQueries(kGpuQueryCount, m_gpuQueries);
+	}
+
+	// 离屏图层的纹理尺寸上限
+	m_gl->glGetIntegerv(GL_MAX_TEXTURE_SIZE, &m_maxTextureSize);
+
+	// 着色器程序经ShaderCache构建：同进程已链接过或磁盘有匹配二进制时跳过编译
+	QElapsedTimer programClock;
+	programClock.start();
+	const ShaderCache::Stats cacheBefore = ShaderCache::instance().stats();
+	// 链接失败的程序不保留（绘制函数见空指针即跳过，下次initializeGL重试），其缓存二进制一并丢弃
+	const auto linked = [](QOpenGLShaderProgram*& prog, const QString& name, const QByteArray& vs, const QByteArray& fs) {
+		if (prog->isLinked()) return true;
+		qWarning() << "Renderer: program" << name << "failed to link:" << prog->log();
+		ShaderCache::instance().drop(name, vs, fs);
+		delete prog;
+		prog = nullptr;
+		return false;
+	};
+
 	if (!m_progRect) {
 		static auto vs1 = R"(#version 330 core
 layout(location=0) in vec2 aPos;
 void main(){ gl_Position = vec4(aPos, 0.0, 1.0); })";
 
-		static auto fs1 = R"(
-#version 330 core
+		static const QByteArray fs1 = QByteArray(R"(#version 330 core
 out vec4 FragColor;
 uniform vec2 uViewportSize;
 uniform vec4 uRectPx;
 uniform float uRadius;
 uniform vec4 uColor;
-
-float sdRoundRect(vec2 p, vec2 halfSize, float r){
-    vec2 q = abs(p) - (halfSize - vec2(r));
-    float outside = length(max(q, 0.0));
-    float inside = min(max(q.x, q.y), 0.0);
-    return outside + inside - r;
-}
-
+uniform vec4 uClipPx;
+uniform float uClipRadius;
+uniform float uStrokeW;
+uniform vec4 uStrokeColor;
+)") + kClipGlsl + kRectGlsl + R"(
 void main(){
     vec2 fragPx = vec2(gl_FragCoord.x, uViewportSize.y - gl_FragCoord.y);
-    vec2 rectCenter = uRectPx.xy + 0.5 * uRectPx.zw;
-    vec2 halfSize   = 0.5 * uRectPx.zw;
-    float r = min(uRadius, min(halfSize.x, halfSize.y));
-    vec2 p = fragPx - rectCenter;
-    float dist = sdRoundRect(p, halfSize, r);
-    float aa = fwidth(dist);
-    float alpha = 1.0 - smoothstep(0.0, aa, dist);
-    FragColor = vec4(uColor.rgb, uColor.a * alpha);
+    float clipA = clipCoverage(fragPx, uClipPx, uClipRadius);
+    if (clipA <= 0.0) discard;
+    vec4 c = rectColor(fragPx, uRectPx, uRadius, uColor, uStrokeW, uStrokeColor);
+    FragColor = vec4(c.rgb, c.a * clipA);
 })";
 
-		m_progRect = new QOpenGLShaderProgram();
-		m_progRect->addShaderFromSourceCode(QOpenGLShader::Vertex, vs1);
-		m_progRect->addShaderFromSourceCode(QOpenGLShader::Fragment, fs1);
-		m_progRect->link();
-
-		m_locViewportSize = m_progRect->uniformLocation("uViewportSize");
-		m_locRectPx = m_progRect->uniformLocation("uRectPx");
-		m_locRadius = m_progRect->uniformLocation("uRadius");
-		m_locColor = m_progRect->uniformLocation("uColor");
+		m_progRect = ShaderCache::instance().build(QStringLiteral("rect"), vs1, fs1);
+		if (linked(m_progRect, QStringLiteral("rect"), vs1, fs1)) {
+			m_locViewportSize = m_progRect->uniformLocation("uViewportSize");
+			m_locRectPx = m_progRect->uniformLocation("uRectPx");
+			m_locRadius = m_progRect->uniformLocation("uRadius");
+			m_locColor = m_progRect->uniformLocation("uColor");
+			m_locClipPx = m_progRect->uniformLocation("uClipPx");
+			m_locClipRadius = m_progRect->uniformLocation("uClipRadius");
+			m_locStrokeW = m_progRect->uniformLocation("uStrokeW");
+			m_locStrokeColor = m_progRect->uniformLocation("uStrokeColor");
+		}
+	}
 
+	if (!m_vao.isCreated()) {
+		// 逐命令路径的三个程序共用；顶点数据每帧写入流式缓冲，属性指针在prepareImmediate中按本帧偏移设置
 		m_vao.create();
 		m_vao.bind();
-
-		m_gl->glGenBuffers(1, &m_vbo);
-		m_gl->glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-		m_gl->glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 12, nullptr, GL_DYNAMIC_DRAW);
-
 		m_gl->glEnableVertexAttribArray(0);
-		m_gl->glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
-
 		m_vao.release();
 	}
 
@@ -113,18 +401,24 @@ void main(){
 layout(location=0) in vec2 aPos;
 void main(){ gl_Position = vec4(aPos, 0.0, 1.0); })";
 
-		static auto fs2 = R"(
-#version 330 core
+		static const QByteArray fs2 = QByteArray(R"(#version 330 core
 out vec4 FragColor;
 uniform vec2  uViewportSize;
 uniform vec4  uDstRectPx;
 uniform vec4  uSrcRectPx;
 uniform vec2  uTexSizePx;
 uniform vec4  uTint;
+uniform int   uSdf;
+uniform int   uMask;
+uniform int   uPremul;
 uniform sampler2D uTex;
-
+uniform vec4  uClipPx;
+uniform float uClipRadius;
+)") + kClipGlsl + R"(
 void main(){
     vec2 fragPx = vec2(gl_FragCoord.x, uViewportSize.y - gl_FragCoord.y);
+    float clipA = clipCoverage(fragPx, uClipPx, uClipRadius);
+    if (clipA <= 0.0) discard;
     vec2 dst0   = uDstRectPx.xy;
     vec2 dstSz  = uDstRectPx.zw;
     vec2 t      = (fragPx - dst0) / dstSz;  // 0..1
@@ -132,29 +426,288 @@ void main(){
     vec2 uv     = srcPx / uTexSizePx;
 
     vec4 texel = texture(uTex, uv);
-    FragColor  = texel * uTint;
+    // 单通道（R8）页：红色通道为覆盖率/距离，还原为白色蒙版
+    if (uMask != 0) texel = vec4(1.0, 1.0, 1.0, texel.r);
+    if (uSdf != 0) {
+        // 距离场：alpha=0.5为轮廓，按屏幕空间导数做一个像素宽的抗锯齿过渡
+        float w = max(fwidth(texel.a), 1e-4) * 0.5;
+        float a = smoothstep(0.5 - w, 0.5 + w, texel.a);
+        FragColor = vec4(uTint.rgb, uTint.a * a * clipA);
+    } else if (uPremul != 0) {
+        // 预乘纹理（离屏图层）：着色与剪裁覆盖率作用于全部通道
+        FragColor = texel * vec4(uTint.rgb * uTint.a, uTint.a) * clipA;
+    } else {
+        FragColor = texel * uTint;
+        FragColor.a *= clipA;
+    }
 })";
 
-		m_progTex = new QOpenGLShaderProgram();
-		m_progTex->addShaderFromSourceCode(QOpenGLShader::Vertex, vs2);
-		m_progTex->addShaderFromSourceCode(QOpenGLShader::Fragment, fs2);
-		m_progTex->link();
+		m_progTex = ShaderCache::instance().build(QStringLiteral("tex"), vs2, fs2);
+		if (linked(m_progTex, QStringLiteral("tex"), vs2, fs2)) {
+			m_texLocViewportSize = m_progTex->uniformLocation("uViewportSize");
+			m_texLocDstRect = m_progTex->uniformLocation("uDstRectPx");
+			m_texLocSrcRect = m_progTex->uniformLocation("uSrcRectPx");
+			m_texLocTexSize = m_progTex->uniformLocation("uTexSizePx");
+			m_texLocTint = m_progTex->uniformLocation("uTint");
+			m_texLocSampler = m_progTex->uniformLocation("uTex");
+			m_texLocSdf = m_progTex->uniformLocation("uSdf");
+			m_texLocMask = m_progTex->uniformLocation("uMask");
+			m_texLocPremul = m_progTex->uniformLocation("uPremul");
+			m_texLocClipPx = m_progTex->uniformLocation("uClipPx");
+			m_texLocClipRadius = m_progTex->uniformLocation("uClipRadius");
+		}
+	}
+
+	if (!m_progShadow) {
+		static auto vs5 = R"(#version 330 core
+layout(location=0) in vec2 aPos;
+void main(){ gl_Position = vec4(aPos, 0.0, 1.0); })";
+
+		static const QByteArray fs5 = QByteArray(R"(#version 330 core
+out vec4 FragColor;
+uniform vec2  uViewportSize;
+uniform vec4  uRectPx;
+uniform float uRadius;
+uniform float uSigma;
+uniform vec4  uColor;
+uniform vec4  uClipPx;
+uniform float uClipRadius;
+)") + kShadowGlsl + kClipGlsl + R"(
+void main(){
+    vec2 fragPx = vec2(gl_FragCoord.x, uViewportSize.y - gl_FragCoord.y);
+    float clipA = clipCoverage(fragPx, uClipPx, uClipRadius);
+    if (clipA <= 0.0) discard;
+    float a = shadowAlpha(uRectPx, uRadius, uSigma, fragPx);
+    FragColor = vec4(uColor.rgb, uColor.a * a * clipA);
+})";
 
-		m_texLocViewportSize = m_progTex->uniformLocation("uViewportSize");
-		m_texLocDstRect = m_progTex->uniformLocation("uDstRectPx");
-		m_texLocSrcRect = m_progTex->uniformLocation("uSrcRectPx");
-		m_texLocTexSize = m_progTex->uniformLocation("uTexSizePx");
-		m_texLocTint = m_progTex->uniformLocation("uTint");
-		m_texLocSampler = m_progTex->uniformLocation("uTex");
+		m_progShadow = ShaderCache::instance().build(QStringLiteral("shadow"), vs5, fs5);
+		if (linked(m_progShadow, QStringLiteral("shadow"), vs5, fs5)) {
+			m_shadowLocViewportSize = m_progShadow->uniformLocation("uViewportSize");
+			m_shadowLocRectPx = m_progShadow->uniformLocation("uRectPx");
+			m_shadowLocRadius = m_progShadow->uniformLocation("uRadius");
+			m_shadowLocSigma = m_progShadow->uniformLocation("uSigma");
+			m_shadowLocColor = m_progShadow->uniformLocation("uColor");
+			m_shadowLocClipPx = m_progShadow->uniformLocation("uClipPx");
+			m_shadowLocClipRadius = m_progShadow->uniformLocation("uClipRadius");
+		}
+	}
+
+	if (!m_progRectInst && m_glx) {
+		static auto vs3 = R"(#version 330 core
+layout(location=0) in vec2  aCorner;
+layout(location=1) in vec4  iRectPx;
+layout(location=2) in vec4  iClipPx;
+layout(location=3) in vec3  iParams;   // x: 圆角半径, y: 剪裁圆角半径, z: 描边宽度
+layout(location=4) in vec4  iColor;
+layout(location=5) in float iDepth;
+layout(location=6) in vec4  iStrokeColor;
+uniform vec2 uViewportSize;
+flat out vec4  vRectPx;
+flat out vec4  vClipPx;
+flat out vec3  vParams;
+flat out vec4  vColor;
+flat out vec4  vStrokeColor;
+void main(){
+    vec2 px = iRectPx.xy + aCorner * iRectPx.zw;
+    vec2 ndc = vec2(px.x / uViewportSize.x * 2.0 - 1.0, 1.0 - px.y / uViewportSize.y * 2.0);
+    vRectPx = iRectPx;
+    vClipPx = iClipPx;
+    vParams = iParams;
+    vColor  = iColor;
+    vStrokeColor = iStrokeColor;
+    gl_Position = vec4(ndc, iDepth, 1.0);
+})";
+
+		static const QByteArray fs3 = QByteArray(R"(#version 330 core
+out vec4 FragColor;
+uniform vec2 uViewportSize;
+flat in vec4  vRectPx;
+flat in vec4  vClipPx;
+flat in vec3  vParams;
+flat in vec4  vColor;
+flat in vec4  vStrokeColor;
+)") + kClipGlsl + kRectGlsl + R"(
+void main(){
+    vec2 fragPx = vec2(gl_FragCoord.x, uViewportSize.y - gl_FragCoord.y);
+    float clipA = clipCoverage(fragPx, vClipPx, vParams.y);
+    if (clipA <= 0.0) discard;
+    vec4 c = rectColor(fragPx, vRectPx, vParams.x, vColor, vParams.z, vStrokeColor);
+    FragColor = vec4(c.rgb, c.a * clipA);
+})";
+
+		static auto vs4 = R"(#version 330 core
+layout(location=0) in vec2  aCorner;
+layout(location=1) in vec4  iDstPx;
+layout(location=2) in vec4  iSrcPx;
+layout(location=3) in vec4  iClipPx;
+layout(location=4) in float iClipRadius;
+layout(location=5) in vec4  iTint;
+layout(location=6) in float iDepth;
+uniform vec2 uViewportSize;
+uniform vec2 uTexSizePx;
+out vec2 vUv;
+flat out vec4  vClipPx;
+flat out float vClipRadius;
+flat out vec4  vTint;
+void main(){
+    vec2 px = iDstPx.xy + aCorner * iDstPx.zw;
+    vUv   = (iSrcPx.xy + aCorner * iSrcPx.zw) / uTexSizePx;
+    vClipPx = iClipPx;
+    vClipRadius = iClipRadius;
+    vTint = iTint;
+    gl_Position = vec4(px.x / uViewportSize.x * 2.0 - 1.0, 1.0 - px.y / uViewportSize.y * 2.0, iDepth, 1.0);
+})";
+
+		static const QByteArray fs4 = QByteArray(R"(#version 330 core
+out vec4 FragColor;
+in vec2 vUv;
+flat in vec4  vClipPx;
+flat in float vClipRadius;
+flat in vec4  vTint;
+uniform vec2 uViewportSize;
+uniform int uSdf;
+uniform int uMask;
+uniform int uPremul;
+uniform sampler2D uTex;
+)") + kClipGlsl + R"(
+void main(){
+    vec2 fragPx = vec2(gl_FragCoord.x, uViewportSize.y - gl_FragCoord.y);
+    float clipA = clipCoverage(fragPx, vClipPx, vClipRadius);
+    if (clipA <= 0.0) discard;
+    vec4 texel = texture(uTex, vUv);
+    if (uMask != 0) texel = vec4(1.0, 1.0, 1.0, texel.r);
+    if (uSdf != 0) {
+        float w = max(fwidth(texel.a), 1e-4) * 0.5;
+        float a = smoothstep(0.5 - w, 0.5 + w, texel.a);
+        FragColor = vec4(vTint.rgb, vTint.a * a * clipA);
+    } else if (uPremul != 0) {
+        FragColor = texel * vec4(vTint.rgb * vTint.a, vTint.a) * clipA;
+    } else {
+        FragColor = texel * vTint;
+        FragColor.a *= clipA;
+    }
+})";
+
+		static auto vs6 = R"(#version 330 core
+layout(location=0) in vec2  aCorner;
+layout(location=1) in vec4  iRectPx;
+layout(location=2) in vec4  iClipPx;
+layout(location=3) in vec3  iParams;   // x: 圆角半径, y: 高斯σ, z: 剪裁圆角半径
+layout(location=4) in vec4  iColor;
+layout(location=5) in float iDepth;
+uniform vec2 uViewportSize;
+flat out vec4 vRectPx;
+flat out vec4 vClipPx;
+flat out vec3 vParams;
+flat out vec4 vColor;
+void main(){
+    float m = 3.0 * iParams.y + 1.0;
+    vec2 px = iRectPx.xy - vec2(m) + aCorner * (iRectPx.zw + vec2(2.0 * m));
+    vRectPx = iRectPx;
+    vClipPx = iClipPx;
+    vParams = iParams;
+    vColor  = iColor;
+    gl_Position = vec4(px.x / uViewportSize.x * 2.0 - 1.0, 1.0 - px.y / uViewportSize.y * 2.0, iDepth, 1.0);
+})";
+
+		static const QByteArray fs6 = QByteArray(R"(#version 330 core
+out vec4 FragColor;
+uniform vec2 uViewportSize;
+flat in vec4 vRectPx;
+flat in vec4 vClipPx;
+flat in vec3 vParams;
+flat in vec4 vColor;
+)") + kShadowGlsl + kClipGlsl + R"(
+void main(){
+    vec2 fragPx = vec2(gl_FragCoord.x, uViewportSize.y - gl_FragCoord.y);
+    float clipA = clipCoverage(fragPx, vClipPx, vParams.z);
+    if (clipA <= 0.0) discard;
+    float a = shadowAlpha(vRectPx, vParams.x, vParams.y, fragPx);
+    FragColor = vec4(vColor.rgb, vColor.a * a * clipA);
+})";
+
+		m_progRectInst = ShaderCache::instance().build(QStringLiteral("rectInst"), vs3, fs3);
+		m_progTexInst = ShaderCache::instance().build(QStringLiteral("texInst"), vs4, fs4);
+		m_progShadowInst = ShaderCache::instance().build(QStringLiteral("shadowInst"), vs6, fs6);
+
+		if (!m_progRectInst->isLinked() || !m_progTexInst->isLinked() || !m_progShadowInst->isLinked()) {
+			// 链接失败：仅保留逐命令路径
+			delete m_progRectInst;
+			m_progRectInst = nullptr;
+			delete m_progTexInst;
+			m_progTexInst = nullptr;
+			delete m_progShadowInst;
+			m_progShadowInst = nullptr;
+		}
+		else {
+			m_instLocViewportSize = m_progRectInst->uniformLocation("uViewportSize");
+			m_texInstLocViewportSize = m_progTexInst->uniformLocation("uViewportSize");
+			m_texInstLocTexSize = m_progTexInst->uniformLocation("uTexSizePx");
+			m_texInstLocSampler = m_progTexInst->uniformLocation("uTex");
+			m_texInstLocSdf = m_progTexInst->uniformLocation("uSdf");
+			m_texInstLocMask = m_progTexInst->uniformLocation("uMask");
+			m_texInstLocPremul = m_progTexInst->uniformLocation("uPremul");
+			m_shadowInstLocViewportSize = m_progShadowInst->uniformLocation("uViewportSize");
+
+			m_gl->glGenBuffers(1, &m_quadVbo);
+			m_gl->glBindBuffer(GL_ARRAY_BUFFER, m_quadVbo);
+			m_gl->glBufferData(GL_ARRAY_BUFFER, sizeof(kUnitQuad), kUnitQuad, GL_STATIC_DRAW);
+
+			// 各VAO共用单位四边形（location 0，逐顶点），其余location为逐实例属性
+			const auto setupVao = [this](QOpenGLVertexArrayObject& vao, const GLuint instanceAttribCount) {
+				vao.create();
+				vao.bind();
+				m_gl->glBindBuffer(GL_ARRAY_BUFFER, m_quadVbo);
+				m_gl->glEnableVertexAttribArray(0);
+				m_gl->glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+				for (GLuint loc = 1; loc <= instanceAttribCount; ++loc) {
+					m_gl->glEnableVertexAttribArray(loc);
+					m_glx->glVertexAttribDivisor(loc, 1);
+				}
+				vao.release();
+				};
+			setupVao(m_rectInstVao, 6);
+			setupVao(m_imgInstVao, 6);
+			setupVao(m_shadowInstVao, 5);
+		}
+	}
+
+	const ShaderCache::Stats cacheAfter = ShaderCache::instance().stats();
+	const int compiled = cacheAfter.compiles - cacheBefore.compiles;
+	const int cached = cacheAfter.memoryHits + cacheAfter.diskHits - cacheBefore.memoryHits - cacheBefore.diskHits;
+	if (compiled + cached > 0) {
+		qDebug() << "Renderer: shader programs ready in" << static_cast<double>(programClock.nsecsElapsed()) / 1.0e6
+			<< "ms, compiled" << compiled << "cached" << cached;
 	}
 }
 
 void Renderer::releaseGL()
 {
-	if (m_gl && m_vbo) { m_gl->glDeleteBuffers(1, &m_vbo); m_vbo = 0; }
+	if (m_gl) {
+		for (auto& [id, layer] : m_layers) releaseLayer(layer);
+	}
+	m_layers.clear();
+	m_layerPages.clear();
+	if (m_gl && m_quadVbo) { m_gl->glDeleteBuffers(1, &m_quadVbo); m_quadVbo = 0; }
+	m_stream.release();
+	if (m_glx && m_gpuQueries[0]) m_glx->glDeleteQueries(kGpuQueryCount, m_gpuQueries);
+	std::fill(std::begin(m_gpuQueries), std::end(m_gpuQueries), 0u);
+	std::fill(std::begin(m_gpuQueryPending), std::end(m_gpuQueryPending), false);
+	m_gpuQueryActive = false;
+	m_gpuTimingSupported = false;
+	m_gpuTiming = false;
 	if (m_progRect) { delete m_progRect; m_progRect = nullptr; }
 	if (m_progTex) { delete m_progTex; m_progTex = nullptr; }
+	if (m_progRectInst) { delete m_progRectInst; m_progRectInst = nullptr; }
+	if (m_progTexInst) { delete m_progTexInst; m_progTexInst = nullptr; }
+	if (m_progShadow) { delete m_progShadow; m_progShadow = nullptr; }
+	if (m_progShadowInst) { delete m_progShadowInst; m_progShadowInst = nullptr; }
 	if (m_vao.isCreated()) m_vao.destroy();
+	if (m_rectInstVao.isCreated()) m_rectInstVao.destroy();
+	if (m_imgInstVao.isCreated()) m_imgInstVao.destroy();
+	if (m_shadowInstVao.isCreated()) m_shadowInstVao.destroy();
+	m_glx = nullptr;
 }
 
 void Renderer::resize(const int fbWpx, const int fbHpx)
@@ -164,23 +717,21 @@ void Renderer::resize(const int fbWpx, const int fbHpx)
 	if (m_gl) m_gl->glViewport(0, 0, m_fbWpx, m_fbHpx);
 }
 
-void Renderer::applyClip(const QRectF& clipLogical)
+void Renderer::setScissorPx(const QRect& clipPxTopLeft)
 {
-	if (clipLogical.width() <= 0.0 || clipLogical.height() <= 0.0) {
-		restoreClip();
-		return;
-	}
-	m_clipPx = clipLogicalToPxTopLeft(clipLogical, m_currentDpr, m_fbWpx, m_fbHpx);
-	if (m_clipPx.width() <= 0 || m_clipPx.height() <= 0) {
-		restoreClip();
-		return;
-	}
+	if (m_clipActive && m_clipPx == clipPxTopLeft) return;
+	m_clipPx = clipPxTopLeft;
 	m_clipActive = true;
 	glScissorTopLeft(m_gl, m_clipPx, m_fbHpx);
 }
 
 void Renderer::restoreClip()
 {
+	if (!m_damagePx.isEmpty()) {
+		// 局部重绘期间"无剪裁"即剪裁到当前损坏区域
+		setScissorPx(m_damagePx);
+		return;
+	}
 	if (m_clipActive) {
 		m_gl->glDisable(GL_SCISSOR_TEST);
 		m_clipActive = false;
@@ -188,74 +739,898 @@ void Renderer::restoreClip()
 	}
 }
 
-void Renderer::drawRoundedRect(const Render::RoundedRectCmd& cmd)
+void Renderer::prepareImmediate(const Render::FrameData& fd, const IconResolver& iconCache)
 {
-	if (!m_progRect || !m_gl || m_fbWpx <= 0 || m_fbHpx <= 0) return;
+	// 整帧顶点按命令类型依次展开，一次写入流式缓冲；局部重绘的多个区域重放时复用
+	m_immVerts.clear();
+	m_immVerts.reserve((fd.roundedRects.size() + fd.shadows.size() + fd.images.size()) * 12);
+	const auto pushQuad = [this](const QRectF& rPx) {
+		const int first = static_cast<int>(m_immVerts.size() / 2);
+		float verts[12];
+		rectPxToNdcVerts(rPx, m_fbWpx, m_fbHpx, verts);
+		m_immVerts.insert(m_immVerts.end(), verts, verts + 12);
+		return first;
+	};
 
-	applyClip(cmd.clipRect);
+	m_immRectFirst.resize(fd.roundedRects.size());
+	for (std::size_t i = 0; i < fd.roundedRects.size(); ++i) {
+		m_immRectFirst[i] = m_culler.rectCulled(i) ? -1 : pushQuad(scaledRect(fd.roundedRects[i].rect, m_currentDpr));
+	}
 
-	const QRectF rp(cmd.rect.x() * m_currentDpr, cmd.rect.y() * m_currentDpr, cmd.rect.width() * m_currentDpr, cmd.rect.height() * m_currentDpr);
-	const float  rr = cmd.radiusPx * m_currentDpr;
+	m_immShadowFirst.resize(fd.shadows.size());
+	for (std::size_t i = 0; i < fd.shadows.size(); ++i) {
+		const auto& cmd = fd.shadows[i];
+		m_immShadowFirst[i] = -1;
+		if (m_culler.shadowCulled(i) || cmd.color.alpha() <= 0 || cmd.rect.width() <= 0.0 || cmd.rect.height() <= 0.0) continue;
+		const QRectF rp = scaledRect(cmd.rect, m_currentDpr);
+		m_immShadowFirst[i] = pushQuad(shadowBoundsPx(rp, shadowSigmaPx(cmd.blurPx, m_currentDpr)));
+	}
 
-	float verts[12];
-	rectPxToNdcVerts(rp, m_fbWpx, m_fbHpx, verts);
+	m_immImageFirst.resize(fd.images.size());
+	for (std::size_t i = 0; i < fd.images.size(); ++i) {
+		const auto& img = fd.images[i];
+		m_immImageFirst[i] = -1;
+		if (img.textureId == 0 || m_culler.imageCulled(i)) continue;
+		m_immImageFirst[i] = static_cast<int>(m_immVerts.size() / 2);
+		forEachImageQuad(img, iconCache, m_layerPages, m_currentDpr, [&pushQuad](const ImageQuad& q) { pushQuad(q.dstPx); });
+	}
 
+	m_prepared = true;
+	if (m_immVerts.empty()) return;
+	const qsizetype vertBytes = static_cast<qsizetype>(m_immVerts.size() * sizeof(float));
+	const qsizetype base = m_stream.reserve(StreamBuffer::alignedSize(vertBytes)) ? m_stream.write(m_immVerts.data(), vertBytes) : -1;
+	if (base < 0) {
+		// 顶点未能写入：属性指针仍指向上一批数据，本次不绘制
+		m_prepared = false;
+		++m_stats.streamOverflows;
+		return;
+	}
 	m_vao.bind();
-	m_gl->glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-	m_gl->glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(verts), verts);
+	m_gl->glBindBuffer(GL_ARRAY_BUFFER, m_stream.buffer());
+	m_gl->glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), reinterpret_cast<const void*>(static_cast<std::size_t>(base)));
+	m_vao.release();
+}
+
+void Renderer::drawRoundedRect(const Render::RoundedRectCmd& cmd, const Render::ClipRegion& clipRegion, const int firstVertex)
+{
+	if (!m_progRect || !m_gl || m_fbWpx <= 0 || m_fbHpx <= 0 || firstVertex < 0 || !cmd.visible()) return;
+
+	const ShaderClip clip = shaderClip(clipRegion, m_currentDpr, m_fbWpx, m_fbHpx);
+	if (!clip.visible) return;
+
+	const QRectF rp(cmd.rect.x() * m_currentDpr, cmd.rect.y() * m_currentDpr, cmd.rect.width() * m_currentDpr, cmd.rect.height() * m_currentDpr);
+	const float  rr = cmd.radiusPx * m_currentDpr;
 
+	m_vao.bind();
 	m_progRect->bind();
 	m_progRect->setUniformValue(m_locViewportSize, QVector2D(static_cast<float>(m_fbWpx), static_cast<float>(m_fbHpx)));
 	m_progRect->setUniformValue(m_locRectPx, QVector4D(static_cast<float>(rp.x()), static_cast<float>(rp.y()), static_cast<float>(rp.width()), static_cast<float>(rp.height())));
 	m_progRect->setUniformValue(m_locRadius, rr);
 	m_progRect->setUniformValue(m_locColor, QVector4D(cmd.color.redF(), cmd.color.greenF(), cmd.color.blueF(), cmd.color.alphaF()));
-	m_gl->glDrawArrays(GL_TRIANGLES, 0, 6);
+	m_progRect->setUniformValue(m_locClipPx, QVector4D(clip.px[0], clip.px[1], clip.px[2], clip.px[3]));
+	m_progRect->setUniformValue(m_locClipRadius, clip.radiusPx);
+	m_progRect->setUniformValue(m_locStrokeW, cmd.strokeWidthPx * m_currentDpr);
+	m_progRect->setUniformValue(m_locStrokeColor,
+		QVector4D(cmd.strokeColor.redF(), cmd.strokeColor.greenF(), cmd.strokeColor.blueF(), cmd.strokeColor.alphaF()));
+	m_gl->glDrawArrays(GL_TRIANGLES, firstVertex, 6);
+	++m_stats.drawCalls;
 	m_progRect->release();
 	m_vao.release();
-
-	restoreClip();
 }
 
-void Renderer::drawImage(const Render::ImageCmd& img, const IconCache& iconCache)
+void Renderer::drawShadow(const Render::ShadowCmd& cmd, const Render::ClipRegion& clipRegion, const int firstVertex)
 {
-	if (!m_progTex || !m_gl || img.textureId == 0 || m_fbWpx <= 0 || m_fbHpx <= 0) return;
+	if (!m_progShadow || !m_gl || m_fbWpx <= 0 || m_fbHpx <= 0 || firstVertex < 0) return;
 
-	applyClip(img.clipRect);
+	const ShaderClip clip = shaderClip(clipRegion, m_currentDpr, m_fbWpx, m_fbHpx);
+	if (!clip.visible) return;
 
-	const QRectF dstPx(img.dstRect.x() * m_currentDpr, img.dstRect.y() * m_currentDpr, img.dstRect.width() * m_currentDpr, img.dstRect.height() * m_currentDpr);
-
-	float verts[12];
-	rectPxToNdcVerts(dstPx, m_fbWpx, m_fbHpx, verts);
+	const QRectF rp(cmd.rect.x() * m_currentDpr, cmd.rect.y() * m_currentDpr, cmd.rect.width() * m_currentDpr, cmd.rect.height() * m_currentDpr);
+	const float sigma = shadowSigmaPx(cmd.blurPx, m_currentDpr);
 
 	m_vao.bind();
-	m_gl->glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-	m_gl->glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(verts), verts);
+	m_progShadow->bind();
+	m_progShadow->setUniformValue(m_shadowLocViewportSize, QVector2D(static_cast<float>(m_fbWpx), static_cast<float>(m_fbHpx)));
+	m_progShadow->setUniformValue(m_shadowLocRectPx, QVector4D(static_cast<float>(rp.x()), static_cast<float>(rp.y()), static_cast<float>(rp.width()), static_cast<float>(rp.height())));
+	m_progShadow->setUniformValue(m_shadowLocRadius, cmd.radiusPx * m_currentDpr);
+	m_progShadow->setUniformValue(m_shadowLocSigma, sigma);
+	m_progShadow->setUniformValue(m_shadowLocColor, QVector4D(cmd.color.redF(), cmd.color.greenF(), cmd.color.blueF(), cmd.color.alphaF()));
+	m_progShadow->setUniformValue(m_shadowLocClipPx, QVector4D(clip.px[0], clip.px[1], clip.px[2], clip.px[3]));
+	m_progShadow->setUniformValue(m_shadowLocClipRadius, clip.radiusPx);
+	m_gl->glDrawArrays(GL_TRIANGLES, firstVertex, 6);
+	++m_stats.drawCalls;
+	m_progShadow->release();
+	m_vao.release();
+}
+
+void Renderer::drawImage(const Render::ImageCmd& img, const Render::ClipRegion& clipRegion, const IconResolver& iconCache, const int firstVertex)
+{
+	if (!m_progTex || !m_gl || img.textureId == 0 || m_fbWpx <= 0 || m_fbHpx <= 0 || firstVertex < 0) return;
+
+	const ShaderClip clip = shaderClip(clipRegion, m_currentDpr, m_fbWpx, m_fbHpx);
+	if (!clip.visible) return;
 
+	// 展开顺序与prepareImmediate一致，第k个四边形位于 firstVertex + 6k
+	const QVector4D clipPx(clip.px[0], clip.px[1], clip.px[2], clip.px[3]);
+	int vertex = firstVertex;
+	forEachImageQuad(img, iconCache, m_layerPages, m_currentDpr, [this, &vertex, &clipPx, &clip](const ImageQuad& q) {
+		drawTexturedQuad(q.dstPx, q.srcPx, q.page, q.tint, clipPx, clip.radiusPx, vertex);
+		vertex += 6;
+	});
+}
+
+void Renderer::drawTexturedQuad(const QRectF& dstPx, const QRectF& srcPx, const IconCache::Region& page, const QColor& tint,
+	const QVector4D& clipPx, const float clipRadiusPx, const int firstVertex)
+{
+	m_vao.bind();
 	m_progTex->bind();
 	m_progTex->setUniformValue(m_texLocViewportSize, QVector2D(static_cast<float>(m_fbWpx), static_cast<float>(m_fbHpx)));
 	m_progTex->setUniformValue(m_texLocDstRect, QVector4D(static_cast<float>(dstPx.x()), static_cast<float>(dstPx.y()), static_cast<float>(dstPx.width()), static_cast<float>(dstPx.height())));
-	m_progTex->setUniformValue(m_texLocSrcRect, QVector4D(static_cast<float>(img.srcRectPx.x()), static_cast<float>(img.srcRectPx.y()),
-		static_cast<float>(img.srcRectPx.width()), static_cast<float>(img.srcRectPx.height())));
-	const QSize texSz = iconCache.textureSizePx(img.textureId);
-	m_progTex->setUniformValue(m_texLocTexSize, QVector2D(static_cast<float>(texSz.width()), static_cast<float>(texSz.height())));
-	m_progTex->setUniformValue(m_texLocTint, QVector4D(img.tint.redF(), img.tint.greenF(), img.tint.blueF(), img.tint.alphaF()));
+	m_progTex->setUniformValue(m_texLocSrcRect, QVector4D(static_cast<float>(srcPx.x()), static_cast<float>(srcPx.y()),
+		static_cast<float>(srcPx.width()), static_cast<float>(srcPx.height())));
+	m_progTex->setUniformValue(m_texLocTexSize, QVector2D(static_cast<float>(page.pageSizePx.width()), static_cast<float>(page.pageSizePx.height())));
+	m_progTex->setUniformValue(m_texLocTint, QVector4D(tint.redF(), tint.greenF(), tint.blueF(), tint.alphaF()));
 	m_progTex->setUniformValue(m_texLocSampler, 0);
+	m_progTex->setUniformValue(m_texLocSdf, page.sdf ? 1 : 0);
+	m_progTex->setUniformValue(m_texLocMask, page.mask ? 1 : 0);
+	m_progTex->setUniformValue(m_texLocPremul, page.premultiplied ? 1 : 0);
+	m_progTex->setUniformValue(m_texLocClipPx, clipPx);
+	m_progTex->setUniformValue(m_texLocClipRadius, clipRadiusPx);
 
+	if (page.premultiplied) applyBlend(true);
 	m_gl->glActiveTexture(GL_TEXTURE0);
-	m_gl->glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(img.textureId));
-	m_gl->glDrawArrays(GL_TRIANGLES, 0, 6);
+	m_gl->glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(page.textureId));
+	m_gl->glDrawArrays(GL_TRIANGLES, firstVertex, 6);
+	++m_stats.drawCalls;
 	m_gl->glBindTexture(GL_TEXTURE_2D, 0);
+	if (page.premultiplied) applyBlend(false);
 
 	m_progTex->release();
 	m_vao.release();
+}
 
-	restoreClip();
+const std::vector<Render::CmdRef>& Renderer::drawOrder(const Render::FrameData& fd)
+{
+	if (fd.hasOrderedStream()) return fd.commands;
+
+	// 兼容直接写入类型数组的旧代码：按"先投影、再矩形、后图像"构造顺序
+	m_fallbackOrder.clear();
+	m_fallbackOrder.reserve(fd.shadows.size() + fd.roundedRects.size() + fd.images.size());
+	for (std::size_t i = 0; i < fd.shadows.size(); ++i)
+		m_fallbackOrder.push_back(Render::CmdRef{ Render::CmdType::Shadow, static_cast<std::uint32_t>(i) });
+	for (std::size_t i = 0; i < fd.roundedRects.size(); ++i)
+		m_fallbackOrder.push_back(Render::CmdRef{ Render::CmdType::RoundedRect, static_cast<std::uint32_t>(i) });
+	for (std::size_t i = 0; i < fd.images.size(); ++i)
+		m_fallbackOrder.push_back(Render::CmdRef{ Render::CmdType::Image, static_cast<std::uint32_t>(i) });
+	return m_fallbackOrder;
+}
+
+void Renderer::drawFrameImmediate(const Render::FrameData& fd, const std::vector<Render::CmdRef>& order, const IconResolver& iconCache)
+{
+	if (!m_prepared) return;
+	for (const auto& ref : order) {
+		switch (ref.type) {
+		case Render::CmdType::RoundedRect: {
+			const auto& cmd = fd.roundedRects[ref.index];
+			drawRoundedRect(cmd, fd.clip(cmd.clip), m_immRectFirst[ref.index]);
+			break;
+		}
+		case Render::CmdType::Image: {
+			const auto& img = fd.images[ref.index];
+			drawImage(img, fd.clip(img.clip), iconCache, m_immImageFirst[ref.index]);
+			break;
+		}
+		case Render::CmdType::Shadow: {
+			const auto& cmd = fd.shadows[ref.index];
+			drawShadow(cmd, fd.clip(cmd.clip), m_immShadowFirst[ref.index]);
+			break;
+		}
+		}
+	}
+}
+
+void Renderer::packRectInstances(const Render::FrameData& fd)
+{
+	const auto& cmds = fd.roundedRects;
+	// 逻辑像素 -> 设备像素；剪裁作为逐实例属性，由着色器逐片段完成
+	m_rectInstances.clear();
+	m_rectInstances.reserve(cmds.size());
+	m_rectSlots.resize(cmds.size() + 1);
+	m_opaqueInstances.clear();
+
+	for (std::size_t i = 0; i < cmds.size(); ++i) {
+		const auto& cmd = cmds[i];
+		m_rectSlots[i] = static_cast<qsizetype>(m_rectInstances.size());
+		if (m_culler.rectCulled(i) || !cmd.visible() || cmd.rect.width() <= 0.0 || cmd.rect.height() <= 0.0) continue;
+
+		const ShaderClip clip = shaderClip(fd.clip(cmd.clip), m_currentDpr, m_fbWpx, m_fbHpx);
+		if (!clip.visible) continue;  // 剪裁区域完全在帧缓冲之外
+
+		RectInstance inst{};
+		std::copy(std::begin(clip.px), std::end(clip.px), inst.clipPx);
+		inst.clipRadiusPx = clip.radiusPx;
+		inst.rectPx[0] = static_cast<float>(cmd.rect.x() * m_currentDpr);
+		inst.rectPx[1] = static_cast<float>(cmd.rect.y() * m_currentDpr);
+		inst.rectPx[2] = static_cast<float>(cmd.rect.width() * m_currentDpr);
+		inst.rectPx[3] = static_cast<float>(cmd.rect.height() * m_currentDpr);
+		inst.radiusPx = cmd.radiusPx * m_currentDpr;
+		inst.color[0] = static_cast<uchar>(cmd.color.red());
+		inst.color[1] = static_cast<uchar>(cmd.color.green());
+		inst.color[2] = static_cast<uchar>(cmd.color.blue());
+		inst.color[3] = static_cast<uchar>(cmd.color.alpha());
+		inst.strokeWidthPx = std::max(0.0f, cmd.strokeWidthPx) * m_currentDpr;
+		inst.strokeColor[0] = static_cast<uchar>(cmd.strokeColor.red());
+		inst.strokeColor[1] = static_cast<uchar>(cmd.strokeColor.green());
+		inst.strokeColor[2] = static_cast<uchar>(cmd.strokeColor.blue());
+		inst.strokeColor[3] = static_cast<uchar>(cmd.strokeColor.alpha());
+		inst.depth = m_rectDepth.empty() ? 0.0f : m_rectDepth[i];
+		m_rectInstances.push_back(inst);
+
+		// 不透明命令的内部进入预通道：直角、无剪裁，比命令自身略近，使其混合绘制只剩边缘一圈；
+		// 有描边时只取描边以内的填充区域（描边留给混合绘制）
+		if (m_rectDepth.empty() || cmd.color.alpha() < 255) continue;
+		const float sw = inst.strokeWidthPx;
+		const QRect in = opaqueInteriorPx(QRectF(inst.rectPx[0] + sw, inst.rectPx[1] + sw, inst.rectPx[2] - 2.0f * sw, inst.rectPx[3] - 2.0f * sw),
+			std::max(0.0f, inst.radiusPx - sw), clip, m_fbWpx, m_fbHpx);
+		if (in.isEmpty()) continue;
+		RectInstance opaque{};
+		opaque.rectPx[0] = static_cast<float>(in.x());
+		opaque.rectPx[1] = static_cast<float>(in.y());
+		opaque.rectPx[2] = static_cast<float>(in.width());
+		opaque.rectPx[3] = static_cast<float>(in.height());
+		std::copy(std::begin(inst.color), std::end(inst.color), opaque.color);
+		opaque.depth = inst.depth - m_depthHalfStep;
+		m_opaqueInstances.push_back(opaque);
+		m_stats.opaquePixels += static_cast<qint64>(in.width()) * in.height();
+	}
+	m_rectSlots[cmds.size()] = static_cast<qsizetype>(m_rectInstances.size());
+
+	// 由近及远：先画的内部写入深度后，被它挡住的更远内部在着色前即被拒绝
+	std::sort(m_opaqueInstances.begin(), m_opaqueInstances.end(),
+		[](const RectInstance& a, const RectInstance& b) { return a.depth < b.depth; });
+	m_stats.opaqueRects += static_cast<int>(m_opaqueInstances.size());
+}
+
+void Renderer::packShadowInstances(const Render::FrameData& fd)
+{
+	const auto& cmds = fd.shadows;
+	m_shadowInstances.clear();
+	m_shadowInstances.reserve(cmds.size());
+	m_shadowSlots.resize(cmds.size() + 1);
+
+	for (std::size_t i = 0; i < cmds.size(); ++i) {
+		const auto& cmd = cmds[i];
+		m_shadowSlots[i] = static_cast<qsizetype>(m_shadowInstances.size());
+		if (m_culler.shadowCulled(i) || cmd.color.alpha() <= 0 || cmd.rect.width() <= 0.0 || cmd.rect.height() <= 0.0) continue;
+
+		const ShaderClip clip = shaderClip(fd.clip(cmd.clip), m_currentDpr, m_fbWpx, m_fbHpx);
+		if (!clip.visible) continue;
+
+		ShadowInstance inst{};
+		std::copy(std::begin(clip.px), std::end(clip.px), inst.clipPx);
+		inst.clipRadiusPx = clip.radiusPx;
+		inst.rectPx[0] = static_cast<float>(cmd.rect.x() * m_currentDpr);
+		inst.rectPx[1] = static_cast<float>(cmd.rect.y() * m_currentDpr);
+		inst.rectPx[2] = static_cast<float>(cmd.rect.width() * m_currentDpr);
+		inst.rectPx[3] = static_cast<float>(cmd.rect.height() * m_currentDpr);
+		inst.radiusPx = cmd.radiusPx * m_currentDpr;
+		inst.sigmaPx = shadowSigmaPx(cmd.blurPx, m_currentDpr);
+		inst.color[0] = static_cast<uchar>(cmd.color.red());
+		inst.color[1] = static_cast<uchar>(cmd.color.green());
+		inst.color[2] = static_cast<uchar>(cmd.color.blue());
+		inst.color[3] = static_cast<uchar>(cmd.color.alpha());
+		inst.depth = m_shadowDepth.empty() ? 0.0f : m_shadowDepth[i];
+		m_shadowInstances.push_back(inst);
+	}
+	m_shadowSlots[cmds.size()] = static_cast<qsizetype>(m_shadowInstances.size());
+}
+
+void Renderer::packImageInstances(const Render::FrameData& fd, const IconResolver& iconCache)
+{
+	const auto& cmds = fd.images;
+	m_imageInstances.clear();
+	m_imageInstances.reserve(cmds.size());
+	m_imageInstPages.clear();
+	m_imageInstPages.reserve(cmds.size());
+	m_imageSlots.resize(cmds.size() + 1);
+
+	for (std::size_t i = 0; i < cmds.size(); ++i) {
+		const auto& img = cmds[i];
+		m_imageSlots[i] = static_cast<qsizetype>(m_imageInstances.size());
+		if (img.textureId == 0 || m_culler.imageCulled(i) || img.tint.alpha() <= 0 || img.dstRect.width() <= 0.0 || img.dstRect.height() <= 0.0) continue;
+
+		const ShaderClip clip = shaderClip(fd.clip(img.clip), m_currentDpr, m_fbWpx, m_fbHpx);
+		if (!clip.visible) continue;
+
+		// 一条命令可展开为多个实例（文本按字形展开）；各实例记录所在图集页作为批次拆分依据
+		const float depth = m_imageDepth.empty() ? 0.0f : m_imageDepth[i];
+		forEachImageQuad(img, iconCache, m_layerPages, m_currentDpr, [this, &clip, depth](const ImageQuad& q) {
+			ImageInstance inst{};
+			std::copy(std::begin(clip.px), std::end(clip.px), inst.clipPx);
+			inst.clipRadiusPx = clip.radiusPx;
+			inst.dstPx[0] = static_cast<float>(q.dstPx.x());
+			inst.dstPx[1] = static_cast<float>(q.dstPx.y());
+			inst.dstPx[2] = static_cast<float>(q.dstPx.width());
+			inst.dstPx[3] = static_cast<float>(q.dstPx.height());
+			inst.srcPx[0] = static_cast<float>(q.srcPx.x());
+			inst.srcPx[1] = static_cast<float>(q.srcPx.y());
+			inst.srcPx[2] = static_cast<float>(q.srcPx.width());
+			inst.srcPx[3] = static_cast<float>(q.srcPx.height());
+			inst.tint[0] = static_cast<uchar>(q.tint.red());
+			inst.tint[1] = static_cast<uchar>(q.tint.green());
+			inst.tint[2] = static_cast<uchar>(q.tint.blue());
+			inst.tint[3] = static_cast<uchar>(q.tint.alpha());
+			inst.depth = depth;
+			m_imageInstances.push_back(inst);
+			m_imageInstPages.push_back(q.page);
+		});
+	}
+	m_imageSlots[cmds.size()] = static_cast<qsizetype>(m_imageInstances.size());
 }
 
-void Renderer::drawFrame(const Render::FrameData& fd, const IconCache& iconCache, const float devicePixelRatio)
+void Renderer::setRectInstanceAttribs(const qsizetype baseBytes, const qsizetype firstInstance)
+{
+	// 实例属性指针以本帧数据在流式缓冲中的偏移 + firstInstance为起点，使任意连续区间可单独绘制
+	const auto base = static_cast<std::size_t>(baseBytes) + static_cast<std::size_t>(firstInstance) * sizeof(RectInstance);
+	const auto ptr = [base](const std::size_t off) { return reinterpret_cast<const void*>(base + off); };
+	constexpr auto stride = static_cast<GLsizei>(sizeof(RectInstance));
+
+	m_gl->glBindBuffer(GL_ARRAY_BUFFER, m_stream.buffer());
+	m_gl->glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, ptr(offsetof(RectInstance, rectPx)));
+	m_gl->glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, ptr(offsetof(RectInstance, clipPx)));
+	m_gl->glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, ptr(offsetof(RectInstance, radiusPx)));
+	m_gl->glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, ptr(offsetof(RectInstance, color)));
+	m_gl->glVertexAttribPointer(5, 1, GL_FLOAT, GL_FALSE, stride, ptr(offsetof(RectInstance, depth)));
+	m_gl->glVertexAttribPointer(6, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, ptr(offsetof(RectInstance, strokeColor)));
+}
+
+void Renderer::setImageInstanceAttribs(const qsizetype firstInstance)
+{
+	const auto base = static_cast<std::size_t>(m_imgInstBase) + static_cast<std::size_t>(firstInstance) * sizeof(ImageInstance);
+	const auto ptr = [base](const std::size_t off) { return reinterpret_cast<const void*>(base + off); };
+	constexpr auto stride = static_cast<GLsizei>(sizeof(ImageInstance));
+
+	m_gl->glBindBuffer(GL_ARRAY_BUFFER, m_stream.buffer());
+	m_gl->glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, ptr(offsetof(ImageInstance, dstPx)));
+	m_gl->glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, ptr(offsetof(ImageInstance, srcPx)));
+	m_gl->glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, ptr(offsetof(ImageInstance, clipPx)));
+	m_gl->glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, stride, ptr(offsetof(ImageInstance, clipRadiusPx)));
+	m_gl->glVertexAttribPointer(5, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, ptr(offsetof(ImageInstance, tint)));
+	m_gl->glVertexAttribPointer(6, 1, GL_FLOAT, GL_FALSE, stride, ptr(offsetof(ImageInstance, depth)));
+}
+
+void Renderer::setShadowInstanceAttribs(const qsizetype firstInstance)
+{
+	const auto base = static_cast<std::size_t>(m_shadowInstBase) + static_cast<std::size_t>(firstInstance) * sizeof(ShadowInstance);
+	const auto ptr = [base](const std::size_t off) { return reinterpret_cast<const void*>(base + off); };
+	constexpr auto stride = static_cast<GLsizei>(sizeof(ShadowInstance));
+
+	m_gl->glBindBuffer(GL_ARRAY_BUFFER, m_stream.buffer());
+	m_gl->glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, ptr(offsetof(ShadowInstance, rectPx)));
+	m_gl->glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, ptr(offsetof(ShadowInstance, clipPx)));
+	m_gl->glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, ptr(offsetof(ShadowInstance, radiusPx)));
+	m_gl->glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, ptr(offsetof(ShadowInstance, color)));
+	m_gl->glVertexAttribPointer(5, 1, GL_FLOAT, GL_FALSE, stride, ptr(offsetof(ShadowInstance, depth)));
+}
+
+void Renderer::drawRectRange(const qsizetype firstInstance, const qsizetype count)
+{
+	if (count <= 0) return;
+
+	m_rectInstVao.bind();
+	setRectInstanceAttribs(m_rectInstBase, firstInstance);
+	m_progRectInst->bind();
+	m_progRectInst->setUniformValue(m_instLocViewportSize, QVector2D(static_cast<float>(m_fbWpx), static_cast<float>(m_fbHpx)));
+	m_glx->glDrawArraysInstanced(GL_TRIANGLES, 0, 6, static_cast<GLsizei>(count));
+	++m_stats.drawCalls;
+	m_progRectInst->release();
+	m_rectInstVao.release();
+}
+
+void Renderer::drawShadowRange(const qsizetype firstInstance, const qsizetype count)
+{
+	if (count <= 0) return;
+
+	m_shadowInstVao.bind();
+	setShadowInstanceAttribs(firstInstance);
+	m_progShadowInst->bind();
+	m_progShadowInst->setUniformValue(m_shadowInstLocViewportSize, QVector2D(static_cast<float>(m_fbWpx), static_cast<float>(m_fbHpx)));
+	m_glx->glDrawArraysInstanced(GL_TRIANGLES, 0, 6, static_cast<GLsizei>(count));
+	++m_stats.drawCalls;
+	m_progShadowInst->release();
+	m_shadowInstVao.release();
+}
+
+void Renderer::drawImageRange(const qsizetype firstInstance, const qsizetype count, const IconCache::Region& page)
+{
+	if (count <= 0) return;
+
+	const QSize texSz = page.pageSizePx;
+	m_imgInstVao.bind();
+	setImageInstanceAttribs(firstInstance);
+	m_progTexInst->bind();
+	m_progTexInst->setUniformValue(m_texInstLocViewportSize, QVector2D(static_cast<float>(m_fbWpx), static_cast<float>(m_fbHpx)));
+	m_progTexInst->setUniformValue(m_texInstLocTexSize, QVector2D(static_cast<float>(std::max(1, texSz.width())), static_cast<float>(std::max(1, texSz.height()))));
+	m_progTexInst->setUniformValue(m_texInstLocSampler, 0);
+	m_progTexInst->setUniformValue(m_texInstLocSdf, page.sdf ? 1 : 0);
+	m_progTexInst->setUniformValue(m_texInstLocMask, page.mask ? 1 : 0);
+	m_progTexInst->setUniformValue(m_texInstLocPremul, page.premultiplied ? 1 : 0);
+
+	if (page.premultiplied) applyBlend(true);
+	m_gl->glActiveTexture(GL_TEXTURE0);
+	m_gl->glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(page.textureId));
+	m_glx->glDrawArraysInstanced(GL_TRIANGLES, 0, 6, static_cast<GLsizei>(count));
+	++m_stats.drawCalls;
+	m_gl->glBindTexture(GL_TEXTURE_2D, 0);
+	if (page.premultiplied) applyBlend(false);
+
+	m_progTexInst->release();
+	m_imgInstVao.release();
+}
+
+void Renderer::prepareBatched(const Render::FrameData& fd, const IconResolver& iconCache)
+{
+	// 打包并一次性写入整帧实例数据（按类型数组顺序，即各类型内的命令流顺序）
+	packRectInstances(fd);
+	packImageInstances(fd, iconCache);
+	packShadowInstances(fd);
+	const qsizetype rectBytes = static_cast<qsizetype>(m_rectInstances.size() * sizeof(RectInstance));
+	const qsizetype imgBytes = static_cast<qsizetype>(m_imageInstances.size() * sizeof(ImageInstance));
+	const qsizetype shadowBytes = static_cast<qsizetype>(m_shadowInstances.size() * sizeof(ShadowInstance));
+	const qsizetype opaqueBytes = static_cast<qsizetype>(m_opaqueInstances.size() * sizeof(RectInstance));
+	// 先按整帧总量预留：扩容会孤立存储，只能发生在本帧首次写入之前
+	m_prepared = m_stream.reserve(StreamBuffer::alignedSize(rectBytes) + StreamBuffer::alignedSize(imgBytes)
+		+ StreamBuffer::alignedSize(shadowBytes) + StreamBuffer::alignedSize(opaqueBytes));
+	// 空数组不写入（偏移不会被使用）；任一数组写入失败时整批不绘制，而不是按偏移0读到别的数据
+	const auto write = [this](const void* data, const qsizetype bytes) {
+		if (!m_prepared || bytes <= 0) return qsizetype(0);
+		const qsizetype base = m_stream.write(data, bytes);
+		if (base < 0) m_prepared = false;
+		return base;
+	};
+	m_rectInstBase = write(m_rectInstances.data(), rectBytes);
+	m_imgInstBase = write(m_imageInstances.data(), imgBytes);
+	m_shadowInstBase = write(m_shadowInstances.data(), shadowBytes);
+	m_opaqueInstBase = write(m_opaqueInstances.data(), opaqueBytes);
+	if (!m_prepared) ++m_stats.streamOverflows;
+}
+
+bool Renderer::targetHasDepth() const
+{
+	if (!m_gl || !m_glx) return false;
+	GLint fbo = 0;
+	m_gl->glGetIntegerv(GL_FRAMEBUFFER_BINDING, &fbo);
+	const GLenum attachment = fbo ? GL_DEPTH_ATTACHMENT : GL_DEPTH;
+	GLint type = GL_NONE;
+	m_gl->glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &type);
+	if (type == GL_NONE) return false;
+	GLint bits = 0;
+	m_gl->glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE, &bits);
+	return bits >= 16;
+}
+
+void Renderer::assignDepths(const Render::FrameData& fd, const std::vector<Render::CmdRef>& order)
+{
+	if (!m_depthTarget) {
+		m_rectDepth.clear();
+		m_imageDepth.clear();
+		m_shadowDepth.clear();
+		return;
+	}
+
+	// 命令流第k条 -> 1 - 2(k+1)/(n+1)：越靠后越近，全部落在(-1, 1)内，清除值（最远）之前
+	m_rectDepth.assign(fd.roundedRects.size(), 1.0f);
+	m_imageDepth.assign(fd.images.size(), 1.0f);
+	m_shadowDepth.assign(fd.shadows.size(), 1.0f);
+	const float step = 2.0f / static_cast<float>(order.size() + 1);
+	m_depthHalfStep = 0.5f * step;
+	for (std::size_t k = 0; k < order.size(); ++k) {
+		const float z = 1.0f - step * static_cast<float>(k + 1);
+		const Render::CmdRef& ref = order[k];
+		switch (ref.type) {
+		case Render::CmdType::RoundedRect: m_rectDepth[ref.index] = z; break;
+		case Render::CmdType::Image:       m_imageDepth[ref.index] = z; break;
+		case Render::CmdType::Shadow:      m_shadowDepth[ref.index] = z; break;
+		}
+	}
+}
+
+void Renderer::drawOpaquePass()
+{
+	// 深度清除与绘制一样受损坏区域剪裁约束
+	m_gl->glDepthMask(GL_TRUE);
+	m_gl->glClearDepthf(1.0f);
+	m_gl->glClear(GL_DEPTH_BUFFER_BIT);
+	m_gl->glEnable(GL_DEPTH_TEST);
+	m_gl->glDepthFunc(GL_LESS);
+	m_gl->glDisable(GL_BLEND);
+
+	m_rectInstVao.bind();
+	setRectInstanceAttribs(m_opaqueInstBase, 0);
+	m_progRectInst->bind();
+	m_progRectInst->setUniformValue(m_instLocViewportSize, QVector2D(static_cast<float>(m_fbWpx), static_cast<float>(m_fbHpx)));
+	m_glx->glDrawArraysInstanced(GL_TRIANGLES, 0, 6, static_cast<GLsizei>(m_opaqueInstances.size()));
+	++m_stats.drawCalls;
+	m_progRectInst->release();
+	m_rectInstVao.release();
+
+	// 之后的混合绘制只测试不写入：被更晚的不透明内部覆盖的片段（含不透明命令自身的内部）在着色前被拒绝
+	m_gl->glEnable(GL_BLEND);
+	m_gl->glDepthMask(GL_FALSE);
+}
+
+void Renderer::drawFrameBatched(const std::vector<Render::CmdRef>& order)
+{
+	if (m_fbWpx <= 0 || m_fbHpx <= 0 || !m_prepared) return;
+
+	const bool opaquePass = !m_opaqueInstances.empty();
+	if (opaquePass) drawOpaquePass();
+
+	// 按命令流顺序遍历，相邻且状态兼容的命令合并为一个批次：
+	//    - 剪裁是逐实例属性（着色器中完成），不同剪裁的命令也可合并
+	//    - 圆角矩形、投影：同类相邻命令总可合并
+	//    - 图像：同类相邻命令合并为一段，段内再按实例所在图集页（GL纹理）拆分
+	const std::size_t n = order.size();
+	std::size_t i = 0;
+	while (i < n) {
+		const Render::CmdRef head = order[i];
+		std::size_t j = i + 1;
+		std::uint32_t last = head.index;
+
+		if (head.type == Render::CmdType::RoundedRect) {
+			while (j < n && order[j].type == Render::CmdType::RoundedRect && order[j].index == last + 1) {
+				last = order[j].index;
+				++j;
+			}
+			const qsizetype first = m_rectSlots[head.index];
+			drawRectRange(first, m_rectSlots[last + 1] - first);
+		}
+		else if (head.type == Render::CmdType::Shadow) {
+			while (j < n && order[j].type == Render::CmdType::Shadow && order[j].index == last + 1) {
+				last = order[j].index;
+				++j;
+			}
+			const qsizetype first = m_shadowSlots[head.index];
+			drawShadowRange(first, m_shadowSlots[last + 1] - first);
+		}
+		else {
+			while (j < n && order[j].type == Render::CmdType::Image && order[j].index == last + 1) {
+				last = order[j].index;
+				++j;
+			}
+			const qsizetype end = m_imageSlots[last + 1];
+			qsizetype first = m_imageSlots[head.index];
+			while (first < end) {
+				const int tex = m_imageInstPages[first].textureId;
+				qsizetype stop = first + 1;
+				while (stop < end && m_imageInstPages[stop].textureId == tex) ++stop;
+				drawImageRange(first, stop - first, m_imageInstPages[first]);
+				first = stop;
+			}
+		}
+		i = j;
+	}
+
+	if (opaquePass) {
+		m_gl->glDisable(GL_DEPTH_TEST);
+		m_gl->glDepthMask(GL_TRUE);
+	}
+}
+
+bool Renderer::beginFrame(const Render::FrameData& fd, const float devicePixelRatio)
 {
 	m_currentDpr = std::max(0.5f, devicePixelRatio);
+	m_stats = FrameStats{};
+	m_stats.rectCount = static_cast<int>(fd.roundedRects.size());
+	m_stats.imageCount = static_cast<int>(fd.images.size());
+	m_stats.shadowCount = static_cast<int>(fd.shadows.size());
+	m_stats.layerCount = static_cast<int>(fd.layers.size());
+	++m_frameSerial;
+	m_stream.beginFrame();
+	beginGpuTimer();
 
-	for (const auto& rr : fd.roundedRects) drawRoundedRect(rr);
-	for (const auto& im : fd.images)       drawImage(im, iconCache);
+	const bool batched = batchedAvailable();
+	m_depthTarget = batched && m_opaquePass && targetHasDepth();
+	return batched;
+}
+
+bool Renderer::batchedAvailable() const noexcept
+{
+	return m_submitPath == SubmitPath::Batched && m_progRectInst && m_progTexInst && m_progShadowInst && m_glx;
+}
+
+void Renderer::applyBlend(const bool premultiplied)
+{
+	if (premultiplied) {
+		m_gl->glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	}
+	else if (m_layerDepth > 0) {
+		// 图层内：颜色按alpha混合、alpha按覆盖率累积，纹理中即为预乘颜色
+		m_gl->glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	}
+	else {
+		// 窗口约定的混合方式（MainOpenGlWindow与PopupOverlay初始化时设置）
+		m_gl->glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	}
+}
+
+void Renderer::updateLayers(const Render::FrameData& fd, const IconResolver& iconCache)
+{
+	for (const auto& def : fd.layers) {
+		if (def.id <= 0 || !def.content || def.bounds.width() <= 0.0 || def.bounds.height() <= 0.0) continue;
+		Layer& layer = m_layers[def.id];  // unordered_map：嵌套递归插入不会使引用失效
+		if (layer.lastFrame == m_frameSerial && layer.texture) continue;  // 同一帧内被多个切片重复引用
+		layer.lastFrame = m_frameSerial;
+
+		const float scale = layerScale(def);
+		if (layerStale(layer, def, scale)) {
+			updateLayers(*def.content, iconCache);  // 嵌套图层先于外层绘制
+			if (!renderLayer(layer, def, scale, iconCache)) {
+				m_layerPages.remove(Render::layerTextureId(def.id));
+				continue;
+			}
+		}
+		m_layerPages.insert(Render::layerTextureId(def.id), IconCache::Region{
+			.textureId = static_cast<int>(layer.texture), .pageSizePx = layer.sizePx, .srcScale = layer.scale, .premultiplied = true });
+	}
+}
+
+float Renderer::layerScale(const Render::LayerDef& def) const
+{
+	// 超出纹理尺寸上限时降低图层分辨率（合成时按srcScale还原到目标尺寸）
+	const qreal maxSide = std::max(def.bounds.width(), def.bounds.height());
+	return std::min(m_currentDpr, static_cast<float>(m_maxTextureSize / maxSide));
+}
+
+bool Renderer::layerStale(const Layer& layer, const Render::LayerDef& def, const float scale)
+{
+	return !layer.texture || layer.version != def.version || layer.bounds != def.bounds || layer.scale != scale;
+}
+
+qsizetype Renderer::frameStreamBytes(const Render::FrameData& fd, const IconResolver& iconCache, const bool batched)
+{
+	qsizetype imageQuads = 0;
+	for (const auto& img : fd.images) imageQuads += imageQuadBound(img, iconCache);
+	if (batched) {
+		// 不透明内部最多每个矩形一个
+		const qsizetype rectBytes = StreamBuffer::alignedSize(static_cast<qsizetype>(fd.roundedRects.size() * sizeof(RectInstance)));
+		return 2 * rectBytes
+			+ StreamBuffer::alignedSize(imageQuads * static_cast<qsizetype>(sizeof(ImageInstance)))
+			+ StreamBuffer::alignedSize(static_cast<qsizetype>(fd.shadows.size() * sizeof(ShadowInstance)));
+	}
+	const qsizetype quads = static_cast<qsizetype>(fd.roundedRects.size() + fd.shadows.size()) + imageQuads;
+	return StreamBuffer::alignedSize(quads * 12 * static_cast<qsizetype>(sizeof(float)));
+}
+
+qsizetype Renderer::layerStreamBytes(const Render::FrameData& fd, const IconResolver& iconCache, const bool batched,
+	std::vector<int>& seen) const
+{
+	qsizetype total = 0;
+	for (const auto& def : fd.layers) {
+		if (def.id <= 0 || !def.content || def.bounds.width() <= 0.0 || def.bounds.height() <= 0.0) continue;
+		if (std::find(seen.begin(), seen.end(), def.id) != seen.end()) continue;
+		seen.push_back(def.id);
+		const auto it = m_layers.find(def.id);
+		if (it != m_layers.end() && !layerStale(it->second, def, layerScale(def))) continue;
+		total += layerStreamBytes(*def.content, iconCache, batched, seen) + frameStreamBytes(*def.content, iconCache, batched);
+	}
+	return total;
+}
+
+void Renderer::reserveFrameStream(const Render::FrameData& fd, const IconResolver& iconCache, const bool batched)
+{
+	// 重绘的图层与主帧先后写入同一流式缓冲，扩容只能发生在本帧首次写入之前：按总量一次预留
+	std::vector<int> seen;
+	m_stream.reserve(layerStreamBytes(fd, iconCache, batched, seen) + frameStreamBytes(fd, iconCache, batched));
+}
+
+bool Renderer::renderLayer(Layer& layer, const Render::LayerDef& def, const float scale, const IconResolver& iconCache)
+{
+	const QSize sizePx(std::max(1, static_cast<int>(std::ceil(def.bounds.width() * scale))),
+		std::max(1, static_cast<int>(std::ceil(def.bounds.height() * scale))));
+	if (!layer.texture || layer.sizePx != sizePx) {
+		if (!layer.texture) {
+			m_gl->glGenTextures(1, &layer.texture);
+			m_gl->glGenFramebuffers(1, &layer.fbo);
+		}
+		m_gl->glBindTexture(GL_TEXTURE_2D, layer.texture);
+		m_gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, sizePx.width(), sizePx.height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		m_gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		m_gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		m_gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		m_gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		m_gl->glBindTexture(GL_TEXTURE_2D, 0);
+		layer.sizePx = sizePx;
+	}
+
+	// 保存当前绘制目标（QOpenGLWindow局部更新时为窗口自己的帧缓冲，而非0）
+	GLint prevFbo = 0;
+	GLint prevViewport[4]{};
+	GLfloat prevClear[4]{};
+	m_gl->glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFbo);
+	m_gl->glGetIntegerv(GL_VIEWPORT, prevViewport);
+	m_gl->glGetFloatv(GL_COLOR_CLEAR_VALUE, prevClear);
+
+	m_gl->glBindFramebuffer(GL_FRAMEBUFFER, layer.fbo);
+	m_gl->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, layer.texture, 0);
+	if (m_gl->glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		qWarning() << "Renderer: layer framebuffer incomplete, size" << sizePx;
+		m_gl->glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(prevFbo));
+		releaseLayer(layer);
+		return false;
+	}
+
+	// 切换到图层坐标系：视口、缩放与剪裁状态在绘制后恢复
+	const int fbWpx = m_fbWpx;
+	const int fbHpx = m_fbHpx;
+	const float dpr = m_currentDpr;
+	const QRect damagePx = m_damagePx;
+	const bool depthTarget = m_depthTarget;
+	m_damagePx = QRect();
+	m_depthTarget = false;  // 图层帧缓冲只有颜色附件
+	restoreClip();
+	m_fbWpx = sizePx.width();
+	m_fbHpx = sizePx.height();
+	m_currentDpr = scale;
+	m_gl->glViewport(0, 0, m_fbWpx, m_fbHpx);
+	++m_layerDepth;
+	applyBlend(false);
+	m_gl->glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	m_gl->glClear(GL_COLOR_BUFFER_BIT);
+
+	// 内容只在变化时重绘，平移复制一份的开销可以接受
+	const Render::FrameData local = translatedFrame(*def.content, -def.bounds.topLeft());
+	const auto& order = drawOrder(local);
+	const bool batched = batchedAvailable();
+	prepareFrame(local, order, iconCache, batched);
+	if (batched) drawFrameBatched(order);
+	else         drawFrameImmediate(local, order, iconCache);
+
+	--m_layerDepth;
+	applyBlend(false);
+	m_gl->glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(prevFbo));
+	m_gl->glViewport(prevViewport[0], prevViewport[1], prevViewport[2], prevViewport[3]);
+	m_gl->glClearColor(prevClear[0], prevClear[1], prevClear[2], prevClear[3]);
+	m_fbWpx = fbWpx;
+	m_fbHpx = fbHpx;
+	m_currentDpr = dpr;
+	m_damagePx = damagePx;
+	m_depthTarget = depthTarget;
+
+	layer.version = def.version;
+	layer.bounds = def.bounds;
+	layer.scale = scale;
+	++m_stats.layerRenders;
+	return true;
+}
+
+void Renderer::releaseLayer(Layer& layer)
+{
+	if (layer.fbo) m_gl->glDeleteFramebuffers(1, &layer.fbo);
+	if (layer.texture) m_gl->glDeleteTextures(1, &layer.texture);
+	layer = Layer{};
+}
+
+void Renderer::collectLayers()
+{
+	// 连续若干帧未被引用的图层（子树已销毁或不再分层）释放纹理
+	for (auto it = m_layers.begin(); it != m_layers.end();) {
+		if (m_frameSerial - it->second.lastFrame > kLayerRetainFrames) {
+			releaseLayer(it->second);
+			m_layerPages.remove(Render::layerTextureId(it->first));
+			it = m_layers.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+void Renderer::beginGpuTimer()
+{
+	if (!m_gpuTiming || m_gpuQueryActive) return;
+
+	// 从最旧的查询开始取回已完成的结果（保留最新一个）
+	for (int k = 0; k < kGpuQueryCount; ++k) {
+		const int slot = (m_gpuQueryNext + k) % kGpuQueryCount;
+		if (!m_gpuQueryPending[slot]) continue;
+		GLuint available = 0;
+		m_glx->glGetQueryObjectuiv(m_gpuQueries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) continue;
+		GLuint ns = 0;  // 32位纳秒足以容纳约4秒的单帧耗时
+		m_glx->glGetQueryObjectuiv(m_gpuQueries[slot], GL_QUERY_RESULT, &ns);
+		m_gpuQueryPending[slot] = false;
+		m_gpuTimeNs = static_cast<qint64>(ns);
+	}
+
+	if (m_gpuQueryPending[m_gpuQueryNext]) return;  // GPU落后超过kGpuQueryCount帧：本帧不计时
+	m_glx->glBeginQuery(GL_TIME_ELAPSED, m_gpuQueries[m_gpuQueryNext]);
+	m_gpuQueryActive = true;
+}
+
+void Renderer::endGpuTimer()
+{
+	if (!m_gpuQueryActive) return;
+	m_glx->glEndQuery(GL_TIME_ELAPSED);
+	m_gpuQueryActive = false;
+	m_gpuQueryPending[m_gpuQueryNext] = true;
+	m_gpuQueryNext = (m_gpuQueryNext + 1) % kGpuQueryCount;
+}
+
+void Renderer::endFrame()
+{
+	endGpuTimer();
+	m_stream.endFrame();
+	const auto& st = m_stream.frameStats();
+	m_stats.uploadBytes = st.uploadBytes;
+	m_stats.fenceWaits = st.fenceWaits;
+	m_stats.streamOrphans = st.orphans;
+}
+
+void Renderer::prepareFrame(const Render::FrameData& fd, const std::vector<Render::CmdRef>& order, const IconResolver& iconCache,
+	const bool batched)
+{
+	// 剔除只影响打包：被剔除的命令不产生实例/顶点，命令流与批次合并规则不变
+	if (m_culling && m_fbWpx > 0 && m_fbHpx > 0) {
+		m_culler.run(fd, order, QRectF(0.0, 0.0, m_fbWpx / m_currentDpr, m_fbHpx / m_currentDpr));
+		const auto& cs = m_culler.stats();
+		m_stats.culledClipped += cs.clipped;
+		m_stats.culledOffscreen += cs.offscreen;
+		m_stats.culledOccluded += cs.occluded;
+	}
+	else {
+		m_culler.reset();
+	}
+
+	if (batched) {
+		assignDepths(fd, order);
+		prepareBatched(fd, iconCache);
+	}
+	else {
+		prepareImmediate(fd, iconCache);
+	}
+}
+
+void Renderer::drawFrame(const Render::FrameData& fd, const IconResolver& iconCache, const float devicePixelRatio)
+{
+	const bool batched = beginFrame(fd, devicePixelRatio);
+	reserveFrameStream(fd, iconCache, batched);
+	updateLayers(fd, iconCache);
+	collectLayers();
+	const auto& order = drawOrder(fd);
+	prepareFrame(fd, order, iconCache, batched);
+	if (batched) drawFrameBatched(order);
+	else         drawFrameImmediate(fd, order, iconCache);
+	endFrame();
+}
+
+void Renderer::drawFrame(const Render::FrameData& fd, const IconResolver& iconCache, const float devicePixelRatio,
+	const std::vector<QRectF>& damage, const QColor& clearColor)
+{
+	if (!m_gl || damage.empty()) return;
+
+	const bool batched = beginFrame(fd, devicePixelRatio);
+	reserveFrameStream(fd, iconCache, batched);
+	updateLayers(fd, iconCache);
+	collectLayers();
+	const auto& order = drawOrder(fd);
+	prepareFrame(fd, order, iconCache, batched);
+
+	m_gl->glClearColor(clearColor.redF(), clearColor.greenF(), clearColor.blueF(), 1.0f);
+	for (const QRectF& region : damage) {
+		m_damagePx = damageLogicalToPx(region, m_currentDpr, m_fbWpx, m_fbHpx);
+		if (m_damagePx.isEmpty()) continue;
+
+		// 剪裁到损坏区域后清除，再按同一剪裁重放整条命令流（区域外的像素保留上一帧内容）
+		restoreClip();
+		m_gl->glClear(GL_COLOR_BUFFER_BIT);
+		if (batched) drawFrameBatched(order);
+		else         drawFrameImmediate(fd, order, iconCache);
+
+		++m_stats.damageRects;
+		m_stats.damagePixels += static_cast<qint64>(m_damagePx.width()) * m_damagePx.height();
+	}
+	m_damagePx = QRect();
+	restoreClip();
+	endFrame();
 }
\ No newline at end of file
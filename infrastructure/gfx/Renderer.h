@@ -7,21 +7,41 @@
  */
 
 #pragma once
+#include <cstdint>
+#include <qcolor.h>
+#include <qglobal.h>
+#include <qhash.h>
+#include <qopenglextrafunctions.h>
 #include <qopenglfunctions.h>
 #include <qopenglshaderprogram.h>
 #include <qopenglvertexarrayobject.h>
+#include <qrect.h>
+#include <qsize.h>
+#include <qvectornd.h>
+#include <unordered_map>
+#include <vector>
 
+#include "CommandCuller.h"
 #include "IconCache.h"
 #include "RenderData.hpp"
+#include "StreamBuffer.h"
 
 /// OpenGL渲染器：管理着色器资源与绘制命令执行
 /// OpenGL渲染器：管理着色器资源与绘制命令执行
 /// 
 /// 功能：
-/// - OpenGL着色器程序与缓冲对象生命周期管理
-/// - 圆角矩形绘制（顶点着色器 + 片段着色器）
+/// - OpenGL着色器程序与缓冲对象生命周期管理（程序经ShaderCache构建，命中缓存时跳过编译链接）
+/// - 圆角矩形绘制（顶点着色器 + 片段着色器；填充与内侧描边在同一次距离场求值中完成）
 /// - 纹理绘制（图标、文本，支持着色）
-/// - 剪裁区域管理（逻辑像素坐标系转换）
+/// - 投影绘制（高斯模糊圆角矩形的解析近似，单次绘制）
+/// - 剪裁区域管理：命令剪裁（含圆角剪裁）在着色器中逐片段完成，glScissor只用于局部重绘的损坏区域
+/// - 按命令流顺序提交：相邻且状态兼容的命令合并为一次实例化绘制
+/// - 提交前CPU剔除（CommandCuller）：剪裁为空、视口之外、被其后不透明直角矩形完全遮挡的命令不打包
+/// - 不透明预通道（批量路径，目标帧缓冲有深度附件时）：不透明圆角矩形的内部由近及远写入深度且不混合，
+///   随后按命令流顺序混合绘制全部命令并做深度测试，被更晚的不透明内部覆盖的片段不再着色；
+///   不透明命令自身的混合绘制因此只剩圆角与抗锯齿边缘一圈
+/// - 逐帧顶点/实例数据统一写入三重缓冲的流式缓冲（StreamBuffer），每帧每类数据只上传一次
+/// - 离屏图层（FrameData::layers）：内容版本变化时绘制到图层纹理（预乘alpha），其余帧只合成一个纹理四边形
 /// 
 /// 坐标系说明：
 /// - 输入：逻辑像素坐标（左上原点）
@@ -31,6 +51,33 @@
 class Renderer
 {
 public:
+	/// 命令提交路径
+	enum class SubmitPath {
+		Immediate,   // 逐命令绘制：按命令流顺序每条命令一次上传+一次glDrawArrays（原始路径，用于对比与回退）
+		Batched      // 批量绘制：整帧实例数据一次上传，命令流中相邻且状态兼容的命令合并为一次glDrawArraysInstanced
+	};
+
+	/// 帧统计：最近一次drawFrame的提交情况
+	struct FrameStats {
+		int    drawCalls{ 0 };    // 发出的绘制调用次数
+		int    rectCount{ 0 };    // 圆角矩形命令数
+		int    imageCount{ 0 };   // 图像命令数
+		int    shadowCount{ 0 };  // 投影命令数
+		int    damageRects{ 0 };  // 局部重绘的损坏区域数（整帧绘制时为0）
+		qint64 damagePixels{ 0 }; // 局部重绘覆盖的像素数（设备像素）
+		qint64 uploadBytes{ 0 };  // 顶点/实例数据上传字节数
+		int    fenceWaits{ 0 };   // 流式缓冲等待GPU栅栏的次数（非0说明CPU领先GPU超过缓冲帧数）
+		int    streamOrphans{ 0 };// 流式缓冲孤立/扩容存储的次数
+		int    streamOverflows{ 0 };// 数据未能写入流式缓冲而跳过绘制的次数（应为0）
+		int    layerCount{ 0 };   // 本帧引用的离屏图层数
+		int    layerRenders{ 0 }; // 本帧重新绘制内容的图层数（其余图层直接合成缓存的纹理）
+		int    culledClipped{ 0 };   // 剔除：与剪裁区域不相交的命令数（含图层内容）
+		int    culledOffscreen{ 0 }; // 剔除：在视口之外的命令数
+		int    culledOccluded{ 0 };  // 剔除：被更晚的不透明矩形完全遮挡的命令数
+		int    opaqueRects{ 0 };     // 不透明预通道绘制的内部区域数（0表示本帧未启用）
+		qint64 opaquePixels{ 0 };    // 不透明内部覆盖的设备像素数（未计局部重绘剪裁）
+	};
+
 	Renderer() = default;
 	~Renderer() = default;
 
@@ -50,29 +97,185 @@ public:
 
 	/// 功能：绘制一帧
 	/// 参数：fd — 包含所有绘制命令的帧数据
-	/// 参数：iconCache — 图标纹理缓存
+	/// 参数：iconCache — 图标纹理缓存（渲染线程中为持锁拷贝的IconSnapshot）
 	/// 参数：devicePixelRatio — DPR（设备像素比），用于逻辑像素到设备像素转换
-	void drawFrame(const Render::FrameData& fd, const IconCache& iconCache, float devicePixelRatio);
+	/// 说明：按fd.commands的顺序绘制（后追加者在上）；命令流不完整时退回"先投影、再矩形、后图像"
+	void drawFrame(const Render::FrameData& fd, const IconResolver& iconCache, float devicePixelRatio);
+
+	/// 功能：局部重绘一帧
+	/// 参数：fd — 包含所有绘制命令的帧数据（完整的一帧）
+	/// 参数：iconCache — 图标纹理缓存
+	/// 参数：devicePixelRatio — DPR（设备像素比）
+	/// 参数：damage — 需重绘的区域（逻辑像素），通常来自DamageTracker
+	/// 参数：clearColor — 各区域绘制前的清除颜色
+	/// 说明：实例数据只打包上传一次，再按各区域剪裁分别重放命令流；区域之外保留帧缓冲原有内容，
+	///       因此要求窗口保留上一帧（如QOpenGLWindow::PartialUpdateBlit）；damage为空时不绘制
+	void drawFrame(const Render::FrameData& fd, const IconResolver& iconCache, float devicePixelRatio,
+		const std::vector<QRectF>& damage, const QColor& clearColor);
+
+	/// 功能：切换命令提交路径
+	/// 说明：批量路径不可用（上下文低于GL 3.3或着色器链接失败）时自动回退到逐命令路径
+	void setSubmitPath(const SubmitPath path) noexcept { m_submitPath = path; }
+	[[nodiscard]] SubmitPath submitPath() const noexcept { return m_submitPath; }
+
+	/// 功能：切换流式缓冲的同步方式
+	/// 说明：需在initializeGL之后调用；上下文不支持非同步映射时始终为Orphan
+	void setStreamMode(const StreamBuffer::Mode mode) { m_stream.setMode(mode); }
+	[[nodiscard]] StreamBuffer::Mode streamMode() const noexcept { return m_stream.mode(); }
+
+	/// 功能：启用/停用提交前剔除（默认启用；停用时所有命令都打包提交，用于对比与排查）
+	void setCullingEnabled(const bool on) noexcept { m_culling = on; }
+	[[nodiscard]] bool cullingEnabled() const noexcept { return m_culling; }
+
+	/// 功能：启用/停用剔除中的遮挡判定（剪裁与视口剔除不受影响）
+	void setOcclusionCullingEnabled(const bool on) noexcept { m_culler.setOcclusionEnabled(on); }
+	[[nodiscard]] bool occlusionCullingEnabled() const noexcept { return m_culler.occlusionEnabled(); }
+
+	/// 功能：启用/停用不透明预通道（默认启用；逐命令路径、无深度附件的目标与离屏图层内始终不启用）
+	void setOpaquePassEnabled(const bool on) noexcept { m_opaquePass = on; }
+	[[nodiscard]] bool opaquePassEnabled() const noexcept { return m_opaquePass; }
+
+	/// 功能：获取最近一帧的提交统计
+	[[nodiscard]] const FrameStats& lastFrameStats() const noexcept { return m_stats; }
+
+	/// 功能：启用GPU计时（每帧一次GL_TIME_ELAPSED查询，包住drawFrame的全部GL命令）
+	/// 说明：需桌面GL 3.3或GL_ARB_timer_query；不支持时无效果
+	void setGpuTimingEnabled(bool on) noexcept { m_gpuTiming = on && m_gpuTimingSupported; }
+	[[nodiscard]] bool gpuTimingSupported() const noexcept { return m_gpuTimingSupported; }
+
+	/// 功能：最近一次取回的整帧GPU耗时（纳秒）
+	/// 返回：查询结果滞后若干帧才可用；尚无新结果时返回-1（取回后即清除，每个结果只报告一次）
+	[[nodiscard]] qint64 takeGpuTimeNs() noexcept { const qint64 ns = m_gpuTimeNs; m_gpuTimeNs = -1; return ns; }
 
 private:
-	void drawRoundedRect(const Render::RoundedRectCmd& cmd);
-	void drawImage(const Render::ImageCmd& img, const IconCache& iconCache);
+	/// 实例化圆角矩形的逐实例属性（与顶点属性布局一一对应，56字节）
+	struct RectInstance {
+		float rectPx[4];     // 目标矩形（设备像素，左上原点）
+		float clipPx[4];     // 剪裁矩形（设备像素，左上原点；宽高<=0表示不剪裁）
+		float radiusPx;      // 圆角半径（设备像素）
+		float clipRadiusPx;  // 剪裁圆角半径（设备像素）
+		float strokeWidthPx; // 描边宽度（设备像素；与前两项作为一个vec3属性读取）
+		uchar color[4];      // RGBA8填充颜色（着色器中归一化）
+		float depth;         // NDC深度（命令流中越靠后越近；不透明预通道未启用时不参与测试）
+		uchar strokeColor[4];// RGBA8描边颜色
+	};
+
+	/// 实例化纹理绘制的逐实例属性（60字节）
+	struct ImageInstance {
+		float dstPx[4];     // 目标矩形（设备像素，左上原点）
+		float srcPx[4];     // 源纹理区域（图集页内像素，已加上子图偏移）
+		float clipPx[4];    // 剪裁矩形（设备像素，左上原点；宽高<=0表示不剪裁）
+		float clipRadiusPx; // 剪裁圆角半径（设备像素）
+		uchar tint[4];      // RGBA8着色
+		float depth;        // NDC深度
+	};
+
+	/// 实例化投影的逐实例属性（52字节）
+	struct ShadowInstance {
+		float rectPx[4];    // 投影形状（设备像素，左上原点）
+		float clipPx[4];    // 剪裁矩形（设备像素，左上原点；宽高<=0表示不剪裁）
+		float radiusPx;     // 圆角半径（设备像素）
+		float sigmaPx;      // 高斯σ（设备像素）
+		float clipRadiusPx; // 剪裁圆角半径（设备像素；与前两项作为一个vec3属性读取）
+		uchar color[4];     // RGBA8颜色
+		float depth;        // NDC深度
+	};
 
-	/// 功能：设置剪裁区域
-	/// 参数：clipLogical — 逻辑像素矩形（左上原点），宽高<=0时禁用剪裁
-	/// 说明：自动转换为OpenGL剪裁坐标（底左原点，设备像素）
-	void applyClip(const QRectF& clipLogical);
+	/// 离屏图层的纹理与帧缓冲
+	struct Layer {
+		unsigned int  fbo{ 0 };
+		unsigned int  texture{ 0 };
+		QSize         sizePx;           // 纹理尺寸（设备像素）
+		QRectF        bounds;           // 绘制时的内容范围（逻辑像素）
+		float         scale{ 0.0f };    // 逻辑像素 -> 纹理像素（通常为DPR，超出纹理上限时更小）
+		std::uint64_t version{ 0 };     // 纹理对应的内容版本
+		std::uint64_t lastFrame{ 0 };   // 最近一次被引用的帧序号（过期回收）
+	};
+
+	// 逐命令路径（顶点在prepareImmediate中整帧一次写入流式缓冲，绘制时按起始顶点索引引用）
+	void prepareImmediate(const Render::FrameData& fd, const IconResolver& iconCache);
+	void drawRoundedRect(const Render::RoundedRectCmd& cmd, const Render::ClipRegion& clipRegion, int firstVertex);
+	void drawShadow(const Render::ShadowCmd& cmd, const Render::ClipRegion& clipRegion, int firstVertex);
+	void drawImage(const Render::ImageCmd& img, const Render::ClipRegion& clipRegion, const IconResolver& iconCache, int firstVertex);
+	void drawTexturedQuad(const QRectF& dstPx, const QRectF& srcPx, const IconCache::Region& page, const QColor& tint,
+		const QVector4D& clipPx, float clipRadiusPx, int firstVertex);
+	void drawFrameImmediate(const Render::FrameData& fd, const std::vector<Render::CmdRef>& order, const IconResolver& iconCache);
+
+	/// 功能：重置帧统计、记录DPR并开始流式缓冲的新一帧
+	/// 返回：本帧是否走批量路径
+	bool beginFrame(const Render::FrameData& fd, float devicePixelRatio);
+	/// 功能：结束流式缓冲的本帧（插入栅栏）并汇总上传统计
+	void endFrame();
+	/// 功能：按当前视口剔除命令，再按提交路径打包并上传整帧数据
+	void prepareFrame(const Render::FrameData& fd, const std::vector<Render::CmdRef>& order, const IconResolver& iconCache, bool batched);
+	/// 功能：批量路径是否可用（已选择且实例化程序链接成功）
+	[[nodiscard]] bool batchedAvailable() const noexcept;
+
+	/// 功能：为fd引用的图层准备纹理（版本、范围或缩放变化时重绘内容），并登记合成时解析用的页信息
+	/// 说明：需在本帧的prepareXxx之前、reserveFrameStream之后调用（图层绘制复用同一套打包数组与流式缓冲）；嵌套图层递归处理
+	void updateLayers(const Render::FrameData& fd, const IconResolver& iconCache);
+	/// 功能：图层纹理的缩放（逻辑像素 -> 纹理像素）
+	[[nodiscard]] float layerScale(const Render::LayerDef& def) const;
+	/// 功能：图层纹理是否需要重绘内容（尚未绘制，或版本、范围、缩放变化）
+	[[nodiscard]] static bool layerStale(const Layer& layer, const Render::LayerDef& def, float scale);
+	/// 功能：一次prepareFrame写入流式缓冲的字节数上限（按剔除前的命令数与字形数计）
+	[[nodiscard]] static qsizetype frameStreamBytes(const Render::FrameData& fd, const IconResolver& iconCache, bool batched);
+	/// 功能：本帧updateLayers将重绘的图层写入流式缓冲的字节数上限（判断与updateLayers一致，嵌套递归）
+	/// 参数：seen — 已计入的图层id（同一帧内被多次引用的图层只绘制一次）
+	[[nodiscard]] qsizetype layerStreamBytes(const Render::FrameData& fd, const IconResolver& iconCache, bool batched, std::vector<int>& seen) const;
+	/// 功能：在本帧首次写入前为重绘的图层与主帧一次预留流式缓冲容量
+	void reserveFrameStream(const Render::FrameData& fd, const IconResolver& iconCache, bool batched);
+	/// 功能：把图层内容绘制到其纹理
+	/// 返回：帧缓冲不完整时为false（图层本帧不绘制）
+	bool renderLayer(Layer& layer, const Render::LayerDef& def, float scale, const IconResolver& iconCache);
+	void releaseLayer(Layer& layer);
+	/// 功能：回收连续kLayerRetainFrames帧未被引用的图层
+	void collectLayers();
+	/// 功能：设置混合方式（预乘纹理 / 图层内 / 窗口默认）
+	void applyBlend(bool premultiplied);
+	/// 功能：取回已完成的GPU计时查询，并为本帧开始一次新查询（环中无空闲查询时本帧不计时）
+	void beginGpuTimer();
+	void endGpuTimer();
+
+	// 批量路径
+	/// 功能：当前绑定的帧缓冲是否有深度附件（不透明预通道的前提）
+	[[nodiscard]] bool targetHasDepth() const;
+	/// 功能：按绘制顺序为各命令分配NDC深度（仅在不透明预通道启用时）
+	void assignDepths(const Render::FrameData& fd, const std::vector<Render::CmdRef>& order);
+	/// 功能：清除深度并由近及远绘制不透明内部（写深度、不混合），之后保持深度测试、关闭深度写入
+	void drawOpaquePass();
+	void prepareBatched(const Render::FrameData& fd, const IconResolver& iconCache);
+	void drawFrameBatched(const std::vector<Render::CmdRef>& order);
+	void packRectInstances(const Render::FrameData& fd);
+	void packImageInstances(const Render::FrameData& fd, const IconResolver& iconCache);
+	void packShadowInstances(const Render::FrameData& fd);
+	void drawRectRange(qsizetype firstInstance, qsizetype count);
+	void drawImageRange(qsizetype firstInstance, qsizetype count, const IconCache::Region& page);
+	void drawShadowRange(qsizetype firstInstance, qsizetype count);
+	void setRectInstanceAttribs(qsizetype baseBytes, qsizetype firstInstance);
+	void setImageInstanceAttribs(qsizetype firstInstance);
+	void setShadowInstanceAttribs(qsizetype firstInstance);
+
+	/// 功能：返回绘制顺序（命令流完整时即fd.commands，否则构造"先投影、再矩形、后图像"的顺序）
+	const std::vector<Render::CmdRef>& drawOrder(const Render::FrameData& fd);
+
+	/// 功能：设置glScissor（设备像素，左上原点；自动转换为OpenGL底左原点）
+	void setScissorPx(const QRect& clipPxTopLeft);
+	/// 说明：局部重绘期间恢复为损坏区域剪裁，否则关闭剪裁
 	void restoreClip();
 
 private:
 	// OpenGL着色器资源（圆角矩形）
 	QOpenGLShaderProgram* m_progRect{ nullptr };
 	QOpenGLVertexArrayObject m_vao;
-	unsigned int m_vbo{ 0 };
 	int m_locViewportSize{ -1 };
 	int m_locRectPx{ -1 };
 	int m_locRadius{ -1 };
 	int m_locColor{ -1 };
+	int m_locClipPx{ -1 };
+	int m_locClipRadius{ -1 };
+	int m_locStrokeW{ -1 };
+	int m_locStrokeColor{ -1 };
 
 	// OpenGL着色器资源（纹理绘制）
 	QOpenGLShaderProgram* m_progTex{ nullptr };
@@ -82,6 +285,81 @@ private:
 	int m_texLocTexSize{ -1 };
 	int m_texLocTint{ -1 };
 	int m_texLocSampler{ -1 };
+	int m_texLocSdf{ -1 };
+	int m_texLocMask{ -1 };
+	int m_texLocPremul{ -1 };
+	int m_texLocClipPx{ -1 };
+	int m_texLocClipRadius{ -1 };
+
+	// OpenGL着色器资源（投影）
+	QOpenGLShaderProgram* m_progShadow{ nullptr };
+	int m_shadowLocViewportSize{ -1 };
+	int m_shadowLocRectPx{ -1 };
+	int m_shadowLocRadius{ -1 };
+	int m_shadowLocSigma{ -1 };
+	int m_shadowLocColor{ -1 };
+	int m_shadowLocClipPx{ -1 };
+	int m_shadowLocClipRadius{ -1 };
+
+	// 批量路径资源（实例化圆角矩形 + 实例化纹理 + 实例化投影，共享单位四边形）
+	QOpenGLShaderProgram* m_progRectInst{ nullptr };
+	QOpenGLShaderProgram* m_progTexInst{ nullptr };
+	QOpenGLShaderProgram* m_progShadowInst{ nullptr };
+	QOpenGLVertexArrayObject m_rectInstVao;
+	QOpenGLVertexArrayObject m_imgInstVao;
+	QOpenGLVertexArrayObject m_shadowInstVao;
+	unsigned int m_quadVbo{ 0 };          // 单位四边形（6个顶点，0..1）
+	qsizetype m_rectInstBase{ 0 };        // 本帧圆角矩形实例在流式缓冲中的字节偏移
+	qsizetype m_imgInstBase{ 0 };         // 本帧纹理实例的字节偏移
+	qsizetype m_shadowInstBase{ 0 };      // 本帧投影实例的字节偏移
+	qsizetype m_opaqueInstBase{ 0 };      // 本帧不透明内部实例的字节偏移
+	bool m_prepared{ false };             // 最近一次prepareXxx的数据已全部写入流式缓冲（否则跳过绘制）
+	int m_instLocViewportSize{ -1 };
+	int m_texInstLocViewportSize{ -1 };
+	int m_texInstLocTexSize{ -1 };
+	int m_texInstLocSampler{ -1 };
+	int m_texInstLocSdf{ -1 };
+	int m_texInstLocMask{ -1 };
+	int m_texInstLocPremul{ -1 };
+	int m_shadowInstLocViewportSize{ -1 };
+
+	// 每帧复用的CPU侧数组
+	std::vector<RectInstance>  m_rectInstances;
+	std::vector<ImageInstance> m_imageInstances;
+	std::vector<ShadowInstance> m_shadowInstances;
+	std::vector<qsizetype>     m_rectSlots;    // 命令索引 -> 实例起始位置（长度n+1；被剔除的命令区间为空）
+	std::vector<qsizetype>     m_imageSlots;
+	std::vector<qsizetype>     m_shadowSlots;
+	std::vector<IconCache::Region> m_imageInstPages;  // 图像实例所在的图集页（与m_imageInstances一一对应，批次拆分键）
+	std::vector<RectInstance>  m_opaqueInstances;     // 不透明内部（直角、无剪裁，按深度由近及远排序）
+	std::vector<float>         m_rectDepth;           // 命令索引 -> NDC深度（不透明预通道未启用时为空）
+	std::vector<float>         m_imageDepth;
+	std::vector<float>         m_shadowDepth;
+	float                      m_depthHalfStep{ 0.0f };  // 相邻命令深度间隔的一半（不透明内部比命令自身更近这么多）
+	std::vector<Render::CmdRef> m_fallbackOrder;
+	std::vector<float>         m_immVerts;        // 逐命令路径的NDC顶点（每个四边形6个顶点）
+	std::vector<int>           m_immRectFirst;    // 命令索引 -> 起始顶点（-1表示不绘制）
+	std::vector<int>           m_immShadowFirst;
+	std::vector<int>           m_immImageFirst;   // 图像命令展开的首个四边形的起始顶点
+
+	// 离屏图层
+	static constexpr std::uint64_t kLayerRetainFrames = 120;
+	std::unordered_map<int, Layer> m_layers;        // 图层id -> 纹理
+	QHash<int, IconCache::Region>  m_layerPages;    // 图层句柄 -> 合成时的纹理信息（预乘、按scale缩放）
+	std::uint64_t m_frameSerial{ 0 };
+	int m_layerDepth{ 0 };        // >0：正在绘制图层内容
+	int m_maxTextureSize{ 4096 };
+
+	// 提交前剔除（标记按类型数组索引，供打包函数跳过）
+	CommandCuller m_culler;
+	bool m_culling{ true };
+
+	// 逐帧流式缓冲（两条提交路径共用）
+	StreamBuffer m_stream;
+
+	SubmitPath m_submitPath{ SubmitPath::Batched };
+	bool m_opaquePass{ true };
+	bool m_depthTarget{ false };  // 本帧（图层内为false）启用不透明预通道
 
 	// 渲染状态
 	int m_fbWpx{ 0 };     // 帧缓冲宽度（设备像素）
@@ -90,8 +368,23 @@ private:
 
 	// OpenGL函数表
 	QOpenGLFunctions* m_gl{ nullptr };
+	QOpenGLExtraFunctions* m_glx{ nullptr };  // GL 3.x扩展函数（实例化绘制所需，不可用时为空）
+
+	// 帧统计
+	FrameStats m_stats;
+
+	// GPU计时（查询环：结果滞后若干帧取回，避免等待GPU）
+	static constexpr int kGpuQueryCount = 4;
+	unsigned int m_gpuQueries[kGpuQueryCount]{};
+	bool   m_gpuQueryPending[kGpuQueryCount]{};
+	int    m_gpuQueryNext{ 0 };
+	bool   m_gpuQueryActive{ false };
+	bool   m_gpuTimingSupported{ false };
+	bool   m_gpuTiming{ false };
+	qint64 m_gpuTimeNs{ -1 };
 
 	// 剪裁状态管理
 	bool  m_clipActive{ false };
 	QRect m_clipPx{ 0,0,0,0 };  // 当前剪裁矩形（设备像素，左上原点 -> OpenGL底左原点）
+	QRect m_damagePx;           // 当前损坏区域（设备像素，左上原点；空表示整帧绘制）
 };
\ No newline at end of file
@@ -0,0 +1,255 @@
+#include "ShaderCache.h"
+
+#include <qbytearray.h>
+#include <qcryptographichash.h>
+#include <qdatastream.h>
+#include <qdir.h>
+#include <qelapsedtimer.h>
+#include <qfile.h>
+#include <qiodevice.h>
+#include <qlogging.h>
+#include <qmutex.h>
+#include <qopenglcontext.h>
+#include <qopenglextrafunctions.h>
+#include <qopenglshaderprogram.h>
+#include <qsavefile.h>
+#include <qstandardpaths.h>
+#include <qstring.h>
+#include <QtGui/qopengl.h>
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+namespace {
+	/// 当前上下文是否支持程序二进制（GLES 3.0 / GL 4.1 / GL_ARB_get_program_binary，且驱动至少提供一种格式）
+	bool binarySupported(QOpenGLContext* ctx) {
+		if (!ctx) return false;
+		const auto ver = ctx->format().version();
+		const bool api = ctx->isOpenGLES() ? ver.first >= 3
+			: (ver >= qMakePair(4, 1) || ctx->hasExtension(QByteArrayLiteral("GL_ARB_get_program_binary")));
+		if (!api) return false;
+		GLint formats = 0;
+		ctx->functions()->glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		return formats > 0;
+	}
+
+	QByteArray driverId(QOpenGLContext* ctx) {
+		auto* gl = ctx->functions();
+		const auto str = [gl](const GLenum e) {
+			const auto* s = reinterpret_cast<const char*>(gl->glGetString(e));
+			return s ? QByteArray(s) : QByteArray();
+		};
+		return str(GL_VENDOR) + '|' + str(GL_RENDERER) + '|' + str(GL_VERSION);
+	}
+
+	double msSince(const QElapsedTimer& t) {
+		return static_cast<double>(t.nsecsElapsed()) / 1.0e6;
+	}
+}
+
+ShaderCache& ShaderCache::instance()
+{
+	static ShaderCache cache;
+	return cache;
+}
+
+ShaderCache::ShaderCache()
+	: m_dir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QStringLiteral("/shadercache"))
+	, m_enabled(qEnvironmentVariable("FJ_SHADER_CACHE") != QStringLiteral("0"))
+{
+}
+
+void ShaderCache::setDirectory(const QString& dir)
+{
+	const QMutexLocker lock(&m_mutex);
+	m_dir = dir;
+}
+
+QString ShaderCache::directory() const
+{
+	const QMutexLocker lock(&m_mutex);
+	return m_dir;
+}
+
+void ShaderCache::setEnabled(const bool on)
+{
+	const QMutexLocker lock(&m_mutex);
+	m_enabled = on;
+}
+
+bool ShaderCache::enabled() const
+{
+	const QMutexLocker lock(&m_mutex);
+	return m_enabled;
+}
+
+ShaderCache::Stats ShaderCache::stats() const
+{
+	const QMutexLocker lock(&m_mutex);
+	return m_stats;
+}
+
+QByteArray ShaderCache::cacheKey(const QByteArray& driverId, const QByteArray& vertexSrc, const QByteArray& fragmentSrc)
+{
+	QCryptographicHash h(QCryptographicHash::Sha1);
+	h.addData(QByteArray::number(kFormatVersion));
+	h.addData(driverId);
+	h.addData(QByteArrayView("\0", 1));
+	h.addData(vertexSrc);
+	h.addData(QByteArrayView("\0", 1));
+	h.addData(fragmentSrc);
+	return h.result().toHex();
+}
+
+QOpenGLShaderProgram* ShaderCache::build(const QString& name, const QByteArray& vertexSrc, const QByteArray& fragmentSrc)
+{
+	QOpenGLContext* ctx = QOpenGLContext::currentContext();
+	if (!enabled() || !binarySupported(ctx)) return compile(name, vertexSrc, fragmentSrc, false);
+
+	const QByteArray key = cacheKey(driverId(ctx), vertexSrc, fragmentSrc);
+	Blob blob;
+	bool inMemory = false;
+	{
+		const QMutexLocker lock(&m_mutex);
+		if (const auto it = m_memory.constFind(key); it != m_memory.constEnd()) {
+			blob = it.value();
+			inMemory = true;
+		}
+	}
+
+	if (inMemory || readFile(name, key, blob)) {
+		QElapsedTimer t;
+		t.start();
+		if (QOpenGLShaderProgram* prog = loadBinary(blob)) {
+			const double ms = msSince(t);
+			{
+				const QMutexLocker lock(&m_mutex);
+				(inMemory ? m_stats.memoryHits : m_stats.diskHits) += 1;
+				m_stats.loadMs += ms;
+				if (!inMemory) m_memory.insert(key, blob);
+			}
+			qDebug() << "ShaderCache:" << name << (inMemory ? "memory hit" : "disk hit") << "in" << ms << "ms";
+			return prog;
+		}
+		// 驱动更新等原因拒绝旧二进制：丢弃后重新编译
+		const QMutexLocker lock(&m_mutex);
+		m_memory.remove(key);
+		++m_stats.rejected;
+	}
+
+	QOpenGLShaderProgram* prog = compile(name, vertexSrc, fragmentSrc, true);
+	if (!prog->isLinked()) return prog;
+
+	// 取回二进制
+	auto* glx = ctx->extraFunctions();
+	GLint length = 0;
+	glx->glGetProgramiv(prog->programId(), GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) return prog;
+	blob.data.resize(length);
+	GLenum format = 0;
+	GLsizei written = 0;
+	glx->glGetProgramBinary(prog->programId(), length, &written, &format, blob.data.data());
+	if (written <= 0) return prog;
+	blob.data.resize(written);
+	blob.format = format;
+
+	{
+		const QMutexLocker lock(&m_mutex);
+		m_memory.insert(key, blob);
+	}
+	writeFile(name, key, blob);
+	return prog;
+}
+
+void ShaderCache::drop(const QString& name, const QByteArray& vertexSrc, const QByteArray& fragmentSrc)
+{
+	QOpenGLContext* ctx = QOpenGLContext::currentContext();
+	if (!ctx) return;
+	const QByteArray key = cacheKey(driverId(ctx), vertexSrc, fragmentSrc);
+	{
+		const QMutexLocker lock(&m_mutex);
+		m_memory.remove(key);
+	}
+	QFile::remove(QDir(directory()).filePath(QStringLiteral("%1-%2.bin").arg(name, QString::fromLatin1(key.left(16)))));
+}
+
+QOpenGLShaderProgram* ShaderCache::compile(const QString& name, const QByteArray& vertexSrc, const QByteArray& fragmentSrc,
+	const bool retrievable)
+{
+	QElapsedTimer t;
+	t.start();
+	auto* prog = new QOpenGLShaderProgram();
+	prog->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexSrc);
+	prog->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentSrc);
+	if (retrievable && prog->programId() != 0) {
+		QOpenGLContext::currentContext()->extraFunctions()->glProgramParameteri(
+			prog->programId(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+	const bool linked = prog->link();
+	const double ms = msSince(t);
+	{
+		const QMutexLocker lock(&m_mutex);
+		++m_stats.compiles;
+		m_stats.compileMs += ms;
+	}
+	if (linked) qDebug() << "ShaderCache:" << name << "compiled in" << ms << "ms";
+	else qWarning() << "ShaderCache:" << name << "link failed:" << prog->log();
+	return prog;
+}
+
+QOpenGLShaderProgram* ShaderCache::loadBinary(const Blob& blob)
+{
+	auto* prog = new QOpenGLShaderProgram();
+	if (!prog->create()) {
+		delete prog;
+		return nullptr;
+	}
+	auto* glx = QOpenGLContext::currentContext()->extraFunctions();
+	glx->glProgramBinary(prog->programId(), blob.format, blob.data.constData(), static_cast<GLsizei>(blob.data.size()));
+	// 无着色器对象时link()只检查GL_LINK_STATUS（即glProgramBinary是否被接受）
+	if (!prog->link()) {
+		delete prog;
+		return nullptr;
+	}
+	return prog;
+}
+
+bool ShaderCache::readFile(const QString& name, const QByteArray& key, Blob& out) const
+{
+	QFile f(QDir(directory()).filePath(QStringLiteral("%1-%2.bin").arg(name, QString::fromLatin1(key.left(16)))));
+	if (!f.open(QIODevice::ReadOnly)) return false;
+
+	QDataStream ds(&f);
+	ds.setVersion(QDataStream::Qt_6_0);
+	quint32 magic = 0, version = 0;
+	QByteArray fileKey;
+	ds >> magic >> version >> fileKey >> out.format >> out.data;
+	return ds.status() == QDataStream::Ok && magic == kFileMagic && version == kFormatVersion && fileKey == key
+		&& !out.data.isEmpty();
+}
+
+void ShaderCache::writeFile(const QString& name, const QByteArray& key, const Blob& blob) const
+{
+	const QDir dir(directory());
+	if (!dir.mkpath(QStringLiteral("."))) return;
+
+	// 同名程序的旧键文件（源码或驱动已变化）不再会被命中
+	const QString fileName = QStringLiteral("%1-%2.bin").arg(name, QString::fromLatin1(key.left(16)));
+	for (const QString& stale : dir.entryList({ name + QStringLiteral("-*.bin") }, QDir::Files)) {
+		if (stale != fileName) QFile::remove(dir.filePath(stale));
+	}
+
+	QSaveFile f(dir.filePath(fileName));
+	if (!f.open(QIODevice::WriteOnly)) return;
+	QDataStream ds(&f);
+	ds.setVersion(QDataStream::Qt_6_0);
+	ds << kFileMagic << kFormatVersion << key << blob.format << blob.data;
+	if (!f.commit()) qWarning() << "ShaderCache: cannot write" << f.fileName();
+}
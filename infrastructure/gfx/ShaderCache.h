@@ -0,0 +1,89 @@
+/*
+ * 文件名：ShaderCache.h
+ * 职责：着色器程序二进制缓存，按驱动与GL版本保存glGetProgramBinary的结果，下次启动或新建渲染器时跳过编译链接。
+ * 依赖：Qt6 OpenGL、Qt6 Core（QStandardPaths、QCryptographicHash）。
+ * 线程：build需在拥有OpenGL上下文的线程调用；内部缓存表加锁，可被多个上下文线程共享。
+ * 备注：缓存键包含驱动标识与着色器源码哈希，源码或驱动变化时自动失效；设置FJ_SHADER_CACHE=0可关闭。
+ */
+
+#pragma once
+#include <qbytearray.h>
+#include <qhash.h>
+#include <qmutex.h>
+#include <qopenglshaderprogram.h>
+#include <qstring.h>
+
+/// 着色器程序缓存：内存 + 磁盘两级
+///
+/// 流程：
+/// - 命中内存（同进程内其他Renderer已链接过，如弹出层的独立渲染器）或磁盘：glProgramBinary直接装载
+/// - 未命中或装载失败（驱动拒绝旧二进制）：从源码编译链接，再取回二进制写入内存与磁盘
+/// - 上下文不支持程序二进制（GL < 4.1且无GL_ARB_get_program_binary）时退化为直接编译
+///
+/// 磁盘文件位于 AppDataLocation/shadercache/<名称>-<键>.bin，写入新键时删除同名旧文件
+class ShaderCache {
+public:
+	/// 累计统计（自进程启动）
+	struct Stats {
+		int    memoryHits{ 0 };   // 内存命中次数
+		int    diskHits{ 0 };     // 磁盘命中次数
+		int    compiles{ 0 };     // 从源码编译次数（含二进制被拒后的重编译）
+		int    rejected{ 0 };     // 驱动拒绝缓存二进制的次数
+		double compileMs{ 0.0 };  // 源码编译链接总耗时
+		double loadMs{ 0.0 };     // 二进制装载总耗时
+	};
+
+	/// 功能：进程内共享实例
+	static ShaderCache& instance();
+
+	/// 功能：构建并链接着色器程序
+	/// 参数：name — 程序名（用于文件名与日志）
+	/// 参数：vertexSrc / fragmentSrc — GLSL源码
+	/// 返回：新建的程序对象（调用方持有）；链接失败时isLinked()为false
+	/// 说明：必须在有效的OpenGL上下文中调用
+	[[nodiscard]] QOpenGLShaderProgram* build(const QString& name, const QByteArray& vertexSrc, const QByteArray& fragmentSrc);
+
+	/// 功能：丢弃程序的缓存二进制（内存与磁盘）
+	/// 参数：name / vertexSrc / fragmentSrc — 与build相同
+	/// 说明：调用方发现程序不可用（如链接失败）时调用，下次build从源码编译；必须在有效的OpenGL上下文中调用
+	void drop(const QString& name, const QByteArray& vertexSrc, const QByteArray& fragmentSrc);
+
+	/// 功能：设置缓存目录（默认 AppDataLocation/shadercache）
+	void setDirectory(const QString& dir);
+	[[nodiscard]] QString directory() const;
+
+	/// 功能：启用/停用缓存（停用时每次从源码编译）
+	void setEnabled(bool on);
+	[[nodiscard]] bool enabled() const;
+
+	[[nodiscard]] Stats stats() const;
+
+	/// 功能：计算缓存键
+	/// 参数：driverId — 驱动标识（厂商、渲染器、GL版本串）
+	/// 返回：十六进制哈希；源码、驱动或缓存格式任一变化时不同
+	[[nodiscard]] static QByteArray cacheKey(const QByteArray& driverId, const QByteArray& vertexSrc, const QByteArray& fragmentSrc);
+
+	static constexpr quint32 kFileMagic = 0x46534243;  // "FSBC"
+	static constexpr quint32 kFormatVersion = 1;
+
+private:
+	/// 程序二进制
+	struct Blob {
+		quint32    format{ 0 };
+		QByteArray data;
+	};
+
+	ShaderCache();
+
+	QOpenGLShaderProgram* compile(const QString& name, const QByteArray& vertexSrc, const QByteArray& fragmentSrc,
+		bool retrievable);
+	QOpenGLShaderProgram* loadBinary(const Blob& blob);
+	bool readFile(const QString& name, const QByteArray& key, Blob& out) const;
+	void writeFile(const QString& name, const QByteArray& key, const Blob& blob) const;
+
+	mutable QMutex m_mutex;
+	QHash<QByteArray, Blob> m_memory;  // 缓存键 -> 程序二进制
+	QString m_dir;
+	bool m_enabled{ true };
+	Stats m_stats;
+};
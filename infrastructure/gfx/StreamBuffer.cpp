@@ -0,0 +1,159 @@
+#include "StreamBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <qglobal.h>
+#include <qopenglextrafunctions.h>
+#include <qopenglfunctions.h>
+#include <QtGui/qopengl.h>
+
+namespace {
+	// 等待栅栏的上限；超时视为驱动异常，改为孤立存储继续
+	constexpr GLuint64 kFenceTimeoutNs = 100'000'000;
+}
+
+void StreamBuffer::initialize(QOpenGLFunctions* gl, QOpenGLExtraFunctions* glx, const Mode mode)
+{
+	m_gl = gl;
+	m_glx = glx;
+	if (!m_gl) return;
+
+	if (!m_buffer) m_gl->glGenBuffers(1, &m_buffer);
+	m_mode = m_glx ? mode : Mode::Orphan;
+	m_region = 0;
+	reallocate(std::max(m_regionBytes, kInitialRegionBytes));
+}
+
+void StreamBuffer::release()
+{
+	deleteFences();
+	if (m_gl && m_buffer) m_gl->glDeleteBuffers(1, &m_buffer);
+	m_buffer = 0;
+	m_regionBytes = 0;
+	m_cursor = 0;
+	m_region = 0;
+	m_gl = nullptr;
+	m_glx = nullptr;
+}
+
+void StreamBuffer::setMode(const Mode mode)
+{
+	const Mode effective = m_glx ? mode : Mode::Orphan;
+	if (effective == m_mode) return;
+	m_mode = effective;
+	m_region = 0;
+	if (m_buffer) reallocate(std::max(m_regionBytes, kInitialRegionBytes));
+}
+
+void StreamBuffer::deleteFences()
+{
+	for (auto& f : m_fences) {
+		if (f && m_glx) m_glx->glDeleteSync(f);
+		f = nullptr;
+	}
+}
+
+void StreamBuffer::reallocate(const qsizetype regionBytes)
+{
+	deleteFences();
+	m_regionBytes = regionBytes;
+	m_cursor = 0;
+
+	// 以nullptr重新指定存储即孤立旧存储：仍在排队的绘制继续读旧数据，新写入不必等待
+	m_gl->glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+	m_gl->glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_regionBytes * regionCount()), nullptr, GL_STREAM_DRAW);
+	++m_stats.orphans;
+}
+
+void StreamBuffer::waitFence(const int region)
+{
+	GLsync& fence = m_fences[region];
+	if (!fence) return;
+
+	// 先非阻塞查询；三重缓冲下通常已就绪
+	GLenum r = m_glx->glClientWaitSync(fence, 0, 0);
+	if (r == GL_TIMEOUT_EXPIRED) {
+		++m_stats.fenceWaits;
+		r = m_glx->glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kFenceTimeoutNs);
+	}
+	m_glx->glDeleteSync(fence);
+	fence = nullptr;
+
+	if (r == GL_TIMEOUT_EXPIRED || r == GL_WAIT_FAILED) {
+		reallocate(m_regionBytes);
+	}
+}
+
+void StreamBuffer::beginFrame()
+{
+	m_stats = Stats{};
+	if (!m_buffer) return;
+
+	if (m_mode == Mode::Unsynchronized) {
+		m_region = (m_region + 1) % kRegionCount;
+		m_cursor = 0;
+		waitFence(m_region);
+	}
+	else {
+		// 上一帧映射失败时中途改为Orphan，区域编号在此归零
+		m_region = 0;
+		reallocate(m_regionBytes);
+	}
+}
+
+bool StreamBuffer::reserve(const qsizetype totalBytes)
+{
+	if (!m_buffer) return false;
+	if (totalBytes <= m_regionBytes - alignUp(m_cursor)) return true;
+	// 本帧已写入的数据只在当前存储中，扩容会孤立它们
+	if (m_cursor > 0) return false;
+	reallocate(std::max(m_regionBytes * 2, alignUp(totalBytes)));
+	return true;
+}
+
+void StreamBuffer::endFrame()
+{
+	if (!m_buffer || m_mode != Mode::Unsynchronized || m_cursor == 0) return;
+
+	GLsync& fence = m_fences[m_region];
+	if (fence) m_glx->glDeleteSync(fence);
+	fence = m_glx->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+qsizetype StreamBuffer::write(const void* data, const qsizetype bytes)
+{
+	if (!m_buffer || bytes <= 0) return -1;
+
+	if (!reserve(alignedSize(bytes))) {
+		qWarning("StreamBuffer: frame data exceeds the reserved region (%lld + %lld > %lld bytes)",
+			static_cast<long long>(alignUp(m_cursor)), static_cast<long long>(bytes), static_cast<long long>(m_regionBytes));
+		return -1;
+	}
+	const qsizetype offset = alignUp(m_cursor);
+	const qsizetype absolute = static_cast<qsizetype>(m_region) * m_regionBytes + offset;
+
+	m_gl->glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+	bool written = false;
+	if (m_mode == Mode::Unsynchronized) {
+		// 目标区间已由栅栏保证不被GPU读取，可跳过驱动的隐式同步
+		void* dst = m_glx->glMapBufferRange(GL_ARRAY_BUFFER, static_cast<GLintptr>(absolute), static_cast<GLsizeiptr>(bytes),
+			GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+		if (dst) {
+			std::memcpy(dst, data, static_cast<std::size_t>(bytes));
+			written = m_glx->glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+		}
+		if (!written) {
+			// 映射失败（或存储在映射期间损坏）：本段改用glBufferSubData写入同一位置，不重新分配，
+			// 本帧已写入的数据保持有效；下一帧起改用孤立化
+			qWarning("StreamBuffer: glMapBufferRange unavailable, falling back to buffer orphaning");
+			m_mode = Mode::Orphan;
+		}
+	}
+	if (!written) {
+		m_gl->glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(absolute), static_cast<GLsizeiptr>(bytes), data);
+	}
+
+	m_cursor = offset + bytes;
+	m_stats.uploadBytes += bytes;
+	return absolute;
+}
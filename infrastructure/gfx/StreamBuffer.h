@@ -0,0 +1,109 @@
+/*
+ * 文件名：StreamBuffer.h
+ * 职责：逐帧流式顶点/实例缓冲，按帧轮转的环形区域写入数据，避免覆写GPU仍在读取的存储引起隐式同步。
+ * 依赖：Qt6 OpenGL。
+ * 线程：仅在拥有OpenGL上下文的线程中使用（通常为UI线程）。
+ * 备注：GL 3.x下使用非同步映射 + 栅栏（fence）；映射或栅栏不可用时退回孤立化（orphaning）。
+ */
+
+#pragma once
+#include <qglobal.h>
+#include <qopenglextrafunctions.h>
+#include <qopenglfunctions.h>
+
+/// 流式缓冲：一个GL缓冲对象划分为kRegionCount个等长区域，每帧写入下一个区域
+///
+/// 同步方式：
+/// - Unsynchronized：每次写入用glMapBufferRange(非同步 + 区域失效)映射目标区间后拷贝；
+///   帧结束时为本区域插入glFenceSync，下次轮到该区域时先等待栅栏，确保GPU已读完上一轮数据
+/// - Orphan：每帧开始时以glBufferData(nullptr)孤立旧存储，再用glBufferSubData写入
+///
+/// 容量：只在一帧的首次写入前扩容（reserve或首次write），扩容即孤立整个缓冲，新存储中没有本帧已写入的数据，
+/// 因此帧中不再扩容：调用方应先以整帧总字节数调用reserve，之后的写入放不下时返回-1
+class StreamBuffer {
+public:
+	enum class Mode {
+		Unsynchronized,  // 非同步映射 + 栅栏（GL 3.2+/GLES 3.0+）
+		Orphan           // 每帧孤立化（兼容路径）
+	};
+
+	/// 帧统计：最近一次beginFrame以来的写入情况
+	struct Stats {
+		qint64 uploadBytes{ 0 };  // 写入字节数
+		int    fenceWaits{ 0 };   // 栅栏未就绪、需要阻塞等待GPU的次数
+		int    orphans{ 0 };      // 孤立/重新分配存储的次数
+	};
+
+	static constexpr int kRegionCount = 3;                       // 三重缓冲
+	static constexpr qsizetype kInitialRegionBytes = 64 * 1024;  // 单个区域的初始容量
+	static constexpr qsizetype kAlignment = 16;                  // 每次写入的起始偏移对齐（满足顶点属性对齐要求）
+
+	StreamBuffer() = default;
+	~StreamBuffer() = default;
+	StreamBuffer(const StreamBuffer&) = delete;
+	StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+	/// 功能：创建缓冲对象
+	/// 参数：gl — 当前上下文的函数表
+	/// 参数：glx — GL 3.x扩展函数（为空时只能使用Orphan模式）
+	/// 参数：mode — 期望的同步方式；不受支持时自动改用Orphan
+	void initialize(QOpenGLFunctions* gl, QOpenGLExtraFunctions* glx, Mode mode = Mode::Unsynchronized);
+
+	/// 功能：释放缓冲对象与未完成的栅栏
+	void release();
+
+	/// 功能：切换同步方式（重新分配存储）
+	void setMode(Mode mode);
+	[[nodiscard]] Mode mode() const noexcept { return m_mode; }
+
+	/// 功能：开始一帧：轮转到下一个区域并等待其栅栏（Orphan模式下孤立旧存储），清零帧统计
+	void beginFrame();
+
+	/// 功能：结束一帧：为本帧写入的区域插入栅栏
+	void endFrame();
+
+	/// 功能：为本帧预留容量（在beginFrame之后、本帧首次write之前调用）
+	/// 参数：totalBytes — 本帧将写入的总字节数（各段按alignedSize计）
+	/// 返回：区域容量足够时返回true；本帧已有写入且容量不足时不扩容，返回false
+	bool reserve(qsizetype totalBytes);
+
+	/// 功能：写入一段数据
+	/// 参数：data — 源数据
+	/// 参数：bytes — 字节数
+	/// 返回：数据在缓冲中的字节偏移（用作glVertexAttribPointer的偏移）；失败或本帧剩余容量不足时返回-1
+	/// 说明：调用后GL_ARRAY_BUFFER绑定为本缓冲；容量不足时只有本帧首次写入会扩容
+	qsizetype write(const void* data, qsizetype bytes);
+
+	[[nodiscard]] GLuint buffer() const noexcept { return m_buffer; }
+	[[nodiscard]] bool isValid() const noexcept { return m_buffer != 0; }
+	[[nodiscard]] const Stats& frameStats() const noexcept { return m_stats; }
+
+	/// 功能：向上对齐到kAlignment
+	[[nodiscard]] static constexpr qsizetype alignUp(const qsizetype v) noexcept {
+		return (v + kAlignment - 1) / kAlignment * kAlignment;
+	}
+
+	/// 功能：一段数据在区域中占用的字节数（含起始对齐），用于累加reserve的总量
+	[[nodiscard]] static constexpr qsizetype alignedSize(const qsizetype bytes) noexcept {
+		return bytes > 0 ? alignUp(bytes) : 0;
+	}
+
+private:
+	/// 功能：按新的区域容量重新分配（孤立）存储，丢弃所有栅栏
+	void reallocate(qsizetype regionBytes);
+	void waitFence(int region);
+	void deleteFences();
+	[[nodiscard]] int regionCount() const noexcept { return m_mode == Mode::Unsynchronized ? kRegionCount : 1; }
+
+	QOpenGLFunctions* m_gl{ nullptr };
+	QOpenGLExtraFunctions* m_glx{ nullptr };
+	Mode m_mode{ Mode::Orphan };
+
+	GLuint    m_buffer{ 0 };
+	qsizetype m_regionBytes{ 0 };  // 单个区域容量（字节）
+	int       m_region{ 0 };       // 当前帧写入的区域
+	qsizetype m_cursor{ 0 };       // 当前区域内的写入位置
+	GLsync    m_fences[kRegionCount]{};
+
+	Stats m_stats;
+};
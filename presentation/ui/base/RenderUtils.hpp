@@ -7,8 +7,10 @@
  */
 
 #pragma once
+#include "FrameProfiler.h"
 #include "RenderData.hpp"
 
+#include <algorithm>
 #include <qbytearray.h>
 #include <qcolor.h>
 #include <qfile.h>
@@ -19,33 +21,61 @@
 
 namespace RenderUtils {
 
+	/// 功能：把父级剪裁合并进单条命令的剪裁
+	/// 参数：clip / clipRadius — 命令现有的剪裁与圆角（就地修改）
+	/// 参数：parentClip / parentRadius — 父级剪裁与圆角
+	/// 说明：交集与某一方矩形重合时沿用该方的圆角（两方重合取较大者）；
+	///       否则交集的角不再是任一方的圆角，退化为直角；两方不相交时clip为空矩形（调用方须按全部剪掉处理）
+	inline void mergeClip(QRectF& clip, float& clipRadius, const QRectF& parentClip, const float parentRadius) {
+		if (clip.width() <= 0.0 || clip.height() <= 0.0) {
+			clip = parentClip;
+			clipRadius = parentRadius;
+			return;
+		}
+		const QRectF merged = clip.intersected(parentClip);
+		const bool isParent = merged == parentClip;
+		const bool isOwn = merged == clip;
+		if (isParent && isOwn) clipRadius = std::max(clipRadius, parentRadius);
+		else if (isParent)     clipRadius = parentRadius;
+		else if (!isOwn)       clipRadius = 0.0f;
+		clip = merged;
+	}
+
 	/// 功能：对新增绘制命令应用父级剪裁区域
 	/// 参数：fd — 帧数据容器
 	/// 参数：rr0 — 圆角矩形命令的起始索引
 	/// 参数：im0 — 图像命令的起始索引  
+	/// 参数：sh0 — 投影命令的起始索引
 	/// 参数：parentClip — 父级剪裁矩形（逻辑像素）
-	/// 说明：将父容器的剪裁区域与子组件的剪裁区域求交，实现剪裁层级传递
-	inline void applyParentClip(Render::FrameData& fd, const int rr0, const int im0, const QRectF& parentClip) {
+	/// 参数：parentClipRadius — 父级剪裁的圆角半径（逻辑像素；如圆角卡片裁剪其内容）
+	/// 说明：将父容器的剪裁区域与子组件的剪裁区域求交，实现剪裁层级传递；剪裁在着色器中逐片段完成。
+	///       合并结果登记为新的剪裁表项（原项可能被范围外的命令共用），相邻命令的同一剪裁只合并一次；
+	///       子剪裁与父剪裁不相交时记为kEmptyClip（不能落成kNoClip，否则命令会不加剪裁地整块绘制）
+	inline void applyParentClip(Render::FrameData& fd, const int rr0, const int im0, const int sh0, const QRectF& parentClip,
+		const float parentClipRadius = 0.0f) {
 		if (parentClip.width() <= 0.0 || parentClip.height() <= 0.0) return;
 
-		for (int i = rr0; i < static_cast<int>(fd.roundedRects.size()); ++i) {
-			auto& cmd = fd.roundedRects[i];
-			if (cmd.clipRect.width() > 0.0 && cmd.clipRect.height() > 0.0) {
-				cmd.clipRect = cmd.clipRect.intersected(parentClip);
-			}
-			else {
-				cmd.clipRect = parentClip;
+		const FrameProfiler::ScopedStage profile(FrameProfiler::Stage::Clip);
+		const float radius = std::max(0.0f, parentClipRadius);
+		Render::ClipId lastIn = Render::kNoClip;
+		Render::ClipId lastOut = Render::kNoClip;
+		bool merged = false;
+		const auto merge = [&](Render::ClipId& id) {
+			if (id == Render::kEmptyClip) return;
+			if (!merged || id != lastIn) {
+				const Render::ClipRegion& own = fd.clip(id);
+				QRectF rect = own.rect;
+				float clipRadius = own.radiusPx;
+				mergeClip(rect, clipRadius, parentClip, radius);
+				lastIn = id;
+				lastOut = rect.width() > 0.0 && rect.height() > 0.0 ? fd.addClip(rect, clipRadius) : Render::kEmptyClip;
+				merged = true;
 			}
-		}
-		for (int i = im0; i < static_cast<int>(fd.images.size()); ++i) {
-			auto& cmd = fd.images[i];
-			if (cmd.clipRect.width() > 0.0 && cmd.clipRect.height() > 0.0) {
-				cmd.clipRect = cmd.clipRect.intersected(parentClip);
-			}
-			else {
-				cmd.clipRect = parentClip;
-			}
-		}
+			id = lastOut;
+		};
+		for (int i = rr0; i < static_cast<int>(fd.roundedRects.size()); ++i) merge(fd.roundedRects[i].clip);
+		for (int i = im0; i < static_cast<int>(fd.images.size()); ++i) merge(fd.images[i].clip);
+		for (int i = sh0; i < static_cast<int>(fd.shadows.size()); ++i) merge(fd.shadows[i].clip);
 	}
 
 	/// 功能：生成文本纹理的统一缓存键
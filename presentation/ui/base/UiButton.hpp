@@ -111,8 +111,8 @@ namespace Ui
 			if (m_opacity <= 0.001f) return; // 完全透明不绘制
 			const QRectF r = visualRectF();
 			const QColor bg = withOpacity(backgroundForState(), m_opacity);
-			fd.roundedRects.push_back(Render::RoundedRectCmd{
-				.rect = r, .radiusPx = m_corner, .color = bg, .clipRect = r // 新增：按钮背景裁剪
+			fd.addRoundedRect(Render::RoundedRectCmd{
+				.rect = r, .radiusPx = m_corner, .color = bg, .clip = fd.addClip(r) // 新增：按钮背景裁剪
 				});
 
 			if (m_iconPainter)
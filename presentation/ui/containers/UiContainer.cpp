@@ -117,10 +117,11 @@ void UiContainer::append(Render::FrameData& fd) const
 
 	const int rr0 = static_cast<int>(fd.roundedRects.size());
 	const int im0 = static_cast<int>(fd.images.size());
+	const int sh0 = static_cast<int>(fd.shadows.size());
 
 	m_child->append(fd);
 
-	RenderUtils::applyParentClip(fd, rr0, im0, QRectF(m_viewport));
+	RenderUtils::applyParentClip(fd, rr0, im0, sh0, QRectF(m_viewport));
 }
 
 bool UiContainer::onMousePress(const QPoint& pos)
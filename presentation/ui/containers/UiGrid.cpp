@@ -738,10 +738,11 @@ void UiGrid::append(Render::FrameData& fd) const {
 
 		const int rr0 = static_cast<int>(fd.roundedRects.size());
 		const int im0 = static_cast<int>(fd.images.size());
+		const int sh0 = static_cast<int>(fd.shadows.size());
 
 		ch.component->append(fd);
 
-		RenderUtils::applyParentClip(fd, rr0, im0, parentClip);
+		RenderUtils::applyParentClip(fd, rr0, im0, sh0, parentClip);
 	}
 }
 
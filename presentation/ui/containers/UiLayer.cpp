@@ -0,0 +1,184 @@
+#include "UiLayer.h"
+
+#include "DamageTracker.h"
+#include "IFocusable.hpp"
+#include "IFocusContainer.hpp"
+#include "ILayoutable.hpp"
+#include "RenderData.hpp"
+#include "UiComponent.hpp"
+#include "UiContent.hpp"
+#include "UiRetained.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <qcolor.h>
+#include <qpoint.h>
+#include <qrect.h>
+#include <qsize.h>
+#include <utility>
+
+UiLayer::UiLayer(std::unique_ptr<IUiComponent> child)
+	: m_child(std::move(child))
+	, m_id(s_nextId++)
+{
+}
+
+void UiLayer::setOpacity(const float opacity) noexcept
+{
+	m_opacity = std::clamp(opacity, 0.0f, 1.0f);
+}
+
+bool UiLayer::isDirty() const noexcept
+{
+	return m_dirty || m_epoch != UiRetained::epoch();
+}
+
+QPoint UiLayer::toChild(const QPoint& pos) const noexcept
+{
+	return pos - QPoint(static_cast<int>(std::lround(m_offset.x())), static_cast<int>(std::lround(m_offset.y())));
+}
+
+void UiLayer::setViewportRect(const QRect& r)
+{
+	if (r != m_viewport) m_dirty = true;
+	m_viewport = r;
+	if (auto* c = dynamic_cast<IUiContent*>(m_child.get())) {
+		c->setViewportRect(r);
+	}
+}
+
+QSize UiLayer::measure(const SizeConstraints& cs)
+{
+	if (!m_child) {
+		return QSize(std::clamp(0, cs.minW, cs.maxW),
+			std::clamp(0, cs.minH, cs.maxH));
+	}
+
+	if (auto* l = dynamic_cast<ILayoutable*>(m_child.get())) {
+		return l->measure(cs);
+	}
+	QSize inner = m_child->bounds().size();
+	inner.setWidth(std::clamp(inner.width(), cs.minW, cs.maxW));
+	inner.setHeight(std::clamp(inner.height(), cs.minH, cs.maxH));
+	return inner;
+}
+
+void UiLayer::arrange(const QRect& finalRect)
+{
+	if (finalRect != m_viewport) m_dirty = true;
+	m_viewport = finalRect;
+	if (!m_child) return;
+
+	if (auto* c = dynamic_cast<IUiContent*>(m_child.get())) {
+		c->setViewportRect(finalRect);
+	}
+	if (auto* l = dynamic_cast<ILayoutable*>(m_child.get())) {
+		l->arrange(finalRect);
+	}
+}
+
+void UiLayer::updateLayout(const QSize& windowSize)
+{
+	m_dirty = true;
+	if (m_child) m_child->updateLayout(windowSize);
+}
+
+void UiLayer::updateResourceContext(IconCache& cache, QOpenGLFunctions* gl, const float devicePixelRatio)
+{
+	m_dirty = true;
+	if (m_child) m_child->updateResourceContext(cache, gl, devicePixelRatio);
+}
+
+void UiLayer::append(Render::FrameData& fd) const
+{
+	if (!m_child) return;
+
+	if (isDirty()) {
+		auto content = std::make_shared<Render::FrameData>();
+		m_child->append(*content);
+
+		// 内容范围：全部命令覆盖范围的外接整像素矩形（整数原点使DPR为整数时纹素与屏幕像素对齐）
+		QRectF united;
+		for (const auto& ref : content->commands) united = united.united(DamageTracker::commandBounds(*content, ref));
+		m_bounds = QRectF(united.toAlignedRect());
+
+		m_content = std::move(content);
+		++m_version;
+		m_dirty = false;
+		m_epoch = UiRetained::epoch();
+		++s_stats.records;
+	}
+	else {
+		++s_stats.composites;
+	}
+
+	if (!m_content || m_bounds.isEmpty() || m_opacity <= 0.0f) return;
+	fd.addLayer(Render::LayerDef{ .id = m_id, .version = m_version, .bounds = m_bounds, .content = m_content },
+		Render::ImageCmd{
+			.dstRect = m_bounds.translated(m_offset),
+			.textureId = Render::layerTextureId(m_id),
+			.srcRectPx = QRectF(0.0, 0.0, m_bounds.width(), m_bounds.height()),
+			.tint = QColor(255, 255, 255, static_cast<int>(std::lround(m_opacity * 255.0f)))
+		});
+}
+
+bool UiLayer::onMousePress(const QPoint& pos)
+{
+	m_dirty = true;
+	return m_child ? m_child->onMousePress(toChild(pos)) : false;
+}
+
+bool UiLayer::onMouseMove(const QPoint& pos)
+{
+	const bool handled = m_child ? m_child->onMouseMove(toChild(pos)) : false;
+	if (handled) m_dirty = true;
+	return handled;
+}
+
+bool UiLayer::onMouseRelease(const QPoint& pos)
+{
+	m_dirty = true;
+	return m_child ? m_child->onMouseRelease(toChild(pos)) : false;
+}
+
+bool UiLayer::onWheel(const QPoint& pos, const QPoint& angleDelta)
+{
+	m_dirty = true;
+	return m_child ? m_child->onWheel(toChild(pos), angleDelta) : false;
+}
+
+bool UiLayer::tick()
+{
+	// 子树自身的动画改变内容；图层级别的移动/淡入淡出由调用方驱动setOffset/setOpacity，不经过这里
+	const bool animating = m_child ? m_child->tick() : false;
+	if (animating || m_wasAnimating) m_dirty = true;
+	m_wasAnimating = animating;
+	return animating;
+}
+
+QRect UiLayer::bounds() const
+{
+	if (m_viewport.isValid()) return m_viewport;
+	return m_child ? m_child->bounds() : QRect();
+}
+
+void UiLayer::onThemeChanged(const bool isDark)
+{
+	m_dirty = true;
+	if (m_child) m_child->onThemeChanged(isDark);
+}
+
+void UiLayer::enumerateFocusables(std::vector<IFocusable*>& out) const
+{
+	if (!m_child) return;
+
+	if (auto* focusable = dynamic_cast<IFocusable*>(m_child.get())) {
+		if (focusable->canFocus()) {
+			out.push_back(focusable);
+		}
+	}
+	if (auto* container = dynamic_cast<IFocusContainer*>(m_child.get())) {
+		container->enumerateFocusables(out);
+	}
+}
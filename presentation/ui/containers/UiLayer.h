@@ -0,0 +1,107 @@
+/*
+ * 文件名：UiLayer.h
+ * 职责：离屏图层容器，把子树录制为一份图层内容，由渲染器绘制到缓存纹理，再以不透明度与平移合成。
+ * 依赖：UI组件接口、渲染数据结构、UiRetained（全局失效纪元）。
+ * 线程：仅在UI线程使用。
+ * 备注：失效规则与UiRetained相同；只改变不透明度或平移时不重新录制，渲染器每帧只合成一个纹理四边形。
+ */
+
+#pragma once
+#include "IFocusContainer.hpp"
+#include "ILayoutable.hpp"
+#include "RenderData.hpp"
+#include "UiComponent.hpp"
+#include "UiContent.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <qpoint.h>
+#include <qrect.h>
+#include <qsize.h>
+#include <vector>
+
+/// 离屏图层容器：子树整体作为一张纹理合成
+///
+/// 用途：
+/// - 组不透明度：子内容先不透明地合成到图层，再整体按opacity混合，重叠的子内容不会相互透出
+/// - 移动/淡入淡出动画：setOffset/setOpacity只改变合成命令，子树既不重新录制，图层纹理也不重绘
+///
+/// 内容范围取子树全部命令覆盖范围（含投影模糊带与抗锯齿外扩）的外接整像素矩形；
+/// 内容版本在每次重新录制时递增，渲染器据此决定是否重绘纹理。
+/// 合成命令是普通的ImageCmd，上级容器的applyParentClip照常作用于它。
+class UiLayer final : public IUiComponent, public IUiContent, public ILayoutable, public IFocusContainer {
+public:
+	/// 统计（进程内累计）
+	struct Stats {
+		std::int64_t records{ 0 };     // 重新录制内容的次数（每次都会使渲染器重绘图层纹理）
+		std::int64_t composites{ 0 };  // 只输出合成命令的次数
+	};
+
+	explicit UiLayer(std::unique_ptr<IUiComponent> child);
+	~UiLayer() override = default;
+
+	[[nodiscard]] IUiComponent* child() const noexcept { return m_child.get(); }
+
+	/// 功能：设置合成不透明度（0~1，不触发内容重绘）
+	void setOpacity(float opacity) noexcept;
+	[[nodiscard]] float opacity() const noexcept { return m_opacity; }
+
+	/// 功能：设置合成平移（逻辑像素，不触发内容重绘；鼠标事件按平移换算后转发给子树）
+	void setOffset(const QPointF& offset) noexcept { m_offset = offset; }
+	[[nodiscard]] QPointF offset() const noexcept { return m_offset; }
+
+	/// 功能：使图层内容失效（子树状态被外部直接修改时调用）
+	void invalidate() noexcept { m_dirty = true; }
+	[[nodiscard]] bool isDirty() const noexcept;
+
+	[[nodiscard]] int layerId() const noexcept { return m_id; }
+	[[nodiscard]] std::uint64_t version() const noexcept { return m_version; }
+	/// 功能：最近一次录制的内容范围（逻辑像素）
+	[[nodiscard]] QRectF contentBounds() const noexcept { return m_bounds; }
+
+	[[nodiscard]] static const Stats& stats() noexcept { return s_stats; }
+	static void resetStats() noexcept { s_stats = Stats{}; }
+
+	// IUiContent
+	void setViewportRect(const QRect& r) override;
+
+	// ILayoutable
+	QSize measure(const SizeConstraints& cs) override;
+	void arrange(const QRect& finalRect) override;
+
+	// IUiComponent
+	void updateLayout(const QSize& windowSize) override;
+	void updateResourceContext(IconCache& cache, QOpenGLFunctions* gl, float devicePixelRatio) override;
+	void append(Render::FrameData& fd) const override;
+	bool onMousePress(const QPoint& pos) override;
+	bool onMouseMove(const QPoint& pos) override;
+	bool onMouseRelease(const QPoint& pos) override;
+	bool onWheel(const QPoint& pos, const QPoint& angleDelta) override;
+	bool tick() override;
+	QRect bounds() const override;
+	void onThemeChanged(bool isDark) override;
+
+	// IFocusContainer
+	void enumerateFocusables(std::vector<IFocusable*>& out) const override;
+
+private:
+	/// 功能：把窗口坐标换算为子树坐标（去掉合成平移）
+	[[nodiscard]] QPoint toChild(const QPoint& pos) const noexcept;
+
+	std::unique_ptr<IUiComponent> m_child;
+	QRect   m_viewport;
+	float   m_opacity{ 1.0f };
+	QPointF m_offset;
+	int     m_id;
+
+	// 录制的内容（append为const，录制时更新）；每次录制新建一份，上一份可能仍被帧数据引用
+	mutable std::shared_ptr<const Render::FrameData> m_content;
+	mutable QRectF        m_bounds;
+	mutable std::uint64_t m_version{ 0 };
+	mutable bool          m_dirty{ true };
+	mutable std::uint64_t m_epoch{ 0 };
+	bool m_wasAnimating{ false };
+
+	static inline int s_nextId{ 1 };
+	static inline Stats s_stats{};
+};
@@ -129,11 +129,11 @@ void UiPage::append(Render::FrameData& fd) const
 	const QRectF card = cardRectF();
 
 	// 背景卡片
-	fd.roundedRects.push_back(Render::RoundedRectCmd{
+	fd.addRoundedRect(Render::RoundedRectCmd{
 		.rect = card,
 		.radiusPx = m_cornerRadius,
 		.color = m_pal.cardBg,
-		.clipRect = QRectF(m_viewport) // 裁剪到页面 viewport
+		.clip = fd.addClip(QRectF(m_viewport)) // 裁剪到页面 viewport
 		});
 
 	// 标题文字
@@ -158,22 +158,23 @@ void UiPage::append(Render::FrameData& fd) const
 
 	const QRectF dst(centerX, centerY, textX, textY);
 
-	fd.images.push_back(Render::ImageCmd{
+	fd.addImage(Render::ImageCmd{
 		.dstRect = dst,
 		.textureId = tex,
 		.srcRectPx = QRectF(0, 0, ts.width(), ts.height()),
 		.tint = QColor(255,255,255,255),
-		.clipRect = card // 标题裁剪到卡片
+		.clip = fd.addClip(card) // 标题裁剪到卡片
 		});
 
 	// 内容裁剪到内容区
 	if (m_content) {
 		const int rr0 = static_cast<int>(fd.roundedRects.size());
 		const int im0 = static_cast<int>(fd.images.size());
+		const int sh0 = static_cast<int>(fd.shadows.size());
 
 		m_content->append(fd);
 
-		RenderUtils::applyParentClip(fd, rr0, im0, contentRectF());
+		RenderUtils::applyParentClip(fd, rr0, im0, sh0, contentRectF());
 	}
 }
 
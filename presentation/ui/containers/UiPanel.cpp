@@ -268,11 +268,11 @@ void UiPanel::append(Render::FrameData& fd) const
 			m_margins.left(), m_margins.top(),
 			-m_margins.right(), -m_margins.bottom());
 		if (bgRect.isValid()) {
-			fd.roundedRects.push_back(Render::RoundedRectCmd{
+			fd.addRoundedRect(Render::RoundedRectCmd{
 				.rect = QRectF(bgRect),
 				.radiusPx = m_radius,
 				.color = m_bg,
-				.clipRect = QRectF(m_viewport) // 仍以整个 viewport 裁剪
+				.clip = fd.addClip(QRectF(m_viewport)) // 仍以整个 viewport 裁剪
 				});
 		}
 	}
@@ -285,10 +285,11 @@ void UiPanel::append(Render::FrameData& fd) const
 
 		const int rr0 = static_cast<int>(fd.roundedRects.size());
 		const int im0 = static_cast<int>(fd.images.size());
+		const int sh0 = static_cast<int>(fd.shadows.size());
 
 		ch.component->append(fd);
 
-		RenderUtils::applyParentClip(fd, rr0, im0, parentClip);
+		RenderUtils::applyParentClip(fd, rr0, im0, sh0, parentClip);
 	}
 }
 
@@ -0,0 +1,154 @@
+#include "UiRetained.h"
+
+#include "IFocusable.hpp"
+#include "IFocusContainer.hpp"
+#include "ILayoutable.hpp"
+#include "RenderData.hpp"
+#include "UiComponent.hpp"
+#include "UiContent.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <qpoint.h>
+#include <qrect.h>
+#include <qsize.h>
+#include <utility>
+
+UiRetained::UiRetained(std::unique_ptr<IUiComponent> child)
+	: m_child(std::move(child))
+{
+}
+
+void UiRetained::setViewportRect(const QRect& r)
+{
+	if (r != m_viewport) m_dirty = true;
+	m_viewport = r;
+	if (auto* c = dynamic_cast<IUiContent*>(m_child.get())) {
+		c->setViewportRect(r);
+	}
+}
+
+QSize UiRetained::measure(const SizeConstraints& cs)
+{
+	if (!m_child) {
+		return QSize(std::clamp(0, cs.minW, cs.maxW),
+			std::clamp(0, cs.minH, cs.maxH));
+	}
+
+	if (auto* l = dynamic_cast<ILayoutable*>(m_child.get())) {
+		return l->measure(cs);
+	}
+	QSize inner = m_child->bounds().size();
+	inner.setWidth(std::clamp(inner.width(), cs.minW, cs.maxW));
+	inner.setHeight(std::clamp(inner.height(), cs.minH, cs.maxH));
+	return inner;
+}
+
+void UiRetained::arrange(const QRect& finalRect)
+{
+	if (finalRect != m_viewport) m_dirty = true;
+	m_viewport = finalRect;
+	if (!m_child) return;
+
+	if (auto* c = dynamic_cast<IUiContent*>(m_child.get())) {
+		c->setViewportRect(finalRect);
+	}
+	if (auto* l = dynamic_cast<ILayoutable*>(m_child.get())) {
+		l->arrange(finalRect);
+	}
+}
+
+void UiRetained::updateLayout(const QSize& windowSize)
+{
+	m_dirty = true;
+	if (m_child) m_child->updateLayout(windowSize);
+}
+
+void UiRetained::updateResourceContext(IconCache& cache, QOpenGLFunctions* gl, const float devicePixelRatio)
+{
+	// 纹理句柄可能随DPR或缓存模式变化
+	m_dirty = true;
+	if (m_child) m_child->updateResourceContext(cache, gl, devicePixelRatio);
+}
+
+void UiRetained::append(Render::FrameData& fd) const
+{
+	if (!m_child) return;
+
+	if (isDirty()) {
+		m_cache.clear();
+		m_child->append(m_cache);
+		m_dirty = false;
+		m_epoch = s_epoch;
+		++s_stats.records;
+	}
+	else {
+		++s_stats.replays;
+		s_stats.replayedCommands += static_cast<std::int64_t>(m_cache.commands.size());
+	}
+	fd.appendFrame(m_cache);
+}
+
+bool UiRetained::onMousePress(const QPoint& pos)
+{
+	// 按下/释放/滚轮较少发生，无论是否处理都视为可能改变了状态
+	m_dirty = true;
+	return m_child ? m_child->onMousePress(pos) : false;
+}
+
+bool UiRetained::onMouseMove(const QPoint& pos)
+{
+	// 移动频繁：只有组件报告已处理（悬停状态变化）时才失效
+	const bool handled = m_child ? m_child->onMouseMove(pos) : false;
+	if (handled) m_dirty = true;
+	return handled;
+}
+
+bool UiRetained::onMouseRelease(const QPoint& pos)
+{
+	m_dirty = true;
+	return m_child ? m_child->onMouseRelease(pos) : false;
+}
+
+bool UiRetained::onWheel(const QPoint& pos, const QPoint& angleDelta)
+{
+	m_dirty = true;
+	return m_child ? m_child->onWheel(pos, angleDelta) : false;
+}
+
+bool UiRetained::tick()
+{
+	const bool animating = m_child ? m_child->tick() : false;
+	if (animating || m_wasAnimating) m_dirty = true;
+	m_wasAnimating = animating;
+	return animating;
+}
+
+QRect UiRetained::bounds() const
+{
+	if (m_viewport.isValid()) return m_viewport;
+	return m_child ? m_child->bounds() : QRect();
+}
+
+void UiRetained::onThemeChanged(const bool isDark)
+{
+	m_dirty = true;
+	if (m_child) m_child->onThemeChanged(isDark);
+}
+
+void UiRetained::enumerateFocusables(std::vector<IFocusable*>& out) const
+{
+	if (!m_child) return;
+
+	// 如果子组件本身可以获得焦点，添加它
+	if (auto* focusable = dynamic_cast<IFocusable*>(m_child.get())) {
+		if (focusable->canFocus()) {
+			out.push_back(focusable);
+		}
+	}
+
+	// 如果子组件是容器，递归枚举其可焦点子组件
+	if (auto* container = dynamic_cast<IFocusContainer*>(m_child.get())) {
+		container->enumerateFocusables(out);
+	}
+}
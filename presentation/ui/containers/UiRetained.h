@@ -0,0 +1,94 @@
+/*
+ * 文件名：UiRetained.h
+ * 职责：保留模式容器，缓存子树上一次生成的绘制命令，子树未变化时直接重放，跳过整棵子树的append。
+ * 依赖：UI组件接口、渲染数据结构。
+ * 线程：仅在UI线程使用。
+ * 备注：按需启用（声明式修饰器retained()）；子树的可见状态只能经由本容器转发的调用改变，否则需调用invalidate()。
+ */
+
+#pragma once
+#include "IFocusContainer.hpp"
+#include "ILayoutable.hpp"
+#include "RenderData.hpp"
+#include "UiComponent.hpp"
+#include "UiContent.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <qpoint.h>
+#include <qrect.h>
+#include <qsize.h>
+#include <vector>
+
+/// 保留模式容器：为子树缓存一份命令切片（display list）
+///
+/// 失效来源（任一发生即在下一次append时重新录制）：
+/// - 布局：updateLayout、视口或arrange矩形变化
+/// - 主题与资源上下文：onThemeChanged、updateResourceContext
+/// - 交互：按下、释放、滚轮事件，以及返回已处理的鼠标移动（悬停变化）
+/// - 动画：tick返回true的帧及其后一帧（动画末帧把状态写到终值后返回false）
+/// - 全局：invalidateAll()（子树重建、键盘输入、焦点变化等不经过本容器的状态变化）
+///
+/// 缓存的是子树自身的输出（未经上级剪裁），上级容器的applyParentClip照常作用于重放出的命令。
+class UiRetained final : public IUiComponent, public IUiContent, public ILayoutable, public IFocusContainer {
+public:
+	/// 命中统计（进程内累计，用于衡量录制开销）
+	struct Stats {
+		std::int64_t replays{ 0 };          // 直接重放缓存的次数
+		std::int64_t records{ 0 };          // 重新录制子树的次数
+		std::int64_t replayedCommands{ 0 }; // 重放的命令条数
+	};
+
+	explicit UiRetained(std::unique_ptr<IUiComponent> child);
+	~UiRetained() override = default;
+
+	[[nodiscard]] IUiComponent* child() const noexcept { return m_child.get(); }
+
+	/// 功能：使本容器的缓存失效（子树状态被外部直接修改时调用）
+	void invalidate() noexcept { m_dirty = true; }
+	[[nodiscard]] bool isDirty() const noexcept { return m_dirty || m_epoch != s_epoch; }
+
+	/// 功能：使所有保留模式容器的缓存失效
+	/// 说明：RebuildHost重建、UiRoot分发键盘与焦点变化时调用
+	static void invalidateAll() noexcept { ++s_epoch; }
+	/// 功能：当前全局失效纪元（其他缓存子树输出的容器据此判断invalidateAll，如UiLayer）
+	[[nodiscard]] static std::uint64_t epoch() noexcept { return s_epoch; }
+
+	[[nodiscard]] static const Stats& stats() noexcept { return s_stats; }
+	static void resetStats() noexcept { s_stats = Stats{}; }
+
+	// IUiContent
+	void setViewportRect(const QRect& r) override;
+
+	// ILayoutable
+	QSize measure(const SizeConstraints& cs) override;
+	void arrange(const QRect& finalRect) override;
+
+	// IUiComponent
+	void updateLayout(const QSize& windowSize) override;
+	void updateResourceContext(IconCache& cache, QOpenGLFunctions* gl, float devicePixelRatio) override;
+	void append(Render::FrameData& fd) const override;
+	bool onMousePress(const QPoint& pos) override;
+	bool onMouseMove(const QPoint& pos) override;
+	bool onMouseRelease(const QPoint& pos) override;
+	bool onWheel(const QPoint& pos, const QPoint& angleDelta) override;
+	bool tick() override;
+	QRect bounds() const override;
+	void onThemeChanged(bool isDark) override;
+
+	// IFocusContainer
+	void enumerateFocusables(std::vector<IFocusable*>& out) const override;
+
+private:
+	std::unique_ptr<IUiComponent> m_child;
+	QRect m_viewport;
+
+	// 缓存的命令切片（append为const，录制时更新）
+	mutable Render::FrameData m_cache;
+	mutable bool          m_dirty{ true };
+	mutable std::uint64_t m_epoch{ 0 };
+	bool m_wasAnimating{ false };
+
+	static inline std::uint64_t s_epoch{ 1 };
+	static inline Stats s_stats{};
+};
@@ -4,6 +4,7 @@
 #include "UiContent.hpp"
 #include "ILayoutable.hpp"
 #include "IFocusContainer.hpp"
+#include "UiRetained.h"
 #include "UiRoot.h"
 
 #include <qopenglfunctions.h>
@@ -69,11 +70,12 @@ void UiRoot::append(Render::FrameData& fd) const
 
 		const int rr0 = static_cast<int>(fd.roundedRects.size());
 		const int im0 = static_cast<int>(fd.images.size());
+		const int sh0 = static_cast<int>(fd.shadows.size());
 
 		c->append(fd);
 
 		const auto clip = QRectF(c->bounds());
-		RenderUtils::applyParentClip(fd, rr0, im0, clip);
+		RenderUtils::applyParentClip(fd, rr0, im0, sh0, clip);
 	}
 }
 
@@ -169,7 +171,10 @@ bool UiRoot::onKeyPress(int key, Qt::KeyboardModifiers modifiers)
 	if (m_focusedComponent) {
 		// 尝试转换为IKeyInput接口
 		if (auto* keyInput = dynamic_cast<IKeyInput*>(m_focusedComponent)) {
-			return keyInput->onKeyPress(key, modifiers);
+			// 键盘输入直达焦点组件，不经过保留模式容器
+			const bool handled = keyInput->onKeyPress(key, modifiers);
+			if (handled) UiRetained::invalidateAll();
+			return handled;
 		}
 	}
 	return false;
@@ -181,7 +186,9 @@ bool UiRoot::onKeyRelease(int key, Qt::KeyboardModifiers modifiers)
 	if (m_focusedComponent) {
 		// 尝试转换为IKeyInput接口
 		if (auto* keyInput = dynamic_cast<IKeyInput*>(m_focusedComponent)) {
-			return keyInput->onKeyRelease(key, modifiers);
+			const bool handled = keyInput->onKeyRelease(key, modifiers);
+			if (handled) UiRetained::invalidateAll();
+			return handled;
 		}
 	}
 	return false;
@@ -189,6 +196,8 @@ bool UiRoot::onKeyRelease(int key, Qt::KeyboardModifiers modifiers)
 
 void UiRoot::setFocus(IUiComponent* component)
 {
+	UiRetained::invalidateAll();  // 焦点样式变化不经过保留模式容器
+
 	// 清除当前焦点
 	if (m_focusedComponent) {
 		if (auto* focusable = dynamic_cast<IFocusable*>(m_focusedComponent)) {
@@ -211,6 +220,8 @@ void UiRoot::setFocus(IUiComponent* component)
 
 void UiRoot::clearFocus()
 {
+	UiRetained::invalidateAll();
+
 	if (m_focusedComponent) {
 		if (auto* focusable = dynamic_cast<IFocusable*>(m_focusedComponent)) {
 			focusable->setFocused(false);
@@ -1,3 +1,4 @@
+#include "FrameClock.h"
 #include "IFocusable.hpp"
 #include "IFocusContainer.hpp"
 #include "ILayoutable.hpp"
@@ -14,7 +15,6 @@
 
 UiScrollView::UiScrollView() {
 	applyTheme(false); // 初始化为浅色主题
-	m_animClock.start(); // 启动动画计时器
 	m_thumbAlpha = BASE_ALPHA; // 初始化为基础半透明状态
 }
 
@@ -205,6 +205,7 @@ void UiScrollView::append(Render::FrameData& fd) const {
 	// 记录当前命令数量，用于应用裁剪
 	const int rr0 = static_cast<int>(fd.roundedRects.size());
 	const int im0 = static_cast<int>(fd.images.size());
+	const int sh0 = static_cast<int>(fd.shadows.size());
 
 	// 先添加子组件的渲染命令
 	if (m_child) {
@@ -212,7 +213,7 @@ void UiScrollView::append(Render::FrameData& fd) const {
 	}
 
 	// 将子组件的渲染命令裁剪到容器视口
-	RenderUtils::applyParentClip(fd, rr0, im0, QRectF(m_viewport));
+	RenderUtils::applyParentClip(fd, rr0, im0, sh0, QRectF(m_viewport));
 
 	// 渲染滚动条
 	if (isScrollbarVisible()) {
@@ -233,11 +234,11 @@ void UiScrollView::renderScrollbar(Render::FrameData& fd) const {
 	QColor trackColor = m_trackColor;
 	trackColor.setAlphaF(trackColor.alphaF() * m_thumbAlpha);
 
-	fd.roundedRects.push_back(Render::RoundedRectCmd{
+	fd.addRoundedRect(Render::RoundedRectCmd{
 		.rect = QRectF(scrollbarRect),
 		.radiusPx = radiusPx,  // 使用药丸形圆角
 		.color = trackColor,
-		.clipRect = QRectF(m_viewport)
+		.clip = fd.addClip(QRectF(m_viewport))
 		});
 
 	// 渲染滚动条 thumb
@@ -253,11 +254,11 @@ void UiScrollView::renderScrollbar(Render::FrameData& fd) const {
 		// 应用淡入淡出透明度
 		thumbColor.setAlphaF(thumbColor.alphaF() * m_thumbAlpha);
 
-		fd.roundedRects.push_back(Render::RoundedRectCmd{
+		fd.addRoundedRect(Render::RoundedRectCmd{
 			.rect = QRectF(thumbRect),
 			.radiusPx = radiusPx,  // 使用药丸形圆角
 			.color = thumbColor,
-			.clipRect = QRectF(m_viewport)
+			.clip = fd.addClip(QRectF(m_viewport))
 			});
 	}
 }
@@ -275,7 +276,7 @@ bool UiScrollView::onMousePress(const QPoint& pos) {
 		if (getUpButtonRect().contains(pos)) {
 			// 点击上按钮
 			m_repeatUp = true;
-			m_repeatStartMs = m_animClock.elapsed();
+			m_repeatStartMs = FrameClock::nowMs();
 			m_lastRepeatMs = m_repeatStartMs;
 			setScrollY(scrollY() - REPEAT_STEP_PX);  // 立即滚动一步
 			showScrollbar();
@@ -284,7 +285,7 @@ bool UiScrollView::onMousePress(const QPoint& pos) {
 		else if (getDownButtonRect().contains(pos)) {
 			// 点击下按钮
 			m_repeatDown = true;
-			m_repeatStartMs = m_animClock.elapsed();
+			m_repeatStartMs = FrameClock::nowMs();
 			m_lastRepeatMs = m_repeatStartMs;
 			setScrollY(scrollY() + REPEAT_STEP_PX);  // 立即滚动一步
 			showScrollbar();
@@ -439,7 +440,7 @@ bool UiScrollView::tick() {
 
 	// 处理重复滚动按钮
 	if (m_repeatUp || m_repeatDown) {
-		const qint64 now = m_animClock.elapsed();
+		const qint64 now = FrameClock::nowMs();
 		const qint64 timeSinceStart = now - m_repeatStartMs;
 
 		// 检查是否超过初始延时，并且到了重复间隔
@@ -465,7 +466,7 @@ bool UiScrollView::tick() {
 
 	// 处理滚动条淡入淡出动画
 	if (m_animActive) {
-		const qint64 now = m_animClock.elapsed();
+		const qint64 now = FrameClock::nowMs();
 		const qint64 timeSinceInteract = now - m_lastInteractMs;
 
 		if (timeSinceInteract > FADE_DELAY_MS) {
@@ -496,7 +497,7 @@ bool UiScrollView::tick() {
 void UiScrollView::showScrollbar() {
 	m_thumbAlpha = 1.0f;
 	m_animActive = true;
-	m_lastInteractMs = m_animClock.elapsed();
+	m_lastInteractMs = FrameClock::nowMs();
 }
 
 void UiScrollView::applyTheme(const bool isDark) {
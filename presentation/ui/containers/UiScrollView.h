@@ -5,7 +5,6 @@
 #include "UiContent.hpp"
 
 #include <qcolor.h>
-#include <qelapsedtimer.h>
 #include <qpoint.h>
 #include <qrect.h>
 #include <qsize.h>
@@ -142,7 +141,6 @@ private:
 	float m_thumbAlpha{ 0.0f };     // 0..1（乘以颜色 alpha 使用）
 	bool  m_animActive{ false };
 	qint64 m_lastInteractMs{ 0 };
-	mutable QElapsedTimer m_animClock;  // 动画计时器
 
 	// 动画参数
 	static constexpr qint64 FADE_DELAY_MS = 600;   // 静默后开始淡出的延时
@@ -301,12 +301,12 @@ namespace UI {
 				const QRectF dst(std::round(x), std::round(lineTop), std::round(drawW), std::round(hLogical));
 				if (dst.width() <= 0.0 || dst.height() <= 0.0) continue;
 
-				fd.images.push_back(Render::ImageCmd{
+				fd.addImage(Render::ImageCmd{
 					.dstRect = dst,
 					.textureId = ln.tex,
 					.srcRectPx = srcPx,
 					.tint = QColor(255,255,255,255),
-					.clipRect = QRectF(m_bounds)
+					.clip = fd.addClip(QRectF(m_bounds))
 					});
 			}
 		}
@@ -435,12 +435,12 @@ namespace UI {
 			const int tex = m_cache->ensureSvgPx(key, svg, QSize(px, px), m_gl);
 			const QSize ts = m_cache->textureSizePx(tex);
 
-			fd.images.push_back(Render::ImageCmd{
+			fd.addImage(Render::ImageCmd{
 				.dstRect = dst,
 				.textureId = tex,
 				.srcRectPx = QRectF(0, 0, ts.width(), ts.height()),
 				.tint = m_color,                     // 以白膜纹理 + tint 输出指定颜色
-				.clipRect = QRectF(m_bounds)         // 严格裁剪到自身 bounds
+				.clip = fd.addClip(QRectF(m_bounds))         // 严格裁剪到自身 bounds
 				});
 		}
 
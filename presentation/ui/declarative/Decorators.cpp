@@ -143,87 +143,66 @@ namespace UI
 				// 应用阴影偏移
 				const QRect shadowRect = shadowBaseRect.translated(m_p.shadowOffset);
 				
-				// 计算分层数量：增加层数以获得更平滑的渐变 layers = clamp(round(blurPx), 8, 64)
+				// 基础半径
+				const float baseRadius = std::max(0.0f, m_p.bgRadius - static_cast<float>(bw));
+
+				// 峰值不透明度与原先的分层叠加保持一致：
+				// 形状内部被全部 layers = clamp(round(blurPx), 8, 64) 层覆盖，第 i 层 alpha_i = baseAlpha * exp(-2.5 * i / layers)
 				const int layers = std::clamp(
 					static_cast<int>(std::round(std::max(1.0f, m_p.shadowBlurPx))),
 					8, 64
 				);
-				
-				// 基础半径
-				const float baseRadius = std::max(0.0f, m_p.bgRadius - static_cast<float>(bw));
-				
-				// 基础透明度
 				const float baseAlpha = static_cast<float>(m_p.shadowColor.alpha()) / 255.0f;
-				
-				// 绘制多层阴影以模拟模糊效果
+				float transmit = 1.0f;
 				for (int i = 1; i <= layers; ++i)
 				{
-					// t ∈ (0, 1]，第 i 层的参数化位置
 					const float t = static_cast<float>(i) / static_cast<float>(layers);
-					
-					// 计算扩展：expand = spreadPx + t * blurPx
-					const float expand = m_p.shadowSpreadPx + t * m_p.shadowBlurPx;
-					
-					// 扩展矩形
-					const QRectF layerRect = QRectF(shadowRect).adjusted(-expand, -expand, expand, expand);
-					
-					// 扩展半径
-					const float layerRadius = baseRadius + expand;
-					
-					// 改进的 alpha 衰减：使用指数衰减实现更平滑的渐变 alpha_i = baseAlpha * exp(-2.5 * t)
-					const float falloff = std::exp(-2.5f * t);
-					const float layerAlpha = baseAlpha * falloff;
-					
-					// 创建该层的颜色
-					QColor layerColor = m_p.shadowColor;
-					layerColor.setAlphaF(layerAlpha);
-					
-					// 添加圆角矩形命令，使用扩展的阴影裁剪区域
-					fd.roundedRects.push_back(Render::RoundedRectCmd{
-						.rect = layerRect,
-						.radiusPx = layerRadius,
-						.color = withOpacity(layerColor, m_p.opacity),
-						.clipRect = shadowClip
-					});
+					transmit *= 1.0f - baseAlpha * std::exp(-2.5f * t);
 				}
+
+				QColor color = m_p.shadowColor;
+				color.setAlphaF(std::clamp(1.0f - transmit, 0.0f, 1.0f));
+
+				// 单条解析高斯投影：形状 = 偏移后的基础矩形按 spread 外扩，边缘按 blurPx 衰减
+				const float spread = m_p.shadowSpreadPx;
+				fd.addShadow(Render::ShadowCmd{
+					.rect = QRectF(shadowRect).adjusted(-spread, -spread, spread, spread),
+					.radiusPx = std::max(0.0f, baseRadius + spread),
+					.blurPx = m_p.shadowBlurPx,
+					.color = withOpacity(color, m_p.opacity),
+					.clip = fd.addClip(shadowClip)
+				});
 			}
 		}
 
-		// 再画边框（若启用）
-		if (m_drawRect.isValid() && borderColor.alpha() > 0 && m_p.borderW > 0.0f)
+		// 再画背景与边框（若启用）：一条带内侧描边的命令，背景只填充边框以内，半透明背景下边框也不会被透出的底色污染
+		const bool hasBorder = borderColor.alpha() > 0 && m_p.borderW > 0.0f;
+		if (m_drawRect.isValid() && (hasBorder || bgColor.alpha() > 0))
 		{
-			fd.roundedRects.push_back(Render::RoundedRectCmd{
+			const int bw = hasBorder ? static_cast<int>(std::round(m_p.borderW)) : 0;
+			fd.addRoundedRect(Render::RoundedRectCmd{
 				.rect = QRectF(m_drawRect),
-				.radiusPx = (m_p.borderRadius > 0.0f ? m_p.borderRadius : m_p.bgRadius),
-				.color = withOpacity(borderColor, m_p.opacity),
-				.clipRect = clip
+				.radiusPx = (hasBorder && m_p.borderRadius > 0.0f) ? m_p.borderRadius : m_p.bgRadius,
+				.color = withOpacity(bgColor, m_p.opacity),
+				.clip = fd.addClip(clip),
+				.strokeWidthPx = static_cast<float>(bw),
+				.strokeColor = withOpacity(borderColor, m_p.opacity)
 				});
 		}
 
-		// 再画背景（若启用），要扣除边框厚度
-		if (m_drawRect.isValid() && bgColor.alpha() > 0)
-		{
-			const int bw = static_cast<int>(std::round(std::max(0.0f, m_p.borderW)));
-			const QRect bgRect = m_drawRect.adjusted(bw, bw, -bw, -bw);
-			if (bgRect.isValid())
-			{
-				fd.roundedRects.push_back(Render::RoundedRectCmd{
-					.rect = QRectF(bgRect),
-					.radiusPx = std::max(0.0f, m_p.bgRadius - static_cast<float>(bw)),
-					.color = withOpacity(bgColor, m_p.opacity),
-					.clipRect = clip
-					});
-			}
-		}
-
 		// 子内容追加 + 内容区裁剪
 		if (m_child) {
 			const int rr0 = static_cast<int>(fd.roundedRects.size());
 			const int im0 = static_cast<int>(fd.images.size());
+			const int sh0 = static_cast<int>(fd.shadows.size());
 
 			m_child->append(fd);
 
-			RenderUtils::applyParentClip(fd, rr0, im0, QRectF(m_contentRect));
+			// 圆角卡片：内容区按同心圆角裁剪（半径扣除边框与内边距），内边距足够大时退化为直角
+			const int bw = static_cast<int>(std::round(std::max(0.0f, m_p.borderW)));
+			const int inset = bw + std::max({ m_p.padding.left(), m_p.padding.top(), m_p.padding.right(), m_p.padding.bottom() });
+			const float clipRadius = std::max(0.0f, m_p.bgRadius - static_cast<float>(inset));
+			RenderUtils::applyParentClip(fd, rr0, im0, sh0, QRectF(m_contentRect), clipRadius);
 		}
 	}
 
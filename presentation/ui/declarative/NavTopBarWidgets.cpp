@@ -6,6 +6,7 @@
  * 备注：实现包装类，转发配置到运行时组件，确保行为一致性
  */
 
+#include "FrameClock.h"
 #include "IconCache.h"
 #include "NavTopBarWidgets.h"
 #include "RenderUtils.hpp"
@@ -13,7 +14,6 @@
 #include <algorithm>
 #include <cmath>
 #include <memory>
-#include <qelapsedtimer.h>
 #include <qopenglfunctions.h>
 
 namespace UI {
@@ -324,9 +324,8 @@ namespace UI {
 			// 处理动画
 			const bool active = m_animPhase != AnimPhase::Idle;
 			if (!active) return false;
-			if (!m_animClock.isValid()) m_animClock.start();
 
-			const qint64 now = m_animClock.elapsed();
+			const qint64 now = FrameClock::nowMs();
 			const float  tRaw = m_animDurationMs > 0 ? static_cast<float>(now - m_phaseStartMs) / static_cast<float>(m_animDurationMs) : 1.0f;
 			const float  t = std::clamp(tRaw, 0.0f, 1.0f);
 			const float  e = easeInOut(t);
@@ -430,7 +429,6 @@ namespace UI {
 		}
 
 		void startAnimSequence(const bool followOn) {
-			if (!m_animClock.isValid()) m_animClock.start();
 			m_phaseStartAlpha = m_themeAlpha;
 			m_phaseStartSlide = m_followSlide;
 
@@ -441,7 +439,7 @@ namespace UI {
 		void beginPhase(const AnimPhase ph, const int durationMs) {
 			m_animPhase = ph;
 			m_animDurationMs = durationMs;
-			m_phaseStartMs = m_animClock.elapsed();
+			m_phaseStartMs = FrameClock::nowMs();
 		}
 
 		bool themeInteractive() const {
@@ -482,9 +480,9 @@ namespace UI {
 				const QSize texSz = m_cache->textureSizePx(tex);
 
 				const QRectF dst(r.center().x() - iconLogical * 0.5, r.center().y() - iconLogical * 0.5, iconLogical, iconLogical);
-				fd.images.push_back(Render::ImageCmd{
+				fd.addImage(Render::ImageCmd{
 					.dstRect = dst, .textureId = tex, .srcRectPx = QRectF(0, 0, texSz.width(), texSz.height()),
-					.tint = iconColor, .clipRect = r
+					.tint = iconColor, .clip = fd.addClip(r)
 					});
 				});
 		}
@@ -508,7 +506,6 @@ namespace UI {
 		AnimPhase     m_animPhase{ AnimPhase::Idle };
 		int           m_animDurationMs{ 0 };
 		qint64        m_phaseStartMs{ 0 };
-		QElapsedTimer m_animClock;
 
 		float m_themeAlpha{ 1.0f };
 		float m_followSlide{ 0.0f };
@@ -3,6 +3,7 @@
 #include "ILayoutable.hpp"
 #include "UiComponent.hpp"
 #include "UiContent.hpp"
+#include "UiRetained.h"
 #include <algorithm>
 #include <functional>
 #include <memory>
@@ -32,6 +33,8 @@ namespace UI {
 		void requestRebuild() {
 			if (!m_builder) return;
 			m_child = m_builder();
+			// 外层的保留模式容器无法感知子树被替换
+			UiRetained::invalidateAll();
 			// 重建后立即同步上下文与视口
 			// 注意：操作顺序很重要，避免主题闪烁
 			if (m_child) {
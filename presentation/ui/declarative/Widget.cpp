@@ -6,6 +6,8 @@
 #include <qmargins.h>
 #include <qsize.h>
 #include "UiComponent.hpp"
+#include "UiLayer.h"
+#include "UiRetained.h"
 #include <utility>
 
 namespace UI {
@@ -33,6 +35,8 @@ namespace UI {
 	std::shared_ptr<Widget> Widget::opacity(const float o) { m_decorations.opacity = o; return self<Widget>(); }
 	std::shared_ptr<Widget> Widget::onTap(std::function<void()> h) { m_decorations.onTap = std::move(h); return self<Widget>(); }
 	std::shared_ptr<Widget> Widget::onHover(std::function<void(bool)> h) { m_decorations.onHover = std::move(h); return self<Widget>(); }
+	std::shared_ptr<Widget> Widget::retained(const bool on) { m_decorations.retained = on; return self<Widget>(); }
+	std::shared_ptr<Widget> Widget::layer(const bool on) { m_decorations.layer = on; return self<Widget>(); }
 
 	void Widget::applyDecorations(IUiComponent* /*component*/) const {
 		// 保留给可以直接吃属性的组件（可直接 setMargins/setBackground）
@@ -40,11 +44,25 @@ namespace UI {
 	}
 
 	std::unique_ptr<IUiComponent> Widget::decorate(std::unique_ptr<IUiComponent> inner) const {
+		// 不透明度按组作用：连同装饰绘制到离屏图层后整体混合（图层本身即缓存子树，无需再叠加保留模式）
+		if (usesLayer()) {
+			auto layer = std::make_unique<UiLayer>(decorateBox(std::move(inner)));
+			layer->setOpacity(m_decorations.opacity);
+			return layer;
+		}
+		// 保留模式包在最外层，连同装饰（背景、阴影等）一起缓存
+		if (m_decorations.retained) {
+			return std::make_unique<UiRetained>(decorateBox(std::move(inner)));
+		}
+		return decorateBox(std::move(inner));
+	}
+
+	std::unique_ptr<IUiComponent> Widget::decorateBox(std::unique_ptr<IUiComponent> inner) const {
 		// 若没有任何装饰，直接返回
 		const bool need = (m_decorations.backgroundColor.alpha() > 0) ||
 			(m_decorations.padding != QMargins()) ||
 			(m_decorations.fixedSize.width() > 0 || m_decorations.fixedSize.height() > 0) ||
-			(m_decorations.opacity < 0.999f) ||
+			(!usesLayer() && m_decorations.opacity < 0.999f) ||
 			(!m_decorations.isVisible) ||
 			static_cast<bool>(m_decorations.onTap) || static_cast<bool>(m_decorations.onHover) ||
 			(m_decorations.borderColor.alpha() > 0) ||
@@ -69,7 +87,7 @@ namespace UI {
 		
 		p.fixedSize = m_decorations.fixedSize;
 		p.visible = m_decorations.isVisible;
-		p.opacity = m_decorations.opacity;
+		p.opacity = usesLayer() ? 1.0f : m_decorations.opacity;
 		p.onTap = m_decorations.onTap;
 		p.onHover = m_decorations.onHover;
 
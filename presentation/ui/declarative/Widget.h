@@ -37,6 +37,10 @@ namespace UI {
 		std::shared_ptr<Widget> opacity(float o);
 		std::shared_ptr<Widget> onTap(std::function<void()> handler);
 		std::shared_ptr<Widget> onHover(std::function<void(bool)> handler);
+		// 保留模式：缓存子树的绘制命令，未变化的帧直接重放（见UiRetained的失效规则）
+		std::shared_ptr<Widget> retained(bool on = true);
+		// 离屏图层：子树绘制到缓存纹理后合成（见UiLayer）；opacity<1时自动启用，使不透明度整体作用于子树
+		std::shared_ptr<Widget> layer(bool on = true);
 
 	protected:
 		struct Decorations {
@@ -60,6 +64,8 @@ namespace UI {
 			float    opacity{ 1.0f };
 			std::function<void()> onTap;
 			std::function<void(bool)> onHover;
+			bool     retained{ false };
+			bool     layer{ false };
 		} m_decorations;
 
 		// 仍保留（对可以直接改属性的组件在里面直接设置）
@@ -67,6 +73,10 @@ namespace UI {
 
 		// 新增：统一包裹装饰器
 		std::unique_ptr<IUiComponent> decorate(std::unique_ptr<IUiComponent> inner) const;
+
+	private:
+		std::unique_ptr<IUiComponent> decorateBox(std::unique_ptr<IUiComponent> inner) const;
+		[[nodiscard]] bool usesLayer() const noexcept { return m_decorations.layer || m_decorations.opacity < 0.999f; }
 	};
 
 	template<typename T, typename... Args>
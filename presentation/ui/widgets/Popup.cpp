@@ -128,10 +128,11 @@ void Popup::append(Render::FrameData& frameData) const
             Render::RoundedRectCmd placeholderCmd;
             placeholderCmd.rect = QRectF(m_viewport);
             placeholderCmd.radiusPx = 2.0f;
-            placeholderCmd.color = QColor(128, 128, 128, 64); // Light gray, semi-transparent
-            placeholderCmd.clipRect = QRectF(); // No clipping needed
+            placeholderCmd.color = Qt::transparent;
+            placeholderCmd.strokeWidthPx = 1.0f; // Outline only, trigger stays visible
+            placeholderCmd.strokeColor = QColor(128, 128, 128, 64); // Light gray, semi-transparent
             
-            frameData.roundedRects.push_back(placeholderCmd);
+            frameData.addRoundedRect(placeholderCmd);
         }
     }
 }
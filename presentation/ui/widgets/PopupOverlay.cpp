@@ -5,6 +5,9 @@
 #include "PopupOverlay.h"
 #include "Renderer.h"
 #include <GL/gl.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <memory>
 #include <qapplication.h>
 #include <qcolor.h>
@@ -210,11 +213,16 @@ void PopupOverlay::paintGL()
 		return;
 	}
 
+	// 背景（阴影+底板）与内容收集到同一命令流，按追加顺序绘制
+	Render::FrameData frameData;
+
 	// 渲染背景
-	renderBackground();
+	renderBackground(frameData);
 
 	// 渲染内容
-	renderContent();
+	renderContent(frameData);
+
+	m_renderer.drawFrame(frameData, m_iconCache, devicePixelRatio());
 }
 
 void PopupOverlay::mousePressEvent(QMouseEvent* event)
@@ -354,32 +362,25 @@ void PopupOverlay::updateContentLayout()
 	m_needsContentLayoutUpdate = false;
 }
 
-void PopupOverlay::renderBackground()
+void PopupOverlay::renderBackground(Render::FrameData& frameData) const
 {
 	// 使用渲染器绘制圆角背景矩形 with shadow
-	// First render shadow layers
+	// First render the shadow: a single analytic Gaussian shadow under the content rect
 	if (m_shadowSize > 0) {
-		int numShadowLayers = static_cast<int>(std::round(m_shadowSize));
+		// Peak opacity matches the former stack of round(m_shadowSize) layers with alpha 0.3 * (1 - i / n)
+		const int numShadowLayers = std::max(1, static_cast<int>(std::round(m_shadowSize)));
+		float transmit = 1.0f;
 		for (int i = 0; i < numShadowLayers; ++i) {
-			float alpha = (1.0f - static_cast<float>(i) / numShadowLayers) * 0.3f; // Exponential falloff
-			// Use integer offsets to maintain pixel alignment
-			int offset = i;
-
-			Render::RoundedRectCmd shadowCmd;
-			shadowCmd.rect = QRectF(
-				m_actualContentRect.x() - offset,
-				m_actualContentRect.y() - offset,
-				m_actualContentRect.width() + 2 * offset,
-				m_actualContentRect.height() + 2 * offset
-			);
-			shadowCmd.radiusPx = m_cornerRadius;
-			shadowCmd.color = QColor(0, 0, 0, static_cast<int>(alpha * 255));
-			shadowCmd.clipRect = QRectF();  // 不需要剪裁
-
-			Render::FrameData shadowFrameData;
-			shadowFrameData.roundedRects.push_back(shadowCmd);
-			m_renderer.drawFrame(shadowFrameData, m_iconCache, devicePixelRatio());
+			transmit *= 1.0f - (1.0f - static_cast<float>(i) / numShadowLayers) * 0.3f;
 		}
+
+		Render::ShadowCmd shadowCmd;
+		shadowCmd.rect = QRectF(m_actualContentRect);
+		shadowCmd.radiusPx = m_cornerRadius;
+		shadowCmd.blurPx = m_shadowSize;
+		shadowCmd.color = QColor(0, 0, 0, static_cast<int>(std::round((1.0f - transmit) * 255.0f)));
+
+		frameData.addShadow(shadowCmd);
 	}
 
 	// Then render the main background
@@ -392,15 +393,11 @@ void PopupOverlay::renderBackground()
 	}
 	bgCmd.radiusPx = m_cornerRadius;
 	bgCmd.color = m_backgroundColor;
-	bgCmd.clipRect = QRectF();  // 不需要剪裁
-
-	Render::FrameData bgFrameData;
-	bgFrameData.roundedRects.push_back(bgCmd);
 
-	m_renderer.drawFrame(bgFrameData, m_iconCache, devicePixelRatio());
+	frameData.addRoundedRect(bgCmd);
 }
 
-void PopupOverlay::renderContent()
+void PopupOverlay::renderContent(Render::FrameData& frameData) const
 {
 	if (!m_content) {
 		return;
@@ -412,8 +409,10 @@ void PopupOverlay::renderContent()
 		// For now, let the content render at its natural position within the actual content rect
 	}
 
-	// 创建渲染数据容器
-	Render::FrameData frameData;
+	// 记录内容命令的起始位置（之前为背景命令，不参与平移）
+	const std::size_t rr0 = frameData.roundedRects.size();
+	const std::size_t im0 = frameData.images.size();
+	const std::size_t sh0 = frameData.shadows.size();
 
 	// 让内容添加渲染数据
 	m_content->append(frameData);
@@ -427,25 +426,9 @@ void PopupOverlay::renderContent()
 			std::round(m_actualContentRect.y())
 		);
 
-		// Translate all rounded rect commands
-		for (auto& rectCmd : frameData.roundedRects) {
-			rectCmd.rect.translate(offset);
-			if (rectCmd.clipRect.width() > 0 && rectCmd.clipRect.height() > 0) {
-				rectCmd.clipRect.translate(offset);
-			}
-		}
-
-		// Translate all image commands
-		for (auto& imageCmd : frameData.images) {
-			imageCmd.dstRect.translate(offset);
-			if (imageCmd.clipRect.width() > 0 && imageCmd.clipRect.height() > 0) {
-				imageCmd.clipRect.translate(offset);
-			}
-		}
+		// Translate all content commands together with their clip regions
+		frameData.translate(offset, rr0, im0, sh0);
 	}
-
-	// 使用渲染器绘制frameData
-	m_renderer.drawFrame(frameData, m_iconCache, devicePixelRatio());
 }
 
 void PopupOverlay::forwardThemeChange(bool isDark)
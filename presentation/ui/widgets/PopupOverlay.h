@@ -96,8 +96,8 @@ private:
 	};
 
 	void updateContentLayout();
-	void renderBackground();
-	void renderContent();
+	void renderBackground(Render::FrameData& frameData) const;
+	void renderContent(Render::FrameData& frameData) const;
 	bool eventFilter(QObject* obj, QEvent* event) override; // For global mouse events
 
 private:
@@ -161,11 +161,11 @@ void UiListBox::updateResourceContext(IconCache& cache, QOpenGLFunctions* gl, co
 void UiListBox::append(Render::FrameData& fd) const
 {
 	// 绘制背景
-	fd.roundedRects.push_back(Render::RoundedRectCmd{
+	fd.addRoundedRect(Render::RoundedRectCmd{
 		.rect = QRectF(m_viewport),
 		.radiusPx = 0.0f,
 		.color = m_pal.bg,
-		.clipRect = QRectF(m_viewport)
+		.clip = fd.addClip(QRectF(m_viewport))
 	});
 
 	// 获取当前项目列表
@@ -195,22 +195,22 @@ void UiListBox::append(Render::FrameData& fd) const
 		}
 		
 		if (itemBg != m_pal.bg) {
-			fd.roundedRects.push_back(Render::RoundedRectCmd{
+			fd.addRoundedRect(Render::RoundedRectCmd{
 				.rect = QRectF(itemRect),
 				.radiusPx = 0.0f,
 				.color = itemBg,
-				.clipRect = QRectF(m_viewport)
+				.clip = fd.addClip(QRectF(m_viewport))
 			});
 		}
 
 		// 绘制选中指示器
 		if (index == m_selectedIndex) {
 			const QRect indicatorRect(itemRect.left(), itemRect.top(), 3, itemRect.height());
-			fd.roundedRects.push_back(Render::RoundedRectCmd{
+			fd.addRoundedRect(Render::RoundedRectCmd{
 				.rect = QRectF(indicatorRect),
 				.radiusPx = 0.0f,
 				.color = m_pal.indicator,
-				.clipRect = QRectF(m_viewport)
+				.clip = fd.addClip(QRectF(m_viewport))
 			});
 		}
 
@@ -243,23 +243,23 @@ void UiListBox::append(Render::FrameData& fd) const
 			const QRectF textDst(textX, textY, wLogical, hLogical);
 			
 			// Push ImageCmd with proper clipping
-			fd.images.push_back(Render::ImageCmd{
+			fd.addImage(Render::ImageCmd{
 				.dstRect = textDst,
 				.textureId = textTex,
 				.srcRectPx = QRectF(0, 0, texSize.width(), texSize.height()),
 				.tint = QColor(255, 255, 255, 255), // White tint since texture is pre-colored
-				.clipRect = QRectF(textRect)
+				.clip = fd.addClip(QRectF(textRect))
 			});
 		}
 
 		// 绘制分隔线（除了最后一项）
 		if (index < static_cast<int>(currentItems.size()) - 1) {
 			const QRect separatorRect(itemRect.left() + 8, itemRect.bottom() - 1, itemRect.width() - 16, 1);
-			fd.roundedRects.push_back(Render::RoundedRectCmd{
+			fd.addRoundedRect(Render::RoundedRectCmd{
 				.rect = QRectF(separatorRect),
 				.radiusPx = 0.0f,
 				.color = m_pal.separator,
-				.clipRect = QRectF(m_viewport)
+				.clip = fd.addClip(QRectF(m_viewport))
 			});
 		}
 	}
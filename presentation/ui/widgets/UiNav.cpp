@@ -3,6 +3,7 @@
 #include "UiNav.h"
 
 #include "IconCache.h"
+#include "FrameClock.h"
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
@@ -282,7 +283,7 @@ namespace Ui {
 	void NavRail::append(Render::FrameData& fd) const
 	{
 		// 1) 导航栏背景
-		fd.roundedRects.push_back(Render::RoundedRectCmd{ .rect = QRectF(m_rect), .radiusPx = 0.0f, .color = m_pal.railBg });
+		fd.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(m_rect), .radiusPx = 0.0f, .color = m_pal.railBg });
 
 		// 2) “整体高亮单元”（将原选中背景矩形 + 指示条合并为一体，并整体移动）
 		const int selForHighlight = m_dataProvider ? m_dataProvider->selectedIndex() : m_selected;
@@ -298,7 +299,7 @@ namespace Ui {
 				rSelTmpl.width() - padX * 2.0f,
 				bgH
 			);
-			fd.roundedRects.push_back(Render::RoundedRectCmd{
+			fd.addRoundedRect(Render::RoundedRectCmd{
 				.rect = bgRect,
 				.radiusPx = 6.0f,
 				.color = m_pal.itemSelected
@@ -314,7 +315,7 @@ namespace Ui {
 				indW,
 				indH
 			);
-			fd.roundedRects.push_back(Render::RoundedRectCmd{
+			fd.addRoundedRect(Render::RoundedRectCmd{
 				.rect = indRect,
 				.radiusPx = indW * 0.5f,
 				.color = m_pal.indicator
@@ -338,11 +339,11 @@ namespace Ui {
 				if (i == m_selected) {
 				}
 				else if (i == m_pressed) {
-					fd.roundedRects.push_back(Render::RoundedRectCmd{ .rect = r.adjusted(5, 5, -5, -5), .radiusPx = 6.0f,
+					fd.addRoundedRect(Render::RoundedRectCmd{ .rect = r.adjusted(5, 5, -5, -5), .radiusPx = 6.0f,
 						.color = m_pal.itemPressed });
 				}
 				else if (i == m_hover) {
-					fd.roundedRects.push_back(Render::RoundedRectCmd{ .rect = r.adjusted(5, 5, -5, -5), .radiusPx = 6.0f,
+					fd.addRoundedRect(Render::RoundedRectCmd{ .rect = r.adjusted(5, 5, -5, -5), .radiusPx = 6.0f,
 						.color = m_pal.itemHover });
 				}
 
@@ -363,7 +364,7 @@ namespace Ui {
 					iconDst = QRectF(r.left() + 13, r.center().y() - static_cast<float>(m_iconLogical) * 0.5f, m_iconLogical, m_iconLogical);
 				}
 
-				fd.images.push_back(Render::ImageCmd{
+				fd.addImage(Render::ImageCmd{
 					.dstRect = iconDst,
 					.textureId = tex,
 					.srcRectPx = QRectF(0, 0, texSz.width(), texSz.height()),
@@ -403,7 +404,7 @@ namespace Ui {
 					);
 
 					// 文字已在纹理阶段着色，这里保持原色输出
-					fd.images.push_back(Render::ImageCmd{
+					fd.addImage(Render::ImageCmd{
 						.dstRect = textDst,
 						.textureId = textTex,
 						.srcRectPx = QRectF(0, 0, ts.width(), ts.height()),
@@ -419,11 +420,11 @@ namespace Ui {
 
 				// 背景态（仅 hover/pressed；选中背景由“整体高亮单元”承担）
 				if (i == m_pressed) {
-					fd.roundedRects.push_back(Render::RoundedRectCmd{ .rect = r.adjusted(6, 6, -6, -6), .radiusPx = 10.0f,
+					fd.addRoundedRect(Render::RoundedRectCmd{ .rect = r.adjusted(6, 6, -6, -6), .radiusPx = 10.0f,
 						.color = m_pal.itemPressed });
 				}
 				else if (i == m_hover) {
-					fd.roundedRects.push_back(Render::RoundedRectCmd{ .rect = r.adjusted(6, 6, -6, -6), .radiusPx = 10.0f,
+					fd.addRoundedRect(Render::RoundedRectCmd{ .rect = r.adjusted(6, 6, -6, -6), .radiusPx = 10.0f,
 						.color = m_pal.itemHover });
 				}
 
@@ -444,7 +445,7 @@ namespace Ui {
 					iconDst = QRectF(r.center().x() - static_cast<float>(m_iconLogical) * 0.5f, r.center().y() - static_cast<float>(m_iconLogical) * 0.5f, m_iconLogical, m_iconLogical);
 				}
 
-				fd.images.push_back(Render::ImageCmd{
+				fd.addImage(Render::ImageCmd{
 					.dstRect = iconDst,
 					.textureId = tex,
 					.srcRectPx = QRectF(0, 0, texSz.width(), texSz.height()),
@@ -485,7 +486,7 @@ namespace Ui {
 					);
 
 					// 文字已在纹理阶段着色，这里保持原色输出
-					fd.images.push_back(Render::ImageCmd{
+					fd.addImage(Render::ImageCmd{
 						.dstRect = textDst,
 						.textureId = textTex,
 						.srcRectPx = QRectF(0, 0, ts.width(), ts.height()),
@@ -500,7 +501,7 @@ namespace Ui {
 		const QColor tglBg = m_togglePressed ? m_pal.itemPressed
 			: (m_toggleHovered ? m_pal.itemHover : QColor(0, 0, 0, 0));
 		if (tglBg.alpha() > 0) {
-			fd.roundedRects.push_back(Render::RoundedRectCmd{ .rect = tgl, .radiusPx = 6.0f, .color = tglBg });
+			fd.addRoundedRect(Render::RoundedRectCmd{ .rect = tgl, .radiusPx = 6.0f, .color = tglBg });
 		}
 
 		// 选择 SVG：展开时显示“向左收起”，收起时显示“向右展开”
@@ -524,7 +525,7 @@ namespace Ui {
 			static_cast<float>(iconLogical)
 		);
 
-		fd.images.push_back(Render::ImageCmd{
+		fd.addImage(Render::ImageCmd{
 			.dstRect = iconDst,
 			.textureId = tex,
 			.srcRectPx = QRectF(0, 0, texSz.width(), texSz.height()),
@@ -534,8 +535,7 @@ namespace Ui {
 
 	bool NavRail::tick()
 	{
-		if (!m_clock.isValid()) m_clock.start();
-		const qint64 now = m_clock.elapsed();
+		const qint64 now = FrameClock::nowMs();
 		bool any = false;
 
 		// 如果接入 DataProvider，则在每次 tick 时对比 DataProvider 真值，触发必要动画
@@ -581,21 +581,19 @@ namespace Ui {
 
 	void NavRail::startIndicatorAnim(const float toY, const int durationMs)
 	{
-		if (!m_clock.isValid()) m_clock.start();
 		m_animIndicator.active = true;
 		m_animIndicator.start = (m_indicatorY < 0.0f ? toY : m_indicatorY);
 		m_animIndicator.end = toY;
-		m_animIndicator.startMs = m_clock.elapsed();
+		m_animIndicator.startMs = FrameClock::nowMs();
 		m_animIndicator.durationMs = durationMs;
 	}
 
 	void NavRail::startExpandAnim(const float toT, const int durationMs)
 	{
-		if (!m_clock.isValid()) m_clock.start();
 		m_animExpand.active = true;
 		m_animExpand.start = m_expandT;
 		m_animExpand.end = std::clamp(toT, 0.0f, 1.0f);
-		m_animExpand.startMs = m_clock.elapsed();
+		m_animExpand.startMs = FrameClock::nowMs();
 		m_animExpand.durationMs = durationMs;
 	}
 
@@ -16,7 +16,6 @@
 #include <cmath>
 #include <qbytearray.h>
 #include <qcolor.h>
-#include <qelapsedtimer.h>
 #include <qopenglfunctions.h>
 #include <qrect.h>
 
@@ -225,7 +224,6 @@ namespace Ui {
 
 		ScalarAnim m_animIndicator;
 		ScalarAnim m_animExpand;
-		QElapsedTimer m_clock;
 
 		IconCache* m_cache{ nullptr };
 		QOpenGLFunctions* m_gl{ nullptr };
@@ -116,6 +116,7 @@ void UiPushButton::append(Render::FrameData& fd) const {
 	// 记录初始命令数量，用于父级剪裁
 	const int rr0 = static_cast<int>(fd.roundedRects.size());
 	const int im0 = static_cast<int>(fd.images.size());
+	const int sh0 = static_cast<int>(fd.shadows.size());
 
 	// 委托给内部按钮进行背景和图标绘制
 	m_button.append(fd);
@@ -129,17 +130,19 @@ void UiPushButton::append(Render::FrameData& fd) const {
 		// 焦点环颜色：根据主题选择
 		QColor focusColor = m_isDarkTheme ? QColor(120, 170, 255, 120) : QColor(70, 130, 255, 120);
 
-		// 添加焦点环（绘制一个外部矩形作为焦点指示）
-		fd.roundedRects.push_back(Render::RoundedRectCmd{
+		// 添加焦点环（按钮外沿一圈描边，不覆盖按钮本身）
+		fd.addRoundedRect(Render::RoundedRectCmd{
 			.rect = focusRect,
 			.radiusPx = m_cornerRadius + focusRingWidth,
-			.color = focusColor,
-			.clipRect = focusRect
+			.color = Qt::transparent,
+			.clip = fd.addClip(focusRect),
+			.strokeWidthPx = focusRingWidth,
+			.strokeColor = focusColor
 			});
 	}
 
 	// 应用父级剪裁到新增的命令
-	RenderUtils::applyParentClip(fd, rr0, im0, QRectF(m_bounds));
+	RenderUtils::applyParentClip(fd, rr0, im0, sh0, QRectF(m_bounds));
 }
 
 bool UiPushButton::onMousePress(const QPoint& pos) {
@@ -377,12 +380,12 @@ void UiPushButton::createIconAndTextPainter() {
 					const float iconY = contentRect.top() + (contentRect.height() - iconSize) * 0.5f;
 					const QRectF iconRect(currentX, iconY, iconSize, iconSize);
 
-					fd.images.push_back(Render::ImageCmd{
+					fd.addImage(Render::ImageCmd{
 						.dstRect = iconRect,
 						.textureId = texId,
 						.srcRectPx = QRectF(QPointF(0, 0), QSizeF(texSizePx)),
 						.tint = iconColor,
-						.clipRect = rect // 使用按钮整体区域作为剪裁
+						.clip = fd.addClip(rect) // 使用按钮整体区域作为剪裁
 						});
 
 					currentX += iconSize + (m_text.isEmpty() ? 0 : 8); // 图标后加间距
@@ -425,12 +428,12 @@ void UiPushButton::createIconAndTextPainter() {
 
 				const QRectF textRect(textX, textY, textWidth, textHeight);
 
-				fd.images.push_back(Render::ImageCmd{
+				fd.addImage(Render::ImageCmd{
 					.dstRect = textRect,
 					.textureId = texId,
 					.srcRectPx = QRectF(QPointF(0, 0), QSizeF(texSizePx)),
 					.tint = iconColor,
-					.clipRect = rect // 使用按钮整体区域作为剪裁
+					.clip = fd.addClip(rect) // 使用按钮整体区域作为剪裁
 					});
 			}
 		}
@@ -3,6 +3,7 @@
 #include "UiTabView.h"
 
 #include "IconCache.h"
+#include "FrameClock.h"
 #include "UiComponent.hpp"
 #include "UiContent.hpp"
 #include <algorithm>
@@ -172,22 +173,22 @@ void UiTabView::append(Render::FrameData& fd) const
 
 	// TabBar 背景
 	if (m_pal.barBg.alpha() > 0) {
-		fd.roundedRects.push_back(Render::RoundedRectCmd{
+		fd.addRoundedRect(Render::RoundedRectCmd{
 			.rect = bar.adjusted(m_tabBarMargin.left(), m_tabBarMargin.top(), -m_tabBarMargin.right(), -m_tabBarMargin.bottom()),
 			.radiusPx = 8.0f,
 			.color = m_pal.barBg,
-			.clipRect = QRectF(m_viewport) // 裁剪到整个 TabView 区域
+			.clip = fd.addClip(QRectF(m_viewport)) // 裁剪到整个 TabView 区域
 			});
 	}
 
 	// Content 背景
 	if (m_pal.contentBg.alpha() > 0) {
 		const QRectF contentR = contentRectF();
-		fd.roundedRects.push_back(Render::RoundedRectCmd{
+		fd.addRoundedRect(Render::RoundedRectCmd{
 			.rect = contentR.adjusted(-m_contentPadding.left(), -m_contentPadding.top(), m_contentPadding.right(), m_contentPadding.bottom()),
 			.radiusPx = 8.0f,
 			.color = m_pal.contentBg,
-			.clipRect = QRectF(m_viewport)
+			.clip = fd.addClip(QRectF(m_viewport))
 			});
 	}
 
@@ -203,11 +204,11 @@ void UiTabView::append(Render::FrameData& fd) const
 			bgH
 		);
 		if (m_indicatorStyle == IndicatorStyle::Full || m_pal.tabSelectedBg.alpha() > 0) {
-			fd.roundedRects.push_back(Render::RoundedRectCmd{
+			fd.addRoundedRect(Render::RoundedRectCmd{
 				.rect = bgRect,
 				.radiusPx = 6.0f,
 				.color = m_pal.tabSelectedBg,
-				.clipRect = bgRect
+				.clip = fd.addClip(bgRect)
 				});
 		}
 		if (m_indicatorStyle != IndicatorStyle::Full) {
@@ -232,11 +233,11 @@ void UiTabView::append(Render::FrameData& fd) const
 					indH
 				);
 			}
-			fd.roundedRects.push_back(Render::RoundedRectCmd{
+			fd.addRoundedRect(Render::RoundedRectCmd{
 				.rect = indRect,
 				.radiusPx = indH * 0.5f,
 				.color = m_pal.indicator,
-				.clipRect = bgRect
+				.clip = fd.addClip(bgRect)
 				});
 		}
 	}
@@ -248,14 +249,14 @@ void UiTabView::append(Render::FrameData& fd) const
 		if (i == m_viewSelected) continue;
 		const QRectF r = tabRectF(i);
 		if (i == m_pressed) {
-			fd.roundedRects.push_back(Render::RoundedRectCmd{
+			fd.addRoundedRect(Render::RoundedRectCmd{
 				.rect = r,
 				.radiusPx = 6.0f,
 				.color = m_pal.tabHover.darker(115)
 				});
 		}
 		else if (i == m_hover) {
-			fd.roundedRects.push_back(Render::RoundedRectCmd{
+			fd.addRoundedRect(Render::RoundedRectCmd{
 				.rect = r,
 				.radiusPx = 6.0f,
 				.color = m_pal.tabHover
@@ -289,12 +290,12 @@ void UiTabView::append(Render::FrameData& fd) const
 
 		const QRectF textDst(textX, textY, wLogical, hLogical);
 
-		fd.images.push_back(Render::ImageCmd{
+		fd.addImage(Render::ImageCmd{
 			.dstRect = textDst,
 			.textureId = tex,
 			.srcRectPx = QRectF(0, 0, ts.width(), ts.height()),
 			.tint = QColor(255,255,255,255),
-			.clipRect = r
+			.clip = fd.addClip(r)
 			});
 	}
 
@@ -303,10 +304,11 @@ void UiTabView::append(Render::FrameData& fd) const
 	if (IUiComponent* curContent = content(curIdx)) {
 		const int rr0 = static_cast<int>(fd.roundedRects.size());
 		const int im0 = static_cast<int>(fd.images.size());
+		const int sh0 = static_cast<int>(fd.shadows.size());
 
 		curContent->append(fd);
 
-		RenderUtils::applyParentClip(fd, rr0, im0, contentRectF());
+		RenderUtils::applyParentClip(fd, rr0, im0, sh0, contentRectF());
 	}
 }
 
@@ -402,7 +404,6 @@ bool UiTabView::onWheel(const QPoint& pos, const QPoint& angleDelta)
 bool UiTabView::tick()
 {
 	bool any = false;
-	if (!m_clock.isValid()) m_clock.start();
 
 	// DataProvider 模式：检查并同步变化
 	if (m_dataProvider) {
@@ -427,7 +428,7 @@ bool UiTabView::tick()
 
 	// 处理动画
 	if (m_animHighlight.active) {
-		const qint64 now = m_clock.elapsed();
+		const qint64 now = FrameClock::nowMs();
 		const float t = easeInOut(
 			static_cast<float>(now - m_animHighlight.startMs) /
 			static_cast<float>(std::max(1, m_animHighlight.durationMs))
@@ -478,11 +479,10 @@ void UiTabView::onThemeChanged(const bool isDark)
 
 void UiTabView::startHighlightAnim(const float toCenterX)
 {
-	if (!m_clock.isValid()) m_clock.start();
 	m_animHighlight.active = true;
 	m_animHighlight.start = (m_highlightCenterX < 0.0f ? toCenterX : m_highlightCenterX);
 	m_animHighlight.end = toCenterX;
-	m_animHighlight.startMs = m_clock.elapsed();
+	m_animHighlight.startMs = FrameClock::nowMs();
 	m_animHighlight.durationMs = m_animDuration;
 }
 
@@ -7,7 +7,6 @@
 
 #include <algorithm>
 #include <qcolor.h>
-#include <qelapsedtimer.h>
 #include <qmargins.h>
 #include <qopenglfunctions.h>
 #include <qpoint.h>
@@ -137,7 +136,6 @@ private:
 		qint64 startMs{ 0 };
 		int durationMs{ 0 };
 	} m_animHighlight;
-	QElapsedTimer m_clock;
 
 	// 外观配置（默认浅色）
 	Palette m_pal{
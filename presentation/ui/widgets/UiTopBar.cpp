@@ -1,5 +1,6 @@
 #include "UiTopBar.h"
 
+#include "FrameClock.h"
 #include "IconCache.h"
 #include "RenderData.hpp"
 #include "UiButton.hpp"
@@ -137,9 +138,9 @@ void UiTopBar::updateResourceContext(IconCache& cache, QOpenGLFunctions* gl, con
 		const QSize texSz = m_cache->textureSizePx(tex);
 
 		const QRectF dst(r.center().x() - iconLogical * 0.5, r.center().y() - iconLogical * 0.5, iconLogical, iconLogical);
-		fd.images.push_back(Render::ImageCmd{
+		fd.addImage(Render::ImageCmd{
 			.dstRect = dst, .textureId = tex, .srcRectPx = QRectF(0, 0, texSz.width(), texSz.height()),
-			.tint = iconColor, .clipRect = r
+			.tint = iconColor, .clip = fd.addClip(r)
 			});
 		});
 
@@ -154,9 +155,9 @@ void UiTopBar::updateResourceContext(IconCache& cache, QOpenGLFunctions* gl, con
 		const QSize texSz = m_cache->textureSizePx(tex);
 
 		const QRectF dst(r.center().x() - iconLogical * 0.5, r.center().y() - iconLogical * 0.5, iconLogical, iconLogical);
-		fd.images.push_back(Render::ImageCmd{
+		fd.addImage(Render::ImageCmd{
 			.dstRect = dst, .textureId = tex, .srcRectPx = QRectF(0, 0, texSz.width(), texSz.height()),
-			.tint = iconColor, .clipRect = r
+			.tint = iconColor, .clip = fd.addClip(r)
 			});
 		});
 
@@ -177,9 +178,9 @@ void UiTopBar::updateResourceContext(IconCache& cache, QOpenGLFunctions* gl, con
 				logicalPx
 			);
 
-			fd.images.push_back(Render::ImageCmd{
+			fd.addImage(Render::ImageCmd{
 				.dstRect = dst, .textureId = tex, .srcRectPx = QRectF(0,0,texSz.width(), texSz.height()),
-				.tint = iconColor, .clipRect = r
+				.tint = iconColor, .clip = fd.addClip(r)
 				});
 			});
 		};
@@ -249,9 +250,8 @@ bool UiTopBar::tick()
 	const bool active = m_animPhase != AnimPhase::Idle;
 
 	if (!active) return false;
-	if (!m_animClock.isValid()) m_animClock.start();
 
-	const qint64 now = m_animClock.elapsed();
+	const qint64 now = FrameClock::nowMs();
 	const float  tRaw = m_animDurationMs > 0 ? static_cast<float>(now - m_phaseStartMs) / static_cast<float>(m_animDurationMs) : 1.0f;
 	const float  t = std::clamp(tRaw, 0.0f, 1.0f);
 	const float  e = easeInOut(t);
@@ -307,7 +307,6 @@ int UiTopBar::scaleDuration(int durationMs)
 
 void UiTopBar::startAnimSequence(const bool followOn)
 {
-	if (!m_animClock.isValid()) m_animClock.start();
 	m_phaseStartAlpha = m_themeAlpha;
 	m_phaseStartSlide = m_followSlide;
 
@@ -319,5 +318,5 @@ void UiTopBar::beginPhase(const AnimPhase ph, const int durationMs)
 {
 	m_animPhase = ph;
 	m_animDurationMs = durationMs;
-	m_phaseStartMs = m_animClock.elapsed();
+	m_phaseStartMs = FrameClock::nowMs();
 }
@@ -6,7 +6,6 @@
 
 #include <cstdint>
 #include <qcolor.h>
-#include <qelapsedtimer.h>
 #include <qglobal.h>
 #include <qopenglfunctions.h>
 #include <qrect.h>
@@ -129,7 +128,6 @@ private:
 	AnimPhase     m_animPhase{ AnimPhase::Idle };
 	int           m_animDurationMs{ 0 };
 	qint64        m_phaseStartMs{ 0 };
-	QElapsedTimer m_animClock;
 
 	float m_themeAlpha{ 1.0f };
 	float m_followSlide{ 0.0f };
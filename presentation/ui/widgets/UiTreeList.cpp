@@ -168,11 +168,11 @@ void UiTreeList::append(Render::FrameData& fd) const
 	// 背景
 	if (m_pal.bg.alpha() > 0 && m_viewport.isValid())
 	{
-		fd.roundedRects.push_back(Render::RoundedRectCmd{
+		fd.addRoundedRect(Render::RoundedRectCmd{
 			.rect = QRectF(m_viewport),
 			.radiusPx = 0.0f,
 			.color = m_pal.bg,
-			.clipRect = QRectF(m_viewport) // 新增
+			.clip = fd.addClip(QRectF(m_viewport)) // 新增
 			});
 	}
 
@@ -191,39 +191,39 @@ void UiTreeList::append(Render::FrameData& fd) const
 		const QRectF inner = QRectF(vn.rect).adjusted(5, 3, -5, -3);
 		if (vn.index == selectedId)
 		{
-			fd.roundedRects.push_back(Render::RoundedRectCmd{
+			fd.addRoundedRect(Render::RoundedRectCmd{
 				.rect = inner,
 				.radiusPx = 6.0f,
 				.color = m_pal.itemSelected,
-				.clipRect = QRectF(m_viewport)
+				.clip = fd.addClip(QRectF(m_viewport))
 				});
 			// 仅选中态绘制左侧指示条
 			const float indW = 3.0f;
 			const float indH = std::clamp(inner.height() * 0.6, 12.0, inner.height() - 6.0);
 			const QRectF ind(inner.left() + 4.0f, inner.center().y() - indH * 0.5f, indW, indH);
-			fd.roundedRects.push_back(Render::RoundedRectCmd{
+			fd.addRoundedRect(Render::RoundedRectCmd{
 				.rect = ind,
 				.radiusPx = indW * 0.5f,
 				.color = m_pal.indicator,
-				.clipRect = QRectF(m_viewport)
+				.clip = fd.addClip(QRectF(m_viewport))
 				});
 		}
 		else if (static_cast<int>(i) == m_pressed)
 		{
-			fd.roundedRects.push_back(Render::RoundedRectCmd{
+			fd.addRoundedRect(Render::RoundedRectCmd{
 				.rect = inner,
 				.radiusPx = 6.0f,
 				.color = m_pal.itemPressed,
-				.clipRect = QRectF(m_viewport)
+				.clip = fd.addClip(QRectF(m_viewport))
 				});
 		}
 		else if (static_cast<int>(i) == m_hover)
 		{
-			fd.roundedRects.push_back(Render::RoundedRectCmd{
+			fd.addRoundedRect(Render::RoundedRectCmd{
 				.rect = inner,
 				.radiusPx = 6.0f,
 				.color = m_pal.itemHover,
-				.clipRect = QRectF(m_viewport)
+				.clip = fd.addClip(QRectF(m_viewport))
 				});
 		}
 
@@ -245,12 +245,12 @@ void UiTreeList::append(Render::FrameData& fd) const
 			const QRectF dst(iconRect.center().x() - logical * 0.5,
 				iconRect.center().y() - logical * 0.5,
 				logical, logical);
-			fd.images.push_back(Render::ImageCmd{
+			fd.addImage(Render::ImageCmd{
 				.dstRect = dst,
 				.textureId = tex,
 				.srcRectPx = QRectF(0, 0, ts.width(), ts.height()),
 				.tint = m_pal.expandIcon,
-				.clipRect = QRectF(m_viewport)
+				.clip = fd.addClip(QRectF(m_viewport))
 				});
 		}
 
@@ -277,22 +277,22 @@ void UiTreeList::append(Render::FrameData& fd) const
 			hLogical
 		);
 
-		fd.images.push_back(Render::ImageCmd{
+		fd.addImage(Render::ImageCmd{
 			.dstRect = textDst,
 			.textureId = tex,
 			.srcRectPx = QRectF(0, 0, ts.width(), ts.height()),
 			.tint = QColor(255, 255, 255, 255),
-			.clipRect = QRectF(m_viewport) // 新增：所有项裁剪到列表 viewport
+			.clip = fd.addClip(QRectF(m_viewport)) // 新增：所有项裁剪到列表 viewport
 			});
 
 		// 分隔线
 		if (info.level == 0 && i < m_visibleNodes.size() - 1)
 		{
-			fd.roundedRects.push_back(Render::RoundedRectCmd{
+			fd.addRoundedRect(Render::RoundedRectCmd{
 				.rect = QRectF(vn.rect.left() + 8, vn.rect.bottom() - 1, vn.rect.width() - 16, 1),
 				.radiusPx = 0.0f,
 				.color = m_pal.separator,
-				.clipRect = QRectF(m_viewport)
+				.clip = fd.addClip(QRectF(m_viewport))
 				});
 		}
 	}
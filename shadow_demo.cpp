@@ -59,15 +59,15 @@ void demonstrateShadowFeatures() {
     qDebug() << "\n=== Improved Shadow Decorator Demo ===\n";
     
     // Demo 1: Basic shadow on a text widget with improved smoothness
-    qDebug() << "Demo 1: Basic text with smooth shadow (8-64 layers)";
+    qDebug() << "Demo 1: Basic text with smooth analytic shadow";
     auto shadowText = std::make_shared<TextWidget>("Hello Smooth Shadow!")
         ->shadow(QColor(0, 0, 0, 120), 12.0f, QPoint(2, 4), 1.0f);  // Lower alpha for better transparency
     
     auto component1 = shadowText->build();
     Render::FrameData frameData1;
     component1->append(frameData1);
-    qDebug() << "Smooth shadow render commands generated:" << frameData1.roundedRects.size();
-    qDebug() << "Expected ~12 layers (vs old ~6), smoother gradients";
+    qDebug() << "Smooth shadow commands generated:" << frameData1.shadows.size();
+    qDebug() << "Expected 1 Gaussian shadow command (vs old ~12 layered rects)";
     qDebug() << "";
     
     // Demo 2: Heavy shadow effect with exponential falloff
@@ -78,8 +78,8 @@ void demonstrateShadowFeatures() {
     auto component2 = heavyShadowText->build();
     Render::FrameData frameData2;
     component2->append(frameData2);
-    qDebug() << "Heavy smooth shadow render commands generated:" << frameData2.roundedRects.size();
-    qDebug() << "Expected ~24 layers (vs old ~12), exponential alpha falloff";
+    qDebug() << "Heavy smooth shadow commands generated:" << frameData2.shadows.size();
+    qDebug() << "Expected 1 Gaussian shadow command (vs old ~24 layered rects)";
     qDebug() << "";
     
     // Demo 3: Card with elevation (now shows more transparent shadow)
@@ -91,7 +91,7 @@ void demonstrateShadowFeatures() {
     Render::FrameData frameData3;
     component3->setViewportRect(QRect(0, 0, 200, 100));
     component3->append(frameData3);
-    qDebug() << "Low elevation card render commands:" << frameData3.roundedRects.size();
+    qDebug() << "Low elevation card render commands:" << frameData3.roundedRects.size() << "rects +" << frameData3.shadows.size() << "shadow";
     qDebug() << "Shadow alpha: ~40 (vs old ~80), much more transparent";
     qDebug() << "";
     
@@ -104,7 +104,7 @@ void demonstrateShadowFeatures() {
     Render::FrameData frameData4;
     component4->setViewportRect(QRect(0, 0, 200, 100));
     component4->append(frameData4);
-    qDebug() << "High elevation card render commands:" << frameData4.roundedRects.size();
+    qDebug() << "High elevation card render commands:" << frameData4.roundedRects.size() << "rects +" << frameData4.shadows.size() << "shadow";
     qDebug() << "Shadow alpha: ~110 (vs old ~170), much more transparent";
     qDebug() << "";
     
@@ -119,12 +119,12 @@ void demonstrateShadowFeatures() {
     Render::FrameData frameData5;
     component5->setViewportRect(QRect(0, 0, 250, 120));
     component5->append(frameData5);
-    qDebug() << "Complex card render commands:" << frameData5.roundedRects.size();
+    qDebug() << "Complex card render commands:" << frameData5.roundedRects.size() << "rects +" << frameData5.shadows.size() << "shadow";
     qDebug() << "";
     
     qDebug() << "=== Demo Complete ===\n";
     qDebug() << "Summary of Shadow Improvements:";
-    qDebug() << "✅ Basic shadow: Works - generates 2-4x more layers for smoother gradients";
+    qDebug() << "✅ Basic shadow: Works - one analytic Gaussian shadow per box";
     qDebug() << "✅ Heavy shadow: Works - exponential alpha falloff for natural blur";
     qDebug() << "✅ Card elevation: Works - automatically maps to more transparent shadow";
     qDebug() << "✅ High elevation: Works - stronger but still transparent shadow";
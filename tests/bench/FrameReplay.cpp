@@ -0,0 +1,236 @@
+/*
+ * 文件名：FrameReplay.cpp
+ * 职责：帧捕获回放工具，在离屏上下文中经Renderer::drawFrame重放捕获的帧并计时，支持按命令区间截取与分段二分定位高开销命令。
+ * 依赖：Qt6 Gui/OpenGL、Renderer、IconCache、FrameCapture。
+ * 线程：单线程（主线程持有OpenGL上下文）。
+ * 备注：纹理以同尺寸占位纹理代替（捕获不含像素内容）；默认使用offscreen平台插件。
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include <qbytearray.h>
+#include <qcommandlineoption.h>
+#include <qcommandlineparser.h>
+#include <qelapsedtimer.h>
+#include <qguiapplication.h>
+#include <qhash.h>
+#include <qoffscreensurface.h>
+#include <qopenglcontext.h>
+#include <qopenglframebufferobject.h>
+#include <qopenglfunctions.h>
+#include <qrect.h>
+#include <qstring.h>
+#include <qstringlist.h>
+#include <qsurfaceformat.h>
+
+#include "FrameCapture.h"
+#include "FrameProfiler.h"
+#include "IconCache.h"
+#include "RenderData.hpp"
+#include "Renderer.h"
+
+namespace {
+
+	struct Timing {
+		double p50Ms{ 0.0 };
+		double p99Ms{ 0.0 };
+		double gpuP50Ms{ -1.0 };
+		int    drawCalls{ 0 };
+		qint64 uploadBytes{ 0 };
+	};
+
+	/// 功能：为捕获中的每个纹理生成同尺寸占位纹理，并把命令中的句柄替换为新句柄
+	void bindPlaceholderTextures(FrameCapture& cap, IconCache& icons, QOpenGLFunctions* gl) {
+		QHash<int, int> remap;
+		for (const auto& t : cap.textures) {
+			if (t.sizePx.isEmpty()) continue;
+			const QByteArray svg = QString(
+				R"(<svg xmlns="http://www.w3.org/2000/svg" width="%1" height="%2"><rect width="%1" height="%2" fill="#ffffff" fill-opacity="0.8"/></svg>)")
+				.arg(t.sizePx.width()).arg(t.sizePx.height()).toUtf8();
+			remap.insert(t.handle, icons.ensureSvgPx(QStringLiteral("replay|%1").arg(t.handle), svg, t.sizePx, gl));
+		}
+		for (auto& img : cap.frame.images) img.textureId = remap.value(img.textureId, 0);
+	}
+
+	Timing timeFrame(Renderer& renderer, const IconCache& icons, QOpenGLFunctions* gl, const Render::FrameData& fd,
+		const float dpr, const int warmup, const int frames) {
+		const auto drawOnce = [&] {
+			gl->glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+			gl->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			renderer.drawFrame(fd, icons, dpr);
+		};
+		for (int i = 0; i < warmup; ++i) drawOnce();
+		gl->glFinish();
+		(void)renderer.takeGpuTimeNs();
+
+		std::vector<double> ms, gpuMs;
+		ms.reserve(static_cast<size_t>(frames));
+		for (int i = 0; i < frames; ++i) {
+			QElapsedTimer t;
+			t.start();
+			drawOnce();
+			gl->glFinish();
+			ms.push_back(static_cast<double>(t.nsecsElapsed()) / 1.0e6);
+			if (const qint64 ns = renderer.takeGpuTimeNs(); ns >= 0) gpuMs.push_back(static_cast<double>(ns) / 1.0e6);
+		}
+
+		Timing r;
+		r.p50Ms = FrameProfiler::percentile(ms, 0.50);
+		r.p99Ms = FrameProfiler::percentile(ms, 0.99);
+		if (!gpuMs.empty()) r.gpuP50Ms = FrameProfiler::percentile(gpuMs, 0.50);
+		r.drawCalls = renderer.lastFrameStats().drawCalls;
+		r.uploadBytes = renderer.lastFrameStats().uploadBytes;
+		return r;
+	}
+
+	void dumpCommands(const FrameCapture& cap, const qsizetype first, const qsizetype last) {
+		const auto& fd = cap.frame;
+		const auto printRect = [](const QRectF& r) {
+			std::printf("(%.1f,%.1f %.1fx%.1f)", r.x(), r.y(), r.width(), r.height());
+		};
+		for (qsizetype i = first; i < last; ++i) {
+			const auto& ref = fd.commands[static_cast<size_t>(i)];
+			std::printf("%6lld ", static_cast<long long>(i));
+			switch (ref.type) {
+			case Render::CmdType::RoundedRect: {
+				const auto& c = fd.roundedRects[ref.index];
+				std::printf("rect   ");
+				printRect(c.rect);
+				std::printf(" r=%.1f clip=", c.radiusPx);
+				printRect(fd.clip(c.clip).rect);
+				break;
+			}
+			case Render::CmdType::Image: {
+				const auto& c = fd.images[ref.index];
+				std::printf("image  ");
+				printRect(c.dstRect);
+				std::printf(" tex=%d clip=", c.textureId);
+				printRect(fd.clip(c.clip).rect);
+				break;
+			}
+			case Render::CmdType::Shadow: {
+				const auto& c = fd.shadows[ref.index];
+				std::printf("shadow ");
+				printRect(c.rect);
+				std::printf(" blur=%.1f clip=", c.blurPx);
+				printRect(fd.clip(c.clip).rect);
+				break;
+			}
+			}
+			std::printf("\n");
+		}
+	}
+
+}
+
+int main(int argc, char* argv[])
+{
+	if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+
+	QGuiApplication app(argc, argv);
+	QCoreApplication::setApplicationName("FangJia_FrameReplay");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Replay a captured frame (.fjcap) through Renderer::drawFrame and time it");
+	parser.addHelpOption();
+	parser.addPositionalArgument("capture", "Frame capture file written by FJ_CAPTURE_FRAMES or Ctrl+Shift+F12.");
+	const QCommandLineOption framesOpt("frames", "Timed frames per measurement.", "n", "60");
+	const QCommandLineOption warmupOpt("warmup", "Untimed warm-up frames per measurement.", "n", "5");
+	const QCommandLineOption rangeOpt("range", "Only replay commands [first, last).", "first:last");
+	const QCommandLineOption bisectOpt("bisect", "Split the range into <k> chunks and time each one alone.", "k");
+	const QCommandLineOption dumpOpt("dump", "Print the commands in the range.");
+	const QCommandLineOption immediateOpt("immediate", "Use the per-command submit path.");
+	parser.addOptions({ framesOpt, warmupOpt, rangeOpt, bisectOpt, dumpOpt, immediateOpt });
+	parser.process(app);
+
+	if (parser.positionalArguments().isEmpty()) parser.showHelp(1);
+
+	FrameCapture cap;
+	if (QString error; !FrameCapture::load(parser.positionalArguments().first(), cap, &error)) {
+		std::fprintf(stderr, "cannot load capture: %s\n", qPrintable(error));
+		return 2;
+	}
+
+	const auto total = static_cast<qsizetype>(cap.frame.commands.size());
+	qsizetype first = 0;
+	qsizetype last = total;
+	if (parser.isSet(rangeOpt)) {
+		const QStringList parts = parser.value(rangeOpt).split(':');
+		first = std::clamp<qsizetype>(parts.value(0).toLongLong(), 0, total);
+		last = parts.size() > 1 && !parts[1].isEmpty() ? std::clamp<qsizetype>(parts[1].toLongLong(), first, total) : total;
+	}
+	std::printf("capture: %lld commands (%zu rects, %zu images, %zu shadows), %zu textures, viewport %dx%d @%.2f\n",
+		static_cast<long long>(total), cap.frame.roundedRects.size(), cap.frame.images.size(), cap.frame.shadows.size(),
+		cap.textures.size(), cap.viewportSize.width(), cap.viewportSize.height(), cap.devicePixelRatio);
+
+	if (parser.isSet(dumpOpt)) {
+		dumpCommands(cap, first, last);
+		return 0;
+	}
+
+	const int frames = std::max(1, parser.value(framesOpt).toInt());
+	const int warmup = std::max(0, parser.value(warmupOpt).toInt());
+	const int fbW = std::max(1, qRound(cap.viewportSize.width() * cap.devicePixelRatio));
+	const int fbH = std::max(1, qRound(cap.viewportSize.height() * cap.devicePixelRatio));
+
+	QSurfaceFormat fmt;
+	fmt.setVersion(3, 3);
+	fmt.setProfile(QSurfaceFormat::CoreProfile);
+	QOpenGLContext context;
+	context.setFormat(fmt);
+	QOffscreenSurface surface;
+	surface.setFormat(fmt);
+	surface.create();
+	if (!context.create() || !context.makeCurrent(&surface)) {
+		std::fprintf(stderr, "failed to create an OpenGL context\n");
+		return 2;
+	}
+	QOpenGLFunctions* gl = context.functions();
+	// 深度附件与窗口一致，回放同样走不透明预通道
+	QOpenGLFramebufferObject fbo(fbW, fbH, QOpenGLFramebufferObject::CombinedDepthStencil);
+	fbo.bind();
+
+	Renderer renderer;
+	renderer.initializeGL(gl);
+	renderer.resize(fbW, fbH);
+	renderer.setSubmitPath(parser.isSet(immediateOpt) ? Renderer::SubmitPath::Immediate : Renderer::SubmitPath::Batched);
+	renderer.setGpuTimingEnabled(true);
+	IconCache icons;
+	bindPlaceholderTextures(cap, icons, gl);
+
+	const auto report = [](const char* label, const Timing& t) {
+		std::printf("%-24s p50 %8.3f ms  p99 %8.3f ms  gpu %8.3f ms  draws %5d  upload %10lld B\n",
+			label, t.p50Ms, t.p99Ms, t.gpuP50Ms, t.drawCalls, static_cast<long long>(t.uploadBytes));
+	};
+
+	const Render::FrameData whole = FrameCapture::slice(cap.frame, first, last);
+	const QByteArray label = QString("[%1, %2)").arg(first).arg(last).toUtf8();
+	report(label.constData(), timeFrame(renderer, icons, gl, whole, cap.devicePixelRatio, warmup, frames));
+
+	if (parser.isSet(bisectOpt) && last > first) {
+		// 各段单独绘制计时，按耗时降序列出；对最慢的段再以--range收窄重复即可逐步定位
+		const qsizetype chunks = std::clamp<qsizetype>(parser.value(bisectOpt).toLongLong(), 1, last - first);
+		struct Chunk { qsizetype first, last; Timing t; };
+		std::vector<Chunk> results;
+		for (qsizetype k = 0; k < chunks; ++k) {
+			const qsizetype a = first + (last - first) * k / chunks;
+			const qsizetype b = first + (last - first) * (k + 1) / chunks;
+			results.push_back({ a, b, timeFrame(renderer, icons, gl, FrameCapture::slice(cap.frame, a, b),
+				cap.devicePixelRatio, warmup, frames) });
+		}
+		std::sort(results.begin(), results.end(), [](const Chunk& x, const Chunk& y) { return x.t.p50Ms > y.t.p50Ms; });
+		std::printf("\nchunks by cost:\n");
+		for (const auto& c : results) {
+			const QByteArray l = QString("  [%1, %2)").arg(c.first).arg(c.last).toUtf8();
+			report(l.constData(), c.t);
+		}
+	}
+
+	fbo.release();
+	renderer.releaseGL();
+	icons.releaseAll(gl);
+	context.doneCurrent();
+	return 0;
+}
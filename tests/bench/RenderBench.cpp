@@ -0,0 +1,558 @@
+/*
+ * 文件名：RenderBench.cpp
+ * 职责：渲染器吞吐基准，在离屏上下文中绘制合成的FrameData负载，输出帧率、绘制调用与上传字节，并写出/对比基线。
+ * 依赖：Qt6 Gui/OpenGL、Renderer、IconCache、RasterCache、RenderUtils。
+ * 线程：单线程（主线程持有OpenGL上下文）。
+ * 备注：默认使用offscreen平台插件，可在无显示环境运行（Mesa llvmpipe：LIBGL_ALWAYS_SOFTWARE=1）；
+ *       基线为JSON，--compare时按场景+提交路径对比帧率，回退超过容差时返回非0；
+ *       --first-frame对比图标首帧耗时（无磁盘缓存 / 冷缓存 / 热缓存）；
+ *       启动时校验流式缓冲扩容帧（含带图层的帧）的绘制结果，不一致时返回非0。
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <qbytearray.h>
+#include <qcolor.h>
+#include <qcommandlineoption.h>
+#include <qcommandlineparser.h>
+#include <qelapsedtimer.h>
+#include <qfile.h>
+#include <qfont.h>
+#include <qguiapplication.h>
+#include <qjsonarray.h>
+#include <qjsondocument.h>
+#include <qjsonobject.h>
+#include <qoffscreensurface.h>
+#include <qopenglcontext.h>
+#include <qopenglframebufferobject.h>
+#include <qopenglfunctions.h>
+#include <qrect.h>
+#include <qstring.h>
+#include <qsurfaceformat.h>
+#include <qtemporarydir.h>
+
+#include "FrameProfiler.h"
+#include "IconCache.h"
+#include "RasterCache.h"
+#include "RenderData.hpp"
+#include "Renderer.h"
+#include "RenderUtils.hpp"
+#include "StreamBuffer.h"
+
+namespace {
+
+	constexpr int kViewW = 1280;
+	constexpr int kViewH = 800;
+	constexpr int kBaselineVersion = 1;
+	constexpr qsizetype kImmediateMaxCommands = 20000;  // 逐命令路径超过此命令数时跳过（耗时过长且无对比意义）
+
+	/// 场景构建上下文：合成负载所需的纹理在构建时生成
+	struct BuildContext {
+		IconCache& icons;
+		QOpenGLFunctions* gl;
+		std::mt19937& rng;
+	};
+
+	struct Scenario {
+		QString name;
+		std::function<void(Render::FrameData&, BuildContext&)> build;
+	};
+
+	struct Result {
+		QString name;
+		QString path;
+		qsizetype commands{ 0 };
+		double buildMs{ 0.0 };
+		double fps{ 0.0 };
+		double frameP50Ms{ 0.0 };
+		double frameP99Ms{ 0.0 };
+		double cpuP50Ms{ 0.0 };     // drawFrame返回前的CPU耗时
+		double gpuP50Ms{ -1.0 };    // GL_TIME_ELAPSED（不支持时为-1）
+		int    drawCalls{ 0 };
+		qint64 uploadBytes{ 0 };    // 每帧
+		int    opaqueRects{ 0 };    // 不透明预通道的内部区域数
+		qint64 opaquePixels{ 0 };   // 不透明内部覆盖的像素数（这些像素上更早的命令不再着色）
+		int    fenceWaits{ 0 };     // 全部计时帧累计
+	};
+
+	QColor randomColor(std::mt19937& rng, const int alphaMin = 255) {
+		std::uniform_int_distribution<int> c(30, 230);
+		std::uniform_int_distribution<int> a(alphaMin, 255);
+		return QColor(c(rng), c(rng), c(rng), a(rng));
+	}
+
+	QRectF randomRect(std::mt19937& rng, const float minSize, const float maxSize) {
+		std::uniform_real_distribution<float> size(minSize, maxSize);
+		const float w = size(rng);
+		const float h = size(rng);
+		std::uniform_real_distribution<float> x(0.0f, kViewW - w);
+		std::uniform_real_distribution<float> y(0.0f, kViewH - h);
+		return QRectF(x(rng), y(rng), w, h);
+	}
+
+	void buildRects(Render::FrameData& fd, BuildContext& ctx, const int count) {
+		// 数量越大尺寸越小，保持总覆盖面积在同一量级
+		const float maxSize = count >= 100000 ? 12.0f : (count >= 10000 ? 32.0f : 96.0f);
+		std::uniform_real_distribution<float> radius(0.0f, 8.0f);
+		for (int i = 0; i < count; ++i) {
+			fd.addRoundedRect(Render::RoundedRectCmd{
+				.rect = randomRect(ctx.rng, 4.0f, maxSize),
+				.radiusPx = radius(ctx.rng),
+				.color = randomColor(ctx.rng, 160) });
+		}
+	}
+
+	void buildShadows(Render::FrameData& fd, BuildContext& ctx, const int count) {
+		std::uniform_real_distribution<float> blur(4.0f, 24.0f);
+		for (int i = 0; i < count; ++i) {
+			const QRectF card = randomRect(ctx.rng, 24.0f, 120.0f);
+			fd.addShadow(Render::ShadowCmd{
+				.rect = card.translated(0, 2), .radiusPx = 8.0f, .blurPx = blur(ctx.rng), .color = QColor(0, 0, 0, 60) });
+			fd.addRoundedRect(Render::RoundedRectCmd{ .rect = card, .radiusPx = 8.0f, .color = randomColor(ctx.rng) });
+		}
+	}
+
+	/// 混合界面负载：卡片、图标与文本交错追加（相邻命令类型不同，考验批次合并）
+	void buildMixed(Render::FrameData& fd, BuildContext& ctx, const int cards) {
+		constexpr int kIconVariants = 32;
+		constexpr int kTextVariants = 200;
+		std::vector<int> iconIds;
+		for (int i = 0; i < kIconVariants; ++i) {
+			const QColor c = QColor::fromHsv(i * 360 / kIconVariants, 180, 220);
+			const QByteArray svg = QString(
+				R"(<svg xmlns="http://www.w3.org/2000/svg" width="24" height="24"><circle cx="12" cy="12" r="%1" fill="%2"/></svg>)")
+				.arg(6 + i % 6).arg(c.name()).toUtf8();
+			iconIds.push_back(ctx.icons.ensureSvgPx(QStringLiteral("bench_icon_%1").arg(i), svg, QSize(24, 24), ctx.gl));
+		}
+		QFont font;
+		font.setPixelSize(14);
+		std::vector<int> textIds;
+		for (int i = 0; i < kTextVariants; ++i) {
+			const QString text = QStringLiteral("Item %1 · 配方").arg(i);
+			const QColor color(40, 40, 40);
+			textIds.push_back(ctx.icons.ensureTextPx(RenderUtils::makeTextCacheKey(text, 14, color), font, text, color, ctx.gl));
+		}
+
+		std::uniform_int_distribution<int> pickIcon(0, kIconVariants - 1);
+		std::uniform_int_distribution<int> pickText(0, kTextVariants - 1);
+		for (int i = 0; i < cards; ++i) {
+			const QRectF card = randomRect(ctx.rng, 80.0f, 200.0f);
+			fd.addRoundedRect(Render::RoundedRectCmd{ .rect = card, .radiusPx = 6.0f, .color = randomColor(ctx.rng) });
+
+			const int icon = iconIds[static_cast<size_t>(pickIcon(ctx.rng))];
+			const QSize is = ctx.icons.textureSizePx(icon);
+			fd.addImage(Render::ImageCmd{
+				.dstRect = QRectF(card.left() + 8, card.top() + 8, 24, 24),
+				.textureId = icon,
+				.srcRectPx = QRectF(0, 0, is.width(), is.height()) });
+
+			const int text = textIds[static_cast<size_t>(pickText(ctx.rng))];
+			const QSize ts = ctx.icons.textureSizePx(text);
+			fd.addImage(Render::ImageCmd{
+				.dstRect = QRectF(card.left() + 40, card.top() + 12, ts.width(), ts.height()),
+				.textureId = text,
+				.srcRectPx = QRectF(0, 0, ts.width(), ts.height()),
+				.clip = fd.addClip(card) });
+		}
+	}
+
+	/// 深层剪裁嵌套：每列一条depth层的圆角容器链，每层追加背景与若干子项，再按UiComponent的方式应用父级剪裁
+	void buildClipNesting(Render::FrameData& fd, BuildContext& ctx, const int columns, const int depth) {
+		constexpr int kLeavesPerLevel = 4;
+		const float colW = static_cast<float>(kViewW) / static_cast<float>(columns);
+		for (int c = 0; c < columns; ++c) {
+			std::vector<std::array<int, 3>> starts;
+			std::vector<QRectF> clips;
+			QRectF box(c * colW, 0, colW, kViewH);
+			for (int d = 0; d < depth; ++d) {
+				starts.push_back({ static_cast<int>(fd.roundedRects.size()), static_cast<int>(fd.images.size()),
+					static_cast<int>(fd.shadows.size()) });
+				clips.push_back(box);
+				fd.addRoundedRect(Render::RoundedRectCmd{ .rect = box, .radiusPx = 6.0f, .color = randomColor(ctx.rng, 40) });
+				for (int k = 0; k < kLeavesPerLevel; ++k) {
+					const QRectF leaf(box.left() + k * box.width() / kLeavesPerLevel, box.top(), box.width() / kLeavesPerLevel, 6.0);
+					fd.addRoundedRect(Render::RoundedRectCmd{ .rect = leaf, .radiusPx = 2.0f, .color = randomColor(ctx.rng) });
+				}
+				box.adjust(0.5, 8.0, -0.5, -2.0);
+			}
+			// 自内向外关闭容器，与组件树的append顺序一致
+			for (int d = depth - 1; d >= 0; --d) {
+				const auto& s = starts[static_cast<size_t>(d)];
+				RenderUtils::applyParentClip(fd, s[0], s[1], s[2], clips[static_cast<size_t>(d)], 6.0f);
+			}
+		}
+	}
+
+	/// 层叠面板：整页背景 + 侧栏 + 多层互相重叠的不透明卡片，典型界面的混合过度绘制
+	void buildStackedPanels(Render::FrameData& fd, BuildContext& ctx, const int pages) {
+		for (int p = 0; p < pages; ++p) {
+			fd.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(0, 0, kViewW, kViewH), .radiusPx = 0.0f, .color = randomColor(ctx.rng) });
+			fd.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(0, 0, 240, kViewH), .radiusPx = 0.0f, .color = randomColor(ctx.rng) });
+			for (int c = 0; c < 24; ++c) {
+				const QRectF card = randomRect(ctx.rng, 160.0f, 420.0f);
+				fd.addShadow(Render::ShadowCmd{ .rect = card.translated(0, 2), .radiusPx = 12.0f, .blurPx = 12.0f, .color = QColor(0, 0, 0, 40) });
+				fd.addRoundedRect(Render::RoundedRectCmd{ .rect = card, .radiusPx = 12.0f, .color = randomColor(ctx.rng) });
+				fd.addRoundedRect(Render::RoundedRectCmd{ .rect = card.adjusted(12, 12, -12, -card.height() * 0.5), .radiusPx = 6.0f,
+					.color = randomColor(ctx.rng, 120) });
+			}
+		}
+	}
+
+	std::vector<Scenario> makeScenarios() {
+		return {
+			{ "rects_1k",     [](auto& fd, auto& ctx) { buildRects(fd, ctx, 1000); } },
+			{ "rects_10k",    [](auto& fd, auto& ctx) { buildRects(fd, ctx, 10000); } },
+			{ "rects_100k",   [](auto& fd, auto& ctx) { buildRects(fd, ctx, 100000); } },
+			{ "shadows_1k",   [](auto& fd, auto& ctx) { buildShadows(fd, ctx, 1000); } },
+			{ "shadows_10k",  [](auto& fd, auto& ctx) { buildShadows(fd, ctx, 10000); } },
+			{ "mixed_ui_2k",  [](auto& fd, auto& ctx) { buildMixed(fd, ctx, 2000); } },
+			{ "clip_deep_32", [](auto& fd, auto& ctx) { buildClipNesting(fd, ctx, 64, 32); } },
+			{ "stacked_8",    [](auto& fd, auto& ctx) { buildStackedPanels(fd, ctx, 8); } },
+		};
+	}
+
+	/// 图标首帧负载的SVG：多边形路径 + 描边，解析与栅格化成本接近真实图标
+	std::vector<QByteArray> makeIconSvgs(const int count) {
+		std::vector<QByteArray> svgs;
+		for (int i = 0; i < count; ++i) {
+			QString points;
+			constexpr int kVertices = 48;
+			for (int v = 0; v < kVertices; ++v) {
+				const double a = 2.0 * 3.14159265358979 * v / kVertices;
+				const double r = (v % 2 ? 5.0 : 10.0) + (i % 5) * 0.3;
+				points += QStringLiteral("%1,%2 ").arg(12.0 + r * std::cos(a), 0, 'f', 2).arg(12.0 + r * std::sin(a), 0, 'f', 2);
+			}
+			svgs.push_back(QString(
+				R"(<svg xmlns="http://www.w3.org/2000/svg" width="24" height="24" viewBox="0 0 24 24">)"
+				R"(<polygon points="%1" fill="#fff" stroke="#fff" stroke-width="%2" stroke-linejoin="round"/></svg>)")
+				.arg(points.trimmed()).arg(1.0 + (i % 3) * 0.5).toUtf8());
+		}
+		return svgs;
+	}
+
+	/// 功能：测量新建IconCache时一帧图标负载的耗时（栅格化或磁盘载入 + 上传 + 绘制完成）
+	/// 参数：disk — 磁盘缓存（为空时不使用）
+	double firstFrameMs(Renderer& renderer, QOpenGLFunctions* gl, RasterCache* disk, const std::vector<QByteArray>& svgs) {
+		constexpr std::array<int, 5> kSizes{ 16, 20, 24, 32, 48 };
+		IconCache icons;
+		icons.setRasterCache(disk);
+		QElapsedTimer t;
+		t.start();
+		Render::FrameData fd;
+		float x = 0.0f;
+		float y = 0.0f;
+		for (size_t i = 0; i < svgs.size(); ++i) {
+			for (const int s : kSizes) {
+				const int id = icons.ensureSvgPx(QStringLiteral("ff_%1_%2").arg(i).arg(s), svgs[i], QSize(s, s), gl);
+				fd.addImage(Render::ImageCmd{ .dstRect = QRectF(x, y, s, s), .textureId = id, .srcRectPx = QRectF(0, 0, s, s),
+					.tint = QColor(60, 60, 60) });
+				x += 52.0f;
+				if (x + 48.0f > kViewW) {
+					x = 0.0f;
+					y = y + 52.0f > kViewH - 48.0f ? 0.0f : y + 52.0f;
+				}
+			}
+		}
+		gl->glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+		gl->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		renderer.drawFrame(fd, icons, 1.0f);
+		gl->glFinish();
+		const double ms = static_cast<double>(t.nsecsElapsed()) / 1.0e6;
+		icons.releaseAll(gl);
+		return ms;
+	}
+
+	/// 功能：以新建的渲染器绘制一帧（流式缓冲为初始容量，本帧需扩容），再绘制一帧（容量已足够，图层提升版本后重绘），
+	///       两帧必须逐像素一致（帧中扩容会丢失先写入的数据）
+	/// 返回：一致且第一帧确实超出初始区域时返回true
+	bool checkStreamGrowthFrame(QOpenGLFunctions* gl, const IconCache& icons, const char* name, Render::FrameData& fd) {
+		Renderer renderer;
+		renderer.initializeGL(gl);
+		renderer.resize(kViewW, kViewH);
+
+		const auto drawAndRead = [&] {
+			gl->glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+			gl->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			renderer.drawFrame(fd, icons, 1.0f);
+			std::vector<uchar> pixels(static_cast<size_t>(kViewW) * kViewH * 4);
+			gl->glReadPixels(0, 0, kViewW, kViewH, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+			return pixels;
+		};
+		const auto grown = drawAndRead();
+		const auto& st = renderer.lastFrameStats();
+		const qint64 uploadBytes = st.uploadBytes;
+		const int orphans = st.streamOrphans;
+		const int overflows = st.streamOverflows;
+		for (auto& def : fd.layers) ++def.version;
+		const bool same = grown == drawAndRead();
+		renderer.releaseGL();
+
+		const bool ok = same && overflows == 0 && uploadBytes > StreamBuffer::kInitialRegionBytes;
+		std::printf("stream growth (%s): %lld B in first frame (initial region %lld B, %d orphans, %d overflows) -> %s\n", name,
+			static_cast<long long>(uploadBytes), static_cast<long long>(StreamBuffer::kInitialRegionBytes), orphans, overflows,
+			ok ? "ok" : "MISMATCH");
+		return ok;
+	}
+
+	/// 功能：流式缓冲扩容校验：无图层的帧（矩形数组放得下，加上投影数组后放不下），
+	///       以及带图层的帧（图层内容与主帧各自放得下，合计放不下；图层先于主帧写入同一缓冲）
+	bool checkStreamGrowth(QOpenGLFunctions* gl, IconCache& icons) {
+		// 独立的随机源，不改变后续场景的负载
+		std::mt19937 rng(7u);
+		BuildContext ctx{ icons, gl, rng };
+
+		Render::FrameData flat;
+		buildShadows(flat, ctx, 1000);
+
+		auto content = std::make_shared<Render::FrameData>();
+		buildShadows(*content, ctx, 600);
+		Render::FrameData layered;
+		buildShadows(layered, ctx, 300);
+		const QRectF bounds(0, 0, kViewW, kViewH);
+		layered.addLayer(Render::LayerDef{ .id = 1, .version = 1, .bounds = bounds, .content = content },
+			Render::ImageCmd{ .dstRect = bounds, .textureId = Render::layerTextureId(1), .srcRectPx = bounds, .tint = QColor(255, 255, 255, 160) });
+
+		const bool flatOk = checkStreamGrowthFrame(gl, icons, "flat", flat);
+		const bool layeredOk = checkStreamGrowthFrame(gl, icons, "layered", layered);
+		return flatOk && layeredOk;
+	}
+
+	const char* pathName(const Renderer::SubmitPath path, const bool opaquePass) {
+		if (path == Renderer::SubmitPath::Immediate) return "immediate";
+		return opaquePass ? "batched" : "batched-blend";
+	}
+
+	Result runScenario(Renderer& renderer, const IconCache& icons, QOpenGLFunctions* gl, const Render::FrameData& fd,
+		const Renderer::SubmitPath path, const bool opaquePass, const int warmup, const int frames) {
+		Result r;
+		r.path = pathName(path, opaquePass);
+		r.commands = static_cast<qsizetype>(fd.commands.size());
+		renderer.setSubmitPath(path);
+		renderer.setOpaquePassEnabled(opaquePass);
+		renderer.setGpuTimingEnabled(true);
+
+		const auto drawOnce = [&] {
+			gl->glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+			gl->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			renderer.drawFrame(fd, icons, 1.0f);
+		};
+		for (int i = 0; i < warmup; ++i) drawOnce();
+		gl->glFinish();
+		(void)renderer.takeGpuTimeNs();
+
+		std::vector<double> frameMs, cpuMs, gpuMs;
+		frameMs.reserve(static_cast<size_t>(frames));
+		cpuMs.reserve(static_cast<size_t>(frames));
+		QElapsedTimer total;
+		total.start();
+		for (int i = 0; i < frames; ++i) {
+			QElapsedTimer t;
+			t.start();
+			drawOnce();
+			cpuMs.push_back(static_cast<double>(t.nsecsElapsed()) / 1.0e6);
+			// 每帧等待完成：离屏上下文没有交换节流，否则测得的是命令入队速度
+			gl->glFinish();
+			frameMs.push_back(static_cast<double>(t.nsecsElapsed()) / 1.0e6);
+			if (const qint64 ns = renderer.takeGpuTimeNs(); ns >= 0) gpuMs.push_back(static_cast<double>(ns) / 1.0e6);
+			r.fenceWaits += renderer.lastFrameStats().fenceWaits;
+		}
+		const double totalMs = static_cast<double>(total.nsecsElapsed()) / 1.0e6;
+
+		const auto& stats = renderer.lastFrameStats();
+		r.fps = totalMs > 0.0 ? frames * 1000.0 / totalMs : 0.0;
+		r.frameP50Ms = FrameProfiler::percentile(frameMs, 0.50);
+		r.frameP99Ms = FrameProfiler::percentile(frameMs, 0.99);
+		r.cpuP50Ms = FrameProfiler::percentile(cpuMs, 0.50);
+		if (!gpuMs.empty()) r.gpuP50Ms = FrameProfiler::percentile(gpuMs, 0.50);
+		r.drawCalls = stats.drawCalls;
+		r.uploadBytes = stats.uploadBytes;
+		r.opaqueRects = stats.opaqueRects;
+		r.opaquePixels = stats.opaquePixels;
+		return r;
+	}
+
+	QJsonObject toJson(const Result& r) {
+		return QJsonObject{
+			{ "name", r.name }, { "path", r.path }, { "commands", r.commands },
+			{ "buildMs", r.buildMs }, { "fps", r.fps },
+			{ "frameP50Ms", r.frameP50Ms }, { "frameP99Ms", r.frameP99Ms },
+			{ "cpuP50Ms", r.cpuP50Ms }, { "gpuP50Ms", r.gpuP50Ms },
+			{ "drawCalls", r.drawCalls }, { "uploadBytes", r.uploadBytes }, { "fenceWaits", r.fenceWaits },
+			{ "opaqueRects", r.opaqueRects }, { "opaquePixels", r.opaquePixels },
+		};
+	}
+
+	/// 功能：与基线对比帧率
+	/// 返回：帧率回退超过tolerance的条目数（基线缺失的条目不计）
+	int compareWithBaseline(const QString& baselinePath, const std::vector<Result>& results, const double tolerance) {
+		QFile f(baselinePath);
+		if (!f.open(QIODevice::ReadOnly)) {
+			std::fprintf(stderr, "cannot open baseline %s\n", qPrintable(baselinePath));
+			return 0;
+		}
+		const QJsonObject root = QJsonDocument::fromJson(f.readAll()).object();
+		if (root.value("version").toInt() != kBaselineVersion) {
+			std::fprintf(stderr, "baseline version mismatch, skipping comparison\n");
+			return 0;
+		}
+
+		int regressions = 0;
+		std::printf("\n%-16s %-13s %10s %10s %8s %10s\n", "scenario", "path", "base fps", "fps", "ratio", "drawCalls");
+		for (const auto& r : results) {
+			for (const auto v : root.value("results").toArray()) {
+				const QJsonObject b = v.toObject();
+				if (b.value("name").toString() != r.name || b.value("path").toString() != r.path) continue;
+				const double baseFps = b.value("fps").toDouble();
+				const double ratio = baseFps > 0.0 ? r.fps / baseFps : 1.0;
+				const bool regressed = ratio < 1.0 - tolerance;
+				regressions += regressed ? 1 : 0;
+				std::printf("%-16s %-13s %10.1f %10.1f %7.2fx %4d -> %-4d%s\n", qPrintable(r.name), qPrintable(r.path),
+					baseFps, r.fps, ratio, b.value("drawCalls").toInt(), r.drawCalls, regressed ? "  REGRESSION" : "");
+			}
+		}
+		return regressions;
+	}
+
+}
+
+int main(int argc, char* argv[])
+{
+	// 无显示环境下默认走offscreen平台插件
+	if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+
+	QGuiApplication app(argc, argv);
+	QCoreApplication::setApplicationName("FangJia_RenderBench");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Headless FrameData rendering benchmark");
+	parser.addHelpOption();
+	const QCommandLineOption framesOpt("frames", "Timed frames per scenario.", "n", "120");
+	const QCommandLineOption warmupOpt("warmup", "Untimed warm-up frames per scenario.", "n", "10");
+	const QCommandLineOption outOpt("out", "Write results as JSON baseline to <file>.", "file", "render_baseline.json");
+	const QCommandLineOption compareOpt("compare", "Compare fps against baseline <file>.", "file");
+	const QCommandLineOption toleranceOpt("tolerance", "Allowed fps drop before a comparison fails (0..1).", "ratio", "0.15");
+	const QCommandLineOption filterOpt("filter", "Only run scenarios whose name contains <text>.", "text");
+	const QCommandLineOption immediateOpt("immediate", "Also run the per-command submit path (small scenarios only).");
+	const QCommandLineOption blendOpt("blend-only", "Also run the batched path without the opaque depth pre-pass.");
+	const QCommandLineOption firstFrameOpt("first-frame", "Also time a first icon frame without, with a cold and with a warm raster disk cache.");
+	parser.addOptions({ framesOpt, warmupOpt, outOpt, compareOpt, toleranceOpt, filterOpt, immediateOpt, blendOpt, firstFrameOpt });
+	parser.process(app);
+
+	const int frames = std::max(1, parser.value(framesOpt).toInt());
+	const int warmup = std::max(0, parser.value(warmupOpt).toInt());
+
+	QSurfaceFormat fmt;
+	fmt.setVersion(3, 3);
+	fmt.setProfile(QSurfaceFormat::CoreProfile);
+	QOpenGLContext context;
+	context.setFormat(fmt);
+	QOffscreenSurface surface;
+	surface.setFormat(fmt);
+	surface.create();
+	if (!context.create() || !context.makeCurrent(&surface)) {
+		std::fprintf(stderr, "failed to create an OpenGL context\n");
+		return 2;
+	}
+	QOpenGLFunctions* gl = context.functions();
+
+	// 绘制到FBO，不依赖平台是否为离屏表面提供默认帧缓冲；深度附件供不透明预通道使用（与窗口的默认格式一致）
+	QOpenGLFramebufferObject fbo(kViewW, kViewH, QOpenGLFramebufferObject::CombinedDepthStencil);
+	fbo.bind();
+
+	Renderer renderer;
+	renderer.initializeGL(gl);
+	renderer.resize(kViewW, kViewH);
+	IconCache icons;
+
+	const QString glRenderer = QString::fromLatin1(reinterpret_cast<const char*>(gl->glGetString(GL_RENDERER)));
+	const QString glVersion = QString::fromLatin1(reinterpret_cast<const char*>(gl->glGetString(GL_VERSION)));
+	std::printf("GL: %s | %s | gpu timing %s\n", qPrintable(glRenderer), qPrintable(glVersion),
+		renderer.gpuTimingSupported() ? "on" : "off");
+	std::printf("%-16s %-13s %8s %9s %9s %9s %9s %6s %12s %10s\n",
+		"scenario", "path", "cmds", "fps", "p50 ms", "p99 ms", "gpu ms", "draws", "upload B", "opaque Mpx");
+
+	std::mt19937 rng(20240501u);
+	BuildContext ctx{ icons, gl, rng };
+	const bool streamOk = checkStreamGrowth(gl, icons);
+	std::vector<Result> results;
+	for (const auto& scenario : makeScenarios()) {
+		if (parser.isSet(filterOpt) && !scenario.name.contains(parser.value(filterOpt))) continue;
+
+		Render::FrameData fd;
+		QElapsedTimer buildClock;
+		buildClock.start();
+		scenario.build(fd, ctx);
+		const double buildMs = static_cast<double>(buildClock.nsecsElapsed()) / 1.0e6;
+
+		std::vector<std::pair<Renderer::SubmitPath, bool>> paths{ { Renderer::SubmitPath::Batched, true } };
+		if (parser.isSet(blendOpt)) paths.emplace_back(Renderer::SubmitPath::Batched, false);
+		if (parser.isSet(immediateOpt) && static_cast<qsizetype>(fd.commands.size()) <= kImmediateMaxCommands) {
+			paths.emplace_back(Renderer::SubmitPath::Immediate, false);
+		}
+		for (const auto& [path, opaquePass] : paths) {
+			Result r = runScenario(renderer, icons, gl, fd, path, opaquePass, warmup, frames);
+			r.name = scenario.name;
+			r.buildMs = buildMs;
+			std::printf("%-16s %-13s %8lld %9.1f %9.2f %9.2f %9.2f %6d %12lld %10.2f\n", qPrintable(r.name), qPrintable(r.path),
+				static_cast<long long>(r.commands), r.fps, r.frameP50Ms, r.frameP99Ms, r.gpuP50Ms, r.drawCalls,
+				static_cast<long long>(r.uploadBytes), static_cast<double>(r.opaquePixels) / 1.0e6);
+			results.push_back(r);
+		}
+	}
+
+	QJsonArray arr;
+	for (const auto& r : results) arr.append(toJson(r));
+	QJsonObject root{
+		{ "version", kBaselineVersion },
+		{ "glRenderer", glRenderer },
+		{ "glVersion", glVersion },
+		{ "viewport", QJsonArray{ kViewW, kViewH } },
+		{ "frames", frames },
+		{ "results", arr },
+	};
+
+	if (parser.isSet(firstFrameOpt)) {
+		// 临时目录中的冷缓存：第一次全部未命中并写入，第二次全部从映射文件载入
+		constexpr int kIconCount = 96;
+		const auto svgs = makeIconSvgs(kIconCount);
+		QTemporaryDir dir;
+		RasterCache disk(dir.path());
+		disk.setEnabled(true);
+		const double noneMs = firstFrameMs(renderer, gl, nullptr, svgs);
+		const double coldMs = firstFrameMs(renderer, gl, &disk, svgs);
+		const double warmMs = firstFrameMs(renderer, gl, &disk, svgs);
+		const auto ds = disk.stats();
+		std::printf("
+first icon frame (%d icons x 5 sizes): no disk cache %.2f ms | cold %.2f ms | warm %.2f ms (%.2fx)"
+			" | disk hits %d misses %d writes %d\n", kIconCount, noneMs, coldMs, warmMs, warmMs > 0.0 ? coldMs / warmMs : 0.0,
+			ds.hits, ds.misses, ds.writes);
+		root.insert("firstFrame", QJsonObject{ { "icons", kIconCount }, { "noneMs", noneMs }, { "coldMs", coldMs }, { "warmMs", warmMs } });
+	}
+	const QString outPath = parser.value(outOpt);
+	if (QFile out(outPath); out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		out.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+		std::printf("\nbaseline written to %s\n", qPrintable(outPath));
+	}
+	else {
+		std::fprintf(stderr, "cannot write %s\n", qPrintable(outPath));
+	}
+
+	int regressions = 0;
+	if (parser.isSet(compareOpt)) {
+		regressions = compareWithBaseline(parser.value(compareOpt), results, parser.value(toleranceOpt).toDouble());
+	}
+
+	fbo.release();
+	renderer.releaseGL();
+	icons.releaseAll(gl);
+	context.doneCurrent();
+	return regressions > 0 || !streamOk ? 1 : 0;
+}
@@ -1,6 +1,11 @@
 #include <QtTest>
 #include <QCoreApplication>
+#include <QFont>
+#include <QGuiApplication>
 #include <QDebug>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
 #include <QSignalSpy>
 
 // Core test for ThemeManager
@@ -23,6 +28,8 @@
 // Formula Service Integration test includes
 #include "FormulaRepository.h"
 #include "services/FormulaService.h"
+#include <QDir>
+#include <QFile>
 #include <QTemporaryDir>
 
 // Core test for RebuildHost
@@ -43,8 +50,56 @@
 #include "presentation/ui/containers/UiScrollView.h"
 #include "presentation/ui/containers/UiPage.h"
 #include "presentation/ui/containers/UiRoot.h"
+#include "presentation/ui/containers/UiLayer.h"
+#include "presentation/ui/containers/UiRetained.h"
 #include "presentation/ui/widgets/UiTreeList.h"
 #include "presentation/ui/base/ILayoutable.hpp"
+#include "presentation/ui/base/RenderUtils.hpp"
+#include "AtlasPacker.h"
+#include "CommandCuller.h"
+#include "DamageTracker.h"
+#include "FrameCapture.h"
+#include "FrameClock.h"
+#include "FrameExchange.h"
+#include "FrameProfiler.h"
+#include "FrameScheduler.h"
+#include "IconCache.h"
+#include "IconLoader.h"
+#include "RasterCache.h"
+#include "ShaderCache.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+
+// 堆分配计数：替换全局operator new，供帧内存复用测试断言稳态录制不再分配
+namespace {
+    std::atomic<qint64> g_heapAllocs{ 0 };
+
+    /// IconCache测试共用的16×16白色方块SVG
+    QByteArray whiteSquareSvg()
+    {
+        return QByteArrayLiteral("<svg xmlns='http://www.w3.org/2000/svg' width='16' height='16'>"
+            "<rect width='16' height='16' fill='#fff'/></svg>");
+    }
+
+    /// 让IconCache无需上下文即可测试：延迟GL模式下纹理操作只排队，gl参数可为空
+    void useDeferredGl(IconCache& icons, const IconCache::RasterMode mode = IconCache::RasterMode::Bitmap)
+    {
+        icons.setDeferredGl(true);
+        icons.setRasterMode(mode, nullptr);
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    g_heapAllocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
 
 class SimpleTestRunner : public QObject
 {
@@ -637,6 +692,55 @@ public slots:
         hoverHandled = decoratedBox->onMouseMove(outsideHover);
         QVERIFY(hoverHandled); // Should handle the change
         QVERIFY(!isHovered); // Should not be hovered anymore
+
+        // Test 6: Shadow is a single Gaussian shadow command drawn beneath the background
+        UI::DecoratedBox::Props shadowProps;
+        shadowProps.bg = QColor(255, 255, 255);
+        shadowProps.bgRadius = 8.0f;
+        shadowProps.useShadow = true;
+        shadowProps.shadowColor = QColor(0, 0, 0, 120);
+        shadowProps.shadowBlurPx = 12.0f;
+        shadowProps.shadowOffset = QPoint(0, 4);
+        UI::DecoratedBox shadowBox(std::make_unique<MockChild>(), shadowProps);
+        shadowBox.setViewportRect(QRect(0, 0, 100, 40));
+
+        Render::FrameData shadowFd;
+        shadowBox.append(shadowFd);
+        QCOMPARE(shadowFd.shadows.size(), size_t(1));
+        QCOMPARE(shadowFd.roundedRects.size(), size_t(1));
+        QVERIFY(shadowFd.commands.front().type == Render::CmdType::Shadow);
+        QCOMPARE(QRectF(shadowFd.shadows[0].rect), QRectF(0, 4, 100, 40));
+        QCOMPARE(shadowFd.shadows[0].blurPx, 12.0f);
+        QVERIFY(shadowFd.shadows[0].color.alpha() > 120);  // 峰值与原分层叠加一致，高于单层alpha
+
+        // Test 7: Border + translucent background is one stroked command (background does not cover the border)
+        UI::DecoratedBox::Props borderProps;
+        borderProps.bg = QColor(255, 255, 255, 128);
+        borderProps.bgRadius = 8.0f;
+        borderProps.border = QColor(0, 120, 215);
+        borderProps.borderW = 2.0f;
+        UI::DecoratedBox borderBox(std::make_unique<MockChild>(), borderProps);
+        borderBox.setViewportRect(QRect(0, 0, 100, 40));
+
+        Render::FrameData borderFd;
+        borderBox.append(borderFd);
+        QCOMPARE(borderFd.roundedRects.size(), size_t(1));
+        QCOMPARE(QRectF(borderFd.roundedRects[0].rect), QRectF(0, 0, 100, 40));
+        QCOMPARE(borderFd.roundedRects[0].radiusPx, 8.0f);
+        QCOMPARE(QColor(borderFd.roundedRects[0].color), QColor(255, 255, 255, 128));
+        QCOMPARE(borderFd.roundedRects[0].strokeWidthPx, 2.0f);
+        QCOMPARE(QColor(borderFd.roundedRects[0].strokeColor), QColor(0, 120, 215));
+
+        // Border only: transparent fill, still visible through the stroke
+        borderProps.bg = Qt::transparent;
+        UI::DecoratedBox outlineBox(std::make_unique<MockChild>(), borderProps);
+        outlineBox.setViewportRect(QRect(0, 0, 100, 40));
+        Render::FrameData outlineFd;
+        outlineBox.append(outlineFd);
+        QCOMPARE(outlineFd.roundedRects.size(), size_t(1));
+        QVERIFY(outlineFd.roundedRects[0].stroked());
+        QVERIFY(outlineFd.roundedRects[0].visible());
+        QCOMPARE(outlineFd.roundedRects[0].color.alpha(), 0);
         
         qDebug() << "DecoratedBox tests PASSED ✅";
     }
@@ -805,6 +909,1221 @@ public slots:
         
         qDebug() << "RebuildHost bounds() fix PASSED ✅";
     }
+
+    void runFrameDataCommandStreamTests()
+    {
+        qDebug() << "=== Testing FrameData ordered command stream ===";
+
+        Render::FrameData fd;
+        fd.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(0, 0, 100, 100), .radiusPx = 0.0f, .color = QColor(255, 255, 255) });
+        fd.addImage(Render::ImageCmd{ .dstRect = QRectF(10, 10, 16, 16), .textureId = 1, .srcRectPx = QRectF(0, 0, 16, 16) });
+        // 覆盖在图像之上的悬停层
+        fd.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(8, 8, 20, 20), .radiusPx = 4.0f, .color = QColor(0, 0, 0, 40) });
+
+        QCOMPARE(fd.commands.size(), size_t(3));
+        QVERIFY(fd.hasOrderedStream());
+        QVERIFY(fd.commands[0].type == Render::CmdType::RoundedRect && fd.commands[0].index == 0);
+        QVERIFY(fd.commands[1].type == Render::CmdType::Image && fd.commands[1].index == 0);
+        QVERIFY(fd.commands[2].type == Render::CmdType::RoundedRect && fd.commands[2].index == 1);
+
+        // 父级剪裁就地修改命令（登记剪裁表项并改写索引），不影响顺序
+        RenderUtils::applyParentClip(fd, 1, 0, 0, QRectF(0, 0, 50, 50));
+        QCOMPARE(fd.roundedRects[0].clip, Render::kNoClip);
+        QCOMPARE(QRectF(fd.clip(fd.roundedRects[1].clip).rect), QRectF(0, 0, 50, 50));
+        QCOMPARE(QRectF(fd.clip(fd.images[0].clip).rect), QRectF(0, 0, 50, 50));
+        // 相同的剪裁共用一个表项
+        QCOMPARE(fd.images[0].clip, fd.roundedRects[1].clip);
+        QCOMPARE(fd.clips.size(), size_t(1));
+        QVERIFY(fd.hasOrderedStream());
+
+        // 投影同样进入命令流，并接受父级剪裁
+        fd.addShadow(Render::ShadowCmd{ .rect = QRectF(20, 20, 40, 40), .radiusPx = 6.0f, .blurPx = 9.0f, .color = QColor(0, 0, 0, 80) });
+        QVERIFY(fd.commands.back().type == Render::CmdType::Shadow && fd.commands.back().index == 0);
+        QVERIFY(fd.hasOrderedStream());
+        RenderUtils::applyParentClip(fd, 2, 1, 0, QRectF(0, 0, 30, 30));
+        QCOMPARE(QRectF(fd.clip(fd.shadows[0].clip).rect), QRectF(0, 0, 30, 30));
+        QCOMPARE(QRectF(fd.clip(fd.roundedRects[1].clip).rect), QRectF(0, 0, 50, 50));
+
+        // 圆角剪裁：交集与哪一方重合就沿用哪一方的圆角，否则退化为直角
+        QRectF clip;
+        float clipRadius = 0.0f;
+        RenderUtils::mergeClip(clip, clipRadius, QRectF(0, 0, 100, 60), 12.0f);
+        QCOMPARE(clip, QRectF(0, 0, 100, 60));
+        QCOMPARE(clipRadius, 12.0f);
+        RenderUtils::mergeClip(clip, clipRadius, QRectF(-10, -10, 200, 200), 0.0f);
+        QCOMPARE(clip, QRectF(0, 0, 100, 60));
+        QCOMPARE(clipRadius, 12.0f);
+        RenderUtils::mergeClip(clip, clipRadius, QRectF(0, 0, 100, 60), 4.0f);
+        QCOMPARE(clipRadius, 12.0f);
+        RenderUtils::mergeClip(clip, clipRadius, QRectF(50, 0, 100, 100), 8.0f);
+        QCOMPARE(clip, QRectF(50, 0, 50, 60));
+        QCOMPARE(clipRadius, 0.0f);
+        RenderUtils::applyParentClip(fd, 0, 0, 0, QRectF(0, 0, 20, 20), 6.0f);
+        QCOMPARE(fd.clip(fd.roundedRects[0].clip).radiusPx, 6.0f);
+        QCOMPARE(QRectF(fd.clip(fd.images[0].clip).rect), QRectF(0, 0, 20, 20));
+        QCOMPARE(fd.clip(fd.images[0].clip).radiusPx, 6.0f);
+
+        // 子组件整块落在父剪裁之外：交集为空时记为kEmptyClip，而不是退化成不剪裁
+        Render::FrameData outside;
+        outside.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(0, 0, 400, 300), .radiusPx = 0.0f, .color = QColor(255, 255, 255) });
+        outside.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(200, 200, 40, 40), .radiusPx = 4.0f, .color = QColor(255, 0, 0),
+            .clip = outside.addClip(QRectF(200, 200, 40, 40)) });
+        outside.addImage(Render::ImageCmd{ .dstRect = QRectF(210, 210, 16, 16), .textureId = 1, .srcRectPx = QRectF(0, 0, 16, 16) });
+        RenderUtils::applyParentClip(outside, 1, 0, 0, QRectF(0, 0, 100, 100));
+        QCOMPARE(outside.roundedRects[1].clip, Render::kEmptyClip);
+        QCOMPARE(outside.roundedRects[0].clip, Render::kNoClip);
+        QVERIFY(outside.clip(outside.roundedRects[1].clip).empty);
+        QCOMPARE(QRectF(outside.clip(outside.images[0].clip).rect), QRectF(0, 0, 100, 100));
+        // 再往上一层父剪裁、平移与拼接都保持全部剪掉
+        RenderUtils::applyParentClip(outside, 1, 0, 0, QRectF(0, 0, 400, 400));
+        outside.translate(QPointF(5, 5), 1, 0, 0);
+        Render::FrameData host;
+        host.addClip(QRectF(0, 0, 10, 10));
+        host.appendFrame(outside);
+        QCOMPARE(host.roundedRects[1].clip, Render::kEmptyClip);
+        // 剔除按剪裁剔除计数，commandBounds为空
+        CommandCuller emptyCuller;
+        emptyCuller.run(host, host.commands, QRectF(0, 0, 400, 300));
+        QVERIFY(emptyCuller.rectCulled(1));
+        QVERIFY(!emptyCuller.rectCulled(0));
+        QCOMPARE(emptyCuller.stats().clipped, 1);
+        QVERIFY(DamageTracker::commandBounds(host, host.commands[1]).isEmpty());
+
+        // 绕过addXxx直接写入的旧代码会被识别出来
+        fd.roundedRects.push_back(Render::RoundedRectCmd{ .rect = QRectF(0, 0, 1, 1), .radiusPx = 0.0f, .color = QColor(0, 0, 0) });
+        QVERIFY(!fd.hasOrderedStream());
+
+        fd.clear();
+        QVERIFY(fd.empty());
+        QVERIFY(fd.commands.empty());
+
+        qDebug() << "FrameData command stream tests PASSED ✅";
+    }
+
+    void runAtlasPackerTests()
+    {
+        qDebug() << "=== Testing AtlasPacker ===";
+
+        AtlasPacker packer(QSize(64, 64), 1);
+        const auto a = packer.allocate(QSize(16, 16));
+        const auto b = packer.allocate(QSize(16, 16));
+        const auto c = packer.allocate(QSize(16, 16));
+        QVERIFY(a && b && c);
+        // 同高度子图排在同一货架，互不重叠且保留padding
+        QCOMPARE(a->y(), b->y());
+        QVERIFY(!a->adjusted(-1, -1, 1, 1).intersects(*b));
+        QCOMPARE(packer.liveCount(), 3);
+        QCOMPARE(packer.fragmentation(), 0.0);
+        QVERIFY(packer.occupancy() > 0.0);
+
+        // 放不下的尺寸直接拒绝
+        QVERIFY(!packer.allocate(QSize(64, 8)));
+
+        // 释放中间子图形成空洞 -> 碎片率上升；释放货架末尾子图 -> 立即回收
+        packer.release(*b);
+        QVERIFY(packer.fragmentation() > 0.3);
+        packer.release(*c);
+        const auto d = packer.allocate(QSize(16, 16));
+        QVERIFY(d);
+        QCOMPARE(d->x(), c->x());
+
+        packer.reset();
+        QVERIFY(packer.empty());
+        QCOMPARE(packer.consumedArea(), qint64(0));
+
+        qDebug() << "AtlasPacker tests PASSED ✅";
+    }
+
+    void runDistanceFieldTests()
+    {
+        qDebug() << "=== Testing IconLoader distance field ===";
+
+        // 16x16蒙版，中间8x8为实心
+        QImage mask(16, 16, QImage::Format_RGBA8888);
+        mask.fill(Qt::transparent);
+        for (int y = 4; y < 12; ++y)
+            for (int x = 4; x < 12; ++x)
+                mask.setPixelColor(x, y, QColor(255, 255, 255, 255));
+
+        const QImage sdf = IconLoader::distanceFieldFromMask(mask, 4);
+        QCOMPARE(sdf.size(), mask.size());
+        QCOMPARE(sdf.format(), QImage::Format_RGBA8888);
+
+        // 内部饱和、远处外部为0、轮廓两侧跨过0.5
+        QVERIFY(sdf.pixelColor(8, 8).alpha() >= 250);
+        QCOMPARE(sdf.pixelColor(0, 0).alpha(), 0);
+        QVERIFY(sdf.pixelColor(4, 8).alpha() > 128);
+        QVERIFY(sdf.pixelColor(3, 8).alpha() < 128);
+        QCOMPARE(sdf.pixelColor(8, 8).red(), 255);
+
+        qDebug() << "IconLoader distance field tests PASSED ✅";
+    }
+
+    void runDamageTrackerTests()
+    {
+        qDebug() << "=== Testing DamageTracker ===";
+
+        const QRectF viewport(0, 0, 400, 300);
+        const auto makeFrame = [](const QColor& hover, const bool withHoverLayer) {
+            Render::FrameData fd;
+            fd.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(0, 0, 400, 40), .radiusPx = 0.0f, .color = QColor(30, 30, 30) });
+            fd.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(10, 60, 80, 30), .radiusPx = 4.0f, .color = hover });
+            if (withHoverLayer) {
+                fd.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(200, 60, 40, 20), .radiusPx = 4.0f, .color = QColor(0, 0, 0, 40) });
+            }
+            fd.addImage(Render::ImageCmd{ .dstRect = QRectF(300, 200, 16, 16), .textureId = 7, .srcRectPx = QRectF(0, 0, 16, 16),
+                .clip = fd.addClip(QRectF(300, 200, 8, 16)) });
+            return fd;
+        };
+
+        DamageTracker tracker;
+
+        // 首帧整帧重绘
+        auto rects = tracker.update(makeFrame(QColor(255, 255, 255), false), viewport);
+        QVERIFY(tracker.fullRepaint());
+        QCOMPARE(rects.size(), size_t(1));
+        QCOMPARE(rects[0], viewport);
+
+        // 无变化时不重绘
+        rects = tracker.update(makeFrame(QColor(255, 255, 255), false), viewport);
+        QVERIFY(!tracker.fullRepaint());
+        QVERIFY(rects.empty());
+
+        // 原位修改：只重绘该命令（外扩1像素抗锯齿余量）
+        rects = tracker.update(makeFrame(QColor(200, 200, 255), false), viewport);
+        QCOMPARE(rects.size(), size_t(1));
+        QCOMPARE(rects[0], QRectF(9, 59, 82, 32));
+
+        // 中间插入一条命令：其后的命令顺序不变，只重绘新命令
+        rects = tracker.update(makeFrame(QColor(200, 200, 255), true), viewport);
+        QCOMPARE(rects.size(), size_t(1));
+        QCOMPARE(rects[0], QRectF(199, 59, 42, 22));
+
+        // 删除同理
+        rects = tracker.update(makeFrame(QColor(200, 200, 255), false), viewport);
+        QCOMPARE(rects.size(), size_t(1));
+        QCOMPARE(rects[0], QRectF(199, 59, 42, 22));
+
+        // 剪裁限制影响范围
+        Render::FrameData clipped = makeFrame(QColor(200, 200, 255), false);
+        clipped.images[0].tint = QColor(255, 0, 0);
+        rects = tracker.update(clipped, viewport);
+        QCOMPARE(rects.size(), size_t(1));
+        QCOMPARE(rects[0], QRectF(299, 199, 10, 18));
+
+        // 视口变化或显式失效时整帧重绘
+        rects = tracker.update(clipped, QRectF(0, 0, 500, 300));
+        QVERIFY(tracker.fullRepaint());
+        tracker.invalidateAll();
+        rects = tracker.update(clipped, QRectF(0, 0, 500, 300));
+        QVERIFY(tracker.fullRepaint());
+
+        // 合并：相交矩形合并，数量超限时合并代价最小的一对
+        std::vector<QRectF> merged{ QRectF(0, 0, 10, 10), QRectF(5, 5, 10, 10), QRectF(100, 0, 10, 10),
+            QRectF(200, 0, 10, 10), QRectF(300, 0, 10, 10), QRectF(104, 20, 10, 10) };
+        DamageTracker::mergeRects(merged, 4);
+        QCOMPARE(merged.size(), size_t(4));
+        QVERIFY(merged[0] == QRectF(0, 0, 15, 15));
+        QVERIFY(std::find(merged.begin(), merged.end(), QRectF(100, 0, 14, 30)) != merged.end());
+
+        qDebug() << "DamageTracker tests PASSED ✅";
+    }
+
+    void runUiRetainedTests()
+    {
+        qDebug() << "=== Testing UiRetained ===";
+
+        // 计数append调用的子组件：一条背景 + 一条悬停层
+        class CountingChild : public IUiComponent {
+        public:
+            mutable int appendCount{ 0 };
+            bool hovered{ false };
+            int  animFrames{ 0 };
+
+            void updateLayout(const QSize&) override {}
+            void updateResourceContext(IconCache&, QOpenGLFunctions*, float) override {}
+            void append(Render::FrameData& fd) const override {
+                ++appendCount;
+                fd.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(0, 0, 100, 40), .radiusPx = 4.0f, .color = QColor(255, 255, 255) });
+                if (hovered) {
+                    fd.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(0, 0, 100, 40), .radiusPx = 4.0f, .color = QColor(0, 0, 0, 30) });
+                }
+            }
+            bool onMousePress(const QPoint&) override { return false; }
+            bool onMouseMove(const QPoint& pos) override {
+                const bool h = QRect(0, 0, 100, 40).contains(pos);
+                if (h == hovered) return false;
+                hovered = h;
+                return true;
+            }
+            bool onMouseRelease(const QPoint&) override { return false; }
+            bool tick() override { return animFrames > 0 && --animFrames > 0; }
+            QRect bounds() const override { return QRect(0, 0, 100, 40); }
+            void applyTheme(bool) override {}
+        };
+
+        auto owned = std::make_unique<CountingChild>();
+        CountingChild* child = owned.get();
+        UiRetained retained(std::move(owned));
+        retained.setViewportRect(QRect(0, 0, 100, 40));
+
+        // 首帧录制，之后的帧直接重放
+        Render::FrameData fd1;
+        retained.append(fd1);
+        Render::FrameData fd2;
+        retained.append(fd2);
+        QCOMPARE(child->appendCount, 1);
+        QCOMPARE(fd2.roundedRects.size(), size_t(1));
+        QVERIFY(fd2.hasOrderedStream());
+
+        // 未改变状态的移动不失效；悬停变化失效
+        QVERIFY(!retained.onMouseMove(QPoint(200, 200)));
+        Render::FrameData fd3;
+        retained.append(fd3);
+        QCOMPARE(child->appendCount, 1);
+        QVERIFY(retained.onMouseMove(QPoint(10, 10)));
+        Render::FrameData fd4;
+        retained.append(fd4);
+        QCOMPARE(child->appendCount, 2);
+        QCOMPARE(fd4.roundedRects.size(), size_t(2));
+
+        // 动画帧与其后一帧都重新录制，之后恢复重放
+        child->animFrames = 2;
+        QVERIFY(retained.tick());
+        QVERIFY(retained.isDirty());
+        retained.append(fd4);
+        QVERIFY(!retained.tick());
+        QVERIFY(retained.isDirty());
+        retained.append(fd4);
+        QVERIFY(!retained.tick());
+        QVERIFY(!retained.isDirty());
+
+        // 全局失效（子树重建、键盘输入等）
+        const int before = child->appendCount;
+        UiRetained::invalidateAll();
+        QVERIFY(retained.isDirty());
+        Render::FrameData fd5;
+        retained.append(fd5);
+        QCOMPARE(child->appendCount, before + 1);
+
+        // 上级剪裁作用于重放出的命令，不污染缓存
+        Render::FrameData fd6;
+        fd6.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(0, 0, 10, 10), .radiusPx = 0.0f, .color = QColor(0, 0, 0) });
+        retained.append(fd6);
+        RenderUtils::applyParentClip(fd6, 1, 0, 0, QRectF(0, 0, 50, 50));
+        QCOMPARE(fd6.roundedRects.size(), size_t(3));
+        QCOMPARE(QRectF(fd6.clip(fd6.roundedRects[1].clip).rect), QRectF(0, 0, 50, 50));
+        QVERIFY(fd6.hasOrderedStream());
+        Render::FrameData fd7;
+        retained.append(fd7);
+        QCOMPARE(fd7.roundedRects[0].clip, Render::kNoClip);
+
+        qDebug() << "UiRetained tests PASSED ✅";
+    }
+
+    void runUiLayerTests()
+    {
+        qDebug() << "=== Testing UiLayer ===";
+
+        class HoverChild : public IUiComponent {
+        public:
+            mutable int appendCount{ 0 };
+            bool hovered{ false };
+
+            void updateLayout(const QSize&) override {}
+            void updateResourceContext(IconCache&, QOpenGLFunctions*, float) override {}
+            void append(Render::FrameData& fd) const override {
+                ++appendCount;
+                fd.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(0, 0, 100, 40), .radiusPx = 4.0f, .color = QColor(255, 255, 255) });
+                if (hovered) {
+                    fd.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(0, 0, 100, 40), .radiusPx = 4.0f, .color = QColor(0, 0, 0, 30) });
+                }
+            }
+            bool onMousePress(const QPoint&) override { return false; }
+            bool onMouseMove(const QPoint& pos) override {
+                const bool h = QRect(0, 0, 100, 40).contains(pos);
+                if (h == hovered) return false;
+                hovered = h;
+                return true;
+            }
+            bool onMouseRelease(const QPoint&) override { return false; }
+            bool tick() override { return false; }
+            QRect bounds() const override { return QRect(0, 0, 100, 40); }
+            void applyTheme(bool) override {}
+        };
+
+        auto owned = std::make_unique<HoverChild>();
+        HoverChild* child = owned.get();
+        UiLayer layer(std::move(owned));
+        layer.setViewportRect(QRect(0, 0, 100, 40));
+
+        // 首帧录制内容：输出一条合成命令 + 一个图层定义，内容范围含抗锯齿外扩
+        Render::FrameData fd1;
+        layer.append(fd1);
+        QCOMPARE(child->appendCount, 1);
+        QCOMPARE(fd1.layers.size(), size_t(1));
+        QCOMPARE(fd1.images.size(), size_t(1));
+        QVERIFY(fd1.roundedRects.empty());
+        QVERIFY(fd1.hasOrderedStream());
+        QVERIFY(Render::isLayerTexture(fd1.images[0].textureId));
+        QVERIFY(fd1.findLayer(fd1.images[0].textureId) != nullptr);
+        QCOMPARE(fd1.layers[0].bounds, QRectF(-1, -1, 102, 42));
+        QCOMPARE(fd1.layers[0].content->roundedRects.size(), size_t(1));
+        QCOMPARE(QRectF(fd1.images[0].dstRect), QRectF(fd1.layers[0].bounds));
+
+        // 只改变不透明度与平移：不重新录制，版本与内容不变，合成命令随之变化
+        layer.setOpacity(0.5f);
+        layer.setOffset(QPointF(10, 0));
+        Render::FrameData fd2;
+        layer.append(fd2);
+        QCOMPARE(child->appendCount, 1);
+        QCOMPARE(fd2.layers[0].version, fd1.layers[0].version);
+        QVERIFY(fd2.layers[0].content == fd1.layers[0].content);
+        QCOMPARE(QRectF(fd2.images[0].dstRect), QRectF(9, -1, 102, 42));
+        QCOMPARE(fd2.images[0].tint.alpha(), 128);
+
+        // 鼠标事件按平移换算：窗口(12,5)对应子树(2,5)
+        QVERIFY(layer.onMouseMove(QPoint(12, 5)));
+        QVERIFY(child->hovered);
+        QVERIFY(layer.isDirty());
+
+        // 重新录制后版本递增；合成命令完全相同时，损坏跟踪仍按图层版本识别变化
+        DamageTracker tracker;
+        const QRectF viewport(0, 0, 400, 300);
+        (void)tracker.update(fd2, viewport);
+        Render::FrameData fd3;
+        layer.append(fd3);
+        QCOMPARE(child->appendCount, 2);
+        QCOMPARE(fd3.layers[0].version, fd2.layers[0].version + 1);
+        QCOMPARE(fd3.images[0].dstRect, fd2.images[0].dstRect);
+        QVERIFY(!tracker.update(fd3, viewport).empty());
+        Render::FrameData fd4;
+        layer.append(fd4);
+        QVERIFY(tracker.update(fd4, viewport).empty());
+
+        // 图层定义随切片一起追加，清空时一并清除
+        Render::FrameData parent;
+        parent.appendFrame(fd4);
+        QCOMPARE(parent.layers.size(), size_t(1));
+        parent.clear();
+        QVERIFY(parent.layers.empty());
+
+        // 完全透明时不输出合成命令
+        layer.setOpacity(0.0f);
+        Render::FrameData fd5;
+        layer.append(fd5);
+        QVERIFY(fd5.images.empty());
+
+        qDebug() << "UiLayer tests PASSED ✅";
+    }
+
+    void runCommandCullerTests()
+    {
+        qDebug() << "=== Testing CommandCuller ===";
+
+        const QRectF viewport(0, 0, 400, 300);
+        const QColor opaque(240, 240, 240);
+
+        Render::FrameData fd;
+        // 0：被整页背景遮挡
+        fd.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(10, 10, 50, 50), .radiusPx = 4.0f, .color = QColor(255, 0, 0) });
+        // 0：剪裁为空
+        fd.addImage(Render::ImageCmd{ .dstRect = QRectF(100, 100, 16, 16), .textureId = 1, .srcRectPx = QRectF(0, 0, 16, 16),
+            .clip = fd.addClip(QRectF(200, 200, 20, 20)) });
+        // 0：视口之外
+        fd.addShadow(Render::ShadowCmd{ .rect = QRectF(500, 10, 40, 40), .radiusPx = 4.0f, .blurPx = 8.0f, .color = QColor(0, 0, 0, 60) });
+        // 1：整页不透明背景（遮挡者）
+        fd.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(0, 0, 400, 300), .radiusPx = 0.0f, .color = opaque });
+        // 2：背景之后的内容
+        fd.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(20, 20, 60, 30), .radiusPx = 6.0f, .color = QColor(0, 120, 215) });
+
+        CommandCuller culler;
+        culler.run(fd, fd.commands, viewport);
+        QVERIFY(culler.rectCulled(0));
+        QVERIFY(culler.imageCulled(0));
+        QVERIFY(culler.shadowCulled(0));
+        QVERIFY(!culler.rectCulled(1));
+        QVERIFY(!culler.rectCulled(2));
+        QCOMPARE(culler.stats().clipped, 1);
+        QCOMPARE(culler.stats().offscreen, 1);
+        QCOMPARE(culler.stats().occluded, 1);
+        QCOMPARE(culler.stats().total(), 3);
+
+        // 半透明、圆角、圆角剪裁的矩形都不能遮挡
+        const Render::ClipRegion roundedClip{ QRectF(0, 0, 400, 300), 8.0f };
+        for (const auto& [cover, coverClip] : { std::pair{ Render::RoundedRectCmd{ .rect = QRectF(0, 0, 400, 300), .radiusPx = 0.0f, .color = QColor(240, 240, 240, 200) }, Render::kNoClipRegion },
+                 std::pair{ Render::RoundedRectCmd{ .rect = QRectF(0, 0, 400, 300), .radiusPx = 8.0f, .color = opaque }, Render::kNoClipRegion },
+                 std::pair{ Render::RoundedRectCmd{ .rect = QRectF(0, 0, 400, 300), .radiusPx = 0.0f, .color = opaque }, roundedClip } }) {
+            Render::FrameData f;
+            f.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(10, 10, 50, 50), .radiusPx = 4.0f, .color = QColor(255, 0, 0) });
+            Render::RoundedRectCmd clipped = cover;
+            clipped.clip = f.addClip(coverClip.rect, coverClip.radiusPx);
+            f.addRoundedRect(clipped);
+            culler.run(f, f.commands, viewport);
+            QVERIFY(!culler.rectCulled(0));
+            QCOMPARE(culler.stats().occluded, 0);
+        }
+
+        // 只部分覆盖（含抗锯齿边缘）不剔除；遮挡者只影响更早的命令
+        Render::FrameData partial;
+        partial.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(0, 0, 100, 100), .radiusPx = 0.0f, .color = QColor(255, 0, 0) });
+        partial.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(0, 0, 100, 100), .radiusPx = 0.0f, .color = opaque });
+        partial.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(10, 10, 20, 20), .radiusPx = 0.0f, .color = QColor(0, 0, 0) });
+        culler.run(partial, partial.commands, viewport);
+        QVERIFY(!culler.rectCulled(0));
+        QVERIFY(!culler.rectCulled(2));
+
+        // 关闭遮挡剔除时只保留剪裁与视口剔除
+        culler.setOcclusionEnabled(false);
+        culler.run(fd, fd.commands, viewport);
+        QVERIFY(!culler.rectCulled(0));
+        QVERIFY(culler.imageCulled(0));
+        QVERIFY(culler.shadowCulled(0));
+        QCOMPARE(culler.stats().occluded, 0);
+
+        culler.reset();
+        QVERIFY(!culler.imageCulled(0));
+        QCOMPARE(culler.stats().total(), 0);
+
+        qDebug() << "CommandCuller tests PASSED ✅";
+    }
+
+    void runFrameProfilerTests()
+    {
+        qDebug() << "=== Testing FrameProfiler ===";
+
+        constexpr qint64 kMs = 1000000;
+        FrameProfiler profiler;
+
+        // 未启用时不采样
+        profiler.beginFrame();
+        profiler.endFrame(1);
+        QCOMPARE(profiler.sampleCount(), 0);
+
+        // 第i帧录制耗时i ms（其中剪裁1ms），GPU耗时i/2 ms
+        profiler.setEnabled(true);
+        for (int i = 1; i <= 100; ++i) {
+            profiler.beginFrame();
+            profiler.addStageNs(FrameProfiler::Stage::Record, i * kMs);
+            profiler.addStageNs(FrameProfiler::Stage::Clip, kMs);
+            profiler.setGpuNs(i * kMs / 2);
+            profiler.endFrame(i % 10);
+        }
+        QCOMPARE(profiler.sampleCount(), 100);
+        // 剪裁从录制中扣除，CPU合计不重复计入
+        QCOMPARE(profiler.sample(0).stageNs[0], qint64(0));
+        QCOMPARE(profiler.sample(99).cpuNs, 100 * kMs);
+
+        const auto sum = profiler.summary();
+        QCOMPARE(sum.frames, 100);
+        QCOMPARE(sum.cpuP50Ms, 50.0);
+        QCOMPARE(sum.cpuP99Ms, 99.0);
+        QCOMPARE(sum.gpuP50Ms, 25.0);
+        QCOMPARE(sum.drawCallsMax, 9);
+        QCOMPARE(sum.stageAvgMs[1], 1.0);
+
+        const auto hist = profiler.histogram();
+        int total = 0;
+        for (const int c : hist) total += c;
+        QCOMPARE(total, 100);
+        QCOMPARE(hist[FrameProfiler::kHistogramBuckets - 1], 100 - 32);
+
+        // 滚动窗口只保留最近kHistory帧
+        for (int i = 0; i < FrameProfiler::kHistory; ++i) {
+            profiler.beginFrame();
+            profiler.addStageNs(FrameProfiler::Stage::Submit, 2 * kMs);
+            profiler.endFrame(3);
+        }
+        QCOMPARE(profiler.sampleCount(), FrameProfiler::kHistory);
+        QCOMPARE(profiler.summary().cpuP99Ms, 2.0);
+        QCOMPARE(profiler.summary().gpuP50Ms, 0.0);
+
+        // 作用域计时只计入活动实例
+        profiler.reset();
+        profiler.beginFrame();
+        {
+            const FrameProfiler::ScopedStage scope(FrameProfiler::Stage::Clip);
+        }
+        FrameProfiler::setActive(&profiler);
+        {
+            const FrameProfiler::ScopedStage scope(FrameProfiler::Stage::Clip);
+        }
+        FrameProfiler::setActive(nullptr);
+        profiler.endFrame(0);
+        QCOMPARE(profiler.sampleCount(), 1);
+        QVERIFY(profiler.sample(0).stageNs[1] >= 0);
+
+        std::vector<double> empty;
+        QCOMPARE(FrameProfiler::percentile(empty, 0.5), 0.0);
+
+        qDebug() << "FrameProfiler tests PASSED ✅";
+    }
+
+    void runFrameSchedulerTests()
+    {
+        qDebug() << "=== Testing FrameScheduler ===";
+
+        int requests = 0;
+        FrameScheduler scheduler([&requests] { ++requests; });
+        scheduler.setRefreshRate(144.0);
+        QVERIFY(qAbs(scheduler.frameIntervalMs() - 1000.0 / 144.0) < 1e-9);
+
+        // 一帧之前的多次请求合并为一次
+        scheduler.requestFrame();
+        scheduler.requestFrame();
+        scheduler.requestFrame();
+        QCOMPARE(requests, 1);
+        QCOMPARE(scheduler.stats().coalesced, qint64(2));
+
+        // 空闲后的首帧取当前时刻；帧内FrameClock固定为帧时间
+        double now = 1000.0;
+        QCOMPARE(scheduler.beginFrame(now), qint64(1000));
+        QVERIFY(FrameClock::inFrame());
+        QCOMPARE(FrameClock::nowMs(), qint64(1000));
+        scheduler.requestFrame();  // 帧内请求推迟到交换完成后
+        QCOMPARE(requests, 1);
+        scheduler.endFrame(false);
+        QVERIFY(!FrameClock::inFrame());
+        now += 2.0;
+        scheduler.frameSwapped(now);
+        QCOMPARE(requests, 2);
+
+        // 无动画、无请求：交换完成后不再请求
+        scheduler.beginFrame(now + 1.0);
+        scheduler.endFrame(false);
+        scheduler.frameSwapped(now + 3.0);
+        QCOMPARE(requests, 2);
+        QVERIFY(!scheduler.pending());
+
+        // 动画：每次交换完成后请求下一帧；帧时间落在上次交换之后的下一个刷新时刻
+        now = 2000.0;
+        scheduler.requestAnimation();
+        QCOMPARE(requests, 3);
+        double swap = now;
+        for (int i = 0; i < 60; ++i) {
+            const qint64 frameMs = scheduler.beginFrame(swap + 1.0);
+            if (i > 0) QCOMPARE(frameMs, qint64(std::llround(swap + scheduler.frameIntervalMs())));
+            scheduler.endFrame(true);
+            swap += 7.5;  // 实际刷新间隔与标称值略有出入
+            scheduler.frameSwapped(swap);
+        }
+        QCOMPARE(requests, 3 + 60);
+        QCOMPARE(scheduler.stats().animationFrames, qint64(59));
+        QVERIFY(qAbs(scheduler.frameIntervalMs() - 7.5) < 0.1);
+
+        // 掉帧造成的双倍间隔不计入估计
+        scheduler.beginFrame(swap + 1.0);
+        scheduler.endFrame(true);
+        swap += 15.0;
+        scheduler.frameSwapped(swap);
+        QVERIFY(qAbs(scheduler.frameIntervalMs() - 7.5) < 0.1);
+
+        // 动画结束后停止出帧
+        const int before = requests;
+        scheduler.beginFrame(swap + 1.0);
+        scheduler.endFrame(false);
+        scheduler.frameSwapped(swap + 7.5);
+        QCOMPARE(requests, before);
+        QVERIFY(!scheduler.animating());
+
+        // 帧外的时间不早于上一帧的帧时间
+        QVERIFY(FrameClock::nowMs() >= qint64(std::llround(swap)));
+
+        // 刷新率未知时退回默认值
+        scheduler.setRefreshRate(0.0);
+        QCOMPARE(scheduler.refreshRate(), FrameScheduler::kDefaultRefreshHz);
+
+        qDebug() << "FrameScheduler tests PASSED ✅";
+    }
+
+    void runFrameExchangeTests()
+    {
+        qDebug() << "=== Testing FrameExchange ===";
+
+        FrameExchange<int> ex;
+        QVERIFY(!ex.hasFresh());
+        QVERIFY(!ex.consume());
+
+        // 发布后消费者取得最新一帧
+        ex.back() = 1;
+        QVERIFY(!ex.publish());
+        QVERIFY(ex.hasFresh());
+        QVERIFY(ex.consume());
+        QCOMPARE(ex.front(), 1);
+
+        // 没有新帧时front保持不变
+        QVERIFY(!ex.consume());
+        QCOMPARE(ex.front(), 1);
+
+        // 生产者领先：未取走的帧被覆盖，只取到最新一帧
+        ex.back() = 2;
+        QVERIFY(!ex.publish());
+        ex.back() = 3;
+        QVERIFY(ex.publish());
+        QVERIFY(ex.consume());
+        QCOMPARE(ex.front(), 3);
+
+        // 写入槽与消费者持有的槽不重叠
+        ex.back() = 4;
+        QCOMPARE(ex.front(), 3);
+        ex.publish();
+        QVERIFY(ex.consume());
+        QCOMPARE(ex.front(), 4);
+
+        qDebug() << "FrameExchange tests PASSED ✅";
+    }
+
+    void runIconCacheDeferredGlTests()
+    {
+        qDebug() << "=== Testing IconCache deferred GL ===";
+
+        // 延迟GL模式：未命中时只分配句柄并排队纹理操作，纹理ID在flushGl后才有
+        IconCache icons;
+        useDeferredGl(icons);
+        const QByteArray svg = whiteSquareSvg();
+        const int handle = icons.ensureSvgPx(QStringLiteral("deferred|16"), svg, QSize(16, 16), nullptr);
+        QVERIFY(handle > 0);
+        QVERIFY(icons.hasPendingGl());
+        QCOMPARE(icons.resolve(handle).textureId, 0);
+        QCOMPARE(icons.textureSizePx(handle), QSize(16, 16));
+        QCOMPARE(icons.ensureSvgPx(QStringLiteral("deferred|16"), svg, QSize(16, 16), nullptr), handle);
+
+        // 以下需要真实的GL上下文执行排队的操作；平台不提供时跳过
+        QOpenGLContext context;
+        QOffscreenSurface surface;
+        surface.create();
+        if (!context.create() || !context.makeCurrent(&surface)) {
+            qDebug() << "No OpenGL context, skipping flushGl checks";
+            qDebug() << "IconCache deferred GL tests PASSED ✅";
+            return;
+        }
+        QOpenGLFunctions* gl = context.functions();
+
+        // 持锁拷贝的快照在flush之前同样解析不到纹理
+        IconSnapshot before;
+        before.capture(icons, handle);
+        QCOMPARE(before.resolve(handle).textureId, 0);
+
+        // flushGl按序执行全部排队操作，之后句柄才解析到纹理
+        icons.flushGl(gl);
+        QVERIFY(!icons.hasPendingGl());
+        const IconCache::Region region = icons.resolve(handle);
+        QVERIFY(region.textureId != 0);
+        QVERIFY(gl->glIsTexture(static_cast<GLuint>(region.textureId)));
+        IconSnapshot after;
+        after.capture(icons, handle);
+        QCOMPARE(after.resolve(handle).textureId, region.textureId);
+
+        // 同一批次内销毁并重建同一页槽位（独占页的大图释放后立即生成另一张）：先销毁旧纹理再创建，新句柄可用
+        const QByteArray bigSvg = QByteArrayLiteral("<svg xmlns='http://www.w3.org/2000/svg' width='600' height='600'>"
+            "<rect width='600' height='600' fill='#fff'/></svg>");
+        const int big = icons.ensureSvgPx(QStringLiteral("deferred|big|a"), bigSvg, QSize(600, 600), nullptr);
+        QVERIFY(big > 0);
+        const int pagesBefore = icons.atlasStats().pageCount;
+        icons.release(QStringLiteral("deferred|big|a"), nullptr);
+        const int big2 = icons.ensureSvgPx(QStringLiteral("deferred|big|b"), bigSvg, QSize(600, 600), nullptr);
+        QVERIFY(big2 > 0 && big2 != big);
+        QCOMPARE(icons.atlasStats().pageCount, pagesBefore);
+        QVERIFY(icons.hasPendingGl());
+        QCOMPARE(icons.resolve(big2).textureId, 0);
+        icons.flushGl(gl);
+        QVERIFY(!icons.hasPendingGl());
+        const int bigTexture = icons.resolve(big2).textureId;
+        QVERIFY(bigTexture != 0);
+        QVERIFY(gl->glIsTexture(static_cast<GLuint>(bigTexture)));
+        QCOMPARE(icons.resolve(big).textureId, 0);
+        QCOMPARE(icons.resolve(handle).textureId, region.textureId);
+
+        icons.releaseAll(nullptr);
+        icons.flushGl(gl);
+        QVERIFY(!icons.hasPendingGl());
+        context.doneCurrent();
+
+        qDebug() << "IconCache deferred GL tests PASSED ✅";
+    }
+
+    void runFrameArenaTests()
+    {
+        qDebug() << "=== Testing FrameData arena ===";
+
+        // 紧凑布局：float矩形 + RGBA8颜色 + 剪裁索引；对照旧布局（QRectF + QColor + 内联剪裁矩形）
+        struct LegacyRoundedRectCmd { QRectF rect; float radiusPx; QColor color; QRectF clipRect; float clipRadiusPx; float strokeWidthPx; QColor strokeColor; };
+        struct LegacyImageCmd { QRectF dstRect; int textureId; QRectF srcRectPx; QColor tint; QRectF clipRect; float clipRadiusPx; };
+        struct LegacyShadowCmd { QRectF rect; float radiusPx; float blurPx; QColor color; QRectF clipRect; float clipRadiusPx; };
+        QVERIFY(std::is_trivially_copyable_v<Render::RoundedRectCmd>);
+        QVERIFY(std::is_trivially_copyable_v<Render::ImageCmd>);
+        QVERIFY(std::is_trivially_copyable_v<Render::ShadowCmd>);
+        QVERIFY(sizeof(Render::RoundedRectCmd) <= 40);
+        QVERIFY(sizeof(Render::ImageCmd) <= 48);
+        QVERIFY(sizeof(Render::ShadowCmd) <= 32);
+        QVERIFY(sizeof(Render::RoundedRectCmd) * 2 < sizeof(LegacyRoundedRectCmd));
+        QVERIFY(sizeof(Render::ImageCmd) * 2 < sizeof(LegacyImageCmd));
+        QVERIFY(sizeof(Render::ShadowCmd) * 2 < sizeof(LegacyShadowCmd));
+
+        // 与QColor往返不丢失8位分量
+        const Render::Rgba8 c = QColor(12, 34, 56, 78);
+        QCOMPARE(QColor(c), QColor(12, 34, 56, 78));
+
+        // 典型一帧：背景 + 逐行卡片（投影、底板、带圆角剪裁的图标）经父级剪裁，再拼接缓存子树并平移
+        Render::FrameData cached;
+        cached.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(460, 20, 300, 200), .radiusPx = 8.0f, .color = QColor(250, 250, 250),
+            .clip = cached.addClip(QRectF(460, 20, 300, 120)) });
+        cached.addImage(Render::ImageCmd{ .dstRect = QRectF(470, 30, 16, 16), .textureId = 9, .srcRectPx = QRectF(0, 0, 32, 32),
+            .clip = cached.addClip(QRectF(460, 20, 300, 120)) });
+        QCOMPARE(cached.clips.size(), size_t(1));
+
+        Render::FrameData frame;
+        DamageTracker tracker;
+        const QRectF viewport(0, 0, 800, 600);
+        const auto record = [&](const int n) {
+            frame.clear();
+            frame.addRoundedRect(Render::RoundedRectCmd{ .rect = viewport, .radiusPx = 0.0f, .color = QColor(240, 240, 240) });
+            for (int row = 0; row < 24; ++row) {
+                const int rr0 = static_cast<int>(frame.roundedRects.size());
+                const int im0 = static_cast<int>(frame.images.size());
+                const int sh0 = static_cast<int>(frame.shadows.size());
+                const QRectF card(20, 20 + row * 24, 400, 20);
+                frame.addShadow(Render::ShadowCmd{ .rect = card, .radiusPx = 6.0f, .blurPx = 8.0f, .color = QColor(0, 0, 0, 40) });
+                frame.addRoundedRect(Render::RoundedRectCmd{ .rect = card, .radiusPx = 6.0f,
+                    .color = row == n % 24 ? QColor(0, 120, 215) : QColor(255, 255, 255) });
+                frame.addImage(Render::ImageCmd{ .dstRect = QRectF(card.left() + 8, card.top() + 2, 16, 16), .textureId = 1 + row % 4,
+                    .srcRectPx = QRectF(0, 0, 32, 32), .clip = frame.addClip(card, 6.0f) });
+                RenderUtils::applyParentClip(frame, rr0, im0, sh0, QRectF(0, 0, 440, 600), 8.0f);
+            }
+            const size_t rr0 = frame.roundedRects.size();
+            const size_t im0 = frame.images.size();
+            const size_t sh0 = frame.shadows.size();
+            frame.appendFrame(cached);
+            frame.translate(QPointF(0, n % 2), rr0, im0, sh0);
+            tracker.update(frame, viewport);
+        };
+
+        // 预热：各数组（含DamageTracker保存的上一帧）增长到稳态容量
+        for (int n = 0; n < 8; ++n) record(n);
+        QVERIFY(frame.hasOrderedStream());
+        QCOMPARE(QRectF(frame.clip(frame.images.back().clip).rect), QRectF(460, 20 + 7 % 2, 300, 120));
+
+        // 稳态：逐帧clear后重新录制不再分配堆内存
+        const qint64 before = g_heapAllocs.load(std::memory_order_relaxed);
+        for (int n = 8; n < 108; ++n) record(n);
+        QCOMPARE(g_heapAllocs.load(std::memory_order_relaxed) - before, qint64(0));
+
+        // 对照：每帧新建的FrameData各数组从零增长
+        const qint64 fresh = g_heapAllocs.load(std::memory_order_relaxed);
+        {
+            Render::FrameData local;
+            local.appendFrame(frame);
+        }
+        QVERIFY(g_heapAllocs.load(std::memory_order_relaxed) - fresh > 0);
+
+        qDebug() << "FrameData arena tests PASSED ✅";
+    }
+
+    void runIconCacheAsyncTests()
+    {
+        qDebug() << "=== Testing IconCache async rasterization ===";
+
+        // 延迟GL模式下无需上下文：放入图集后的纹理操作只排队
+        std::atomic<int> ready{ 0 };
+        IconCache icons;
+        useDeferredGl(icons);
+        icons.setRasterReadyCallback([&ready] { ready.fetch_add(1); });
+        icons.setAsyncRaster(true);
+
+        const QByteArray svg = whiteSquareSvg();
+        const int a = icons.ensureSvgPx(QStringLiteral("async|16"), svg, QSize(16, 16), nullptr);
+        const int b = icons.ensureSvgPx(QStringLiteral("async|24"), svg, QSize(24, 24), nullptr);
+        const int dropped = icons.ensureSvgPx(QStringLiteral("async|32"), svg, QSize(32, 32), nullptr);
+        QVERIFY(a > 0 && b > 0 && dropped > 0);
+
+        // 完成前：句柄已分配、尺寸已知、不绘制，也不占图集
+        QCOMPARE(icons.ensureSvgPx(QStringLiteral("async|16"), svg, QSize(16, 16), nullptr), a);
+        QCOMPARE(icons.textureSizePx(b), QSize(24, 24));
+        QCOMPARE(icons.resolve(b).textureId, 0);
+        QCOMPARE(icons.atlasStats().pendingCount, 3);
+        QCOMPARE(icons.atlasStats().pageCount, 0);
+        icons.release(QStringLiteral("async|32"), nullptr);
+
+        // 关闭异步模式时等待任务完成；结果在上传前不进入图集
+        icons.setAsyncRaster(false);
+        QCOMPARE(ready.load(), 3);
+        QVERIFY(!icons.hasPendingGl());
+
+        // 预算不足一张时每次仍上传一张；等待期间释放的结果被丢弃
+        const auto first = icons.uploadCompleted(nullptr, 1);
+        QCOMPARE(first.uploaded, 1);
+        QVERIFY(first.remaining >= 1);
+        const auto rest = icons.uploadCompleted(nullptr, 1 << 20);
+        QCOMPARE(first.uploaded + rest.uploaded, 2);
+        QCOMPARE(rest.remaining, 0);
+        QCOMPARE(icons.atlasStats().pendingCount, 0);
+        QCOMPARE(icons.atlasStats().entryCount, 2);
+        QCOMPARE(icons.textureSizePx(a), QSize(16, 16));
+        QVERIFY(icons.hasPendingGl());
+
+        // 结果为空图像：标记为失败，不再计为等待中，重复请求返回同一个不绘制的句柄
+        icons.setAsyncRaster(true);
+        const int empty = icons.ensureSvgPx(QStringLiteral("async|empty"), svg, QSize(0, 0), nullptr);
+        QVERIFY(empty > 0);
+        QCOMPARE(icons.atlasStats().pendingCount, 1);
+        icons.setAsyncRaster(false);
+        QCOMPARE(icons.uploadCompleted(nullptr, 1 << 20).uploaded, 0);
+        QCOMPARE(icons.atlasStats().pendingCount, 0);
+        QCOMPARE(icons.atlasStats().failedCount, 1);
+        QCOMPARE(icons.resolve(empty).textureId, 0);
+        QCOMPARE(icons.ensureSvgPx(QStringLiteral("async|empty"), svg, QSize(0, 0), nullptr), empty);
+
+        qDebug() << "IconCache async rasterization tests PASSED ✅";
+    }
+
+    void runIconCacheRepackTests()
+    {
+        qDebug() << "=== Testing IconCache repack ===";
+
+        // 三张白膜放入同一共享页；放入顺序为a、b、big，a占据空页的第一个位置
+        IconCache icons;
+        useDeferredGl(icons);
+        const QByteArray svg = whiteSquareSvg();
+        const int a = icons.ensureSvgPx(QStringLiteral("repack|16"), svg, QSize(16, 16), nullptr);
+        const int b = icons.ensureSvgPx(QStringLiteral("repack|24"), svg, QSize(24, 24), nullptr);
+        const int big = icons.ensureSvgPx(QStringLiteral("repack|300"), svg, QSize(300, 300), nullptr);
+        QVERIFY(a > 0 && b > 0 && big > 0);
+        QCOMPARE(icons.atlasStats().pageCount, 1);
+        const QPoint firstSlot = icons.resolve(a).originPx;
+        const QSize defaultPage = icons.resolve(a).pageSizePx;
+        QCOMPARE(defaultPage, QSize(icons.pageSizePx(), icons.pageSizePx()));
+        const qint64 bytesBefore = icons.cacheStats().bytes;
+
+        // 重排按高度降序放入新页（旧页随后释放）：位置重映射，字节数与页数不变，句柄与尺寸不变
+        icons.compact(nullptr);
+        QCOMPARE(icons.atlasStats().repackCount, 1);
+        QCOMPARE(icons.atlasStats().pageCount, 1);
+        QCOMPARE(icons.atlasStats().entryCount, 3);
+        QCOMPARE(icons.cacheStats().bytes, bytesBefore);
+        QCOMPARE(icons.resolve(big).originPx, firstSlot);
+        QVERIFY(icons.resolve(a).originPx != firstSlot);
+        QCOMPARE(icons.textureSizePx(a), QSize(16, 16));
+        QVERIFY(icons.hasPendingGl());
+
+        // 页尺寸调小后重排：能放下的搬入新尺寸的页，放不下的标记为失败，不再计入图集字节
+        icons.setPageSizePx(256);
+        icons.compact(nullptr);
+        QCOMPARE(icons.atlasStats().repackCount, 2);
+        QCOMPARE(icons.atlasStats().failedCount, 1);
+        QCOMPARE(icons.atlasStats().pageCount, 1);
+        QCOMPARE(icons.atlasStats().entryCount, 3);
+        QCOMPARE(icons.cacheStats().bytes, bytesBefore - 300 * 300);
+        QCOMPARE(icons.resolve(big).textureId, 0);
+        QVERIFY(icons.resolve(big).pageSizePx.isEmpty());
+        QCOMPARE(icons.resolve(b).originPx, firstSlot);
+        QCOMPARE(icons.resolve(a).pageSizePx, QSize(256, 256));
+        QCOMPARE(icons.resolve(b).pageSizePx, QSize(256, 256));
+        QVERIFY(!QRect(icons.resolve(a).originPx, QSize(16, 16)).intersects(QRect(icons.resolve(b).originPx, QSize(24, 24))));
+
+        // 失败项不再参与之后的重排
+        icons.compact(nullptr);
+        QCOMPARE(icons.atlasStats().failedCount, 1);
+        QCOMPARE(icons.atlasStats().pageCount, 1);
+        QCOMPARE(icons.cacheStats().bytes, bytesBefore - 300 * 300);
+        QCOMPARE(icons.resolve(a).pageSizePx, QSize(256, 256));
+
+        qDebug() << "IconCache repack tests PASSED ✅";
+    }
+
+    void runIconCacheBudgetTests()
+    {
+        qDebug() << "=== Testing IconCache byte budget and LRU eviction ===";
+
+        // 16×16白膜子图在R8页中各占256字节
+        IconCache icons;
+        useDeferredGl(icons);
+        icons.setByteBudget(512);
+        const QByteArray svg = whiteSquareSvg();
+        const QSize px(16, 16);
+
+        icons.beginFrame();
+        const int a = icons.ensureSvgPx(QStringLiteral("lru|a"), svg, px, nullptr);
+        icons.beginFrame();
+        const int b = icons.ensureSvgPx(QStringLiteral("lru|b"), svg, px, nullptr);
+        icons.beginFrame();
+        const int c = icons.ensureSvgPx(QStringLiteral("lru|c"), svg, px, nullptr);
+        QVERIFY(a > 0 && b > 0 && c > 0);
+        QCOMPARE(icons.ensureSvgPx(QStringLiteral("lru|a"), svg, px, nullptr), a);
+
+        // 最久未用的b被淘汰；a与c在本帧或上一帧用过，受保护
+        icons.beginFrame();
+        icons.markUsed(c);
+        QCOMPARE(icons.cacheStats().bytes, qint64(768));
+        QCOMPARE(icons.evictToBudget(nullptr), 1);
+        QVERIFY(icons.keyOf(b).isEmpty());
+        QCOMPARE(icons.keyOf(a), QStringLiteral("lru|a"));
+        const auto stats = icons.cacheStats();
+        QCOMPARE(stats.hits, qint64(1));
+        QCOMPARE(stats.misses, qint64(3));
+        QCOMPARE(stats.evictions, qint64(1));
+        QCOMPARE(stats.bytes, qint64(512));
+
+        // 预算再小也不淘汰受保护的句柄；保护期过后才淘汰
+        icons.setByteBudget(1);
+        QCOMPARE(icons.evictToBudget(nullptr), 0);
+        icons.beginFrame();
+        icons.beginFrame();
+        icons.markUsed(c);
+        QCOMPARE(icons.evictToBudget(nullptr), 1);
+        QVERIFY(icons.keyOf(a).isEmpty());
+        QCOMPARE(icons.keyOf(c), QStringLiteral("lru|c"));
+
+        // 被淘汰的键再次ensure时重新生成
+        const int again = icons.ensureSvgPx(QStringLiteral("lru|b"), svg, px, nullptr);
+        QVERIFY(again > 0);
+        QCOMPARE(icons.keyOf(again), QStringLiteral("lru|b"));
+
+        // 距离场模式：别名先于其引用的距离场被淘汰，不留悬空别名
+        IconCache sdf;
+        useDeferredGl(sdf, IconCache::RasterMode::Sdf);
+        sdf.setByteBudget(1);
+        sdf.beginFrame();
+        QVERIFY(sdf.ensureSvgPx(QStringLiteral("lru|sdf"), svg, px, nullptr) > 0);
+        QCOMPARE(sdf.atlasStats().aliasCount, 1);
+        sdf.beginFrame();
+        sdf.beginFrame();
+        QCOMPARE(sdf.evictToBudget(nullptr), 2);
+        QCOMPARE(sdf.atlasStats().aliasCount, 0);
+        QCOMPARE(sdf.atlasStats().entryCount, 0);
+        QCOMPARE(sdf.cacheStats().bytes, qint64(0));
+
+        // 别名只被查找（未标记绘制）也连带记录距离场：超出预算时距离场不会先于别名被淘汰
+        sdf.beginFrame();
+        const int alias = sdf.ensureSvgPx(QStringLiteral("lru|alias"), svg, px, nullptr);
+        for (int f = 0; f < 4; ++f) {
+            sdf.beginFrame();
+            QCOMPARE(sdf.ensureSvgPx(QStringLiteral("lru|alias"), svg, px, nullptr), alias);
+            sdf.evictToBudget(nullptr);
+        }
+        QCOMPARE(sdf.atlasStats().aliasCount, 1);
+        QCOMPARE(sdf.atlasStats().entryCount, 1);
+        QCOMPARE(sdf.textureSizePx(alias), px);
+
+        // 文本只被查找时同样连带记录字形：反复挤出预算后字形仍在
+        IconCache text;
+        useDeferredGl(text);
+        QFont font;
+        font.setPixelSize(14);
+        text.beginFrame();
+        const int run = text.ensureTextPx(QStringLiteral("lru|text"), font, QStringLiteral("Budget"), QColor(Qt::black), nullptr);
+        QVERIFY(run > 0);
+        if (const IconCache::TextRun* tr = text.textRun(run); tr && !tr->glyphs.empty()) {
+            text.setByteBudget(1);
+            for (int f = 0; f < 4; ++f) {
+                text.beginFrame();
+                QCOMPARE(text.ensureTextPx(QStringLiteral("lru|text"), font, QStringLiteral("Budget"), QColor(Qt::black), nullptr), run);
+                QVERIFY(text.ensureSvgPx(QStringLiteral("lru|fill%1").arg(f), svg, px, nullptr) > 0);
+                text.evictToBudget(nullptr);
+            }
+            QVERIFY(text.cacheStats().evictions > 0);
+            for (const auto& g : text.textRun(run)->glyphs) {
+                QVERIFY(!text.keyOf(g.glyphId).isEmpty());
+                QVERIFY(text.textureSizePx(g.glyphId).isValid());
+            }
+
+            // 字形被单独释放时，引用它的文本一并移除（之后的命中不会返回缺字的文本）
+            text.release(text.keyOf(text.textRun(run)->glyphs.front().glyphId), nullptr);
+            QVERIFY(text.textRun(run) == nullptr);
+            QVERIFY(text.keyOf(run).isEmpty());
+        }
+        else {
+            qDebug() << "No rasterizable font available, text run eviction checks skipped";
+        }
+
+        qDebug() << "IconCache byte budget tests PASSED ✅";
+    }
+
+    void runIconCacheMaskFormatTests()
+    {
+        qDebug() << "=== Testing IconCache single-channel mask pages ===";
+
+        // alpha通道原样提取为Alpha8
+        QImage rgba(3, 2, QImage::Format_RGBA8888);
+        rgba.fill(QColor(255, 255, 255, 0));
+        rgba.setPixelColor(1, 0, QColor(255, 255, 255, 128));
+        rgba.setPixelColor(2, 1, QColor(10, 20, 30, 255));
+        const QImage mask = IconLoader::toAlphaMask(rgba);
+        QCOMPARE(mask.format(), QImage::Format_Alpha8);
+        QCOMPARE(mask.size(), QSize(3, 2));
+        QCOMPARE(int(mask.constScanLine(0)[0]), 0);
+        QCOMPARE(int(mask.constScanLine(0)[1]), 128);
+        QCOMPARE(int(mask.constScanLine(1)[2]), 255);
+
+        // 白膜图标放入R8页：整页显存为RGBA8页的1/4
+        IconCache icons;
+        useDeferredGl(icons);
+        const QByteArray svg = whiteSquareSvg();
+        const int icon = icons.ensureSvgPx(QStringLiteral("mask|16"), svg, QSize(16, 16), nullptr);
+        QVERIFY(icon > 0);
+        QCOMPARE(icons.atlasStats().pageCount, 1);
+        QCOMPARE(icons.atlasStats().maskPageCount, 1);
+        QCOMPARE(icons.atlasStats().textureBytes, qint64(1024) * 1024);
+        QCOMPARE(icons.cacheStats().bytes, qint64(256));
+        QVERIFY(icons.resolve(icon).mask);
+        QVERIFY(!icons.resolve(icon).sdf);
+
+        // 距离场同为单通道，但与蒙版分页
+        IconCache sdf;
+        useDeferredGl(sdf, IconCache::RasterMode::Sdf);
+        const int field = sdf.ensureSvgPx(QStringLiteral("mask|sdf"), svg, QSize(16, 16), nullptr);
+        QVERIFY(field > 0);
+        QVERIFY(sdf.resolve(field).mask);
+        QVERIFY(sdf.resolve(field).sdf);
+        QCOMPARE(sdf.atlasStats().maskPageCount, 1);
+
+        qDebug() << "IconCache mask page tests PASSED ✅";
+    }
+
+    void runRasterCacheTests()
+    {
+        qDebug() << "=== Testing RasterCache ===";
+
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        RasterCache disk(dir.path());
+        disk.setEnabled(true);
+        const QByteArray svg = "<svg xmlns='http://www.w3.org/2000/svg' width='16' height='16'>"
+            "<circle cx='8' cy='8' r='6' fill='#fff'/></svg>";
+        const QByteArray hash = RasterCache::contentHash(svg);
+        const QSize px(16, 16);
+
+        // 冷缓存：IconCache栅格化后写入磁盘
+        {
+            IconCache icons;
+            useDeferredGl(icons);
+            icons.setRasterCache(&disk);
+            QVERIFY(icons.ensureSvgPx(QStringLiteral("disk|16"), svg, px, nullptr) > 0);
+        }
+        QCOMPARE(disk.stats().misses, 1);
+        QCOMPARE(disk.stats().writes, 1);
+        QVERIFY(QFile::exists(QDir(dir.path()).filePath(RasterCache::fileName(hash, px, RasterCache::Variant::Mask))));
+
+        // 热缓存：新的IconCache直接载入，像素与栅格化结果一致
+        {
+            IconCache icons;
+            useDeferredGl(icons);
+            icons.setRasterCache(&disk);
+            QVERIFY(icons.ensureSvgPx(QStringLiteral("disk|16"), svg, px, nullptr) > 0);
+            QCOMPARE(icons.textureSizePx(icons.ensureSvgPx(QStringLiteral("disk|16"), svg, px, nullptr)), px);
+        }
+        QCOMPARE(disk.stats().hits, 1);
+        QCOMPARE(disk.stats().writes, 1);
+        {
+            // 映射的图像在作用域结束时解除映射（之后要改写该文件）
+            const QImage loaded = disk.load(hash, px, RasterCache::Variant::Mask);
+            QCOMPARE(loaded.format(), QImage::Format_Alpha8);
+            QVERIFY(loaded == IconLoader::toAlphaMask(IconLoader::renderSvgToImage(svg, px)));
+        }
+
+        // 内容、尺寸或变体不同都不命中
+        QVERIFY(disk.load(RasterCache::contentHash(svg + " "), px, RasterCache::Variant::Mask).isNull());
+        QVERIFY(disk.load(hash, QSize(24, 24), RasterCache::Variant::Mask).isNull());
+        QVERIFY(disk.load(hash, px, RasterCache::Variant::Sdf).isNull());
+
+        // 截断的文件校验失败，重新写入后恢复命中
+        const QString path = QDir(dir.path()).filePath(RasterCache::fileName(hash, px, RasterCache::Variant::Mask));
+        {
+            QFile f(path);
+            QVERIFY(f.open(QIODevice::ReadWrite));
+            QVERIFY(f.resize(f.size() - 4));
+        }
+        const int rejected = disk.stats().rejected;
+        QVERIFY(disk.load(hash, px, RasterCache::Variant::Mask).isNull());
+        QCOMPARE(disk.stats().rejected, rejected + 1);
+        disk.store(hash, px, RasterCache::Variant::Mask, IconLoader::renderSvgToImage(svg, px));
+        QCOMPARE(disk.load(hash, px, RasterCache::Variant::Mask).format(), QImage::Format_RGBA8888);
+
+        // 停用时不读不写
+        disk.setEnabled(false);
+        QVERIFY(disk.load(hash, px, RasterCache::Variant::Mask).isNull());
+
+        qDebug() << "RasterCache tests PASSED ✅";
+    }
+
+    void runFrameCaptureTests()
+    {
+        qDebug() << "=== Testing FrameCapture ===";
+
+        Render::FrameData fd;
+        fd.addShadow(Render::ShadowCmd{ .rect = QRectF(10, 10, 80, 40), .radiusPx = 6.0f, .blurPx = 12.0f,
+            .color = QColor(0, 0, 0, 60) });
+        fd.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(10, 10, 80, 40), .radiusPx = 6.0f,
+            .color = QColor(200, 100, 50), .clip = fd.addClip(QRectF(0, 0, 50, 50), 4.0f) });
+        fd.addImage(Render::ImageCmd{ .dstRect = QRectF(20, 20, 16, 16), .textureId = 7,
+            .srcRectPx = QRectF(0, 0, 32, 32), .tint = QColor(10, 20, 30, 40) });
+        fd.addRoundedRect(Render::RoundedRectCmd{ .rect = QRectF(0, 60, 100, 20), .radiusPx = 0.0f,
+            .color = QColor(255, 255, 255), .strokeWidthPx = 1.5f, .strokeColor = QColor(0, 0, 0, 90) });
+
+        // 捕获 -> 编码 -> 解码：命令流与字段保持不变
+        IconCache icons;
+        const auto cap = FrameCapture::capture(fd, icons, 2.0f, QSize(640, 480));
+        QCOMPARE(cap.textures.size(), size_t(1));
+        QCOMPARE(cap.textures[0].handle, 7);
+
+        const QByteArray data = cap.encode();
+        FrameCapture back;
+        QString error;
+        QVERIFY(FrameCapture::decode(data, back, &error));
+        QCOMPARE(back.devicePixelRatio, 2.0f);
+        QCOMPARE(back.viewportSize, QSize(640, 480));
+        QCOMPARE(back.frame.commands.size(), fd.commands.size());
+        for (size_t i = 0; i < fd.commands.size(); ++i) {
+            QCOMPARE(back.frame.commands[i].type, fd.commands[i].type);
+            QCOMPARE(back.frame.commands[i].index, fd.commands[i].index);
+        }
+        QCOMPARE(QRectF(back.frame.clip(back.frame.roundedRects[0].clip).rect), QRectF(0, 0, 50, 50));
+        QCOMPARE(back.frame.clip(back.frame.roundedRects[0].clip).radiusPx, 4.0f);
+        QCOMPARE(back.frame.roundedRects[1].strokeWidthPx, 1.5f);
+        QCOMPARE(QColor(back.frame.roundedRects[1].strokeColor), QColor(0, 0, 0, 90));
+        QCOMPARE(back.frame.shadows[0].blurPx, 12.0f);
+        QCOMPARE(back.frame.images[0].textureId, 7);
+        QCOMPARE(QColor(back.frame.images[0].tint), QColor(10, 20, 30, 40));
+
+        // 损坏或版本不符的数据被拒绝
+        QVERIFY(!FrameCapture::decode(data.left(data.size() / 2), back, &error));
+        QVERIFY(!FrameCapture::decode(QByteArray("not a capture"), back, &error));
+        QByteArray future = data;
+        future[4] = char(FrameCapture::kVersion + 1);
+        QVERIFY(!FrameCapture::decode(future, back, &error));
+        QVERIFY(error.contains("version"));
+
+        // 区间截取保持顺序
+        const auto part = FrameCapture::slice(fd, 1, 3);
+        QCOMPARE(part.commands.size(), size_t(2));
+        QCOMPARE(part.commands[0].type, Render::CmdType::RoundedRect);
+        QCOMPARE(part.commands[1].type, Render::CmdType::Image);
+        QVERIFY(part.hasOrderedStream());
+        QVERIFY(FrameCapture::slice(fd, 5, 9).empty());
+
+        qDebug() << "FrameCapture tests PASSED ✅";
+    }
+
+    void runShaderCacheKeyTests()
+    {
+        qDebug() << "=== Testing ShaderCache keys ===";
+
+        const QByteArray driver = "Mesa|llvmpipe|4.5 (Core Profile) Mesa 24.0";
+        const QByteArray vs = "#version 330 core\nvoid main(){}";
+        const QByteArray fs = "#version 330 core\nout vec4 c; void main(){ c = vec4(1.0); }";
+
+        const QByteArray key = ShaderCache::cacheKey(driver, vs, fs);
+        QCOMPARE(key, ShaderCache::cacheKey(driver, vs, fs));
+        QCOMPARE(key.size(), 40);
+
+        // 源码、驱动任一变化都会换键（旧缓存失效）
+        QVERIFY(key != ShaderCache::cacheKey(driver, vs + " ", fs));
+        QVERIFY(key != ShaderCache::cacheKey(driver, vs, fs + "\n"));
+        QVERIFY(key != ShaderCache::cacheKey("Mesa|llvmpipe|4.5 (Core Profile) Mesa 24.1", vs, fs));
+        // 源码拼接边界不同也不碰撞
+        QVERIFY(ShaderCache::cacheKey(driver, "ab", "c") != ShaderCache::cacheKey(driver, "a", "bc"));
+
+        qDebug() << "ShaderCache key tests PASSED ✅";
+    }
     
     void runDependencyInjectionTests()
     {
@@ -958,11 +2277,11 @@ public slots:
 
 int main(int argc, char *argv[])
 {
-    QCoreApplication app(argc, argv);
-    
-    // Set test environment
+    // Set test environment（须在创建应用前设置；IconCache的文本排版需要QGuiApplication）
     qputenv("QT_QPA_PLATFORM", "offscreen");
     qputenv("QT_LOGGING_RULES", "qt.qpa.gl=false");
+
+    QGuiApplication app(argc, argv);
     
     qDebug() << "===========================================";
     qDebug() << "Fangjia Core Module Tests";
@@ -984,6 +2303,25 @@ int main(int argc, char *argv[])
         runner.runAppShellTests();
         runner.runUiRootLayoutTests();
         runner.runRebuildHostBoundsTests();
+        runner.runFrameDataCommandStreamTests();
+        runner.runAtlasPackerTests();
+        runner.runDistanceFieldTests();
+        runner.runDamageTrackerTests();
+        runner.runUiRetainedTests();
+        runner.runUiLayerTests();
+        runner.runCommandCullerTests();
+        runner.runFrameProfilerTests();
+        runner.runFrameSchedulerTests();
+        runner.runFrameExchangeTests();
+        runner.runIconCacheDeferredGlTests();
+        runner.runFrameArenaTests();
+        runner.runIconCacheAsyncTests();
+        runner.runIconCacheRepackTests();
+        runner.runIconCacheBudgetTests();
+        runner.runIconCacheMaskFormatTests();
+        runner.runRasterCacheTests();
+        runner.runFrameCaptureTests();
+        runner.runShaderCacheKeyTests();
         runner.runDependencyInjectionTests();
         
         // Run domain tests